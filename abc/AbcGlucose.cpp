@@ -75,7 +75,9 @@ void glucose_solver_reset(Gluco::SimpSolver* S)
 
 int glucose_solver_addclause(Gluco::SimpSolver* S, int * plits, int nlits)
 {
-    vec<Lit> lits;
+    // the solver keeps the scratch vector, so that calls do not allocate
+    vec<Lit>& lits = S->user_lits;
+    lits.clear();
     for ( int i = 0; i < nlits; i++,plits++)
     {
         // note: Glucose uses the same var->lit conventiaon as ABC
@@ -97,7 +99,9 @@ void glucose_solver_setcallback(Gluco::SimpSolver* S, void * pman, int(*pfunc)(v
 
 int glucose_solver_solve(Gluco::SimpSolver* S, int * plits, int nlits)
 {
-    vec<Lit> lits;
+    // the solver keeps the scratch vector, so that calls do not allocate
+    vec<Lit>& lits = S->user_lits;
+    lits.clear();
     for (int i=0;i<nlits;i++,plits++)
     {
         Lit p;
@@ -342,7 +346,9 @@ void glucose_solver_stop(Gluco::Solver* S)
 
 int glucose_solver_addclause(Gluco::Solver* S, int * plits, int nlits)
 {
-    vec<Lit> lits;
+    // the solver keeps the scratch vector, so that calls do not allocate
+    vec<Lit>& lits = S->user_lits;
+    lits.clear();
     for ( int i = 0; i < nlits; i++,plits++)
     {
         // note: Glucose uses the same var->lit conventiaon as ABC
@@ -364,7 +370,9 @@ void glucose_solver_setcallback(Gluco::Solver* S, void * pman, int(*pfunc)(void*
 
 int glucose_solver_solve(Gluco::Solver* S, int * plits, int nlits)
 {
-    vec<Lit> lits;
+    // the solver keeps the scratch vector, so that calls do not allocate
+    vec<Lit>& lits = S->user_lits;
+    lits.clear();
     for (int i=0;i<nlits;i++,plits++)
     {
         Lit p;
@@ -233,6 +233,8 @@ static inline void Sat_MemRestart( Sat_Mem_t * p )
     p->iPage[1]     = 1;
     Sat_MemWriteLimit( p->pPages[0], 2 );
     Sat_MemWriteLimit( p->pPages[1], 2 );
+    p->BookMarkH[0] = p->BookMarkH[1] = 0;
+    p->BookMarkE[0] = p->BookMarkE[1] = 0;
 }
 
 /**Function*************************************************************
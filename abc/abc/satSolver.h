@@ -208,6 +208,10 @@ struct sat_solver_t
     // termination callback
     int         RunId;          // SAT id in this run
     int(*pFuncStop)(int);       // callback to terminate
+
+    // learned clause callback
+    void *      pLearntData;    // user data passed to the callback
+    void(*pFuncLearnt)(void *, lit *, lit *); // called for every learned clause
 };
 
 static inline clause * clause_read( sat_solver * s, cla h )          
@@ -345,6 +349,11 @@ static inline void sat_solver_set_stop_func( sat_solver *s, int (*fnct)(int) )
 { 
     s->pFuncStop = fnct; 
 }
+static inline void sat_solver_set_learnt_func( sat_solver *s, void * pData, void (*fnct)(void *, lit *, lit *) ) 
+{ 
+    s->pLearntData = pData; 
+    s->pFuncLearnt = fnct; 
+}
 
 static inline int sat_solver_add_const( sat_solver * pSat, int iVar, int fCompl )
 {
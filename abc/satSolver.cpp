@@ -639,8 +639,10 @@ int sat_solver_clause_new(sat_solver* s, lit* begin, lit* end, int learnt)
     assert(learnt >= 0 && learnt < 2);
     size           = end - begin;
 
-    // do not allocate memory for the two-literal problem clause
-    if ( fUseBinaryClauses && size == 2 && !learnt )
+    // do not allocate memory for the two-literal problem clause,
+    // unless it is added after a bookmark, in which case the rollback
+    // has to find it in memory to remove it
+    if ( fUseBinaryClauses && size == 2 && !learnt && s->iVarPivot == 0 )
     {
         veci_push(sat_solver_read_wlist(s,lit_neg(begin[0])),(clause_from_lit(begin[1])));
         veci_push(sat_solver_read_wlist(s,lit_neg(begin[1])),(clause_from_lit(begin[0])));
@@ -685,8 +687,10 @@ int sat_solver_clause_new(sat_solver* s, lit* begin, lit* end, int learnt)
 
     //veci_push(sat_solver_read_wlist(s,lit_neg(begin[0])),c);
     //veci_push(sat_solver_read_wlist(s,lit_neg(begin[1])),c);
-    veci_push(sat_solver_read_wlist(s,lit_neg(begin[0])),(size > 2 ? h : clause_from_lit(begin[1])));
-    veci_push(sat_solver_read_wlist(s,lit_neg(begin[1])),(size > 2 ? h : clause_from_lit(begin[0])));
+    // two-literal clauses after a bookmark are watched through their
+    // handles, so that the rollback removes their watches
+    veci_push(sat_solver_read_wlist(s,lit_neg(begin[0])),((size > 2 || s->iVarPivot) ? h : clause_from_lit(begin[1])));
+    veci_push(sat_solver_read_wlist(s,lit_neg(begin[1])),((size > 2 || s->iVarPivot) ? h : clause_from_lit(begin[0])));
 
     return h;
 }
@@ -820,6 +824,8 @@ static void sat_solver_record(sat_solver* s, veci* cls)
     assert(veci_size(cls) > 0);
     if ( h == 0 )
         veci_push( &s->unit_lits, *begin );
+    if ( s->pFuncLearnt )
+        s->pFuncLearnt( s->pLearntData, begin, end );
 
     ///////////////////////////////////
     // add clause to internal storage
@@ -1526,6 +1532,10 @@ void sat_solver_restart( sat_solver* s )
     s->stats.learnts          = 0;
     s->stats.learnts_literals = 0;
     s->stats.tot_literals     = 0;
+
+    // remove the bookmark
+    s->iVarPivot              = 0;
+    s->iTrailPivot            = 0;
 }
 
 void zsat_solver_restart_seed( sat_solver* s, double seed )
@@ -1618,8 +1628,6 @@ int sat_solver_simplify(sat_solver* s)
 
 void sat_solver_reducedb(sat_solver* s)
 {
-    static abctime TimeTotal = 0;
-    abctime clk = Abc_Clock();
     Sat_Mem_t * pMem = &s->Mem;
     int nLearnedOld = veci_size(&s->act_clas);
     int * act_clas = veci_begin(&s->act_clas);
@@ -1723,9 +1731,6 @@ void sat_solver_reducedb(sat_solver* s)
     // perform final move of the clauses
     Counter = Sat_MemCompactLearned( pMem, 1 );
     assert( Counter == (int)s->stats.learnts );
-
-    // report the results
-    TimeTotal += Abc_Clock() - clk;
 }
 
 
@@ -1734,8 +1739,6 @@ void sat_solver_rollback( sat_solver* s )
 {
     Sat_Mem_t * pMem = &s->Mem;
     int i, k, j;
-    static int Count = 0;
-    Count++;
     assert( s->iVarPivot >= 0 && s->iVarPivot <= s->size );
     assert( s->iTrailPivot >= 0 && s->iTrailPivot <= s->qtail );
     // reset implication queue
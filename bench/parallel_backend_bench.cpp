@@ -0,0 +1,115 @@
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <percy/percy.hpp>
+#include <benchmark/benchmark.h>
+#include <kitty/kitty.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Compares the throughput of the parallel synthesizers with different
+    solver backends for their workers. The first argument selects the
+    synthesizer, the second one the backend (a SolverType, or SLV_TOTAL for
+    ABC's Glucose), and the third one whether the solvers of the workers
+    are diversified. Throughput is reported as functions per second.
+*******************************************************************************/
+enum parallel_synth
+{
+    PAR_PD,
+    PAR_PD_CEGAR,
+    PAR_FENCE,
+    PAR_FENCE_CEGAR,
+    PAR_MAJ,
+};
+
+const int NR_FUNCTIONS = 8;
+
+static solver_factory backend_factory(int backend, bool diversify)
+{
+    if (backend == SLV_TOTAL) {
+        return [](int) {
+            return std::unique_ptr<solver_wrapper>(new bmcg_wrapper);
+        };
+    }
+    return make_solver_factory(SolverType(backend), diversify);
+}
+
+static void backend_args(benchmark::internal::Benchmark* b)
+{
+    std::vector<int> backends = { SLV_BSAT2, SLV_TOTAL };
+#ifdef USE_SATOKO
+    backends.push_back(SLV_SATOKO);
+#endif
+#if defined(USE_GLUCOSE) || defined(USE_SYRUP)
+    backends.push_back(SLV_GLUCOSE);
+#endif
+#ifdef USE_CMS
+    backends.push_back(SLV_CMSAT);
+#endif
+    for (int synth = PAR_PD; synth <= PAR_MAJ; synth++) {
+        for (const auto backend : backends) {
+            b->Args({ synth, backend, 0 });
+            if (backend == SLV_BSAT2 || backend == SLV_SATOKO) {
+                b->Args({ synth, backend, 1 });
+            }
+        }
+    }
+}
+
+static void parallel_synthesis(benchmark::State& state)
+{
+    const auto synth = parallel_synth(state.range(0));
+    const auto make_solver = backend_factory(int(state.range(1)),
+            state.range(2) != 0);
+    const int nr_threads = std::max(2u, std::thread::hardware_concurrency());
+    const auto dags = pd_generate_max(7);
+
+    std::vector<dynamic_truth_table> functions;
+    for (int i = 0; i < NR_FUNCTIONS; i++) {
+        dynamic_truth_table tt(4);
+        kitty::create_random(tt, i);
+        functions.push_back(tt);
+    }
+    // Majority synthesis only supports monotone functions.
+    dynamic_truth_table maj(5);
+    kitty::create_majority(maj);
+
+    for (auto _ : state) {
+        for (const auto& tt : functions) {
+            spec spec;
+            spec.add_lex_func_clauses = false;
+            spec.add_colex_clauses = false;
+            spec[0] = synth == PAR_MAJ ? maj : tt;
+            chain c;
+            mig m;
+            switch (synth) {
+            case PAR_PD:
+                pd_synthesize_parallel(spec, c, dags, nr_threads,
+                        nullptr, nullptr, make_solver);
+                break;
+            case PAR_PD_CEGAR:
+                pd_cegar_synthesize_parallel(spec, c, dags, nr_threads,
+                        nullptr, make_solver);
+                break;
+            case PAR_FENCE:
+                pf_fence_synthesize(spec, c, nr_threads,
+                        nullptr, nullptr, make_solver);
+                break;
+            case PAR_FENCE_CEGAR:
+                pf_fence_cegar_synthesize(spec, c, nr_threads,
+                        nullptr, nullptr, make_solver);
+                break;
+            case PAR_MAJ:
+                parallel_maj_synthesize(spec, m, nr_threads, make_solver);
+                break;
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * NR_FUNCTIONS);
+}
+BENCHMARK(parallel_synthesis)->Apply(backend_args)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,142 @@
+#include <cstdlib>
+#include <vector>
+#include <percy/percy.hpp>
+#include <benchmark/benchmark.h>
+#include <kitty/kitty.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Compares the simulation kernels for each supported instruction set with
+    the kitty operations that were used before, for truth tables of 7 to 16
+    variables. The first argument is the number of variables, the second
+    one the SIMD level.
+*******************************************************************************/
+static void simd_args(benchmark::internal::Benchmark* b)
+{
+    for (int nr_in = 7; nr_in <= 16; nr_in++) {
+        for (int level = SIMD_SCALAR; level <= detect_simd_level(); level++) {
+            b->Args({ nr_in, level });
+        }
+    }
+}
+
+static void kitty_args(benchmark::internal::Benchmark* b)
+{
+    for (int nr_in = 7; nr_in <= 16; nr_in++) {
+        b->Args({ nr_in });
+    }
+}
+
+static dynamic_truth_table random_tt(int nr_in)
+{
+    dynamic_truth_table tt(nr_in);
+    kitty::create_random(tt, rand());
+    return tt;
+}
+
+static void kitty_and(benchmark::State& state)
+{
+    const auto x = random_tt(state.range(0));
+    const auto y = random_tt(state.range(0));
+    dynamic_truth_table out(state.range(0));
+    for (auto _ : state) {
+        out = x & y;
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(kitty_and)->Apply(kitty_args);
+
+static void simd_and(benchmark::State& state)
+{
+    set_simd_level(simd_level(state.range(1)));
+    const auto x = random_tt(state.range(0));
+    const auto y = random_tt(state.range(0));
+    dynamic_truth_table out(state.range(0));
+    for (auto _ : state) {
+        tt_and_inv(&*x.cbegin(), &*y.cbegin(), &*out.begin(),
+                int(out.num_blocks()));
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(simd_and)->Apply(simd_args);
+
+static void kitty_maj(benchmark::State& state)
+{
+    const auto x = random_tt(state.range(0));
+    const auto y = random_tt(state.range(0));
+    const auto z = random_tt(state.range(0));
+    dynamic_truth_table out(state.range(0));
+    for (auto _ : state) {
+        out = kitty::ternary_majority(x, y, z);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(kitty_maj)->Apply(kitty_args);
+
+static void simd_maj(benchmark::State& state)
+{
+    set_simd_level(simd_level(state.range(1)));
+    const auto x = random_tt(state.range(0));
+    const auto y = random_tt(state.range(0));
+    const auto z = random_tt(state.range(0));
+    dynamic_truth_table out(state.range(0));
+    for (auto _ : state) {
+        ternary_majority_into(x, y, z, out);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(simd_maj)->Apply(simd_args);
+
+/// The tables only differ in their last bit, so the whole table is scanned.
+static void kitty_find_difference(benchmark::State& state)
+{
+    const auto x = random_tt(state.range(0));
+    auto y = x;
+    kitty::flip_bit(y, y.num_bits() - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kitty::find_first_bit_difference(x, y));
+    }
+}
+BENCHMARK(kitty_find_difference)->Apply(kitty_args);
+
+static void simd_find_difference(benchmark::State& state)
+{
+    set_simd_level(simd_level(state.range(1)));
+    const auto x = random_tt(state.range(0));
+    auto y = x;
+    kitty::flip_bit(y, y.num_bits() - 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tt_find_first_difference(&*x.cbegin(),
+                    &*y.cbegin(), int(x.num_blocks())));
+    }
+}
+BENCHMARK(simd_find_difference)->Apply(simd_args);
+
+/// Simulates a chain of 16 random AND, OR and XOR steps.
+static void chain_simulate(benchmark::State& state)
+{
+    set_simd_level(simd_level(state.range(1)));
+    const int nr_in = state.range(0);
+    const int nr_steps = 16;
+    const char* ops[] = { "8", "e", "6", "2" };
+    chain c;
+    c.reset(nr_in, 1, nr_steps, 2);
+    dynamic_truth_table op(2);
+    for (int i = 0; i < nr_steps; i++) {
+        kitty::create_from_hex_string(op, ops[rand() % 4]);
+        const auto k = 1 + rand() % (nr_in + i - 1);
+        c.set_step(i, rand() % k, k, op);
+    }
+    c.set_output(0, nr_in + nr_steps, false);
+
+    std::vector<dynamic_truth_table> fs, tts;
+    for (auto _ : state) {
+        c.simulate(fs, tts);
+        benchmark::DoNotOptimize(fs);
+    }
+}
+BENCHMARK(chain_simulate)->Apply(simd_args);
+
+BENCHMARK_MAIN();
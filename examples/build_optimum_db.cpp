@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+
+/*******************************************************************************
+    Builds a table of optimum chain sizes without a SAT solver, e.g. the
+    complete table of all four-input functions:
+
+        build_optimum_db 4 7 8 opt4.txt
+
+    or the five-input functions with chains of up to six steps:
+
+        build_optimum_db 5 6 8 opt5.txt
+
+    Every line of the output file holds a truth table in hexadecimal and
+    its optimum number of steps.
+*******************************************************************************/
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <nr_in> <max_steps> [nr_threads] "
+                "[filename]\n", argv[0]);
+        return 1;
+    }
+
+    const auto nr_in = atoi(argv[1]);
+    const auto max_steps = atoi(argv[2]);
+    const auto nr_threads = argc > 3 ? atoi(argv[3]) :
+        std::max(1, int(std::thread::hardware_concurrency()));
+    if (nr_in < 1 || nr_in > OPTDB_MAX_IN || max_steps < 1 ||
+            max_steps > OPTDB_MAX_STEPS || nr_threads < 1) {
+        fprintf(stderr, "Error: invalid arguments\n");
+        return 1;
+    }
+
+    optimum_db db(nr_in);
+    for (int k = 1; k <= max_steps && !db.is_complete(); k++) {
+        const auto begin = std::chrono::steady_clock::now();
+        const auto nr_added = db.build(k, nr_threads);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - begin).count();
+        printf("%d steps: %zu functions (%ldms)\n", k, nr_added, long(elapsed));
+    }
+    printf("%zu functions%s\n", db.size(), db.is_complete() ? " (complete)" : "");
+
+    if (argc > 4) {
+        auto fhandle = fopen(argv[4], "w");
+        if (fhandle == NULL) {
+            fprintf(stderr, "Error: unable to open %s\n", argv[4]);
+            return 1;
+        }
+        const auto nr_digits = nr_in <= 2 ? 1 : (1 << (nr_in - 2));
+        db.foreach_function([&](uint64_t tt, int nr_steps) {
+            fprintf(fhandle, "%0*llx %d\n", nr_digits,
+                    static_cast<unsigned long long>(tt), nr_steps);
+        });
+        fclose(fhandle);
+        printf("wrote %s\n", argv[4]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <percy/percy.hpp>
+
+using namespace percy;
+
+/*******************************************************************************
+    Generates a database of non-isomorphic partial DAGs, e.g. pd9.bin or
+    the fanin 3 DAGs used for majority synthesis. The search space can be
+    split into shards that are generated by independent processes:
+
+        pd_generate 9 2 5 4 0 &
+        pd_generate 9 2 5 4 1 &
+        pd_generate 9 2 5 4 2 &
+        pd_generate 9 2 5 4 3 &
+        wait
+        pd_generate 9 2 5 4 merge
+
+    An interrupted shard resumes where it stopped when it is restarted with
+    the same arguments. Without a shard argument, all shards are generated
+    in this process and merged.
+*******************************************************************************/
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <nr_vertices> <fanin> [split_level] "
+                "[nr_shards] [shard|merge] [prefix] [nr_in]\n", argv[0]);
+        return 1;
+    }
+
+    const auto nr_vertices = atoi(argv[1]);
+    const auto fanin = atoi(argv[2]);
+    const auto split_level = argc > 3 ? atoi(argv[3]) : 4;
+    const auto nr_shards = argc > 4 ? atoi(argv[4]) : 1;
+    const std::string shard = argc > 5 ? argv[5] : "all";
+    const std::string prefix = argc > 6 ? argv[6] : (fanin == 3 ? "pd3_" : "pd");
+    const auto nr_in = argc > 7 ? atoi(argv[7]) : -1;
+    if (nr_vertices < 1 || nr_vertices > MAX_STEPS || split_level < 1 ||
+            nr_shards < 1) {
+        fprintf(stderr, "Error: invalid arguments\n");
+        return 1;
+    }
+
+    const auto base = prefix + std::to_string(nr_vertices);
+    const auto filename = base + ".bin";
+    if (shard == "all" || shard == "merge") {
+        if (shard == "all") {
+            for (int i = 0; i < nr_shards; i++) {
+                printf("generating shard %d/%d\n", i + 1, nr_shards);
+                if (!pd_write_shard(fanin, nr_vertices, split_level,
+                            nr_shards, i, base.c_str(), nr_in)) {
+                    return 1;
+                }
+            }
+        }
+        if (!pd_merge_shards(base.c_str(), nr_shards, filename.c_str())) {
+            return 1;
+        }
+        printf("wrote %s\n", filename.c_str());
+    } else {
+        const auto shard_idx = atoi(shard.c_str());
+        if (shard_idx < 0 || shard_idx >= nr_shards) {
+            fprintf(stderr, "Error: invalid shard %s\n", shard.c_str());
+            return 1;
+        }
+        if (!pd_write_shard(fanin, nr_vertices, split_level, nr_shards,
+                    shard_idx, base.c_str(), nr_in)) {
+            return 1;
+        }
+        printf("completed shard %d/%d\n", shard_idx + 1, nr_shards);
+    }
+
+    return 0;
+}
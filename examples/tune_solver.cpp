@@ -0,0 +1,98 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <percy/percy.hpp>
+
+using namespace percy;
+
+/*******************************************************************************
+    Tunes the parameters of a solver backend on the formulas that an encoder
+    produces for random functions, and writes the best profile that it finds
+    to a file, which get_solver(profile) turns into a configured solver:
+
+        tune_solver bsat ssv 4 16 50 4 bsat_ssv_4.txt
+
+    A profile file that already exists is used as the starting point of the
+    search.
+*******************************************************************************/
+int main(int argc, char** argv)
+{
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <bsat|satoko> <ssv|msv|ditt|fence> <nr_in> "
+                "[nr_functions] [nr_rounds] [nr_threads] [profile_file]\n",
+                argv[0]);
+        return 1;
+    }
+
+    const std::string solver_name = argv[1];
+    const std::string encoder_name = argv[2];
+    const auto nr_in = atoi(argv[3]);
+    const auto nr_functions = argc > 4 ? atoi(argv[4]) : 16;
+    const auto nr_rounds = argc > 5 ? atoi(argv[5]) : 50;
+    const auto nr_threads = argc > 6 ? atoi(argv[6]) : 4;
+    const auto name = solver_name + "_" + encoder_name + "_" +
+        std::to_string(nr_in);
+    const std::string filename = argc > 7 ? argv[7] : name + ".txt";
+
+    SolverType type;
+    if (solver_name == "bsat") {
+        type = SLV_BSAT2;
+#ifdef USE_SATOKO
+    } else if (solver_name == "satoko") {
+        type = SLV_SATOKO;
+#endif
+    } else {
+        fprintf(stderr, "Error: unknown solver %s\n", solver_name.c_str());
+        return 1;
+    }
+
+    EncoderType enc_type;
+    if (encoder_name == "ssv") {
+        enc_type = ENC_SSV;
+    } else if (encoder_name == "msv") {
+        enc_type = ENC_MSV;
+    } else if (encoder_name == "ditt") {
+        enc_type = ENC_DITT;
+    } else if (encoder_name == "fence") {
+        enc_type = ENC_FENCE;
+    } else {
+        fprintf(stderr, "Error: unknown encoder %s\n", encoder_name.c_str());
+        return 1;
+    }
+
+    if (nr_in < 2 || nr_in > 6 || nr_functions < 1 || nr_rounds < 0 ||
+            nr_threads < 1) {
+        fprintf(stderr, "Error: invalid arguments\n");
+        return 1;
+    }
+
+    solver_profile start(type, name.c_str());
+    if (FILE* f = fopen(filename.c_str(), "r")) {
+        fclose(f);
+        if (!start.read(filename.c_str())) {
+            return 1;
+        }
+        if (start.type != type) {
+            fprintf(stderr, "Error: %s is a profile for another solver\n",
+                    filename.c_str());
+            return 1;
+        }
+        printf("starting from %s\n", filename.c_str());
+    }
+
+    printf("generating formulas\n");
+    auto instances = generate_tuning_instances(nr_in, nr_functions, enc_type);
+    printf("tuning on %d formulas\n", int(instances.size()));
+
+    solver_tuner tuner(instances);
+    tuner.verbosity = 1;
+    int64_t score;
+    const auto best = tuner.tune(start, nr_rounds, nr_threads, &score);
+    best.print();
+    if (!best.write(filename.c_str())) {
+        return 1;
+    }
+    printf("wrote %s\n", filename.c_str());
+
+    return 0;
+}
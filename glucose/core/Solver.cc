@@ -1403,6 +1403,84 @@ void Solver::relocAll(ClauseAllocator& to)
 }
 
 
+void Solver::reset()
+{
+    // Restore the state of a newly constructed solver. The vectors are
+    // cleared without freeing their memory, so that a formula of similar
+    // size can be added without reallocating.
+    ok = true;
+    cla_inc = var_inc = 1;
+    var_decay = opt_var_decay;
+    curRestart = 1;
+    qhead = 0;
+    simpDB_assigns = -1;
+    simpDB_props = 0;
+    progress_estimate = 0;
+    remove_satisfied = true;
+    conflict_budget = propagation_budget = -1;
+    asynch_interrupt = false;
+    nbVarsInitialFormula = INT32_MAX;
+    totalTime4Sat = totalTime4Unsat = 0;
+    nbSatCalls = nbUnsatCalls = 0;
+    MYFLAG = 0;
+    sumLBD = 0;
+    nbclausesbeforereduce = firstReduceDB;
+
+    nbRemovedClauses = nbReducedClauses = nbDL2 = nbBin = nbUn = nbReduceDB = 0;
+    solves = starts = decisions = rnd_decisions = propagations = conflicts = 0;
+    conflictsRestarts = nbstopsrestarts = nbstopsrestartssame = lastblockatrestart = 0;
+    dec_vars = clauses_literals = learnts_literals = max_literals = tot_literals = 0;
+
+    model.clear();
+    conflict.clear();
+    activity.clear();
+    watches.clear(false);
+    watchesBin.clear(false);
+    clauses.clear();
+    learnts.clear();
+    assigns.clear();
+    polarity.clear();
+    decision.clear();
+    trail.clear();
+    nbpos.clear();
+    trail_lim.clear();
+    vardata.clear();
+    assumptions.clear();
+    order_heap.clear();
+    permDiff.clear();
+#ifdef UPDATEVARACTIVITY
+    lastDecisionLevel.clear();
+#endif
+    ca.clear();
+    lbdQueue.clear();
+    lbdQueue.initSize(sizeLBDQueue);
+    trailQueue.clear();
+    trailQueue.initSize(sizeTrailQueue);
+    seen.clear();
+    analyze_stack.clear();
+    analyze_toclear.clear();
+    add_tmp.clear();
+    assumptionPositions.clear();
+    initialPositions.clear();
+}
+
+
+void Solver::reserve(int nvars, int nclauses)
+{
+    activity.capacity(nvars);
+    assigns.capacity(nvars);
+    polarity.capacity(nvars);
+    decision.capacity(nvars);
+    trail.capacity(nvars);
+    vardata.capacity(nvars);
+    permDiff.capacity(nvars);
+    seen.capacity(nvars);
+    clauses.capacity(nclauses);
+    // Estimate three literals and a header per clause.
+    ca.reserve(ca.size() + 4 * nclauses);
+}
+
+
 void Solver::garbageCollect()
 {
     // Initialize the next region to a size corresponding to the estimated utilization degree. This
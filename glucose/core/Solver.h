@@ -90,6 +90,9 @@ public:
     // 
     void    setPolarity    (Var v, bool b); // Declare which polarity the decision heuristic should use for a variable. Requires mode 'polarity_user'.
     void    setDecisionVar (Var v, bool b); // Declare if a variable should be eligible for selection in the decision heuristic.
+    bool    getPolarity    (Var v) const;   // The polarity that the decision heuristic uses for a variable.
+    double  varActivity    (Var v) const;   // The activity of a variable.
+    void    bumpVarActivity(Var v, double nbumps); // Raise the activity of a variable as if it had been bumped 'nbumps' times.
 
     // Read state:
     //
@@ -118,6 +121,8 @@ public:
 
     // Memory managment:
     //
+    void    reset();              // Removes all variables and clauses, but keeps the allocated memory.
+    void    reserve(int nvars, int nclauses); // Allocates room for the given number of variables and clauses.
     virtual void garbageCollect();
     void    checkGarbage(double gf);
     void    checkGarbage();
@@ -404,6 +409,9 @@ inline int      Solver::nLearnts      ()      const   { return learnts.size(); }
 inline int      Solver::nVars         ()      const   { return vardata.size(); }
 inline int      Solver::nFreeVars     ()      const   { return (int)dec_vars - (trail_lim.size() == 0 ? trail.size() : trail_lim[0]); }
 inline void     Solver::setPolarity   (Var v, bool b) { polarity[v] = b; }
+inline bool     Solver::getPolarity   (Var v) const { return polarity[v]; }
+inline double   Solver::varActivity   (Var v) const { return activity[v]; }
+inline void     Solver::bumpVarActivity(Var v, double nbumps) { varBumpActivity(v, nbumps * var_inc); }
 inline void     Solver::setDecisionVar(Var v, bool b) 
 { 
     if      ( b && !decision[v]) dec_vars++;
@@ -58,6 +58,8 @@ class RegionAllocator
 
     Ref      alloc     (int size); 
     void     free      (int size)    { wasted_ += size; }
+    void     clear     ()            { sz = 0; wasted_ = 0; } // Keeps the memory for reuse.
+    void     reserve   (uint32_t min_cap) { capacity(min_cap); }
 
     // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
     T&       operator[](Ref r)       { assert(r >= 0 && r < sz); return memory[r]; }
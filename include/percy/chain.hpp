@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <memory>
@@ -8,6 +9,7 @@
 #include "dag.hpp"
 #include "spec.hpp"
 #include "misc.hpp"
+#include "tt_utils.hpp"
 
 /*******************************************************************************
     Definition of Boolean chain. A Boolean chain is a sequence of steps. Each
@@ -19,6 +21,35 @@ namespace percy
 	using kitty::dynamic_truth_table;
 	using kitty::create_nth_var;
 
+    /***************************************************************************
+        A read-only view of the fanins of a chain step. The fanins of all
+        steps are stored contiguously in the chain, so the view is only
+        valid until the chain is modified.
+    ***************************************************************************/
+    class step_view
+    {
+        private:
+            const int* fanins;
+            int nr_fanins;
+
+        public:
+            step_view(const int* fanins, int nr_fanins) :
+                fanins(fanins), nr_fanins(nr_fanins)
+            {
+            }
+
+            int size() const { return nr_fanins; }
+            const int* begin() const { return fanins; }
+            const int* end() const { return fanins + nr_fanins; }
+            int operator[](int i) const { return fanins[i]; }
+
+            int at(int i) const
+            {
+                assert(i >= 0 && i < nr_fanins);
+                return fanins[i];
+            }
+    };
+
     class chain
     {
         private:
@@ -26,28 +57,37 @@ namespace percy
             int fanin;
             int op_tt_size; // The truth table size of operands in the chain (depends on fanin)
             std::vector<dynamic_truth_table> compiled_functions;
-            std::vector<std::vector<int>> steps;
-            std::vector<dynamic_truth_table> operators;
+            std::vector<int> steps; // The fanins of step i start at i * fanin
+            std::vector<uint32_t> operators; // Operator truth tables, one word per step
             std::vector<int> outputs;
 
-        public:
-            chain() 
-            { 
-                reset(0, 0, 0, 0);
+            static uint32_t op_word(const dynamic_truth_table& op)
+            {
+                assert(op.num_vars() <= MAX_FANIN);
+                return static_cast<uint32_t>(*op.cbegin());
             }
-            chain(const chain& c) 
+
+            /// The mask of the operator bits that are in use.
+            uint32_t op_mask() const
             {
-                copy(c);
+                return op_tt_size >= 32 ? ~0u : ((1u << op_tt_size) - 1);
             }
 
-            /*
-            chain(chain&& c)
+            void add_step_word(const int* const in, uint32_t op)
             {
-                vertices = std::move(c.vertices);
-                operators = std::move(c.operators);
-                outputs = std::move(c.outputs);
+                steps.insert(steps.end(), in, in + fanin);
+                operators.push_back(op);
+            }
+
+        public:
+            chain() 
+            { 
+                reset(0, 0, 0, 0);
             }
-            */
+            chain(const chain& c) = default;
+            chain(chain&& c) noexcept = default;
+            chain& operator=(const chain& c) = default;
+            chain& operator=(chain&& c) noexcept = default;
 
             void reset(int nr_in, int nr_out, int nr_steps, int fanin)
             {
@@ -57,28 +97,57 @@ namespace percy
                 this->nr_in = nr_in;
                 this->fanin = fanin;
                 this->op_tt_size = (1 << fanin);
-                steps.resize(nr_steps);
-                for (auto& step : steps) {
-                    step.resize(fanin);
-                }
+                steps.resize(nr_steps * fanin);
                 operators.resize(nr_steps);
                 outputs.resize(nr_out);
             }
 
             int get_fanin() const { return fanin; }
-            int get_nr_steps() const { return steps.size(); }
+            int get_nr_steps() const { return operators.size(); }
             int get_nr_inputs() const { return nr_in; }
             int get_nr_outputs() const { return outputs.size(); }
-            const std::vector<int>& get_step(int i) const { return steps[i]; }
             const std::vector<int>& get_outputs() const { return outputs; }
 
-            const dynamic_truth_table& get_operator(int i) const
+            step_view get_step(int i) const
+            {
+                return step_view(steps.data() + i * fanin, fanin);
+            }
+
+            dynamic_truth_table get_operator(int i) const
+            {
+                dynamic_truth_table op(fanin);
+                *op.begin() = operators.at(i);
+                return op;
+            }
+
+            /// Returns the truth table of the operator of step i as a word,
+            /// in which bit j is the value for fanin assignment j.
+            uint32_t get_operator_word(int i) const
             {
-              return operators.at(i);
+                return operators[i];
             }
 
             std::vector<int>& get_outputs() { return outputs; }
 
+            /// Returns a hash of the steps and outputs of the chain, and of
+            /// its operators unless with_operators is false.
+            std::size_t hash(bool with_operators = true) const
+            {
+                auto seed = kitty::hash_block((uint64_t(nr_in) << 32) | fanin);
+                for (const auto in : steps) {
+                    kitty::hash_combine(seed, kitty::hash_block(in));
+                }
+                if (with_operators) {
+                    for (const auto op : operators) {
+                        kitty::hash_combine(seed, kitty::hash_block(op));
+                    }
+                }
+                for (const auto out : outputs) {
+                    kitty::hash_combine(seed, kitty::hash_block(out));
+                }
+                return seed;
+            }
+
             bool
             is_output_inverted(int out_idx)
             {
@@ -94,48 +163,36 @@ namespace percy
             set_step(int i, const int* const in, const dynamic_truth_table& op)
             {
                 for (int j = 0; j < fanin; j++) {
-                    steps[i][j] = in[j];
+                    steps[i * fanin + j] = in[j];
                 }
-                operators[i] = op;
+                operators[i] = op_word(op);
             }
 
             void
             set_step(int i, int fanin1, int fanin2, const dynamic_truth_table& op)
             {
-                steps[i][0] = fanin1;
-                steps[i][1] = fanin2;
-                operators[i] = op;
+                assert(fanin == 2);
+                steps[i * fanin] = fanin1;
+                steps[i * fanin + 1] = fanin2;
+                operators[i] = op_word(op);
             }
 
             void
             set_step(int i, const std::vector<int>& in, const dynamic_truth_table& op)
             {
-                for (int j = 0; j < fanin; j++) {
-                    steps[i][j] = in[j];
-                }
-                operators[i] = op;
+                set_step(i, in.data(), op);
             }
 
             void
             add_step(const int* const in, const dynamic_truth_table& op)
             {
-                std::vector<int> step(fanin);
-                for (int j = 0; j < fanin; j++) {
-                    step[j] = in[j];
-                }
-                steps.push_back(step);
-                operators.push_back(op);
+                add_step_word(in, op_word(op));
             }
 
             void
             add_step(const std::vector<int>& in, const dynamic_truth_table& op)
             {
-                std::vector<int> step(fanin);
-                for (int j = 0; j < fanin; j++) {
-                    step[j] = in[j];
-                }
-                steps.push_back(step);
-                operators.push_back(op);
+                add_step_word(in.data(), op_word(op));
             }
 
             void
@@ -166,28 +223,24 @@ namespace percy
             void denormalize()
             {
                 // Does nothing if there are no steps to push inverters into.
-                if (steps.size() == 0) {
+                if (operators.size() == 0) {
                     return;
                 }
                 
                 if (outputs.size() == 1) {
                     if (outputs[0] & 1) {
-                        operators[steps.size() - 1] = ~operators[steps.size() - 1];
+                        operators.back() ^= op_mask();
                         outputs[0] = (outputs[0] ^ 1);
                     }
                     return;
                 }
 
-                std::vector<int> refcount(steps.size());
-                std::vector<dynamic_truth_table> tmps(steps.size());
-                std::vector<dynamic_truth_table> ins;
-                std::vector<dynamic_truth_table> fs(outputs.size());
+                std::vector<int> refcount(get_nr_steps());
 
-                for (auto i = 1u; i < steps.size(); i++) {
-                    const auto& v = steps[i];
-                    for (const auto fid : v) {
-                        if (fid > nr_in) {
-                            refcount[fid - nr_in - 1]++;
+                for (auto i = 1; i < get_nr_steps(); i++) {
+                    for (const auto fid : get_step(i)) {
+                        if (fid >= nr_in) {
+                            refcount[fid - nr_in]++;
                         }
                     }
                 }
@@ -203,53 +256,13 @@ namespace percy
                     assert(count > 0);
                 }
 
-                for (auto i = 0; i < nr_in; ++i) {
-                    auto in_tt = kitty::create<dynamic_truth_table>(nr_in);
-                    ins.push_back(in_tt);
-                }
-
-                auto tt_step = kitty::create<dynamic_truth_table>(nr_in);
-                auto tt_compute = kitty::create<dynamic_truth_table>(nr_in);
-                
-                for (auto i = 0u; i < steps.size(); i++) {
-                    const auto& step = steps[i];
+                // Keep only the truth tables of the steps.
+                std::vector<dynamic_truth_table> fs;
+                std::vector<dynamic_truth_table> tmps;
+                simulate(fs, tmps);
+                tmps.erase(tmps.begin(),
+                        tmps.begin() + nr_in + compiled_functions.size());
 
-                    for (int j = 0; j < fanin; j++) {
-                        const auto fanin = step[j];
-                        if (fanin < nr_in) {
-                            create_nth_var(ins[j], fanin);
-                        } else {
-                            ins[j] = tmps[fanin - nr_in];
-                        }
-                    }
-
-                    kitty::clear(tt_step);
-                    for (int j = 1; j < op_tt_size; j++) {
-                        kitty::clear(tt_compute);
-                        tt_compute = ~tt_compute;
-                        if (get_bit(operators[i], j)) {
-                            for (int k = 0; k < fanin; k++) {
-                                if ((j >> k) & 1) {
-                                    tt_compute &= ins[k];
-                                } else {
-                                    tt_compute &= ~ins[k];
-                                }
-                            }
-                            tt_step |= tt_compute;
-                        }
-                    }
-                    tmps[i] = tt_step;
-
-                    for (auto h = 0u; h < outputs.size(); h++) {
-                        const auto out = static_cast<unsigned>(outputs[h]);
-                        const auto var = out >> 1u;
-                        const auto inv = out & 1u;
-                        if (var - nr_in - 1u == i) {
-                            fs[h] = inv ? ~tt_step : tt_step;
-                        }
-                    }
-                }
-                
                 for (auto i = 0u; i < outputs.size(); i++) {
                     auto step_idx = outputs[i] >> 1;
                     const auto invert = outputs[i] & 1;
@@ -261,14 +274,15 @@ namespace percy
                     step_idx -= (nr_in + 1);
                     assert(refcount[step_idx] >= 1);
                     if (refcount[step_idx] == 1) {
-                        operators[step_idx] = ~operators[step_idx];
+                        operators[step_idx] ^= op_mask();
+                        outputs[i] ^= 1;
                     } else {
                         // This output points to a shared step that needs to
                         // be inverted. If no inverted version of this step
                         // exists somewhere in the chain, we need to add a new
                         // step.
                         bool inv_step_found = false;
-                        for (auto j = 0u; j < steps.size(); j++) {
+                        for (auto j = 0u; j < operators.size(); j++) {
                             if (tmps[j] == fs[i]) {
                                 set_output(i, j + nr_in + 1, false);
                                 inv_step_found = true;
@@ -277,14 +291,12 @@ namespace percy
                         if (inv_step_found) {
                             continue;
                         }
-                        std::vector<int> fanins(fanin);
-                        const auto& v = steps[step_idx];
-                        for (int j = 0; j < fanin; j++) {
-                            fanins[j] = v[j];
-                        };
-
-                        add_step(fanins, ~operators[step_idx]);
-                        set_output(i, nr_in + steps.size(), false);
+                        int fanins[MAX_FANIN];
+                        const auto v = get_step(step_idx);
+                        std::copy(v.begin(), v.end(), fanins);
+
+                        add_step_word(fanins, operators[step_idx] ^ op_mask());
+                        set_output(i, nr_in + get_nr_steps(), false);
                         tmps.push_back(fs[i]);
 
                         refcount[step_idx]--;
@@ -297,93 +309,71 @@ namespace percy
             *******************************************************************/
             std::vector<dynamic_truth_table> simulate() const
             {
-                std::vector<dynamic_truth_table> fs(outputs.size());
-                std::vector<dynamic_truth_table> tmps(steps.size());
-                std::vector<dynamic_truth_table> ins;
+                std::vector<dynamic_truth_table> fs;
+                std::vector<dynamic_truth_table> tts;
+                simulate(fs, tts);
+                return fs;
+            }
 
-                for ( auto i = 0; i < nr_in; ++i ) {
-                    ins.push_back( kitty::create<dynamic_truth_table>( nr_in ) );
+            /*******************************************************************
+                Same as above, but simulates into storage owned by the
+                caller, which is only allocated on the first call. Afterwards
+                tts holds the truth tables of the inputs, the compiled
+                functions and the steps, in that order, and fs holds those
+                of the outputs. TT is a dynamic_truth_table or a
+                static_truth_table with nr_in variables. Since the number of
+                words of a static truth table is known at compile time, the
+                latter is fastest when verifying many small chains.
+            *******************************************************************/
+            template<typename TT>
+            void simulate(std::vector<TT>& fs, std::vector<TT>& tts) const
+            {
+                const auto nr_compiled = static_cast<int>(compiled_functions.size());
+                const auto nr_tts = nr_in + nr_compiled + get_nr_steps();
+                if (static_cast<int>(tts.size()) != nr_tts ||
+                        (nr_tts > 0 && tts[0].num_vars() != nr_in)) {
+                    tts.assign(nr_tts, kitty::create<TT>(nr_in));
                 }
-
-                auto tt_step = kitty::create<dynamic_truth_table>(nr_in);
-                auto tt_compute = kitty::create<dynamic_truth_table>(nr_in);
-
-                // Some outputs may be simple constants or projections.
-                for (auto h = 0u; h < outputs.size(); h++)
-                {
-                    const auto out = outputs[h];
-                    const auto var = out >> 1;
-                    const auto inv = out & 1;
-                    if (var == 0) {
-                        clear(tt_step);
-                        fs[h] = inv ? ~tt_step : tt_step;
-                    } else if (var <= nr_in) {
-                        create_nth_var(tt_step, var-1, inv);
-                        fs[h] = tt_step;
-                    }
+                if (fs.size() != outputs.size() ||
+                        (fs.size() > 0 && fs[0].num_vars() != nr_in)) {
+                    fs.assign(outputs.size(), kitty::create<TT>(nr_in));
                 }
 
-                for (auto i = 0u; i < steps.size(); i++) {
-                  const auto& step = steps[i];
+                for (int i = 0; i < nr_in; i++) {
+                    create_nth_var(tts[i], i);
+                }
+                for (int i = 0; i < nr_compiled; i++) {
+                    std::copy(compiled_functions[i].cbegin(),
+                            compiled_functions[i].cend(),
+                            tts[nr_in + i].begin());
+                }
 
-                  for ( int j = 0; j < fanin; ++j )
-                  {
-                    const auto fanin = step[j];
-                    // std::cout << fanin << ' ';
-                    if ( fanin < nr_in )
-                    {
-                      create_nth_var(ins[j], fanin);
-                    }
-                    else if ( fanin < nr_in + compiled_functions.size() )
-                    {
-                      ins[j] = compiled_functions.at( fanin - nr_in );
-                    }
-                    else
-                    {
-                      ins[j] = tmps[fanin - nr_in - compiled_functions.size()];
+                const int nr_words = tts.size() > 0 ? tts[0].num_blocks() : 1;
+                const uint64_t* ins[MAX_FANIN];
+                for (int i = 0; i < get_nr_steps(); i++) {
+                    const auto step = get_step(i);
+                    for (int j = 0; j < fanin; j++) {
+                        ins[j] = &*tts[step[j]].cbegin();
                     }
-                    // kitty::print_binary( ins[j] );
-                    // std::cout << std::endl;
-                  }
+                    auto& tt_step = tts[nr_in + nr_compiled + i];
+                    apply_op(operators[i], ins, fanin, &*tt_step.begin(), nr_words);
+                    tt_step.mask_bits();
+                }
 
-                  kitty::clear(tt_step);
-                  for ( int j = 0; j < op_tt_size; ++j )
-                  {
-                    kitty::clear(tt_compute);
-                    tt_compute = ~tt_compute;
-                    if ( get_bit( operators[i], j ) )
-                    {
-                      for ( int k = 0; k < fanin; ++k)
-                      {
-                        if ((j >> k) & 1)
-                        {
-                          tt_compute &= ins[k];
-                        }
-                        else
-                        {
-                          tt_compute &= ~ins[k];
-                        }
-                      }
-                      tt_step |= tt_compute;
+                for (auto h = 0u; h < outputs.size(); h++) {
+                    const auto var = outputs[h] >> 1;
+                    const auto inv = outputs[h] & 1;
+                    if (var == 0) {
+                        clear(fs[h]);
+                    } else {
+                        fs[h] = tts[var - 1];
                     }
-                  }
-                  // std::cout << "step = ";
-                  // kitty::print_binary( tt_step );
-                  // std::cout << std::endl;
-                  tmps[i] = tt_step;
-
-                  for ( auto h = 0u; h < outputs.size(); ++h )
-                  {
-                    const auto out = outputs[h];
-                    const auto var = out >> 1;
-                    const auto inv = out & 1;
-                    if (var - nr_in - compiled_functions.size() - 1 == static_cast<int>(i)) {
-                      fs[h] = inv ? ~tt_step : tt_step;
+                    if (inv) {
+                        std::transform(fs[h].cbegin(), fs[h].cend(),
+                                fs[h].begin(), [](uint64_t w) { return ~w; });
+                        fs[h].mask_bits();
                     }
-                  }
                 }
-
-                return fs;
             }
 
 
@@ -402,11 +392,9 @@ namespace percy
                 auto tts = simulate();
                 dynamic_truth_table op_tt(fanin);
 
-                for (auto& step : steps) {
-                    if (step.size() != static_cast<unsigned>(spec.fanin)) {
-                        assert(false);
-                        return false;
-                    }
+                if (fanin != spec.fanin) {
+                    assert(false);
+                    return false;
                 }
 
                 auto nr_nontriv = 0;
@@ -422,15 +410,14 @@ namespace percy
 
                 if (spec.add_nontriv_clauses) {
                     // Ensure that there are no trivial operators.
-                    for (auto& op : operators) {
-                        clear(op_tt);
-                        if (op == op_tt) {
+                    for (const auto op : operators) {
+                        if (op == 0) {
                             assert(false);
                             return false;
                         }
                         for (int i = 0; i < fanin; i++) {
                             create_nth_var(op_tt, i);
-                            if (op == op_tt) {
+                            if (op == op_word(op_tt)) {
                                 assert(false);
                                 return false;
                             }
@@ -441,12 +428,11 @@ namespace percy
                 if ( spec.add_alonce_clauses )
                 {
                   /* Ensure that each step is used at least once. */
-                  std::vector<int32_t> nr_uses( steps.size() );
+                  std::vector<int32_t> nr_uses( get_nr_steps() );
 
-                  for ( auto i = 0u; i < steps.size(); ++i )
+                  for ( auto i = 0; i < get_nr_steps(); ++i )
                   {
-                    auto const& step = steps[i];
-                    for ( const auto& fid : step )
+                    for ( const auto fid : get_step( i ) )
                     {
                       if ( fid >= nr_in + compiled_functions.size() )
                       {
@@ -476,10 +462,10 @@ namespace percy
 
                 if (spec.add_noreapply_clauses) {
                     // Ensure there is no re-application of operands.
-                    for (auto i = 0u; i < steps.size() - 1; i++) {
-                        const auto & fanins1 = steps[i];
-                        for (auto ip = i + 1; ip < steps.size(); ip++) {
-                            const auto& fanins2 = steps[ip];
+                    for (auto i = 0u; i + 1 < operators.size(); i++) {
+                        const auto fanins1 = get_step(i);
+                        for (auto ip = i + 1; ip < operators.size(); ip++) {
+                            const auto fanins2 = get_step(ip);
 
                             auto is_subsumed = true;
                             auto has_fanin_i = false;
@@ -509,10 +495,10 @@ namespace percy
                 if (spec.add_colex_clauses) {
                     // Ensure that steps are in co-lexicographical order.
                     for (int i = 0; i < spec.nr_steps - 1; i++) {
-                        const auto& v1 = steps[i];
-                        const auto& v2 = steps[i + 1];
+                        const auto v1 = get_step(i);
+                        const auto v2 = get_step(i + 1);
                         
-                        if (colex_compare(v1, v2) == 1) {
+                        if (colex_compare(v1.begin(), v2.begin(), fanin) == 1) {
                             assert(false);
                             return false;
                         }
@@ -522,10 +508,10 @@ namespace percy
                 if (spec.add_lex_clauses) {
                     // Ensure that steps are in lexicographical order.
                     for (int i = 0; i < spec.nr_steps - 1; i++) {
-                        const auto& v1 = steps[i];
-                        const auto& v2 = steps[i + 1];
+                        const auto v1 = get_step(i);
+                        const auto v2 = get_step(i + 1);
                         
-                        if (lex_compare(v1, v2) == 1) {
+                        if (lex_compare(v1.begin(), v2.begin(), fanin) == 1) {
                             assert(false);
                             return false;
                         }
@@ -535,14 +521,14 @@ namespace percy
                 if (spec.add_lex_func_clauses) {
                     // Ensure that step operators are in lexicographical order.
                     for (int i = 0; i < spec.nr_steps - 1; i++) {
-                        const auto& v1 = steps[i];
-                        const auto& v2 = steps[i + 1];
+                        const auto v1 = get_step(i);
+                        const auto v2 = get_step(i + 1);
 
-                        if (colex_compare(v1, v2) == 0) {
+                        if (colex_compare(v1.begin(), v2.begin(), fanin) == 0) {
                             // The operator of step i must be lexicographically
                             // less than that of i + 1.
-                            const auto& op1 = operators[i];
-                            const auto& op2 = operators[i + 1];
+                            const auto op1 = operators[i];
+                            const auto op2 = operators[i + 1];
                             if (op2 < op1) {
                                 assert(false);
                                 return false;
@@ -567,7 +553,7 @@ namespace percy
                                 continue;
                             }
                             for (int i = 1; i < spec.nr_steps; i++) {
-                                const auto& v1 = steps[i];
+                                const auto v1 = get_step(i);
                                 auto has_fanin_p = false;
                                 auto has_fanin_q = false;
 
@@ -584,7 +570,7 @@ namespace percy
                                 }
                                 auto p_in_prev_step = false;
                                 for (int ip = 0; ip < i; ip++) {
-                                    const auto& v2 = steps[ip];
+                                    const auto v2 = get_step(ip);
                                     has_fanin_p = false;
 
                                     for (const auto fid : v2) {
@@ -620,8 +606,9 @@ namespace percy
                 const auto tt2 = ~in1 & in2;
                 const auto tt3 = in1 & ~in2;
                 const auto tt4 = in1 | in2;
-                for (const auto& op : operators) {
-                    if (op != tt1 && op != tt2 && op != tt3 && op != tt4) {
+                for (const auto op : operators) {
+                    if (op != op_word(tt1) && op != op_word(tt2) &&
+                            op != op_word(tt3) && op != op_word(tt4)) {
                         return false;
                     }
                 }
@@ -636,8 +623,8 @@ namespace percy
                 kitty::dynamic_truth_table maj_tt(3);
                 kitty::create_majority(maj_tt);
 
-                for (const auto& op : operators) {
-                    if (op != maj_tt) {
+                for (const auto op : operators) {
+                    if (op != op_word(maj_tt)) {
                         return false;
                     }
                 }
@@ -650,6 +637,7 @@ namespace percy
                 nr_in = c.nr_in;
                 fanin = c.fanin;
                 op_tt_size = c.op_tt_size;
+                compiled_functions = c.compiled_functions;
                 steps = c.steps;
                 operators = c.operators;
                 outputs = c.outputs;
@@ -672,11 +660,11 @@ namespace percy
                 }
 
                 s << "node [shape=circle];\n";
-                for (size_t i = 0; i < steps.size(); i++) {
-                    const auto& step = steps[i];
+                for (size_t i = 0; i < operators.size(); i++) {
+                    const auto step = get_step(i);
                     const auto idx = nr_in + i + 1;
                     s << "x" << idx << " [label=<";
-                    kitty::print_binary(operators[i], s);
+                    kitty::print_binary(get_operator(i), s);
                     s << ">];\n";
                     for (int j = 0; j < fanin; j++) {
                         s << "x" << step[j]+1 << " -- x" << idx << ";\n";
@@ -740,13 +728,8 @@ namespace percy
                     s << char(('a' + step_idx));
                     return;
                 }
-                const auto& step = steps[step_idx - nr_in];
-                auto word = 0;
-                for (int i = 0; i < 4; i++) {
-                    if (kitty::get_bit(operators[step_idx - nr_in], i)) {
-                        word |= (1 << i);
-                    }
-                }
+                const auto step = get_step(step_idx - nr_in);
+                const auto word = operators[step_idx - nr_in];
                 assert(word <= 15);
                 switch (word) {
                     case 2:
@@ -783,7 +766,7 @@ namespace percy
                         break;
                     default:
                         // Invalid operator detected.
-                        printf("Invalid operator %d\n", word);
+                        printf("Invalid operator %u\n", word);
                         assert(0);
                         break;
                 }
@@ -819,7 +802,7 @@ namespace percy
                     s << char(('a' + step_idx));
                     return;
                 }
-                const auto& step = get_step(step_idx - nr_in);
+                const auto step = get_step(step_idx - nr_in);
                 s << "<";
                 step_to_mag_expression(s, step[0]);
                 step_to_mag_expression(s, step[1]);
@@ -841,7 +824,7 @@ namespace percy
 
             void print_mag()
             {
-                std::cout << steps.size() << "-step MAJ chain\n";
+                std::cout << get_nr_steps() << "-step MAJ chain\n";
                 to_mag_expression(std::cout);
                 std::cout << "\n";
             }
@@ -11,10 +11,14 @@ namespace percy
     {
     private:
         std::vector<std::vector<int>> clauses;
-        int _nr_vars;
+        int _nr_vars = 0;
+        int book_vars = 0;
+        std::size_t book_clauses = 0;
 
     public:
-        void restart() { _nr_vars = 0;  clauses.clear(); }
+        void restart() { _nr_vars = 0;  clauses.clear(); book_vars = 0; book_clauses = 0; }
+        bool bookmark() { book_vars = _nr_vars; book_clauses = clauses.size(); return true; }
+        void rollback() { _nr_vars = book_vars; clauses.resize(book_clauses); }
         void clear() { restart(); };
         int nr_vars() { return _nr_vars; }
         int nr_clauses() { return clauses.size(); }
@@ -38,6 +42,23 @@ namespace percy
             return 1;
         }
 
+        /// Adds the formula to a solver, with its clauses in the given
+        /// order if there is one. Returns false if the solver finds the
+        /// formula to be unsatisfiable while adding it.
+        bool add_to(solver_wrapper& solver,
+                const std::vector<int>* order = nullptr) const
+        {
+            solver.set_nr_vars(_nr_vars);
+            for (std::size_t i = 0; i < clauses.size(); i++) {
+                auto& clause = clauses[order ? (*order)[i] : i];
+                auto lits = const_cast<int*>(clause.data());
+                if (!solver.add_clause(lits, lits + clause.size())) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
         void to_dimacs(FILE* f) 
         {
             fprintf(f, "p cnf %d %d\n", nr_vars(), nr_clauses());
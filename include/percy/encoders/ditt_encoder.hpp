@@ -1121,7 +1121,7 @@ namespace percy
                     }
                 }
                 
-                return solver->add_clause(
+                return add_blocking_clause(solver,
                             pabc::Vec_IntArray(vLits), 
                             pabc::Vec_IntArray(vLits) + ctr);
             }
@@ -1148,7 +1148,7 @@ namespace percy
                     }
                 }
 
-                return solver->add_clause(
+                return add_blocking_clause(solver,
                             pabc::Vec_IntArray(vLits), 
                             pabc::Vec_IntArray(vLits) + ctr);
             }
@@ -1156,47 +1156,33 @@ namespace percy
             int simulate(const spec& spec)
             {
                 std::vector<int> fanins(spec.fanin);
-                auto tt_comp = kitty::create<dynamic_truth_table>(spec.nr_in);
+                std::vector<const uint64_t*> fanin_words(spec.fanin);
 
                 for (int i = 0; i < spec.nr_steps; i++) {
                     find_fanin(i, fanins, spec);
 
-                    kitty::clear(sim_tts[spec.nr_in + i]);
+                    uint32_t op = 0;
                     for (int j = 1; j <= nr_op_vars_per_step; j++) {
-                        kitty::clear(tt_comp);
-                        tt_comp = ~tt_comp;
                         if (solver->var_value(get_op_var(spec, i, j))) {
-                            //printf("op[%d][%d]=1\n", i, j);
-                            for (int k = 0; k < spec.fanin; k++) {
-                                if ((j >> k) & 1) {
-                                    tt_comp &= sim_tts[fanins[k]];
-                                } else {
-                                    tt_comp &= ~sim_tts[fanins[k]];
-                                }
-                            }
-                            sim_tts[spec.nr_in + i] |= tt_comp;
-                        /*} else {
-                            printf("op[%d][%d]=0\n", i, j);*/
+                            op |= (1u << j);
                         }
                     }
-
-                    /*
-                    printf("tt[%d]: ", i);
-                    kitty::print_binary(sim_tts[spec.nr_in + i]);
-                    std::cout << std::endl;
-    */
+                    for (int k = 0; k < spec.fanin; k++) {
+                        fanin_words[k] = &*sim_tts[fanins[k]].cbegin();
+                    }
+                    auto& tt_step = sim_tts[spec.nr_in + i];
+                    apply_op(op, fanin_words.data(), spec.fanin,
+                            &*tt_step.begin(), int(tt_step.num_blocks()));
                 }
 
-                /*
-                std::cout << "sim tt: ";
-                kitty::print_binary(sim_tts[spec.nr_in + spec.nr_steps - 1]);
-                std::cout << std::endl;
-                std::cout << "spc tt: ";
-                kitty::print_binary(spec[0]);
-                std::cout << std::endl;
-                */
-
-                const auto iMint = kitty::find_first_bit_difference(sim_tts[spec.nr_in + spec.nr_steps - 1], spec.out_inv ? ~spec[0] : spec[0]);
+                const auto& tt_out = sim_tts[spec.nr_in + spec.nr_steps - 1];
+                const auto nr_bits = int64_t(1) << spec.nr_in;
+                const uint64_t last_mask = nr_bits >= 64 ? ~uint64_t(0) :
+                    ((uint64_t(1) << nr_bits) - 1);
+                const auto iMint = int(tt_find_first_difference(
+                            &*tt_out.cbegin(), &*spec[0].cbegin(),
+                            int(tt_out.num_blocks()), nullptr,
+                            spec.out_inv ? ~uint64_t(0) : 0, last_mask));
                 assert(iMint > 0 || iMint == -1);
                 return iMint;
             }
@@ -4,6 +4,7 @@
 #include <kitty/kitty.hpp>
 #include <abc/vecWec.h>
 #include "encoder.hpp"
+#include "../tt_utils.hpp"
 
 namespace percy
 {
@@ -338,7 +339,7 @@ namespace percy
             for (int i = spec.nr_in; i < spec.nr_in + spec.nr_steps; i++) {
                 for (int k = 0; k < 3; k++)
                     pFanins[k] = &sim_tts[find_fanin(spec, i, k)];
-                sim_tts[i] = kitty::ternary_majority(*pFanins[0], *pFanins[1], *pFanins[2]);
+                ternary_majority_into(*pFanins[0], *pFanins[1], *pFanins[2], sim_tts[i]);
             }
             /*
             const auto iMint =
@@ -3,6 +3,7 @@
 #include <bitset>
 #include "../spec.hpp"
 #include "../misc.hpp"
+#include "../tt_simd.hpp"
 #include "../sat_circuits.hpp"
 
 #pragma GCC diagnostic push
@@ -12,6 +13,24 @@
 
 namespace percy
 {
+    /// The parts that variables play in an encoding, which related
+    /// encodings have in common.
+    enum VarRole
+    {
+        ROLE_SEL,
+        ROLE_OP,
+        ROLE_OUT,
+        ROLE_SIM,
+    };
+
+    /// Identifies a variable by its part, the step it belongs to, and its
+    /// index among the variables of that part and step.
+    static inline int64_t
+    make_var_role(VarRole role, int step, int64_t idx)
+    {
+        return (int64_t(role) << 56) | (int64_t(step) << 40) | idx;
+    }
+
     class encoder
     {
     protected:
@@ -23,12 +42,46 @@ namespace percy
         {
             solver = &s;
         }
+
+        /// Stores the role of every variable of the current encoding in
+        /// roles, or -1 for variables without one. Variables with the same
+        /// role in related encodings, e.g. for another number of steps,
+        /// fence, or partial DAG, can be warm-started from each other.
+        virtual void get_var_roles(const spec& spec,
+                std::vector<int64_t>& roles) const
+        {
+            (void)spec;
+            roles.clear();
+        }
+
+    protected:
+        /// Passes the expected size of a formula with the given number of
+        /// variables, of which nr_sel_vars select fanins, to the solver.
+        /// Each selection variable takes part in up to 2^(fanin + 1)
+        /// simulation clauses per minterm.
+        void reserve_formula(const spec& spec, int nr_vars, int nr_sel_vars)
+        {
+            solver->reserve(nr_vars,
+                    nr_sel_vars * spec.get_tt_size() * (2 << spec.fanin));
+        }
     };
 
     class enumerating_encoder
     {
     protected:
         bool dirty = false;
+        solver_wrapper* blocking_log = nullptr;
+
+        /// Adds a clause that blocks solutions to the solver, and to the
+        /// blocking log if there is one.
+        int add_blocking_clause(solver_wrapper* solver,
+                pabc::lit* begin, pabc::lit* end)
+        {
+            if (blocking_log) {
+                blocking_log->add_clause(begin, end);
+            }
+            return solver->add_clause(begin, end);
+        }
 
     public:
         virtual bool block_solution(const spec& spec) = 0;
@@ -39,6 +92,13 @@ namespace percy
             dirty = false;
         }
 
+        /// Sets a formula that records the blocking clauses, so that they
+        /// can be added again after the solver is rolled back.
+        void set_blocking_log(solver_wrapper* log)
+        {
+            blocking_log = log;
+        }
+
         bool is_dirty() { return dirty; }
         void set_dirty(bool dirty) { this->dirty = dirty;  }
         virtual void extract_chain(const spec& spec, chain& chain) = 0;
@@ -70,6 +130,21 @@ namespace percy
         
         virtual void cegar_extract_chain(const spec& spec, chain& chain) = 0;
 
+        /// Computes the set of minterms at which the last simulation
+        /// differs from the specified function, ignoring don't cares.
+        /// Must be called after simulate().
+        void simulation_difference(const spec& spec,
+                kitty::dynamic_truth_table& diff) const
+        {
+            diff = sim_tts[spec.nr_in + spec.nr_steps - 1] ^ spec[0];
+            if (spec.out_inv) {
+                diff = ~diff;
+            }
+            if (spec.has_dc_mask(0)) {
+                diff &= ~spec.get_dc_mask(0);
+            }
+        }
+
         /// Resets the simulation truth tables, based on the number of PIs.
         void reset_sim_tts(int nr_in)
         {
@@ -90,8 +165,63 @@ namespace percy
         virtual bool create_tt_clauses(const spec& spec, int idx) = 0;
         virtual kitty::dynamic_truth_table& simulate(const spec& spec) = 0;
 
+        /// Simulates the current solution and returns the index of the
+        /// first minterm at which a non-trivial output differs from the
+        /// specification, ignoring don't cares. Returns -1 if the solution
+        /// implements the specification. Encoders that support multiple
+        /// outputs check all of them in a single simulation pass.
+        virtual int64_t find_counterexample(const spec& spec)
+        {
+            const auto h = spec.synth_func(0);
+            const auto& sim_tt = simulate(spec);
+            const auto nr_bits = int64_t(1) << spec.nr_in;
+            const uint64_t last_mask = nr_bits >= 64 ? ~uint64_t(0) :
+                ((uint64_t(1) << nr_bits) - 1);
+            return tt_find_first_difference(&*sim_tt.cbegin(),
+                    &*spec[h].cbegin(), int(sim_tt.num_blocks()),
+                    spec.has_dc_mask(h) ? &*spec.get_dc_mask(h).cbegin() : nullptr,
+                    ((spec.out_inv >> h) & 1) ? ~uint64_t(0) : 0, last_mask);
+        }
+
+        /// Simulates the current solution and computes the set of all
+        /// minterms at which a non-trivial output differs from the
+        /// specification, ignoring don't cares.
+        virtual void simulation_difference(const spec& spec,
+                kitty::dynamic_truth_table& diff)
+        {
+            const auto h = spec.synth_func(0);
+            diff = simulate(spec) ^ spec[h];
+            if ((spec.out_inv >> h) & 1) {
+                diff = ~diff;
+            }
+            if (spec.has_dc_mask(h)) {
+                diff &= ~spec.get_dc_mask(h);
+            }
+        }
+
         virtual void extract_chain(const spec& spec, chain& chain) = 0;
         virtual void reset_sim_tts(int) { }
+
+        /// Encodes the part of the formula that is the same for every
+        /// fence of spec.nr_steps steps, with its variables in front of
+        /// the ones that depend on the fence. A solver bookmarked after
+        /// this part can roll back to it and take the clauses of the next
+        /// fence from encode_structure. Returns false if the encoder does
+        /// not split its formulas, or if the shared part is unsatisfiable.
+        virtual bool encode_shared(const spec& spec)
+        {
+            (void)spec;
+            return false;
+        }
+
+        /// Adds the clauses of fence f on top of the part that was
+        /// encoded by encode_shared.
+        virtual bool encode_structure(const spec& spec, const fence& f)
+        {
+            (void)spec;
+            (void)f;
+            return false;
+        }
     };
 
     template<int FI>
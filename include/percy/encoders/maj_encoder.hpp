@@ -3,6 +3,7 @@
 #include <vector>
 #include <kitty/kitty.hpp>
 #include "encoder.hpp"
+#include "../tt_utils.hpp"
 
 namespace percy
 {
@@ -1881,7 +1882,7 @@ namespace percy
                 assert(found);
                 for (int k = 0; k < 3; k++)
                     pFanins[k] = &sim_tts[fanins[k]];
-                sim_tts[i] = kitty::ternary_majority(*pFanins[0], *pFanins[1], *pFanins[2]);
+                ternary_majority_into(*pFanins[0], *pFanins[1], *pFanins[2], sim_tts[i]);
             }
 
             int iMint = -1;
@@ -1914,7 +1915,7 @@ namespace percy
                 assert(found);
                 for (int k = 0; k < 3; k++)
                     pFanins[k] = &sim_tts[fanins[k]];
-                sim_tts[i] = kitty::ternary_majority(*pFanins[0], *pFanins[1], *pFanins[2]);
+                ternary_majority_into(*pFanins[0], *pFanins[1], *pFanins[2], sim_tts[i]);
             }
 
             int iMint = -1;
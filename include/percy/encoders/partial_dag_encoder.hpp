@@ -4,6 +4,7 @@
 #include <kitty/kitty.hpp>
 #include "encoder.hpp"
 #include "../partial_dag.hpp"
+#include "../structure_nogoods.hpp"
 
 namespace percy
 {
@@ -22,11 +23,37 @@ namespace percy
         int ops_offset;
         int sim_offset;
         pabc::Vec_Int_t* vLits = NULL;
+        int sel_offsets[MAX_STEPS];
+        int op_offsets[MAX_STEPS];
+        int sim_offsets[MAX_STEPS];
+        int pi_fanins[MAX_STEPS];
+
+        // State of the incremental encoding. The vertices of the
+        // current DAG prefix form a stack, and each of them owns an
+        // activation variable that guards all of its clauses. The
+        // output constraints are guarded by the output variable, and
+        // the symmetry breaking clauses, which depend on the complete
+        // DAG, by the leaf variable.
+        int guard_lit = -1;
+        std::vector<pabc::lit> guarded_clause;
+        int nr_levels = 0;
+        int level_acts[MAX_STEPS];
+        partial_dag level_dag { 2, MAX_STEPS };
+        int out_act = -1;
+        int leaf_act = -1;
+        std::vector<pabc::lit> inc_assumps;
+        std::vector<pabc::lit> inc_conflict;
+        int inc_max_vars = PD_INC_MAX_VARS;
 
         // We only support fanin-2 gates for now,
         // so this is a constant.
         const int PD_OP_VARS_PER_STEP = 3;
 
+        // Once the incremental encoding has allocated this many
+        // variables, the solver is restarted to get rid of the
+        // variables and clauses of retired vertices.
+        static const int PD_INC_MAX_VARS = 1 << 18;
+
         static const int NR_SIM_TTS = 32;
         std::vector<kitty::dynamic_truth_table> sim_tts { NR_SIM_TTS };
 
@@ -35,15 +62,11 @@ namespace percy
             const partial_dag& dag, 
             int i) const
         {
-            const auto& vertex = dag.get_vertex(i);
-            auto nr_pi_fanins = 0;
-            if (vertex[1] == FANIN_PI) {
-                // If the second fanin is a PI, the first one 
-                // certainly is.
-                nr_pi_fanins = 2;
-            } else if (vertex[0] == FANIN_PI) {
-                nr_pi_fanins = 1;
-            }
+            return nr_svars_for_pi_fanins(spec, nr_pi_fanins_for_step(dag, i));
+        }
+
+        int nr_svars_for_pi_fanins(const spec& spec, int nr_pi_fanins) const
+        {
             switch (nr_pi_fanins) {
             case 1:
                 return spec.nr_in;
@@ -59,6 +82,8 @@ namespace percy
             const auto& vertex = dag.get_vertex(i);
             auto nr_pi_fanins = 0;
             if (vertex[1] == FANIN_PI) {
+                // If the second fanin is a PI, the first one 
+                // certainly is.
                 nr_pi_fanins = 2;
             } else if (vertex[0] == FANIN_PI) {
                 nr_pi_fanins = 1;
@@ -73,11 +98,9 @@ namespace percy
             int step_idx,
             int var_idx) const
         {
-            auto offset = 0;
-            for (int i = 0; i < step_idx; i++) {
-                offset += nr_svars_for_step(spec, dag, i);
-            }
-            return offset + var_idx;
+            (void)spec;
+            (void)dag;
+            return sel_offsets[step_idx] + var_idx;
         }
 
         int get_res_var(
@@ -96,15 +119,70 @@ namespace percy
 
         int get_sim_var(const spec& spec, int step_idx, int t) const
         {
-            return sim_offset + spec.get_tt_size() * step_idx + t;
+            (void)spec;
+            return sim_offsets[step_idx] + t;
         }
 
         int get_op_var(int step_idx, int var_idx) const
         {
-            return ops_offset + step_idx * PD_OP_VARS_PER_STEP + var_idx;
+            return op_offsets[step_idx] + var_idx;
+        }
+
+        /// Adds a clause to the solver. While a vertex or leaf of the
+        /// incremental encoding is being pushed, its activation literal
+        /// is appended to the clause.
+        int add_clause(pabc::lit* begin, pabc::lit* end)
+        {
+            if (guard_lit == -1) {
+                return solver->add_clause(begin, end);
+            }
+            guarded_clause.assign(begin, end);
+            guarded_clause.push_back(guard_lit);
+            return solver->add_clause(
+                guarded_clause.data(),
+                guarded_clause.data() + guarded_clause.size());
+        }
+
+        /// Records where the variables of each step start. In the
+        /// regular encodings the selection, operator, and simulation
+        /// variables are laid out in three contiguous blocks. The
+        /// incremental encoding allocates them per step instead, so
+        /// the lookups go through these tables.
+        void set_step_offsets(const spec& spec, const partial_dag& dag)
+        {
+            auto offset = sel_offset;
+            for (int i = 0; i < spec.nr_steps; i++) {
+                sel_offsets[i] = offset;
+                offset += nr_svars_for_step(spec, dag, i);
+                pi_fanins[i] = nr_pi_fanins_for_step(dag, i);
+                op_offsets[i] = ops_offset + i * PD_OP_VARS_PER_STEP;
+                sim_offsets[i] = sim_offset + spec.get_tt_size() * i;
+            }
         }
 
     public:
+        /// Selection variables are identified by their index among the
+        /// options of their step, which depend on the number of PI fanins
+        /// of the vertex.
+        void get_var_roles(const spec& spec,
+                std::vector<int64_t>& roles) const override
+        {
+            roles.assign(solver->nr_vars(), -1);
+            for (int i = 0; i < spec.nr_steps; i++) {
+                const auto nr_svars = nr_svars_for_pi_fanins(spec, pi_fanins[i]);
+                for (int j = 0; j < nr_svars; j++) {
+                    roles[sel_offsets[i] + j] = make_var_role(ROLE_SEL, i,
+                            (int64_t(pi_fanins[i]) << 32) | j);
+                }
+                for (int j = 0; j < PD_OP_VARS_PER_STEP; j++) {
+                    roles[get_op_var(i, j)] = make_var_role(ROLE_OP, i, j);
+                }
+                for (int t = 0; t < spec.get_tt_size(); t++) {
+                    roles[get_sim_var(spec, i, t)] = make_var_role(ROLE_SIM, i, t);
+                }
+            }
+        }
+
         partial_dag_encoder()
         {
             vLits = pabc::Vec_IntAlloc(128);
@@ -136,6 +214,10 @@ namespace percy
             ops_offset = nr_sel_vars;
             sim_offset = nr_sel_vars + nr_op_vars;
             total_nr_vars = nr_sel_vars + nr_op_vars + nr_sim_vars;
+            set_step_offsets(spec, dag);
+            nr_levels = 0;
+            out_act = -1;
+            leaf_act = -1;
 
             if (spec.verbosity > 1) {
                 printf("Creating variables (PD-%d)\n", spec.fanin);
@@ -167,6 +249,10 @@ namespace percy
             ops_offset = nr_sel_vars + nr_res_vars;
             sim_offset = nr_sel_vars + nr_res_vars + nr_op_vars;
             total_nr_vars = nr_sel_vars + nr_res_vars + nr_op_vars + nr_sim_vars;
+            set_step_offsets(spec, dag);
+            nr_levels = 0;
+            out_act = -1;
+            leaf_act = -1;
 
             if (spec.verbosity > 1) {
                 printf("Creating variables (PD-%d)\n", spec.fanin);
@@ -192,19 +278,7 @@ namespace percy
             }
 
             for (int i = 0; i < spec.nr_steps; i++) {
-                const auto nr_svars_for_i = nr_svars_for_step(spec, dag, i);
-                if (nr_svars_for_i == 0) {
-                    continue;
-                }
-
-                for (int j = 0; j < nr_svars_for_i; j++) {
-                    pabc::Vec_IntSetEntry(vLits, j,
-                        pabc::Abc_Var2Lit(get_sel_var(spec, dag, i, j), 0));
-                }
-
-                status &= solver->add_clause(
-                    pabc::Vec_IntArray(vLits),
-                    pabc::Vec_IntArray(vLits) + nr_svars_for_i);
+                status &= create_fanin_clauses(spec, dag, i);
             }
             if (spec.verbosity > 2) {
                 printf("Nr. clauses = %d (POST)\n", solver->nr_clauses());
@@ -213,6 +287,26 @@ namespace percy
             return status;
         }
 
+        bool create_fanin_clauses(
+            const spec& spec,
+            const partial_dag& dag,
+            int i)
+        {
+            const auto nr_svars_for_i = nr_svars_for_step(spec, dag, i);
+            if (nr_svars_for_i == 0) {
+                return true;
+            }
+
+            for (int j = 0; j < nr_svars_for_i; j++) {
+                pabc::Vec_IntSetEntry(vLits, j,
+                    pabc::Abc_Var2Lit(get_sel_var(spec, dag, i, j), 0));
+            }
+
+            return add_clause(
+                pabc::Vec_IntArray(vLits),
+                pabc::Vec_IntArray(vLits) + nr_svars_for_i);
+        }
+
         /// The simulation variables of the final step must be equal to
         /// the function we're trying to synthesize.
         bool fix_output_sim_vars(const spec& spec)
@@ -228,7 +322,7 @@ namespace percy
                 }
                 const auto sim_var = get_sim_var(spec, ilast_step, t);
                 pabc::lit sim_lit = pabc::Abc_Var2Lit(sim_var, 1 - outbit);
-                ret &= solver->add_clause(&sim_lit, &sim_lit + 1);
+                ret &= add_clause(&sim_lit, &sim_lit + 1);
             }
 
             return ret;
@@ -246,7 +340,7 @@ namespace percy
                 }
                 const auto sim_var = get_sim_var(spec, ilast_step, t);
                 pabc::lit sim_lit = pabc::Abc_Var2Lit(sim_var, 1 - outbit);
-                (void)solver->add_clause(&sim_lit, &sim_lit + 1);
+                (void)add_clause(&sim_lit, &sim_lit + 1);
             }
         }
 
@@ -261,7 +355,7 @@ namespace percy
             }
             const auto sim_var = get_sim_var(spec, ilast_step, t);
             pabc::lit sim_lit = pabc::Abc_Var2Lit(sim_var, 1 - outbit);
-            return solver->add_clause(&sim_lit, &sim_lit + 1);
+            return add_clause(&sim_lit, &sim_lit + 1);
         }
 
         void vfix_output_sim_vars(const spec& spec, int t)
@@ -275,31 +369,41 @@ namespace percy
             }
             const auto sim_var = get_sim_var(spec, ilast_step, t);
             pabc::lit sim_lit = pabc::Abc_Var2Lit(sim_var, 1 - outbit);
-            (void)solver->add_clause(&sim_lit, &sim_lit + 1);
+            (void)add_clause(&sim_lit, &sim_lit + 1);
         }
 
         bool create_nontriv_clauses(const spec& spec)
         {
-            int pLits[3];
             bool status = true;
             for (int i = 0; i < spec.nr_steps; i++) {
-                // Dissallow the constant zero operator.
-                pLits[0] = pabc::Abc_Var2Lit(get_op_var(i, 0), 0);
-                pLits[1] = pabc::Abc_Var2Lit(get_op_var(i, 1), 0);
-                pLits[2] = pabc::Abc_Var2Lit(get_op_var(i, 2), 0);
-                status &= solver->add_clause(pLits, pLits + 3);
+                status &= create_nontriv_clauses(spec, i);
+            }
 
-                // Dissallow variable projections.
-                pLits[0] = pabc::Abc_Var2Lit(get_op_var(i, 0), 0);
-                pLits[1] = pabc::Abc_Var2Lit(get_op_var(i, 1), 1);
-                pLits[2] = pabc::Abc_Var2Lit(get_op_var(i, 2), 1);
-                status &= solver->add_clause(pLits, pLits + 3);
+            return status;
+        }
 
-                pLits[0] = pabc::Abc_Var2Lit(get_op_var(i, 0), 1);
-                pLits[1] = pabc::Abc_Var2Lit(get_op_var(i, 1), 0);
-                pLits[2] = pabc::Abc_Var2Lit(get_op_var(i, 2), 1);
-                status &= solver->add_clause(pLits, pLits + 3);
-            }
+        bool create_nontriv_clauses(const spec& spec, int i)
+        {
+            (void)spec;
+            int pLits[3];
+            bool status = true;
+
+            // Dissallow the constant zero operator.
+            pLits[0] = pabc::Abc_Var2Lit(get_op_var(i, 0), 0);
+            pLits[1] = pabc::Abc_Var2Lit(get_op_var(i, 1), 0);
+            pLits[2] = pabc::Abc_Var2Lit(get_op_var(i, 2), 0);
+            status &= add_clause(pLits, pLits + 3);
+
+            // Dissallow variable projections.
+            pLits[0] = pabc::Abc_Var2Lit(get_op_var(i, 0), 0);
+            pLits[1] = pabc::Abc_Var2Lit(get_op_var(i, 1), 1);
+            pLits[2] = pabc::Abc_Var2Lit(get_op_var(i, 2), 1);
+            status &= add_clause(pLits, pLits + 3);
+
+            pLits[0] = pabc::Abc_Var2Lit(get_op_var(i, 0), 1);
+            pLits[1] = pabc::Abc_Var2Lit(get_op_var(i, 1), 0);
+            pLits[2] = pabc::Abc_Var2Lit(get_op_var(i, 2), 1);
+            status &= add_clause(pLits, pLits + 3);
 
             return status;
         }
@@ -342,7 +446,7 @@ namespace percy
                     get_op_var(i, ((c << 1) | b) - 1), 1 - a);
             }
 
-            auto status = solver->add_clause(pLits, pLits + ctr);
+            auto status = add_clause(pLits, pLits + ctr);
 
             return status;
         }
@@ -387,7 +491,7 @@ namespace percy
                     get_op_var(i, ((c << 1) | b) - 1), 1 - a);
             }
 
-            return solver->add_clause(pLits, pLits + ctr);
+            return add_clause(pLits, pLits + ctr);
         }
 
         bool create_tt_clauses(
@@ -462,32 +566,58 @@ namespace percy
             const int t)
         {
             for (int i = 0; i < spec.nr_steps; i++) {
-                const auto& vertex = dag.get_vertex(i);
-                auto nr_pi_fanins = 0;
-                if (vertex[1] == FANIN_PI) {
-                    // If the second fanin is a PI, the first one 
-                    // certainly is.
-                    nr_pi_fanins = 2;
-                } else if (vertex[0] == FANIN_PI) {
-                    nr_pi_fanins = 1;
+                vcreate_tt_clauses(spec, dag, i, t);
+            }
+        }
+
+        /// Creates the simulation clauses of step i for tt index t.
+        void vcreate_tt_clauses(
+            const spec& spec,
+            const partial_dag& dag,
+            const int i,
+            const int t)
+        {
+            const auto& vertex = dag.get_vertex(i);
+            auto nr_pi_fanins = 0;
+            if (vertex[1] == FANIN_PI) {
+                // If the second fanin is a PI, the first one 
+                // certainly is.
+                nr_pi_fanins = 2;
+            } else if (vertex[0] == FANIN_PI) {
+                nr_pi_fanins = 1;
+            }
+            if (nr_pi_fanins == 0) {
+                // The fanins for this step are fixed
+                const auto j = vertex[0] + spec.nr_in - 1;
+                const auto k = vertex[1] + spec.nr_in - 1;
+                (void)add_simulation_clause(spec, t, i, j, k, 0, 0, 1);
+                (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 0);
+                (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 1);
+                (void)add_simulation_clause(spec, t, i, j, k, 1, 0, 0);
+                (void)add_simulation_clause(spec, t, i, j, k, 1, 0, 1);
+                (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 0);
+                (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 1);
+            } else if (nr_pi_fanins == 1) {
+                // The first fanin is flexible
+                const auto k = vertex[1] + spec.nr_in - 1;
+                auto ctr = 0;
+                for (int j = 0; j < spec.nr_in; j++) {
+                    const auto sel_var = get_sel_var(spec, dag, i, j);
+                    (void)add_simulation_clause(spec, t, i, j, k, 0, 0, 1, sel_var);
+                    (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 0, sel_var);
+                    (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 1, sel_var);
+                    (void)add_simulation_clause(spec, t, i, j, k, 1, 0, 0, sel_var);
+                    (void)add_simulation_clause(spec, t, i, j, k, 1, 0, 1, sel_var);
+                    (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 0, sel_var);
+                    (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 1, sel_var);
+                    ctr++;
                 }
-                if (nr_pi_fanins == 0) {
-                    // The fanins for this step are fixed
-                    const auto j = vertex[0] + spec.nr_in - 1;
-                    const auto k = vertex[1] + spec.nr_in - 1;
-                    (void)add_simulation_clause(spec, t, i, j, k, 0, 0, 1);
-                    (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 0);
-                    (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 1);
-                    (void)add_simulation_clause(spec, t, i, j, k, 1, 0, 0);
-                    (void)add_simulation_clause(spec, t, i, j, k, 1, 0, 1);
-                    (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 0);
-                    (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 1);
-                } else if (nr_pi_fanins == 1) {
-                    // The first fanin is flexible
-                    const auto k = vertex[1] + spec.nr_in - 1;
-                    auto ctr = 0;
-                    for (int j = 0; j < spec.nr_in; j++) {
-                        const auto sel_var = get_sel_var(spec, dag, i, j);
+            } else {
+                // Both fanins are fully flexible
+                auto ctr = 0;
+                for (int k = 1; k < spec.nr_in; k++) {
+                    for (int j = 0; j < k; j++) {
+                        const auto sel_var = get_sel_var(spec, dag, i, ctr);
                         (void)add_simulation_clause(spec, t, i, j, k, 0, 0, 1, sel_var);
                         (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 0, sel_var);
                         (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 1, sel_var);
@@ -497,22 +627,6 @@ namespace percy
                         (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 1, sel_var);
                         ctr++;
                     }
-                } else {
-                    // Both fanins are fully flexible
-                    auto ctr = 0;
-                    for (int k = 1; k < spec.nr_in; k++) {
-                        for (int j = 0; j < k; j++) {
-                            const auto sel_var = get_sel_var(spec, dag, i, ctr);
-                            (void)add_simulation_clause(spec, t, i, j, k, 0, 0, 1, sel_var);
-                            (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 0, sel_var);
-                            (void)add_simulation_clause(spec, t, i, j, k, 0, 1, 1, sel_var);
-                            (void)add_simulation_clause(spec, t, i, j, k, 1, 0, 0, sel_var);
-                            (void)add_simulation_clause(spec, t, i, j, k, 1, 0, 1, sel_var);
-                            (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 0, sel_var);
-                            (void)add_simulation_clause(spec, t, i, j, k, 1, 1, 1, sel_var);
-                            ctr++;
-                        }
-                    }
                 }
             }
         }
@@ -556,7 +670,7 @@ namespace percy
                         pLits[ctr++] = pabc::Abc_Var2Lit(sel_varpp, 1);
                     }
                     if (ctr > 1) {
-                        return solver->add_clause(pLits, pLits + ctr);
+                        return add_clause(pLits, pLits + ctr);
                     }
                 }
             } else if (depth == 2) {
@@ -572,7 +686,7 @@ namespace percy
                         pLits[ctr++] = pabc::Abc_Var2Lit(sel_varp, 1);
                     }
                     if (ctr > 1) {
-                        return solver->add_clause(pLits, pLits + ctr);
+                        return add_clause(pLits, pLits + ctr);
                     }
                 }
                 for (int ipp = ip + 1; ipp < spec.nr_steps; ipp++) {
@@ -743,7 +857,7 @@ namespace percy
                                     }
                                 }
                             }
-                            if (!solver->add_clause(Vec_IntArray(vLits), Vec_IntArray(vLits) + ctr)) {
+                            if (!add_clause(Vec_IntArray(vLits), Vec_IntArray(vLits) + ctr)) {
                                 return false;
                             }
                         } else {
@@ -787,7 +901,7 @@ namespace percy
                                             }
                                         }
                                     }
-                                    if (!solver->add_clause(Vec_IntArray(vLits), Vec_IntArray(vLits) + ctr)) {
+                                    if (!add_clause(Vec_IntArray(vLits), Vec_IntArray(vLits) + ctr)) {
                                         return false;
                                     }
                                     svar_ctr++;
@@ -814,6 +928,7 @@ namespace percy
         encode(const spec& spec, const partial_dag& dag)
         {
             create_variables(spec, dag);
+            reserve_formula(spec, total_nr_vars, nr_sel_vars);
             create_main_clauses(spec, dag);
             vfix_output_sim_vars(spec);
 
@@ -836,6 +951,252 @@ namespace percy
             return true;
         }
 
+        /// Encodes the part of the formula that is the same for every
+        /// partial DAG of spec.nr_steps vertices: the operator and
+        /// simulation variables, the output values and the nontriviality
+        /// clauses. The selection variables come after them, so that a
+        /// solver which is bookmarked after this part can roll back to it
+        /// and take the clauses of the next DAG from encode_structure.
+        bool encode_shared(const spec& spec)
+        {
+            nr_op_vars = spec.nr_steps * PD_OP_VARS_PER_STEP;
+            nr_sim_vars = spec.nr_steps * spec.get_tt_size();
+            ops_offset = 0;
+            sim_offset = nr_op_vars;
+            sel_offset = nr_op_vars + nr_sim_vars;
+            nr_sel_vars = 0;
+            total_nr_vars = sel_offset;
+            for (int i = 0; i < spec.nr_steps; i++) {
+                op_offsets[i] = ops_offset + i * PD_OP_VARS_PER_STEP;
+                sim_offsets[i] = sim_offset + spec.get_tt_size() * i;
+            }
+            nr_levels = 0;
+            out_act = -1;
+            leaf_act = -1;
+            solver->set_nr_vars(total_nr_vars);
+
+            vfix_output_sim_vars(spec);
+            if (spec.add_nontriv_clauses && !create_nontriv_clauses(spec)) {
+                return false;
+            }
+            return true;
+        }
+
+        /// Adds the clauses of dag on top of the part that was encoded by
+        /// encode_shared.
+        bool encode_structure(const spec& spec, const partial_dag& dag)
+        {
+            assert(spec.nr_steps == dag.nr_vertices());
+
+            nr_sel_vars = 0;
+            for (int i = 0; i < spec.nr_steps; i++) {
+                nr_sel_vars += nr_svars_for_step(spec, dag, i);
+            }
+            total_nr_vars = sel_offset + nr_sel_vars;
+            set_step_offsets(spec, dag);
+            reserve_formula(spec, total_nr_vars, nr_sel_vars);
+            solver->set_nr_vars(total_nr_vars);
+            create_main_clauses(spec, dag);
+
+            if (!create_fanin_clauses(spec, dag)) {
+                return false;
+            }
+            if (spec.add_noreapply_clauses && !create_noreapply_clauses(spec, dag)) {
+                return false;
+            }
+            if (spec.add_symvar_clauses && !create_symvar_clauses(spec, dag)) {
+                return false;
+            }
+            return true;
+        }
+
+        /// Pushes the next vertex of dag onto the incremental stack.
+        /// The vertex gets fresh variables and an activation variable
+        /// that guards all of its clauses.
+        void inc_push_vertex(const spec& spec, const partial_dag& dag)
+        {
+            const auto i = nr_levels;
+            const auto vertex = dag.get_vertex(i);
+            auto var = solver->nr_vars();
+            level_acts[i] = var++;
+            sel_offsets[i] = var;
+            pi_fanins[i] = nr_pi_fanins_for_step(dag, i);
+            var += nr_svars_for_step(spec, dag, i);
+            op_offsets[i] = var;
+            var += PD_OP_VARS_PER_STEP;
+            sim_offsets[i] = var;
+            var += spec.get_tt_size();
+            solver->set_nr_vars(var);
+
+            guard_lit = pabc::Abc_Var2Lit(level_acts[i], 1);
+            for (int t = 0; t < spec.get_tt_size(); t++) {
+                vcreate_tt_clauses(spec, dag, i, t);
+            }
+            (void)create_fanin_clauses(spec, dag, i);
+            if (spec.add_nontriv_clauses) {
+                (void)create_nontriv_clauses(spec, i);
+            }
+            guard_lit = -1;
+
+            level_dag.set_vertex(i, vertex[0], vertex[1]);
+            nr_levels++;
+        }
+
+        /// Permanently disables the clauses guarded by act_var.
+        void inc_retire(int act_var)
+        {
+            auto lit = pabc::Abc_Var2Lit(act_var, 1);
+            (void)solver->add_clause(&lit, &lit + 1);
+        }
+
+        /// Restarts the incremental encoding from an empty stack. Must
+        /// be called after the solver is restarted, and whenever the
+        /// specification changes.
+        void inc_reset()
+        {
+            nr_levels = 0;
+            out_act = -1;
+            leaf_act = -1;
+        }
+
+        /// Sets the number of variables after which the incremental
+        /// encoding restarts the solver.
+        void set_inc_max_vars(int max_vars)
+        {
+            inc_max_vars = max_vars;
+        }
+
+        /// Returns the number of vertices currently on the stack.
+        int inc_nr_levels() const
+        {
+            return nr_levels;
+        }
+
+        /// Encodes dag on top of the previously encoded one. Partial
+        /// DAGs that come out of the generators in order share long
+        /// prefixes of identical vertices. The clauses of a shared prefix
+        /// are kept, along with anything the solver has learned from
+        /// them, and only the differing suffix is retired and pushed
+        /// again. The clauses that depend on the complete DAG are guarded
+        /// by a leaf variable that is retired on the next call. Use
+        /// inc_solve to solve the resulting instance.
+        bool inc_encode(const spec& spec, const partial_dag& dag)
+        {
+            assert(dag.get_fanin() == 2);
+            assert(spec.nr_steps == dag.nr_vertices());
+
+            if (leaf_act != -1) {
+                inc_retire(leaf_act);
+                leaf_act = -1;
+            }
+            if (out_act != -1) {
+                inc_retire(out_act);
+                out_act = -1;
+            }
+            if (solver->nr_vars() > inc_max_vars) {
+                solver->restart();
+                inc_reset();
+            }
+
+            auto prefix = 0;
+            while (prefix < nr_levels && prefix < dag.nr_vertices()) {
+                const auto v = dag.get_vertex(prefix);
+                const auto w = level_dag.get_vertex(prefix);
+                if (v[0] != w[0] || v[1] != w[1]) {
+                    break;
+                }
+                prefix++;
+            }
+            while (nr_levels > prefix) {
+                inc_retire(level_acts[--nr_levels]);
+            }
+            while (nr_levels < dag.nr_vertices()) {
+                inc_push_vertex(spec, dag);
+            }
+
+            out_act = solver->nr_vars();
+            solver->set_nr_vars(out_act + 1);
+            guard_lit = pabc::Abc_Var2Lit(out_act, 1);
+            vfix_output_sim_vars(spec);
+            auto status = true;
+            if (spec.add_noreapply_clauses || spec.add_symvar_clauses) {
+                leaf_act = solver->nr_vars();
+                solver->set_nr_vars(leaf_act + 1);
+                guard_lit = pabc::Abc_Var2Lit(leaf_act, 1);
+            }
+            if (spec.add_noreapply_clauses) {
+                status = create_noreapply_clauses(spec, dag);
+            }
+            if (status && spec.add_symvar_clauses) {
+                status = create_symvar_clauses(spec, dag);
+            }
+            guard_lit = -1;
+
+            return status;
+        }
+
+        /// Solves the instance created by inc_encode, assuming that the
+        /// vertices on the stack and the current leaf are active.
+        synth_result inc_solve(int conflict_limit)
+        {
+            inc_assumps.clear();
+            for (int i = 0; i < nr_levels; i++) {
+                inc_assumps.push_back(pabc::Abc_Var2Lit(level_acts[i], 0));
+            }
+            if (out_act != -1) {
+                inc_assumps.push_back(pabc::Abc_Var2Lit(out_act, 0));
+            }
+            if (leaf_act != -1) {
+                inc_assumps.push_back(pabc::Abc_Var2Lit(leaf_act, 0));
+            }
+            return solver->solve(
+                inc_assumps.data(),
+                inc_assumps.data() + inc_assumps.size(),
+                conflict_limit);
+        }
+
+        /// After inc_solve has returned failure, derives a structural
+        /// nogood from the final conflict of the solver. The nogood
+        /// consists of the vertices whose activation variables are part
+        /// of the conflict: every partial DAG that has the same vertices
+        /// at the same positions contains the same (renamed) clauses, so
+        /// it is unsatisfiable as well. If the output constraints are in
+        /// the conflict, the nogood only applies to DAGs of the same size.
+        /// Returns false if no nogood can be derived, e.g. because the
+        /// solver does not report final conflicts or because the conflict
+        /// depends on the symmetry breaking clauses of the complete DAG.
+        bool inc_nogood(pd_nogood& nogood)
+        {
+            if (!solver->final_conflict(inc_conflict) || inc_conflict.empty()) {
+                return false;
+            }
+            nogood.nr_vertices = -1;
+            nogood.nr_fixed = 0;
+            bool in_conflict[MAX_STEPS] = { false };
+            for (const auto lit : inc_conflict) {
+                const auto var = pabc::Abc_Lit2Var(lit);
+                if (var == out_act) {
+                    nogood.nr_vertices = nr_levels;
+                    continue;
+                }
+                auto found = false;
+                for (int i = 0; i < nr_levels && !found; i++) {
+                    if (level_acts[i] == var) {
+                        in_conflict[i] = found = true;
+                    }
+                }
+                if (!found) {
+                    return false;
+                }
+            }
+            for (int i = 0; i < nr_levels; i++) {
+                if (in_conflict[i]) {
+                    nogood.add_vertex(level_dag, i);
+                }
+            }
+            return true;
+        }
+
         /// Allowing multiple selection variables to be true can lead
         /// to infinite CEGAR loops. Multiple different fanin assignments
         /// may be consistent with a partial truth table, but it is
@@ -891,7 +1252,7 @@ namespace percy
                     const auto fi_var = 
                         get_res_var(spec, dag, i, svars.size() * (1 + 2) + 1);
                     auto fi_lit = pabc::Abc_Var2Lit(fi_var, 0);
-                    (void)solver->add_clause(&fi_lit, &fi_lit + 1);
+                    (void)add_clause(&fi_lit, &fi_lit + 1);
                 }
             }
         }
@@ -900,14 +1261,6 @@ namespace percy
         cegar_encode(const spec& spec, const partial_dag& dag)
         {
             cegar_create_variables(spec, dag);
-            /*
-            for (int i = 0; i < spec.nr_rand_tt_assigns; i++) {
-                const auto t = rand() % spec.get_tt_size();
-                //printf("creating tt/IO clause at idx %d\n", t+1);
-                vcreate_tt_clauses(spec, dag, t);
-                vfix_output_sim_vars(spec, t);
-            }
-            */
 
             create_cardinality_constraints(spec, dag);
 
@@ -77,6 +77,35 @@ namespace percy
                 return lex_offset + step_idx * (nr_op_vars_per_step - 1) + op_idx;
             }
 
+            /// The options of a step do not depend on the number of steps,
+            /// so selection variables are identified by their index within
+            /// their step.
+            void get_var_roles(const spec& spec,
+                    std::vector<int64_t>& roles) const override
+            {
+                roles.assign(total_nr_vars, -1);
+                auto svar_offset = 0;
+                for (int i = 0; i < spec.nr_steps; i++) {
+                    for (int j = 0; j < nr_svar_map[i]; j++) {
+                        roles[get_sel_var(svar_offset + j)] =
+                            make_var_role(ROLE_SEL, i, j);
+                    }
+                    svar_offset += nr_svar_map[i];
+                    for (int j = 1; j <= nr_op_vars_per_step; j++) {
+                        roles[get_op_var(spec, i, j)] =
+                            make_var_role(ROLE_OP, i, j);
+                    }
+                    for (int h = 0; h < spec.nr_nontriv; h++) {
+                        roles[get_out_var(spec, h, i)] =
+                            make_var_role(ROLE_OUT, i, h);
+                    }
+                    for (int t = 0; t < spec.get_tt_size(); t++) {
+                        roles[get_sim_var(spec, i, t)] =
+                            make_var_role(ROLE_SIM, i, t);
+                    }
+                }
+            }
+
             /*******************************************************************
                 Ensures that each gate has FI operands.
             *******************************************************************/
@@ -1092,36 +1121,37 @@ namespace percy
             int simulate( const spec& spec )
             {
                 std::vector<int> fanins(spec.fanin);
-                auto tt_comp = kitty::create<dynamic_truth_table>( spec.nr_in );
+                std::vector<const uint64_t*> fanin_words(spec.fanin);
 
                 for ( int i = 0; i < spec.nr_steps; ++i )
                 {
                   find_fanin( i, fanins, spec );
 
-                  kitty::clear(sim_tts[spec.nr_in + i]);
+                  uint32_t op = 0;
                   for ( int j = 1; j <= nr_op_vars_per_step; ++j )
                   {
-                    kitty::clear( tt_comp );
-                    tt_comp = ~tt_comp;
                     if ( solver->var_value( get_op_var( spec, i, j ) ) )
                     {
-                      for ( int k = 0; k < spec.fanin; ++k )
-                      {
-                        if ( (j >> k) & 1 )
-                        {
-                          tt_comp &= sim_tts[fanins[k]];
-                        }
-                        else
-                        {
-                          tt_comp &= ~sim_tts[fanins[k]];
-                        }
-                      }
-                      sim_tts[spec.nr_in + i] |= tt_comp;
+                      op |= ( 1u << j );
                     }
                   }
-                }
-
-                const auto iMint = kitty::find_first_bit_difference(sim_tts[spec.nr_in + spec.nr_steps - 1], spec.out_inv ? ~spec[0] : spec[0]);
+                  for ( int k = 0; k < spec.fanin; ++k )
+                  {
+                    fanin_words[k] = &*sim_tts[fanins[k]].cbegin();
+                  }
+                  auto& tt_step = sim_tts[spec.nr_in + i];
+                  apply_op( op, fanin_words.data(), spec.fanin,
+                            &*tt_step.begin(), int( tt_step.num_blocks() ) );
+                }
+
+                const auto& tt_out = sim_tts[spec.nr_in + spec.nr_steps - 1];
+                const auto nr_bits = int64_t(1) << spec.nr_in;
+                const uint64_t last_mask = nr_bits >= 64 ? ~uint64_t(0) :
+                    ((uint64_t(1) << nr_bits) - 1);
+                const auto iMint = int(tt_find_first_difference(
+                            &*tt_out.cbegin(), &*spec[0].cbegin(),
+                            int(tt_out.num_blocks()), nullptr,
+                            spec.out_inv ? ~uint64_t(0) : 0, last_mask));
                 assert(iMint > 0 || iMint == -1);
                 return iMint;
             }
@@ -1255,6 +1285,7 @@ namespace percy
                 assert(spec.nr_steps <= MAX_STEPS);
 
                 create_variables(spec);
+                reserve_formula(spec, total_nr_vars, nr_sel_vars);
                 if (!create_main_clauses(spec)) {
                     return false;
                 }
@@ -1389,7 +1420,7 @@ namespace percy
                     svar_offset += nr_svars_for_i;
                 }
                 
-                return solver->add_clause(
+                return add_blocking_clause(solver,
                             pabc::Vec_IntArray(vLits), 
                             pabc::Vec_IntArray(vLits) + ctr);
             }
@@ -1418,7 +1449,7 @@ namespace percy
                     svar_offset += nr_svars_for_i;
                 }
 
-                return solver->add_clause(
+                return add_blocking_clause(solver,
                             pabc::Vec_IntArray(vLits), 
                             pabc::Vec_IntArray(vLits) + ctr);
             }
@@ -14,49 +14,52 @@ namespace percy
         int nr_sim_vars;
         int nr_sel_vars;
         int nr_res_vars;
+        int nr_out_vars;
         int total_nr_vars;
         int sel_offset;
         int res_offset;
         int ops_offset;
         int sim_offset;
+        int out_offset;
 
         pabc::Vec_Int_t* vLits; // Dynamic vector of literals
 
         static const int NR_SIM_TTS = 32;
         std::vector<kitty::dynamic_truth_table> sim_tts { NR_SIM_TTS };
 
+        /// Fixes the value of the steps that compute the non-trivial
+        /// outputs at minterm t + 1. With a single non-trivial output, the
+        /// last step is the output. Otherwise, the output variables select
+        /// the steps that compute the outputs.
         bool fix_output_sim_vars(const spec& spec, int  t)
         {
-            if (spec.is_dont_care(0, t + 1)) {
-                return true;
-            }
-            auto ilast_step = spec.nr_steps - 1;
-            auto outbit = kitty::get_bit(
-                spec[spec.synth_func(0)], t + 1);
-            if ((spec.out_inv >> spec.synth_func(0)) & 1) {
-                outbit = 1 - outbit;
-            }
-            const auto sim_var = get_sim_var(spec, ilast_step, t);
-            pabc::lit sim_lit = pabc::Abc_Var2Lit(sim_var, 1 - outbit);
-            return solver->add_clause(&sim_lit, &sim_lit + 1);
-        }
-
-        void vfix_output_sim_vars(const spec& spec, int  t)
-        {
-            auto ilast_step = spec.nr_steps - 1;
-
-            auto outbit = kitty::get_bit(
-                spec[spec.synth_func(0)], t + 1);
-            if ((spec.out_inv >> spec.synth_func(0)) & 1) {
-                outbit = 1 - outbit;
+            auto ret = true;
+            pabc::lit pLits[2];
+            for (int h = 0; h < spec.nr_nontriv; h++) {
+                const auto func = spec.synth_func(h);
+                if (spec.is_dont_care(func, t + 1)) {
+                    continue;
+                }
+                auto outbit = kitty::get_bit(spec[func], t + 1);
+                if ((spec.out_inv >> func) & 1) {
+                    outbit = 1 - outbit;
+                }
+                if (spec.nr_nontriv == 1) {
+                    const auto sim_var = get_sim_var(spec, spec.nr_steps - 1, t);
+                    pLits[0] = pabc::Abc_Var2Lit(sim_var, 1 - outbit);
+                    ret &= solver->add_clause(pLits, pLits + 1);
+                    continue;
+                }
+                for (int i = 0; i < spec.nr_steps; i++) {
+                    pLits[0] = pabc::Abc_Var2Lit(get_out_var(spec, h, i), 1);
+                    pLits[1] = pabc::Abc_Var2Lit(get_sim_var(spec, i, t),
+                            1 - outbit);
+                    ret &= solver->add_clause(pLits, pLits + 2);
+                }
             }
-            const auto sim_var = get_sim_var(spec, ilast_step, t);
-            pabc::lit sim_lit = pabc::Abc_Var2Lit(sim_var, 1 - outbit);
-            (void)solver->add_clause(&sim_lit, &sim_lit + 1);
+            return ret;
         }
 
-
-
     public:
         const int OP_VARS_PER_STEP = 3;
 
@@ -173,6 +176,49 @@ namespace percy
             return sim_offset + spec.get_tt_size() * step_idx + t;
         }
 
+        /// Output variables only exist if there are multiple non-trivial
+        /// outputs, since a single output is always computed by the last
+        /// step.
+        int get_out_var(const spec& spec, int h, int i) const
+        {
+            assert(spec.nr_nontriv > 1);
+            assert(h < spec.nr_nontriv);
+            assert(i < spec.nr_steps);
+
+            return out_offset + spec.nr_steps * h + i;
+        }
+
+        /// The options of a step depend on the fence, so selection
+        /// variables are identified by the fanins that they select.
+        void get_var_roles(const spec& spec,
+                std::vector<int64_t>& roles) const override
+        {
+            roles.assign(total_nr_vars, -1);
+            for (int i = 0; i < spec.nr_steps; i++) {
+                const auto level = get_level(spec, i + spec.nr_in);
+                auto ctr = 0;
+                for (int k = first_step_on_level(level - 1);
+                    k < first_step_on_level(level); k++) {
+                    for (int j = 0; j < k; j++) {
+                        roles[get_sel_var(spec, i, ctr++)] =
+                            make_var_role(ROLE_SEL, i, (k << 16) | j);
+                    }
+                }
+                for (int j = 0; j < OP_VARS_PER_STEP; j++) {
+                    roles[get_op_var(spec, i, j)] = make_var_role(ROLE_OP, i, j);
+                }
+                if (spec.nr_nontriv > 1) {
+                    for (int h = 0; h < spec.nr_nontriv; h++) {
+                        roles[get_out_var(spec, h, i)] =
+                            make_var_role(ROLE_OUT, i, h);
+                    }
+                }
+                for (int t = 0; t < spec.get_tt_size(); t++) {
+                    roles[get_sim_var(spec, i, t)] = make_var_role(ROLE_SIM, i, t);
+                }
+            }
+        }
+
         void create_variables(const spec& spec)
         {
             nr_op_vars = spec.nr_steps * OP_VARS_PER_STEP;
@@ -187,12 +233,16 @@ namespace percy
             sel_offset = 0;
             ops_offset = nr_sel_vars;
             sim_offset = nr_sel_vars + nr_op_vars;
-            total_nr_vars = nr_sel_vars + nr_op_vars + nr_sim_vars;
+            out_offset = nr_sel_vars + nr_op_vars + nr_sim_vars;
+            nr_out_vars = spec.nr_nontriv > 1 ?
+                spec.nr_nontriv * spec.nr_steps : 0;
+            total_nr_vars = out_offset + nr_out_vars;
 
             if (spec.verbosity) {
                 printf("creating %d sel_vars\n", nr_sel_vars);
                 printf("creating %d op_vars\n", nr_op_vars);
                 printf("creating %d sim_vars\n", nr_sim_vars);
+                printf("creating %d out_vars\n", nr_out_vars);
             }
 
             solver->set_nr_vars(total_nr_vars);
@@ -216,13 +266,17 @@ namespace percy
             res_offset = nr_sel_vars;
             ops_offset = nr_sel_vars + nr_res_vars;
             sim_offset = nr_sel_vars + nr_res_vars + nr_op_vars;
-            total_nr_vars = nr_sel_vars + nr_res_vars + nr_op_vars + nr_sim_vars;
+            out_offset = sim_offset + nr_sim_vars;
+            nr_out_vars = spec.nr_nontriv > 1 ?
+                spec.nr_nontriv * spec.nr_steps : 0;
+            total_nr_vars = out_offset + nr_out_vars;
 
             if (spec.verbosity) {
                 printf("creating %d sel_vars\n", nr_sel_vars);
                 printf("creating %d res_vars\n", nr_res_vars);
                 printf("creating %d op_vars\n", nr_op_vars);
                 printf("creating %d sim_vars\n", nr_sim_vars);
+                printf("creating %d out_vars\n", nr_out_vars);
             }
 
             solver->set_nr_vars(total_nr_vars);
@@ -238,6 +292,31 @@ namespace percy
             return true;
         }
 
+        /// Ensures that every non-trivial output points to a step, and
+        /// that at least one of them points to the last step.
+        bool create_output_clauses(const spec& spec)
+        {
+            if (spec.nr_nontriv < 2) {
+                return true;
+            }
+            auto ret = true;
+            for (int h = 0; h < spec.nr_nontriv; h++) {
+                for (int i = 0; i < spec.nr_steps; i++) {
+                    pabc::Vec_IntSetEntry(vLits, i,
+                            pabc::Abc_Var2Lit(get_out_var(spec, h, i), 0));
+                }
+                ret &= solver->add_clause(pabc::Vec_IntArray(vLits),
+                        pabc::Vec_IntArray(vLits) + spec.nr_steps);
+            }
+            for (int h = 0; h < spec.nr_nontriv; h++) {
+                pabc::Vec_IntSetEntry(vLits, h, pabc::Abc_Var2Lit(
+                            get_out_var(spec, h, spec.nr_steps - 1), 0));
+            }
+            ret &= solver->add_clause(pabc::Vec_IntArray(vLits),
+                    pabc::Vec_IntArray(vLits) + spec.nr_nontriv);
+            return ret;
+        }
+
         
 
         /*******************************************************************
@@ -272,6 +351,15 @@ namespace percy
         }
 
         bool create_tt_clauses(const spec& spec, int t) override
+        {
+            auto ret = create_sim_clauses(spec, t);
+            ret &= fix_output_sim_vars(spec, t);
+            return ret;
+        }
+
+        /// Adds the clauses that simulate the steps at minterm t + 1,
+        /// which depend on the fence through the selection variables.
+        bool create_sim_clauses(const spec& spec, int t)
         {
             auto ret = true;
 
@@ -294,8 +382,6 @@ namespace percy
                 }
             }
 
-            ret &= fix_output_sim_vars(spec, t);
-
             return ret;
         }
 
@@ -371,10 +457,19 @@ namespace percy
         }
 
         /// Add clauses which ensure that every step is used at least once.
-        void create_alonce_clauses(const spec& spec)
+        /// Returns false if a step can not be used by any output or later
+        /// step in the fence.
+        bool create_alonce_clauses(const spec& spec)
         {
+            auto ret = true;
             for (int i = 0; i < spec.nr_steps - 1; i++) {
                 auto ctr = 0;
+                if (spec.nr_nontriv > 1) {
+                    for (int h = 0; h < spec.nr_nontriv; h++) {
+                        pabc::Vec_IntSetEntry(vLits, ctr++,
+                                pabc::Abc_Var2Lit(get_out_var(spec, h, i), 0));
+                    }
+                }
                 const auto level = get_level(spec, i + spec.nr_in);
                 const auto idx = spec.nr_in + i;
                 for (int ip = i + 1; ip < spec.nr_steps; ip++) {
@@ -399,8 +494,12 @@ namespace percy
                         }
                     }
                 }
-                solver->add_clause(pabc::Vec_IntArray(vLits), pabc::Vec_IntArray(vLits) + ctr);
+                if (ctr == 0) {
+                    return false;
+                }
+                ret &= solver->add_clause(pabc::Vec_IntArray(vLits), pabc::Vec_IntArray(vLits) + ctr);
             }
+            return ret;
         }
 
         bool add_simulation_clause(
@@ -545,7 +644,7 @@ namespace percy
         /// Extracts chain from encoded CNF solution.
         void extract_chain(const spec& spec, chain& chain) override
         {
-            chain.reset(spec.nr_in, 1, spec.nr_steps, 2);
+            chain.reset(spec.nr_in, spec.get_nr_out(), spec.nr_steps, 2);
 
             kitty::dynamic_truth_table op(2);
             for (int i = 0; i < spec.nr_steps; i++) {
@@ -586,10 +685,33 @@ namespace percy
                 }
             }
 
-            // TODO: support multiple outputs
-            chain.set_output(0,
-                ((spec.nr_steps + spec.nr_in) << 1) +
-                ((spec.out_inv) & 1));
+            auto triv_count = 0, nontriv_count = 0;
+            for (int h = 0; h < spec.get_nr_out(); h++) {
+                const auto inv = (spec.out_inv >> h) & 1;
+                if ((spec.triv_flag >> h) & 1) {
+                    chain.set_output(h,
+                        (spec.triv_func(triv_count++) << 1) + inv);
+                    continue;
+                }
+                const auto step = output_step(spec, nontriv_count++);
+                chain.set_output(h, ((step + spec.nr_in + 1) << 1) + inv);
+            }
+        }
+
+        /// Returns the step that computes the h-th non-trivial output in
+        /// the current solution.
+        int output_step(const spec& spec, int h) const
+        {
+            if (spec.nr_nontriv == 1) {
+                return spec.nr_steps - 1;
+            }
+            for (int i = 0; i < spec.nr_steps; i++) {
+                if (solver->var_value(get_out_var(spec, h, i))) {
+                    return i;
+                }
+            }
+            assert(false);
+            return spec.nr_steps - 1;
         }
 
         void create_colex_clauses(const spec& spec)
@@ -730,6 +852,7 @@ namespace percy
 
             update_level_map(spec, f);
             create_variables(spec);
+            reserve_formula(spec, total_nr_vars, nr_sel_vars);
             success = create_main_clauses(spec);
             if (!success) {
                 return false;
@@ -738,13 +861,16 @@ namespace percy
             if (!create_fanin_clauses(spec)) {
                 return false;
             }
+            if (!create_output_clauses(spec)) {
+                return false;
+            }
 
             if (spec.add_nontriv_clauses) {
                 create_nontriv_clauses(spec);
             }
 
-            if (spec.add_alonce_clauses) {
-                create_alonce_clauses(spec);
+            if (spec.add_alonce_clauses && !create_alonce_clauses(spec)) {
+                return false;
             }
             if (spec.add_noreapply_clauses) {
                 create_noreapply_clauses(spec);
@@ -764,6 +890,76 @@ namespace percy
             return true;
         }
 
+        /// The operator, simulation and output variables only depend on
+        /// the number of steps, so they come first, along with the clauses
+        /// that fix the outputs and rule out trivial operators.
+        bool encode_shared(const spec& spec) override
+        {
+            nr_op_vars = spec.nr_steps * OP_VARS_PER_STEP;
+            nr_sim_vars = spec.nr_steps * spec.get_tt_size();
+            nr_out_vars = spec.nr_nontriv > 1 ?
+                spec.nr_nontriv * spec.nr_steps : 0;
+            ops_offset = 0;
+            sim_offset = nr_op_vars;
+            out_offset = nr_op_vars + nr_sim_vars;
+            sel_offset = out_offset + nr_out_vars;
+            nr_sel_vars = 0;
+            total_nr_vars = sel_offset;
+            solver->set_nr_vars(total_nr_vars);
+
+            for (int t = 0; t < spec.get_tt_size(); t++) {
+                if (!fix_output_sim_vars(spec, t)) {
+                    return false;
+                }
+            }
+            if (!create_output_clauses(spec)) {
+                return false;
+            }
+            if (spec.add_nontriv_clauses) {
+                create_nontriv_clauses(spec);
+            }
+
+            return true;
+        }
+
+        /// The selection variables follow the shared ones.
+        bool encode_structure(const spec& spec, const fence& f) override
+        {
+            assert(spec.nr_steps == f.nr_nodes());
+
+            update_level_map(spec, f);
+            nr_sel_vars = 0;
+            for (int i = 0; i < spec.nr_steps; i++) {
+                nr_sel_vars += nr_svars_for_step(spec, i);
+            }
+            total_nr_vars = sel_offset + nr_sel_vars;
+            reserve_formula(spec, total_nr_vars, nr_sel_vars);
+            solver->set_nr_vars(total_nr_vars);
+
+            for (int t = 0; t < spec.get_tt_size(); t++) {
+                if (!create_sim_clauses(spec, t)) {
+                    return false;
+                }
+            }
+            if (!create_fanin_clauses(spec)) {
+                return false;
+            }
+            if (spec.add_alonce_clauses && !create_alonce_clauses(spec)) {
+                return false;
+            }
+            if (spec.add_noreapply_clauses) {
+                create_noreapply_clauses(spec);
+            }
+            if (spec.add_colex_clauses) {
+                create_colex_clauses(spec);
+            }
+            if (spec.add_symvar_clauses) {
+                create_symvar_clauses(spec);
+            }
+
+            return true;
+        }
+
         /// Encodes specifciation for use in CEGAR based synthesis flow.
         bool cegar_encode(const spec& spec, const fence& f) override
         {
@@ -775,13 +971,16 @@ namespace percy
             if (!create_fanin_clauses(spec)) {
                 return false;
             }
+            if (!create_output_clauses(spec)) {
+                return false;
+            }
             create_cardinality_constraints(spec);
 
             if (spec.add_nontriv_clauses) {
                 create_nontriv_clauses(spec);
             }
-            if (spec.add_alonce_clauses) {
-                create_alonce_clauses(spec);
+            if (spec.add_alonce_clauses && !create_alonce_clauses(spec)) {
+                return false;
             }
             if (spec.add_noreapply_clauses) {
                 create_noreapply_clauses(spec);
@@ -856,19 +1055,13 @@ namespace percy
                 auto& tt_step = sim_tts[spec.nr_in + i];
                 switch (op) {
                 case 2: // x1^(~x2)
-                    tt_step = sim_tts[op_inputs[0]] & (~sim_tts[op_inputs[1]]);
-                    break;
                 case 4: // (~x1)^x2
-                    tt_step = (~sim_tts[op_inputs[0]]) & sim_tts[op_inputs[1]];
-                    break;
                 case 6: // XOR
-                    tt_step = sim_tts[op_inputs[0]] ^ sim_tts[op_inputs[1]];
-                    break;
                 case 8: // AND
-                    tt_step = sim_tts[op_inputs[0]] & sim_tts[op_inputs[1]];
-                    break;
                 case 14: // OR
-                    tt_step = sim_tts[op_inputs[0]] | sim_tts[op_inputs[1]];
+                    apply_op2(op, &*sim_tts[op_inputs[0]].cbegin(),
+                            &*sim_tts[op_inputs[1]].cbegin(), &*tt_step.begin(),
+                            int(tt_step.num_blocks()));
                     break;
                 default:
                     fprintf(stderr, "Error: unknown operator\n");
@@ -880,7 +1073,60 @@ namespace percy
             return sim_tts[spec.nr_in + spec.nr_steps - 1];
         }
 
-        void reset_sim_tts(int nr_in) override 
+        /// Simulates all steps once and compares every non-trivial output
+        /// against the specification, word by word. Returns the smallest
+        /// minterm at which any of the outputs is wrong, or -1.
+        int64_t find_counterexample(const spec& spec) override
+        {
+            (void)simulate(spec);
+
+            const auto nr_bits = int64_t(1) << spec.nr_in;
+            const uint64_t last_mask = nr_bits >= 64 ? ~uint64_t(0) :
+                ((uint64_t(1) << nr_bits) - 1);
+            int64_t first_one = -1;
+            for (int h = 0; h < spec.nr_nontriv; h++) {
+                const auto func = spec.synth_func(h);
+                const auto& sim_tt =
+                    sim_tts[spec.nr_in + output_step(spec, h)];
+                const uint64_t inv = ((spec.out_inv >> func) & 1) ?
+                    ~uint64_t(0) : 0;
+                // Only the words before an earlier counterexample matter.
+                const auto nr_words = int(sim_tt.num_blocks());
+                const auto end = first_one == -1 ? nr_words :
+                    std::min(nr_words, int(first_one / 64) + 1);
+                const auto idx = tt_find_first_difference(
+                        &*sim_tt.cbegin(), &*spec[func].cbegin(), end,
+                        spec.has_dc_mask(func) ?
+                            &*spec.get_dc_mask(func).cbegin() : nullptr,
+                        inv, end == nr_words ? last_mask : ~uint64_t(0));
+                if (idx != -1 && (first_one == -1 || idx < first_one)) {
+                    first_one = idx;
+                }
+            }
+            return first_one;
+        }
+
+        void simulation_difference(const spec& spec,
+                kitty::dynamic_truth_table& diff) override
+        {
+            (void)simulate(spec);
+
+            diff = kitty::dynamic_truth_table(spec.nr_in);
+            for (int h = 0; h < spec.nr_nontriv; h++) {
+                const auto func = spec.synth_func(h);
+                auto func_diff =
+                    sim_tts[spec.nr_in + output_step(spec, h)] ^ spec[func];
+                if ((spec.out_inv >> func) & 1) {
+                    func_diff = ~func_diff;
+                }
+                if (spec.has_dc_mask(func)) {
+                    func_diff &= ~spec.get_dc_mask(func);
+                }
+                diff |= func_diff;
+            }
+        }
+
+        void reset_sim_tts(int nr_in) override
         {
             for (int i = 0; i < NR_SIM_TTS; i++) {
                 sim_tts[i] = kitty::dynamic_truth_table(nr_in);
@@ -804,7 +804,7 @@ namespace percy
                     svar_offset += nr_svars_for_i;
                 }
                 
-                return solver->add_clause(pabc::Vec_IntArray(vLits), pabc::Vec_IntArray(vLits) + ctr);
+                return add_blocking_clause(solver, pabc::Vec_IntArray(vLits), pabc::Vec_IntArray(vLits) + ctr);
             }
 
 
@@ -831,7 +831,7 @@ namespace percy
                     svar_offset += nr_svars_for_i;
                 }
 
-                return solver->add_clause(pabc::Vec_IntArray(vLits), pabc::Vec_IntArray(vLits) + ctr);
+                return add_blocking_clause(solver, pabc::Vec_IntArray(vLits), pabc::Vec_IntArray(vLits) + ctr);
             }
 
             kitty::dynamic_truth_table& simulate(const spec&)
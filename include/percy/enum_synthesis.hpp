@@ -0,0 +1,764 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "spec.hpp"
+#include "chain.hpp"
+#include "tt_utils.hpp"
+#include "solvers/solver_wrapper.hpp"
+
+/*******************************************************************************
+    SAT-free exact synthesis of Boolean chains with fanin 2 for functions
+    of up to five inputs. Chains of increasing size are enumerated step by
+    step, with truth tables packed into a single machine word. The
+    enumeration respects the same symmetry breaks as the SAT encodings,
+    selected by the flags of the specification, so that the chains found
+    satisfy the same checks. In addition, it prunes steps that compute
+    constants or functions that are already computed, chains with more
+    unused steps than can still be consumed, and inputs on which none of
+    the outputs depend, none of which can occur in an optimum chain.
+
+    For functions of up to four inputs, the optimum sizes of all functions
+    are computed once by dynamic programming, using the footprint method
+    of Knuth[1]. The table provides the exact size to enumerate for single
+    outputs, and the functions computed by one optimum chain, to which the
+    enumeration is first restricted.
+    [1] Donald Ervin Knuth, "The Art of Computer Programming, Volume 4A,
+    Combinatorial Algorithms, Part 1," 2011, Section 7.1.2
+*******************************************************************************/
+namespace percy
+{
+    const int ENUM_MAX_IN = 5;
+    const int ENUM_NR_OPS = 5;
+
+    /// Returns the truth table of the i-th normal operator that depends on
+    /// both fanins. The operators are ordered by increasing truth table,
+    /// so that they respect the lex_func clauses.
+    inline uint32_t enum_op_word(int i)
+    {
+        static const uint32_t ops[ENUM_NR_OPS] = { 0x2, 0x4, 0x6, 0x8, 0xe };
+        return ops[i];
+    }
+
+    /// Applies the i-th normal operator to packed truth tables.
+    template<typename Word>
+    inline Word enum_apply_op(int i, Word a, Word b)
+    {
+        switch (i) {
+        case 0:
+            return a & ~b;
+        case 1:
+            return ~a & b;
+        case 2:
+            return a ^ b;
+        case 3:
+            return a & b;
+        default:
+            return a | b;
+        }
+    }
+
+    /// The optimum sizes of all functions of four variables.
+    struct enum_cost_db
+    {
+        /// The optimum number of steps, indexed by truth table.
+        std::vector<uint8_t> cost;
+        /// For normal functions, the set of steps on two inputs with which
+        /// an optimum chain can start, as indices into first_steps.
+        std::vector<uint32_t> footprint;
+        /// The normal functions, grouped by their cost.
+        std::vector<std::vector<uint16_t>> by_cost;
+        std::vector<uint16_t> first_steps;
+    };
+
+    /// Returns the optimum sizes of all functions of four variables. The
+    /// table is computed once, by dynamic programming over increasing
+    /// costs. A function of cost r is found by combining a function of
+    /// cost j with one of cost k, where j + k + 1 = r, or where j + k = r
+    /// if the two can share a step. As in Knuth's footprint method, the
+    /// latter is detected by keeping track of the first steps with which
+    /// each function can be computed optimally. For four variables this
+    /// gives the exact cost of every function.
+    inline const enum_cost_db& get_enum_cost_db()
+    {
+        static const enum_cost_db db = [] {
+            const int nr_funcs = 1 << 16;
+            const uint8_t unknown = 0xff;
+            enum_cost_db db;
+            db.cost.assign(nr_funcs, unknown);
+            db.footprint.assign(nr_funcs, 0);
+            db.by_cost.resize(2);
+
+            // Only normal functions are combined. Their complements have
+            // the same cost.
+            int nr_known = 0;
+            const auto set_cost = [&](uint16_t f, int c) {
+                db.cost[f] = c;
+                db.cost[uint16_t(~f)] = c;
+                nr_known += 2;
+            };
+            const uint16_t vars[4] = { 0xaaaa, 0xcccc, 0xf0f0, 0xff00 };
+            set_cost(0, 0);
+            for (const auto x : vars) {
+                set_cost(x, 0);
+                db.by_cost[0].push_back(x);
+            }
+            for (int k = 1; k < 4; k++) {
+                for (int j = 0; j < k; j++) {
+                    for (int op = 0; op < ENUM_NR_OPS; op++) {
+                        const auto f = enum_apply_op<uint16_t>(op, vars[j], vars[k]);
+                        set_cost(f, 1);
+                        db.footprint[f] = 1u << db.first_steps.size();
+                        db.first_steps.push_back(f);
+                        db.by_cost[1].push_back(f);
+                    }
+                }
+            }
+
+            for (int r = 2; nr_known < nr_funcs; r++) {
+                for (int j = 0; j < r; j++) {
+                    for (int k = j; j + k <= r; k++) {
+                        const auto shared = (j + k == r);
+                        if (shared && j == 0) {
+                            continue;
+                        }
+                        const auto& gs = db.by_cost[j];
+                        const auto& hs = db.by_cost[k];
+                        for (auto gi = 0u; gi < gs.size(); gi++) {
+                            const auto g = gs[gi];
+                            for (auto hi = (j == k ? gi + 1 : 0u); hi < hs.size(); hi++) {
+                                const auto h = hs[hi];
+                                // Steps shared by g and h start chains of
+                                // f, otherwise all first steps of both do.
+                                const auto fp = shared ?
+                                    db.footprint[g] & db.footprint[h] :
+                                    db.footprint[g] | db.footprint[h];
+                                if (!fp) {
+                                    continue;
+                                }
+                                for (int op = 0; op < ENUM_NR_OPS; op++) {
+                                    const auto f = enum_apply_op<uint16_t>(op, g, h);
+                                    if (db.cost[f] == unknown) {
+                                        set_cost(f, r);
+                                        db.footprint[f] = fp;
+                                    } else if (db.cost[f] == r) {
+                                        db.footprint[f] |= fp;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+                db.by_cost.emplace_back();
+                for (int f = 0; f < nr_funcs; f += 2) {
+                    if (db.cost[f] == r) {
+                        db.by_cost[r].push_back(uint16_t(f));
+                    }
+                }
+            }
+            return db;
+        }();
+        return db;
+    }
+
+    /// Extends a packed truth table of nr_in <= 4 variables to four
+    /// variables.
+    inline uint16_t enum_extend_to_4(uint32_t tt, int nr_in)
+    {
+        for (int i = nr_in; i < 4; i++) {
+            tt |= tt << (1 << i);
+        }
+        return uint16_t(tt);
+    }
+
+    /// Returns the optimum number of steps of a function of at most four
+    /// variables.
+    inline int enum_optimum_size(const kitty::dynamic_truth_table& tt)
+    {
+        assert(tt.num_vars() <= 4);
+        const auto word = uint32_t(*tt.cbegin()) &
+            (~0u >> (32 - (1 << tt.num_vars())));
+        return get_enum_cost_db().cost[enum_extend_to_4(word, tt.num_vars())];
+    }
+
+    /// Collects the functions computed by the steps of an optimum chain
+    /// for the normal function f of four variables, which starts with the
+    /// first step of index first_step if it is not -1. The chain is
+    /// reconstructed from a combination that was used to compute the
+    /// cost table.
+    inline void enum_optimum_steps(
+        const enum_cost_db& db,
+        uint16_t f,
+        int first_step,
+        std::vector<uint16_t>& steps)
+    {
+        const int r = db.cost[f];
+        if (r == 0) {
+            return;
+        }
+        if (r == 1) {
+            steps.push_back(f);
+            return;
+        }
+        const uint32_t required = first_step == -1 ? ~0u : (1u << first_step);
+        for (int j = 0; j < r; j++) {
+            for (int k = j; j + k <= r; k++) {
+                const auto shared = (j + k == r);
+                if (shared && j == 0) {
+                    continue;
+                }
+                const auto& gs = db.by_cost[j];
+                const auto& hs = db.by_cost[k];
+                for (auto gi = 0u; gi < gs.size(); gi++) {
+                    const auto g = gs[gi];
+                    for (auto hi = (j == k ? gi + 1 : 0u); hi < hs.size(); hi++) {
+                        const auto h = hs[hi];
+                        const auto fp = shared ?
+                            db.footprint[g] & db.footprint[h] :
+                            db.footprint[g] | db.footprint[h];
+                        if (!(fp & required)) {
+                            continue;
+                        }
+                        auto is_combination = false;
+                        for (int op = 0; op < ENUM_NR_OPS; op++) {
+                            if (enum_apply_op<uint16_t>(op, g, h) == f) {
+                                is_combination = true;
+                            }
+                        }
+                        if (!is_combination) {
+                            continue;
+                        }
+                        // The chains of g and h must share a first step,
+                        // and the required first step must be in one of
+                        // them.
+                        auto step = first_step;
+                        if (shared && step == -1) {
+                            step = 0;
+                            while (!((fp >> step) & 1)) {
+                                step++;
+                            }
+                        }
+                        auto g_step = -1, h_step = -1;
+                        if (shared) {
+                            g_step = h_step = step;
+                        } else if (step != -1 && ((db.footprint[g] >> step) & 1)) {
+                            g_step = step;
+                        } else {
+                            h_step = step;
+                        }
+                        enum_optimum_steps(db, g, g_step, steps);
+                        enum_optimum_steps(db, h, h_step, steps);
+                        std::sort(steps.begin(), steps.end());
+                        steps.erase(std::unique(steps.begin(), steps.end()), steps.end());
+                        steps.push_back(f);
+                        return;
+                    }
+                }
+            }
+        }
+        assert(false);
+    }
+
+    /// Enumerates chains for a specification, using truth tables of type
+    /// Word, which must have at least 2^nr_in bits.
+    template<typename Word>
+    class enum_synthesizer
+    {
+    private:
+        int nr_in;
+        int nr_steps;
+        Word tt_mask;
+        bool has_dc;
+        bool add_colex;
+        bool add_lex;
+        bool add_lex_func;
+        bool add_noreapply;
+
+        /// Distinct non-trivial target functions and their care sets.
+        std::vector<Word> targets;
+        std::vector<Word> cares;
+        std::vector<int> matched; ///< Step that computes each target, or -1
+        int nr_unmatched;
+
+        /// Pairs of inputs (p, q), p < q, in which all targets are symmetric.
+        std::vector<std::pair<int, int>> symmetric_pairs;
+        uint32_t usable_inputs;
+        uint32_t required_inputs; ///< Inputs on which the targets depend
+
+        /// If not empty, the only functions the steps may compute.
+        std::vector<Word> allowed_steps;
+
+        Word tts[ENUM_MAX_IN + MAX_STEPS];
+        int fanins[MAX_STEPS][2];
+        int op_idx[MAX_STEPS];
+        int nr_uses[ENUM_MAX_IN + MAX_STEPS];
+        int nr_unused; ///< Steps that are not used by other steps
+        int nr_fresh;  ///< Required inputs that are not used by any step
+
+        uint64_t nr_nodes_visited = 0;
+
+        bool matches(Word tt, int t) const
+        {
+            return ((tt ^ targets[t]) & cares[t]) == 0 ||
+                ((~tt ^ targets[t]) & cares[t]) == 0;
+        }
+
+        /// A node is open if it is a step that is not used by any other
+        /// step, or a required input that is not used by any step.
+        bool is_open(int x) const
+        {
+            return nr_uses[x] == 0 &&
+                (x >= nr_in || ((required_inputs >> x) & 1));
+        }
+
+        bool is_usable(int x) const
+        {
+            return x >= nr_in || ((usable_inputs >> x) & 1);
+        }
+
+        /// Checks the ordering of step i with fanins (a, b) and operator
+        /// op with respect to step i - 1.
+        bool is_ordered(int i, int a, int b, int op) const
+        {
+            if (i == 0) {
+                return true;
+            }
+            const auto pa = fanins[i - 1][0];
+            const auto pb = fanins[i - 1][1];
+            if (add_colex && (b < pb || (b == pb && a < pa))) {
+                return false;
+            }
+            if (add_lex && (a < pa || (a == pa && b < pb))) {
+                return false;
+            }
+            if (add_lex_func && a == pa && b == pb && op < op_idx[i - 1]) {
+                return false;
+            }
+            return true;
+        }
+
+        /// Checks the symmetric variable clauses for a step with fanins
+        /// (a, b).
+        bool respects_symvars(int a, int b) const
+        {
+            for (const auto& pq : symmetric_pairs) {
+                const auto p = pq.first;
+                const auto q = pq.second;
+                if ((a == q || b == q) && a != p && nr_uses[p] == 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool is_reapplication(int a, int b) const
+        {
+            if (!add_noreapply || b < nr_in) {
+                return false;
+            }
+            const auto s = b - nr_in;
+            return fanins[s][0] == a || fanins[s][1] == a;
+        }
+
+        bool is_allowed(Word tt, int nr_nodes) const
+        {
+            if (!allowed_steps.empty() &&
+                    std::find(allowed_steps.begin(), allowed_steps.end(), tt) ==
+                    allowed_steps.end()) {
+                return false;
+            }
+            // With don't cares an output may be a projection or a constant
+            // in its care set, and the encoders still map it to a step.
+            if (has_dc) {
+                return true;
+            }
+            if (tt == 0) {
+                return false;
+            }
+            for (int j = 0; j < nr_nodes; j++) {
+                if (tts[j] == tt) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool search(int i)
+        {
+            nr_nodes_visited++;
+            const auto remaining = nr_steps - i;
+            if (remaining == 0) {
+                return nr_unmatched == 0;
+            }
+            // Every step computes at most one new target.
+            if (!has_dc && nr_unmatched > remaining) {
+                return false;
+            }
+            // In the end, all required inputs are used and all steps are
+            // used or compute a target. The unused steps and fresh inputs
+            // are joined by the remaining steps, each of which consumes at
+            // most one more of them than it leaves unused itself.
+            const auto nr_open = nr_unused + nr_fresh;
+            if (nr_open - remaining > int(targets.size())) {
+                return false;
+            }
+            // The number of open nodes the next step has to consume.
+            const auto min_consumed = nr_open - remaining + 2 -
+                int(targets.size());
+
+            const auto nr_nodes = nr_in + i;
+            for (int b = 1; b < nr_nodes; b++) {
+                if (!is_usable(b)) {
+                    continue;
+                }
+                const auto open_b = is_open(b);
+                for (int a = 0; a < b; a++) {
+                    if (!is_usable(a)) {
+                        continue;
+                    }
+                    const auto open_a = is_open(a);
+                    if (int(open_a) + int(open_b) < min_consumed) {
+                        continue;
+                    }
+                    if (is_reapplication(a, b) || !respects_symvars(a, b)) {
+                        continue;
+                    }
+                    const auto fresh_a = open_a && a < nr_in;
+                    const auto fresh_b = open_b && b < nr_in;
+                    const auto delta_unused = 1 - (open_a - fresh_a) -
+                        (open_b - fresh_b);
+                    for (int op = 0; op < ENUM_NR_OPS; op++) {
+                        if (!is_ordered(i, a, b, op)) {
+                            continue;
+                        }
+                        const auto tt = Word(enum_apply_op(op, tts[a], tts[b]) & tt_mask);
+                        if (!is_allowed(tt, nr_nodes)) {
+                            continue;
+                        }
+                        if (remaining == 1 && nr_unmatched > 0) {
+                            // The last step must compute the remaining
+                            // targets.
+                            auto all_matched = true;
+                            for (int t = 0; t < int(targets.size()); t++) {
+                                if (matched[t] == -1 && !matches(tt, t)) {
+                                    all_matched = false;
+                                    break;
+                                }
+                            }
+                            if (!all_matched) {
+                                continue;
+                            }
+                        }
+
+                        tts[nr_nodes] = tt;
+                        fanins[i][0] = a;
+                        fanins[i][1] = b;
+                        op_idx[i] = op;
+                        nr_uses[a]++;
+                        nr_uses[b]++;
+                        nr_uses[nr_nodes] = 0;
+                        nr_unused += delta_unused;
+                        nr_fresh -= fresh_a + fresh_b;
+                        for (int t = 0; t < int(targets.size()); t++) {
+                            if (matched[t] == -1 && matches(tt, t)) {
+                                matched[t] = i;
+                                nr_unmatched--;
+                            }
+                        }
+
+                        if (search(i + 1)) {
+                            return true;
+                        }
+
+                        for (int t = 0; t < int(targets.size()); t++) {
+                            if (matched[t] == i) {
+                                matched[t] = -1;
+                                nr_unmatched++;
+                            }
+                        }
+                        nr_fresh += fresh_a + fresh_b;
+                        nr_unused -= delta_unused;
+                        nr_uses[a]--;
+                        nr_uses[b]--;
+                    }
+                }
+            }
+            return false;
+        }
+
+        static Word to_word(const kitty::dynamic_truth_table& tt)
+        {
+            return Word(*tt.cbegin());
+        }
+
+    public:
+        /// Prepares the enumeration for a preprocessed specification.
+        enum_synthesizer(const spec& spec)
+        {
+            assert(spec.fanin == 2);
+            assert(spec.get_nr_in() <= ENUM_MAX_IN);
+            assert(sizeof(Word) * 8 >= (1u << spec.get_nr_in()));
+
+            nr_in = spec.get_nr_in();
+            tt_mask = Word(~uint64_t(0) >> (64 - (1 << nr_in)));
+            add_colex = spec.add_colex_clauses;
+            add_lex = spec.add_lex_clauses;
+            add_lex_func = spec.add_lex_func_clauses;
+            add_noreapply = spec.add_noreapply_clauses;
+
+            has_dc = false;
+            for (int i = 0; i < spec.nr_nontriv; i++) {
+                if (spec.has_dc_mask(spec.synth_func(i))) {
+                    has_dc = true;
+                }
+            }
+
+            usable_inputs = has_dc ? (1u << nr_in) - 1 : 0;
+            kitty::dynamic_truth_table tt_var(nr_in);
+            for (int i = 0; i < nr_in; i++) {
+                kitty::create_nth_var(tt_var, i);
+                tts[i] = to_word(tt_var) & tt_mask;
+                nr_uses[i] = 0;
+            }
+
+            for (int i = 0; i < spec.nr_nontriv; i++) {
+                const auto h = spec.synth_func(i);
+                const auto f = Word(to_word(spec[h]) & tt_mask);
+                auto care = tt_mask;
+                if (spec.has_dc_mask(h)) {
+                    care &= ~to_word(spec.get_dc_mask(h));
+                }
+                if (!has_dc) {
+                    for (int j = 0; j < nr_in; j++) {
+                        if (kitty::has_var(spec[h], j)) {
+                            usable_inputs |= (1u << j);
+                        }
+                    }
+                }
+                // Outputs that are equal or complementary share a step.
+                auto is_new = true;
+                for (int t = 0; t < int(targets.size()); t++) {
+                    if (cares[t] == care && (((targets[t] ^ f) & care) == 0 ||
+                                ((targets[t] ^ ~f) & care) == 0)) {
+                        is_new = false;
+                    }
+                }
+                if (is_new) {
+                    targets.push_back(f);
+                    cares.push_back(care);
+                }
+            }
+            required_inputs = has_dc ? 0 : usable_inputs;
+
+            if (spec.add_symvar_clauses) {
+                for (int q = 1; q < nr_in; q++) {
+                    for (int p = 0; p < q; p++) {
+                        auto symm = true;
+                        for (int i = 0; i < spec.nr_nontriv; i++) {
+                            const auto& f = spec[spec.synth_func(i)];
+                            if (!(swap(f, p, q) == f)) {
+                                symm = false;
+                                break;
+                            }
+                        }
+                        if (symm) {
+                            symmetric_pairs.emplace_back(p, q);
+                        }
+                    }
+                }
+            }
+        }
+
+        bool has_single_target() const
+        {
+            return !has_dc && targets.size() == 1;
+        }
+
+        /// A lower bound on the number of steps: every target needs a
+        /// step of its own, and a chain that depends on k inputs needs at
+        /// least k - 1 steps. For up to four inputs, every target needs at
+        /// least as many steps as its optimum chain, which makes the bound
+        /// exact for a single target.
+        int lower_bound() const
+        {
+            auto lb = has_dc ? 1 : int(targets.size());
+            auto nr_required = 0;
+            for (int i = 0; i < nr_in; i++) {
+                nr_required += (required_inputs >> i) & 1;
+            }
+            lb = std::max(lb, nr_required - int(targets.size()));
+            if (!has_dc && nr_in <= 4) {
+                const auto& db = get_enum_cost_db();
+                for (const auto f : targets) {
+                    lb = std::max(lb, int(db.cost[enum_extend_to_4(f, nr_in)]));
+                }
+            }
+            return std::max(lb, 1);
+        }
+
+        /// Restricts the enumeration to steps that compute the functions
+        /// of an optimum chain of the single target, or those functions
+        /// with symmetric inputs permuted, so that the symmetric variable
+        /// clauses can be satisfied. Only applies to four inputs.
+        void restrict_to_optimum_steps()
+        {
+            assert(has_single_target() && nr_in == 4);
+            std::vector<uint16_t> steps;
+            const auto f = uint16_t(targets[0]);
+            enum_optimum_steps(get_enum_cost_db(), (f & 1) ? uint16_t(~f) : f,
+                    -1, steps);
+            allowed_steps.assign(steps.begin(), steps.end());
+            kitty::dynamic_truth_table tt(nr_in);
+            for (auto i = 0u; i < allowed_steps.size(); i++) {
+                for (const auto& pq : symmetric_pairs) {
+                    *tt.begin() = allowed_steps[i];
+                    kitty::swap_inplace(tt, pq.first, pq.second);
+                    const auto swapped = to_word(tt);
+                    if (std::find(allowed_steps.begin(), allowed_steps.end(),
+                                swapped) == allowed_steps.end()) {
+                        allowed_steps.push_back(swapped);
+                    }
+                }
+            }
+        }
+
+        void clear_restriction()
+        {
+            allowed_steps.clear();
+        }
+
+        /// Looks for a chain with exactly nr_steps steps. Returns true
+        /// if one was found, which can then be extracted.
+        bool find_chain(int nr_steps)
+        {
+            assert(nr_steps <= MAX_STEPS);
+            this->nr_steps = nr_steps;
+            matched.assign(targets.size(), -1);
+            nr_unmatched = int(targets.size());
+            nr_unused = 0;
+            nr_fresh = 0;
+            for (int i = 0; i < nr_in; i++) {
+                nr_fresh += (required_inputs >> i) & 1;
+            }
+            return search(0);
+        }
+
+        uint64_t get_nr_nodes_visited() const
+        {
+            return nr_nodes_visited;
+        }
+
+        /// Extracts the chain found by the last successful call to
+        /// find_chain.
+        void extract_chain(const spec& spec, chain& c) const
+        {
+            c.reset(nr_in, spec.get_nr_out(), nr_steps, 2);
+            kitty::dynamic_truth_table op(2);
+            for (int i = 0; i < nr_steps; i++) {
+                *op.begin() = enum_op_word(op_idx[i]);
+                c.set_step(i, fanins[i][0], fanins[i][1], op);
+            }
+
+            auto triv_count = 0;
+            for (int h = 0; h < spec.get_nr_out(); h++) {
+                if ((spec.triv_flag >> h) & 1) {
+                    c.set_output(h, (spec.triv_func(triv_count++) << 1) +
+                            ((spec.out_inv >> h) & 1));
+                    continue;
+                }
+                const auto f = Word(to_word(spec[h]) & tt_mask);
+                auto care = tt_mask;
+                if (spec.has_dc_mask(h)) {
+                    care &= ~to_word(spec.get_dc_mask(h));
+                }
+                for (int i = 0; i < nr_steps; i++) {
+                    const auto tt = tts[nr_in + i];
+                    if (((tt ^ f) & care) == 0) {
+                        c.set_output(h, nr_in + i + 1, false);
+                        break;
+                    } else if (((~tt ^ f) & care) == 0) {
+                        c.set_output(h, nr_in + i + 1, true);
+                        break;
+                    }
+                }
+            }
+        }
+    };
+
+    /// Synthesizes an optimum chain by enumeration, without a SAT solver.
+    /// Only specifications with fanin 2, at most ENUM_MAX_IN inputs and
+    /// no primitives are supported.
+    inline synth_result
+    enum_synthesize(spec& spec, chain& c, synth_stats* stats = NULL)
+    {
+        assert(spec.get_nr_in() >= spec.fanin);
+        spec.preprocess();
+
+        if (spec.fanin != 2 || spec.get_nr_in() > ENUM_MAX_IN ||
+                spec.get_nr_compiled_functions() > 0) {
+            fprintf(stderr, "Error: enumeration requires fanin 2 and at "
+                    "most %d inputs\n", ENUM_MAX_IN);
+            return failure;
+        }
+
+        if (stats) {
+            stats->synth_time = 0;
+            stats->sat_time = 0;
+            stats->unsat_time = 0;
+            stats->nr_vars = 0;
+            stats->nr_clauses = 0;
+        }
+
+        // The special case when the Boolean chain to be synthesized
+        // consists entirely of trivial functions.
+        if (spec.nr_triv == spec.get_nr_out()) {
+            c.reset(spec.get_nr_in(), spec.get_nr_out(), 0, spec.fanin);
+            for (int h = 0; h < spec.get_nr_out(); h++) {
+                c.set_output(h, (spec.triv_func(h) << 1) +
+                    ((spec.out_inv >> h) & 1));
+            }
+            return success;
+        }
+
+        const auto run = [&](auto& synth) {
+            const auto begin = std::chrono::steady_clock::now();
+            const auto lb = synth.lower_bound();
+            spec.nr_steps = std::max(spec.initial_steps, lb);
+            auto found = false;
+            if (synth.has_single_target() && spec.get_nr_in() == 4 &&
+                    spec.nr_steps == lb) {
+                // The size is known, so try the functions of an optimum
+                // chain first.
+                synth.restrict_to_optimum_steps();
+                found = synth.find_chain(spec.nr_steps);
+                synth.clear_restriction();
+            }
+            while (!found && spec.nr_steps <= MAX_STEPS) {
+                found = synth.find_chain(spec.nr_steps);
+                if (!found) {
+                    spec.nr_steps++;
+                }
+            }
+            if (stats) {
+                stats->synth_time =
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - begin).count();
+            }
+            if (!found) {
+                return failure;
+            }
+            synth.extract_chain(spec, c);
+            return success;
+        };
+
+        if (spec.get_nr_in() <= 4) {
+            enum_synthesizer<uint16_t> synth(spec);
+            return run(synth);
+        }
+        enum_synthesizer<uint32_t> synth(spec);
+        return run(synth);
+    }
+
+}
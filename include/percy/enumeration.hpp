@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
+#include <vector>
+#include "chain.hpp"
+
+namespace percy
+{
+    /// The number of consecutive solutions over which enumeration latency
+    /// is averaged.
+    const int ENUM_LATENCY_WINDOW = 100;
+
+    /// The number of solutions after which an enumeration compacts its
+    /// solver by default. Compaction makes the solver learn again what it
+    /// knew, so it only pays off in long enumerations.
+    const int ENUM_COMPACT_INTERVAL = 10000;
+
+    /***************************************************************************
+        Decides which of the chains that an enumeration finds are reported.
+        Stores are used to filter out chains that are equivalent to ones
+        that were reported before, such as chains with the same structure.
+    ***************************************************************************/
+    class solution_store
+    {
+    public:
+        virtual ~solution_store() = default;
+
+        /// Returns false if the chain, or one that the store considers
+        /// equivalent to it, has been inserted before.
+        virtual bool insert(const chain& chain) = 0;
+
+        virtual std::size_t size() const = 0;
+
+        virtual void clear() = 0;
+    };
+
+    /// Remembers a hash of every chain, and considers chains equivalent if
+    /// their hashes are equal. With structural set, the operators of the
+    /// chains are ignored. The store takes a word per chain, at the cost of
+    /// treating chains that happen to have the same hash as equivalent.
+    class chain_hash_store : public solution_store
+    {
+    private:
+        bool structural;
+        std::unordered_set<std::size_t> hashes;
+
+    public:
+        chain_hash_store(bool structural = false) : structural(structural)
+        {
+        }
+
+        bool insert(const chain& chain) override
+        {
+            return hashes.insert(chain.hash(!structural)).second;
+        }
+
+        std::size_t size() const override
+        {
+            return hashes.size();
+        }
+
+        void clear() override
+        {
+            hashes.clear();
+        }
+    };
+
+    /// Statistics of a solution enumeration. The latencies of all solutions
+    /// but the first, which includes the synthesis of the optimum, are
+    /// averaged over windows of ENUM_LATENCY_WINDOW solutions, so that a
+    /// growing cost per solution shows as growing window latencies.
+    struct enum_stats
+    {
+        int nr_solutions = 0;
+        int nr_duplicates = 0;  ///< Solutions that the store filtered out
+        int nr_compactions = 0;
+        int64_t first_time = 0; ///< Time to the first solution (in us)
+        int64_t total_time = 0; ///< Time spent on all solutions (in us)
+        int64_t max_latency = 0;
+        std::vector<int64_t> window_latencies; ///< Mean latency per window (in us)
+        int64_t window_time = 0;
+
+        void add_solution(int64_t latency)
+        {
+            total_time += latency;
+            if (nr_solutions++ == 0) {
+                first_time = latency;
+                return;
+            }
+            max_latency = std::max(max_latency, latency);
+            window_time += latency;
+            if ((nr_solutions - 1) % ENUM_LATENCY_WINDOW == 0) {
+                window_latencies.push_back(window_time / ENUM_LATENCY_WINDOW);
+                window_time = 0;
+            }
+        }
+
+        void print(FILE* f = stdout) const
+        {
+            fprintf(f, "solutions=%d duplicates=%d compactions=%d\n",
+                    nr_solutions, nr_duplicates, nr_compactions);
+            fprintf(f, "first=%lldus total=%lldus max latency=%lldus\n",
+                    (long long)first_time, (long long)total_time,
+                    (long long)max_latency);
+            for (std::size_t i = 0; i < window_latencies.size(); i++) {
+                fprintf(f, "solutions %d-%d: %lldus/solution\n",
+                        int(i * ENUM_LATENCY_WINDOW) + 2,
+                        int((i + 1) * ENUM_LATENCY_WINDOW) + 1,
+                        (long long)window_latencies[i]);
+            }
+        }
+    };
+}
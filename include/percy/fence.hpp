@@ -9,6 +9,7 @@
 #include "concurrentqueue.h"
 #include <cmath>
 #include <thread>
+#include <type_traits>
 #include <percy/spec.hpp>
 
 /*******************************************************************************
@@ -23,48 +24,32 @@
 *******************************************************************************/
 namespace percy
 {
+    /***************************************************************************
+        A Boolean fence. The number of nodes on each level is stored
+        inline, so fences are trivially copyable and can be created,
+        copied, and passed through concurrent queues without allocating
+        memory.
+    ***************************************************************************/
     class fence
     {
         private:
-            std::vector<int> _fence;
+            int _fence[MAX_STEPS];
             int _nr_nodes;
             int _nr_levels;
 
         public:
             fence() { reset(0, 0); }
 
-            fence(const fence& f) 
-            {
-                reset(f._nr_nodes, f._nr_levels);
-                for (int i = 0; i < _nr_levels; i++) {
-                    _fence[i] = f._fence[i];
-                }
-            }
-
-            fence& operator=(const fence& f)
-            {
-                reset(f._nr_nodes, f._nr_levels);
-                for (int i = 0; i < _nr_levels; i++) {
-                    _fence[i] = f._fence[i];
-                }
-
-                return *this;
-            }
-
-            fence(fence&& f) 
-            {
-                _nr_nodes = f._nr_nodes;
-                _nr_levels = f._nr_levels;
-                _fence = std::move(f._fence);
-            }
-            
             fence(int k, int l) { reset(k, l); }
 
             void reset(int nr_nodes, int nr_levels)
             { 
+                assert(nr_levels >= 0 && nr_levels <= MAX_STEPS);
                 _nr_nodes = nr_nodes;
                 _nr_levels = nr_levels;
-                _fence.resize(nr_levels);
+                for (int i = 0; i < nr_levels; i++) {
+                    _fence[i] = 0;
+                }
             }
             
             int nr_nodes() const
@@ -88,6 +73,9 @@ namespace percy
             }
     };
 
+    static_assert(std::is_trivially_copyable<fence>::value,
+            "fences are copied between threads without allocation");
+
     class fence_generator
     {
         public:
@@ -592,6 +580,184 @@ namespace percy
 
     };
 
+    /***************************************************************************
+        Generates the same fences, in the same order, as the recursive
+        fence generator. Instead of calling back for every fence, it keeps
+        the search on an explicit stack and hands out one fence at a time,
+        which is written into a fence owned by the caller. No memory is
+        allocated during the search.
+
+        The search space can be split into disjoint ranges, so that
+        several threads can generate fences concurrently. Subtrees of the
+        search at the split level are numbered in the order in which they
+        are visited, and distributed over the ranges in a round-robin
+        fashion.
+    ***************************************************************************/
+    class iter_fence_generator
+    {
+        private:
+            int _nr_levels = 0;
+            int _nr_nodes = 0;
+            int _nr_outputs = 1;
+            int _max_fanin = 2;
+            int _budget = 0;
+            bool _po_filter = true;
+
+            // The search stack: the number of nodes spent on each level
+            // beyond the minimum of one, and the maximum we may spend.
+            int _level = 0;
+            int _nodes_spent[MAX_STEPS];
+            int _max_spent[MAX_STEPS];
+            bool _descending = true;
+            bool _finished = true;
+
+            int _split_level = 2;
+            int _nr_ranges = 1;
+            int _range = 0;
+            uint64_t _nr_subtrees = 0;
+
+            uint64_t _nr_solutions = 0;
+
+            int max_nodes_on_level(int level) const
+            {
+                if (level == 0) {
+                    return _nr_outputs;
+                }
+                int nr_allowed = _nodes_spent[0] + 1;
+                for (int i = 0; i < level; i++) {
+                    nr_allowed *= _max_fanin;
+                }
+                return nr_allowed;
+            }
+
+            /// Returns true if the subtree that starts at the current
+            /// level belongs to another range.
+            bool skip_subtree()
+            {
+                if (_nr_ranges == 1) {
+                    return false;
+                }
+                // Solutions that are found above the split level form
+                // subtrees by themselves.
+                if (_level == _split_level ||
+                        (_level < _split_level && _budget == 0)) {
+                    const auto subtree = _nr_subtrees++;
+                    return subtree % _nr_ranges != 
+                        static_cast<uint64_t>(_range);
+                }
+                return false;
+            }
+
+            void spend(int nodes)
+            {
+                _nodes_spent[_level] = nodes;
+                _budget -= nodes;
+                ++_level;
+            }
+
+        public:
+            iter_fence_generator() { }
+
+            iter_fence_generator(bool po_filter) : _po_filter(po_filter) { }
+
+            uint64_t nr_solutions() const { return _nr_solutions; }
+
+            int nr_levels() const { return _nr_levels; }
+            int nr_nodes() const { return _nr_nodes; }
+            bool po_filter() const { return _po_filter; }
+            void set_po_filter(bool po_filter) { _po_filter = po_filter; }
+
+            void 
+            reset(
+                    int nr_nodes, 
+                    int nr_levels, 
+                    int nr_outputs=1, 
+                    int max_fanin=2)
+            {
+                assert(nr_levels >= 1);
+                assert(nr_nodes >= nr_levels);
+                assert(nr_levels <= MAX_STEPS);
+
+                _nr_nodes = nr_nodes;
+                _nr_levels = nr_levels;
+                _nr_outputs = nr_outputs;
+                _max_fanin = max_fanin;
+                for (int i = 0; i < nr_levels; i++) {
+                    _nodes_spent[i] = 0;
+                }
+
+                _budget = _nr_nodes - _nr_levels;
+                _nr_solutions = 0;
+                _nr_subtrees = 0;
+                _level = 0;
+                _descending = true;
+                _finished = false;
+            }
+
+            /// Restricts the generator to one of nr_ranges disjoint ranges
+            /// of the search space. Applies until it is changed, also
+            /// after the generator is reset.
+            void set_range(int nr_ranges, int range, int split_level = 2)
+            {
+                assert(nr_ranges > 0 && range >= 0 && range < nr_ranges);
+                assert(split_level >= 0);
+                _nr_ranges = nr_ranges;
+                _range = range;
+                _split_level = split_level;
+            }
+
+            /// Writes the next fence into f. Returns false if there are
+            /// no more fences.
+            bool next_fence(fence& f)
+            {
+                while (!_finished) {
+                    if (_descending) {
+                        if (skip_subtree()) {
+                            _descending = false;
+                            continue;
+                        }
+                        if (_budget == 0) {
+                            ++_nr_solutions;
+                            if (f.nr_nodes() != _nr_nodes ||
+                                    f.nr_levels() != _nr_levels) {
+                                f.reset(_nr_nodes, _nr_levels);
+                            }
+                            for (int i = 0; i < _nr_levels; i++) {
+                                f[i] = _nodes_spent[_nr_levels - 1 - i] + 1;
+                            }
+                            _descending = false;
+                            return true;
+                        }
+                        // At the final level we have to spend the
+                        // remaining budget.
+                        const auto start_budget = 
+                            (_level == _nr_levels - 1) ? _budget : 0;
+                        _max_spent[_level] = _po_filter ? 
+                            std::min(max_nodes_on_level(_level) - 1, _budget) :
+                            _budget;
+                        if (start_budget > _max_spent[_level]) {
+                            _descending = false;
+                            continue;
+                        }
+                        spend(start_budget);
+                    } else {
+                        if (--_level < 0) {
+                            _finished = true;
+                            break;
+                        }
+                        const auto nodes_spent = _nodes_spent[_level];
+                        _budget += nodes_spent;
+                        _nodes_spent[_level] = 0;
+                        if (nodes_spent < _max_spent[_level]) {
+                            spend(nodes_spent + 1);
+                            _descending = true;
+                        }
+                    }
+                }
+                return false;
+            }
+    };
+
     /***************************************************************************
         Generates all fences of k nodes.
     ***************************************************************************/
@@ -627,6 +793,32 @@ namespace percy
         }
     }
     
+    /***************************************************************************
+        Generates one of nr_ranges disjoint ranges of the fences of k nodes,
+        and puts them into a concurrent queue to be consumed by other
+        threads. Different threads can generate different ranges.
+    ***************************************************************************/
+    inline void
+    generate_fences(
+            spec& spec,
+            moodycamel::ConcurrentQueue<fence>& q,
+            int nr_ranges,
+            int range)
+    {
+        iter_fence_generator gen;
+        gen.set_range(nr_ranges, range);
+        fence f;
+
+        for (int l = 1; l <= spec.nr_steps; l++) {
+            gen.reset(spec.nr_steps, l, spec.get_nr_out(), spec.fanin);
+            while (gen.next_fence(f)) {
+                while (!q.try_enqueue(f)) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
     /***************************************************************************
         Generates all fences of k nodes and puts them into a concurrent queue
         to be consumed by other threads.
@@ -634,14 +826,27 @@ namespace percy
     inline void
     generate_fences(spec& spec, moodycamel::ConcurrentQueue<fence>& q)
     {
-        rec_fence_generator gen;
+        generate_fences(spec, q, 1, 0);
+    }
+    
+    /***************************************************************************
+        Same as above, but appends the fences to a vector, e.g. so that they
+        can be reordered before they are consumed.
+    ***************************************************************************/
+    inline void
+    generate_fences(spec& spec, std::vector<fence>& fences)
+    {
+        iter_fence_generator gen;
+        fence f;
 
         for (int l = 1; l <= spec.nr_steps; l++) {
             gen.reset(spec.nr_steps, l, spec.get_nr_out(), spec.fanin);
-            gen.generate_fences(q);
+            while (gen.next_fence(f)) {
+                fences.push_back(f);
+            }
         }
     }
-    
+
     inline void print_fence(const fence& f)
     {
         for (int i = f.nr_levels()-1; i >= 0; i--) {
@@ -29,6 +29,8 @@
   \author Winston Haaswijk
 */
 
+#pragma once
+
 #include <percy/partial_dag.hpp>
 
 namespace percy
@@ -59,6 +61,43 @@ private:
     // Function to call when a solution is found.
     std::function<void(partial_dag3_generator*)> _callback;
 
+    // Sharding of the search space. The subtrees rooted at the split
+    // level are numbered in the order in which they are visited. Only
+    // those whose index is congruent to the shard modulo the number of
+    // shards, and that do not precede the first subtree, are searched.
+    int _split_level = -1;
+    int _nr_shards = 1;
+    int _shard = 0;
+    uint64_t _first_subtree = 0;
+    uint64_t _nr_subtrees = 0;
+
+    // Function to call when the search enters a subtree of this shard.
+    std::function<void(partial_dag3_generator*, uint64_t)> _subtree_callback;
+
+    // Set while the search is in a subtree of another shard.
+    bool _skip_solutions = false;
+
+    /// Updates whether the solutions in the subtree that starts at the
+    /// current level belong to another shard, or have been found before.
+    /// Unlike the fanin 2 generator, the disabled matrix is not restored
+    /// exactly when backtracking, so the subtrees of other shards are
+    /// still traversed (but not reported) to keep the search identical to
+    /// an unsharded one. The expensive per-solution work, such as
+    /// isomorphism checking, is still divided among the shards.
+    void skip_subtree()
+    {
+        if (_split_level == -1 ||
+                _level != std::min(_split_level, _nr_vertices)) {
+            return;
+        }
+        const auto subtree = _nr_subtrees++;
+        _skip_solutions = subtree < _first_subtree ||
+            subtree % _nr_shards != static_cast<uint64_t>(_shard);
+        if (!_skip_solutions && _subtree_callback) {
+            _subtree_callback(this, subtree);
+        }
+    }
+
 public:
     partial_dag3_generator() : _initialized(false) { }
 
@@ -97,6 +136,35 @@ public:
         _callback = 0;
     }
 
+    /// Restricts the (default) GEN_NOREAPPLY search to one shard of the
+    /// search space, which is split at the given level (or at the last
+    /// level, if the DAGs have fewer vertices). Shards may be
+    /// searched independently, e.g. by different processes. Subtrees
+    /// with an index smaller than first_subtree are skipped, so that an
+    /// interrupted search can be resumed.
+    void set_shard(
+        int split_level,
+        int nr_shards,
+        int shard,
+        uint64_t first_subtree = 0)
+    {
+        assert(split_level >= 1);
+        assert(nr_shards > 0 && shard >= 0 && shard < nr_shards);
+        _split_level = split_level;
+        _nr_shards = nr_shards;
+        _shard = shard;
+        _first_subtree = first_subtree;
+    }
+
+    void set_subtree_callback(std::function<void(partial_dag3_generator*, uint64_t)>&& f)
+    {
+        _subtree_callback = std::move(f);
+    }
+
+    /// The number of subtrees at the split level visited so far, by
+    /// any shard.
+    uint64_t nr_subtrees() const { return _nr_subtrees; }
+
     void reset(int nr_vertices)
     {
         assert(nr_vertices > 0);
@@ -354,6 +422,8 @@ public:
         assert(_initialized);
         _nr_solutions = 0;
         _level = 1;
+        _nr_subtrees = 0;
+        _skip_solutions = false;
 
         search_noreapply_dags();
 
@@ -362,6 +432,7 @@ public:
 
     void search_noreapply_dags()
     {
+        skip_subtree();
         if (_level == _nr_vertices) {
             for (int i = 1; i <= _nr_vertices - 1; i++) {
                 if (_covered_steps[i] == 0) {
@@ -371,6 +442,10 @@ public:
                     return;
                 }
             }
+            if (_skip_solutions) {
+                noreapply_backtrack();
+                return;
+            }
             ++_nr_solutions;
             if (_verbosity) {
                 printf("Found solution: ");
@@ -29,6 +29,8 @@
   \author Winston Haaswijk
 */
 
+#pragma once
+
 #include <percy/partial_dag.hpp>
 
 namespace percy
@@ -59,6 +61,38 @@ private:
     // Function to call when a solution is found.
     std::function<void(partial_dag_generator*)> _callback;
 
+    // Sharding of the search space. The subtrees rooted at the split
+    // level are numbered in the order in which they are visited. Only
+    // those whose index is congruent to the shard modulo the number of
+    // shards, and that do not precede the first subtree, are searched.
+    int _split_level = -1;
+    int _nr_shards = 1;
+    int _shard = 0;
+    uint64_t _first_subtree = 0;
+    uint64_t _nr_subtrees = 0;
+
+    // Function to call when the search enters a subtree of this shard.
+    std::function<void(partial_dag_generator*, uint64_t)> _subtree_callback;
+
+    /// Returns true if the subtree that starts at the current level
+    /// belongs to another shard, or has been searched before.
+    bool skip_subtree()
+    {
+        if (_split_level == -1 ||
+                _level != std::min(_split_level, _nr_vertices)) {
+            return false;
+        }
+        const auto subtree = _nr_subtrees++;
+        if (subtree < _first_subtree ||
+                subtree % _nr_shards != static_cast<uint64_t>(_shard)) {
+            return true;
+        }
+        if (_subtree_callback) {
+            _subtree_callback(this, subtree);
+        }
+        return false;
+    }
+
 public:
     partial_dag_generator() : _initialized(false) { }
 
@@ -97,6 +131,35 @@ public:
         _callback = 0;
     }
 
+    /// Restricts the (default) GEN_NOREAPPLY search to one shard of the
+    /// search space, which is split at the given level (or at the last
+    /// level, if the DAGs have fewer vertices). Shards may be
+    /// searched independently, e.g. by different processes. Subtrees
+    /// with an index smaller than first_subtree are skipped, so that an
+    /// interrupted search can be resumed.
+    void set_shard(
+        int split_level,
+        int nr_shards,
+        int shard,
+        uint64_t first_subtree = 0)
+    {
+        assert(split_level >= 1);
+        assert(nr_shards > 0 && shard >= 0 && shard < nr_shards);
+        _split_level = split_level;
+        _nr_shards = nr_shards;
+        _shard = shard;
+        _first_subtree = first_subtree;
+    }
+
+    void set_subtree_callback(std::function<void(partial_dag_generator*, uint64_t)>&& f)
+    {
+        _subtree_callback = std::move(f);
+    }
+
+    /// The number of subtrees at the split level visited so far, by
+    /// any shard.
+    uint64_t nr_subtrees() const { return _nr_subtrees; }
+
     void reset(int nr_vertices)
     {
         assert(nr_vertices > 0);
@@ -313,6 +376,7 @@ public:
         assert(_initialized);
         _nr_solutions = 0;
         _level = 1;
+        _nr_subtrees = 0;
 
         search_noreapply_dags();
 
@@ -321,6 +385,10 @@ public:
 
     void search_noreapply_dags()
     {
+        if (skip_subtree()) {
+            noreapply_backtrack();
+            return;
+        }
         if (_level == _nr_vertices) {
             for (int i = 1; i <= _nr_vertices - 1; i++) {
                 if (_covered_steps[i] == 0) {
@@ -0,0 +1,378 @@
+/*!
+  \file partial_dag_shards.hpp
+  \brief Sharded, resumable generation of partial DAG databases
+
+  Generating the non-isomorphic partial DAGs of larger sizes (e.g. nine
+  or more vertices with fanin 2, or the fanin 3 DAGs used for majority
+  synthesis) takes a long time. The functions in this file split the
+  search space of a generator into shards, which can be generated by
+  independent processes, and merge the results into a single database
+  in the format written by write_partial_dags.
+
+  Every shard writes two files:
+    - <base>.shard-<s>-of-<S>.bin: the DAGs found by the shard
+    - <base>.shard-<s>-of-<S>.idx: a checkpoint index
+
+  The index starts with a header line that records the generation
+  parameters. Each time the shard enters a new subtree of the search
+  space, a line "<subtree> <nr_dags>" is appended, where nr_dags is the
+  number of DAGs written before the subtree was entered. When the shard
+  completes, a line "done <nr_dags>" is appended. An interrupted shard
+  resumes at the last subtree it entered.
+*/
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <percy/partial_dag.hpp>
+#include "partial_dag_generator.hpp"
+#include "partial_dag3_generator.hpp"
+
+namespace percy
+{
+
+struct pd_shard_entry
+{
+    uint64_t subtree;
+    uint64_t begin; /// Index of the first DAG of the subtree in the shard
+    uint64_t end; /// One past the index of the last DAG of the subtree
+};
+
+struct pd_shard_index
+{
+    int fanin = 0;
+    int nr_vertices = 0;
+    int split_level = 0;
+    int nr_shards = 0;
+    int shard = 0;
+    int nr_in = -1;
+    bool done = false;
+    uint64_t nr_dags = 0; /// Nr. of DAGs in a completed shard
+    std::vector<pd_shard_entry> entries;
+};
+
+inline std::string
+pd_shard_filename(const char* const base, int shard, int nr_shards, const char* const ext)
+{
+    return std::string(base) + ".shard-" + std::to_string(shard) + "-of-" +
+        std::to_string(nr_shards) + ext;
+}
+
+/// Reads the index of a shard. Lines that were not completely written
+/// are ignored. Returns false if the index does not exist or has an
+/// invalid header.
+inline bool read_pd_shard_index(const char* const filename, pd_shard_index& index)
+{
+    auto fhandle = fopen(filename, "r");
+    if (fhandle == NULL) {
+        return false;
+    }
+
+    char line[128];
+    if (fgets(line, sizeof(line), fhandle) == NULL ||
+            sscanf(line, "pd-shard %d %d %d %d %d %d", &index.fanin,
+                &index.nr_vertices, &index.split_level, &index.nr_shards,
+                &index.shard, &index.nr_in) != 6) {
+        fclose(fhandle);
+        return false;
+    }
+
+    index.done = false;
+    index.entries.clear();
+    while (fgets(line, sizeof(line), fhandle) != NULL) {
+        if (line[strlen(line) - 1] != '\n') {
+            break;
+        }
+        unsigned long subtree, nr_dags;
+        if (sscanf(line, "done %lu", &nr_dags) == 1) {
+            index.done = true;
+            index.nr_dags = nr_dags;
+            break;
+        } else if (sscanf(line, "%lu %lu", &subtree, &nr_dags) == 2) {
+            if (!index.entries.empty()) {
+                index.entries.back().end = nr_dags;
+            }
+            index.entries.push_back({ subtree, nr_dags, nr_dags });
+        } else {
+            break;
+        }
+    }
+    if (index.done && !index.entries.empty()) {
+        index.entries.back().end = index.nr_dags;
+    }
+    fclose(fhandle);
+
+    return true;
+}
+
+inline void set_pd_vertices(partial_dag& g, const partial_dag_generator* gen)
+{
+    for (int i = 0; i < gen->nr_vertices(); i++) {
+        g.set_vertex(i, gen->_js[i], gen->_ks[i]);
+    }
+}
+
+inline void set_pd_vertices(partial_dag& g, const partial_dag3_generator* gen)
+{
+    for (int i = 0; i < gen->nr_vertices(); i++) {
+        g.set_vertex(i, gen->_js[i], gen->_ks[i], gen->_ls[i]);
+    }
+}
+
+template<typename Generator>
+bool pd_write_shard_impl(
+    int fanin,
+    int nr_vertices,
+    int split_level,
+    int nr_shards,
+    int shard,
+    const char* const base,
+    int nr_in)
+{
+    const auto data_filename = pd_shard_filename(base, shard, nr_shards, ".bin");
+    const auto idx_filename = pd_shard_filename(base, shard, nr_shards, ".idx");
+
+    // Recover the DAGs written before the shard was interrupted, up to the
+    // last subtree it entered. That subtree is searched again.
+    std::vector<partial_dag> dags;
+    uint64_t first_subtree = 0;
+    pd_shard_index index;
+    if (read_pd_shard_index(idx_filename.c_str(), index)) {
+        if (index.fanin != fanin || index.nr_vertices != nr_vertices ||
+                index.split_level != split_level ||
+                index.nr_shards != nr_shards || index.shard != shard ||
+                index.nr_in != nr_in) {
+            fprintf(stderr, "Error: shard index %s does not match "
+                    "the generation parameters\n", idx_filename.c_str());
+            return false;
+        }
+        if (index.done) {
+            return true;
+        }
+        if (!index.entries.empty()) {
+            const auto& last = index.entries.back();
+            first_subtree = last.subtree;
+            auto fhandle = fopen(data_filename.c_str(), "rb");
+            if (fhandle == NULL) {
+                fprintf(stderr, "Error: unable to open shard file %s\n",
+                        data_filename.c_str());
+                return false;
+            }
+            partial_dag g;
+            while (dags.size() < last.begin &&
+                    read_partial_dag(g, fanin, fhandle)) {
+                dags.push_back(g);
+            }
+            fclose(fhandle);
+            if (dags.size() < last.begin) {
+                fprintf(stderr, "Error: shard file %s is truncated\n",
+                        data_filename.c_str());
+                return false;
+            }
+            index.entries.pop_back();
+        }
+    } else {
+        index.entries.clear();
+    }
+
+    auto data_fhandle = fopen(data_filename.c_str(), "wb");
+    auto idx_fhandle = fopen(idx_filename.c_str(), "w");
+    if (data_fhandle == NULL || idx_fhandle == NULL) {
+        fprintf(stderr, "Error: unable to open shard files for %s\n", base);
+        if (data_fhandle != NULL) {
+            fclose(data_fhandle);
+        }
+        if (idx_fhandle != NULL) {
+            fclose(idx_fhandle);
+        }
+        return false;
+    }
+    fprintf(idx_fhandle, "pd-shard %d %d %d %d %d %d\n", fanin, nr_vertices,
+            split_level, nr_shards, shard, nr_in);
+    for (const auto& entry : index.entries) {
+        fprintf(idx_fhandle, "%lu %lu\n",
+                (unsigned long)entry.subtree, (unsigned long)entry.begin);
+    }
+    for (const auto& dag : dags) {
+        write_partial_dag(dag, data_fhandle);
+    }
+    fflush(data_fhandle);
+    fflush(idx_fhandle);
+
+    uint64_t nr_dags = dags.size();
+    partial_dag g;
+    Generator gen;
+
+#ifndef DISABLE_NAUTY
+    std::set<std::vector<graph>> can_reprs;
+    pd_iso_checker checker(nr_vertices);
+    for (const auto& dag : dags) {
+        can_reprs.insert(checker.crepr(dag));
+    }
+    dags.clear();
+
+    gen.set_callback([&g, data_fhandle, &can_reprs, &checker, nr_in, &nr_dags]
+    (Generator* gen) {
+        set_pd_vertices(g, gen);
+        const auto res = can_reprs.insert(checker.crepr(g));
+        if (res.second && (nr_in == -1 || g.nr_pi_fanins() >= nr_in)) {
+            write_partial_dag(g, data_fhandle);
+            ++nr_dags;
+        }
+    });
+#else
+    dags.clear();
+    gen.set_callback([&g, data_fhandle, nr_in, &nr_dags]
+    (Generator* gen) {
+        set_pd_vertices(g, gen);
+        if (nr_in == -1 || g.nr_pi_fanins() >= nr_in) {
+            write_partial_dag(g, data_fhandle);
+            ++nr_dags;
+        }
+    });
+#endif
+    // Make sure that everything found up to this subtree is on disk
+    // before recording that the subtree has been entered.
+    gen.set_subtree_callback([data_fhandle, idx_fhandle, &nr_dags]
+    (Generator*, uint64_t subtree) {
+        fflush(data_fhandle);
+        fprintf(idx_fhandle, "%lu %lu\n",
+                (unsigned long)subtree, (unsigned long)nr_dags);
+        fflush(idx_fhandle);
+    });
+
+    g.reset(fanin, nr_vertices);
+    gen.reset(nr_vertices);
+    gen.set_shard(split_level, nr_shards, shard, first_subtree);
+    gen.count_dags();
+
+    fclose(data_fhandle);
+    fprintf(idx_fhandle, "done %lu\n", (unsigned long)nr_dags);
+    fclose(idx_fhandle);
+
+    return true;
+}
+
+/// Generates one shard of the non-isomorphic partial DAGs with the given
+/// number of vertices and fanin size (2 or 3). The search space is split
+/// into subtrees at split_level, which are assigned to the shards in a
+/// round-robin fashion. A larger split level yields more and smaller
+/// subtrees, which balances the shards better and loses less work when a
+/// shard is interrupted. If the shard has been (partially) generated
+/// before with the same parameters, generation resumes where it stopped.
+/// If nr_in is not -1, only DAGs with at least nr_in PI fanins are kept.
+inline bool pd_write_shard(
+    int fanin,
+    int nr_vertices,
+    int split_level,
+    int nr_shards,
+    int shard,
+    const char* const base,
+    int nr_in = -1)
+{
+    if (fanin == 2) {
+        return pd_write_shard_impl<partial_dag_generator>(
+            fanin, nr_vertices, split_level, nr_shards, shard, base, nr_in);
+    } else if (fanin == 3) {
+        return pd_write_shard_impl<partial_dag3_generator>(
+            fanin, nr_vertices, split_level, nr_shards, shard, base, nr_in);
+    }
+    fprintf(stderr, "Error: unsupported fanin size %d\n", fanin);
+    return false;
+}
+
+/// Merges the completed shards with the given base filename into a
+/// single file. DAGs are written in the order in which they are found by
+/// an unsharded search, and isomorphic DAGs found by different shards are
+/// removed. The result is therefore identical to that of
+/// pd_write_nonisomorphic and pd3_write_nonisomorphic.
+inline bool pd_merge_shards(
+    const char* const base,
+    int nr_shards,
+    const char* const filename)
+{
+    struct range
+    {
+        pd_shard_entry entry;
+        int shard;
+    };
+
+    std::vector<std::vector<partial_dag>> shard_dags(nr_shards);
+    std::vector<range> ranges;
+    pd_shard_index first_index;
+    for (int shard = 0; shard < nr_shards; shard++) {
+        const auto idx_filename =
+            pd_shard_filename(base, shard, nr_shards, ".idx");
+        pd_shard_index index;
+        if (!read_pd_shard_index(idx_filename.c_str(), index) || !index.done) {
+            fprintf(stderr, "Error: shard %d of %s is not complete\n",
+                    shard, base);
+            return false;
+        }
+        if (shard == 0) {
+            first_index = index;
+        } else if (index.fanin != first_index.fanin ||
+                index.nr_vertices != first_index.nr_vertices ||
+                index.split_level != first_index.split_level ||
+                index.nr_in != first_index.nr_in) {
+            fprintf(stderr, "Error: shards of %s were generated with "
+                    "different parameters\n", base);
+            return false;
+        }
+
+        const auto data_filename =
+            pd_shard_filename(base, shard, nr_shards, ".bin");
+        auto fhandle = fopen(data_filename.c_str(), "rb");
+        if (fhandle == NULL) {
+            fprintf(stderr, "Error: unable to open shard file %s\n",
+                    data_filename.c_str());
+            return false;
+        }
+        partial_dag g;
+        while (read_partial_dag(g, index.fanin, fhandle)) {
+            shard_dags[shard].push_back(g);
+        }
+        fclose(fhandle);
+        if (shard_dags[shard].size() != index.nr_dags) {
+            fprintf(stderr, "Error: shard file %s is truncated\n",
+                    data_filename.c_str());
+            return false;
+        }
+        for (const auto& entry : index.entries) {
+            ranges.push_back({ entry, shard });
+        }
+    }
+    std::sort(ranges.begin(), ranges.end(),
+        [] (const range& r1, const range& r2) {
+            return r1.entry.subtree < r2.entry.subtree;
+        });
+
+    auto fhandle = fopen(filename, "wb");
+    if (fhandle == NULL) {
+        fprintf(stderr, "Error: unable to open output file\n");
+        return false;
+    }
+#ifndef DISABLE_NAUTY
+    std::set<std::vector<graph>> can_reprs;
+    pd_iso_checker checker(first_index.nr_vertices);
+#endif
+    for (const auto& r : ranges) {
+        for (auto i = r.entry.begin; i < r.entry.end; i++) {
+            const auto& dag = shard_dags[r.shard][i];
+#ifndef DISABLE_NAUTY
+            if (!can_reprs.insert(checker.crepr(dag)).second) {
+                continue;
+            }
+#endif
+            write_partial_dag(dag, fhandle);
+        }
+    }
+    fclose(fhandle);
+
+    return true;
+}
+
+}
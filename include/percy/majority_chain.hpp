@@ -33,6 +33,7 @@
 
 #pragma once
 #include <array>
+#include "tt_utils.hpp"
 
 namespace percy
 {
@@ -149,22 +150,9 @@ public:
         }
       }
 
-      kitty::clear( step_tt );
-      switch ( operators[i] )
-      {
-      case 0:
-        step_tt = kitty::ternary_majority(  child_tts.at( 0 ),  child_tts.at( 1 ),  child_tts.at( 2 ) );
-        break;
-      case 1:
-        step_tt = kitty::ternary_majority( ~child_tts.at( 0 ),  child_tts.at( 1 ),  child_tts.at( 2 ) );
-        break;
-      case 2:
-        step_tt = kitty::ternary_majority(  child_tts.at( 0 ), ~child_tts.at( 1 ),  child_tts.at( 2 ) );
-        break;
-      case 3:
-        step_tt = kitty::ternary_majority(  child_tts.at( 0 ),  child_tts.at( 1 ), ~child_tts.at( 2 ) );
-        break;
-      }
+      /* operators 1-3 complement the corresponding child */
+      ternary_majority_into( child_tts.at( 0 ), child_tts.at( 1 ), child_tts.at( 2 ), step_tt,
+                             operators[i] == 1, operators[i] == 2, operators[i] == 3 );
 
       step_tts[i] = step_tt;
 
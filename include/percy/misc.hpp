@@ -118,6 +118,20 @@ namespace percy
         return 0;
     }
 
+    inline int lex_compare(const int* const fanins1, const int* const fanins2, int fanin)
+    {
+        for (int i = 0; i < fanin; i++) {
+            if (fanins1[i] < fanins2[i]) {
+                return -1;
+            } else if (fanins1[i] > fanins2[i]) {
+                return 1;
+            }
+        }
+
+        // All fanins are equal
+        return 0;
+    }
+
     inline int lex_compare(const std::vector<int>& fanins1, const std::vector<int>& fanins2)
     {
         assert(fanins1.size() == fanins2.size());
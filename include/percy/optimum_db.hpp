@@ -0,0 +1,410 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "chain.hpp"
+#include "partial_dag.hpp"
+#include "enum_synthesis.hpp"
+#include "generators/partial_dag_generator.hpp"
+
+/*******************************************************************************
+    Builds tables of optimum fanin 2 chains without a SAT solver. Instead
+    of synthesizing one function at a time, the builder goes over the
+    non-isomorphic partial DAGs of increasing size. For each DAG it
+    enumerates the assignments of inputs to the PI fanins and of normal
+    operators to the vertices, and simulates the resulting chains on
+    64-bit truth tables. Every function is recorded with the first,
+    hence smallest, DAG that computes it.
+
+    The enumeration is reduced in two ways. Inputs are assigned to the PI
+    fanins up to a permutation of the inputs, i.e. each fanin gets an input
+    that is already used or the next unused one, and the functions found
+    are recorded together with all their permutations and complements.
+    Chains in which a step computes a constant, an input or the same
+    function as another step, or its complement, are skipped, since the
+    function of such a chain has a smaller one.
+*******************************************************************************/
+namespace percy
+{
+    /// The maximum number of inputs of the functions in an optimum_db.
+    const int OPTDB_MAX_IN = 6;
+    /// The maximum size of the chains in an optimum_db.
+    const int OPTDB_MAX_STEPS = 10;
+
+    /// An optimum chain, given by the partial DAG it is derived from.
+    struct optimum_db_entry
+    {
+        uint8_t nr_steps;
+        uint8_t out_inv;
+        uint32_t dag_idx; ///< Index of the DAG among those with nr_steps vertices
+        uint32_t ops; ///< Normal operator of each step, three bits per step
+        uint8_t pis[2 * OPTDB_MAX_STEPS]; ///< Inputs of the PI fanins, in order
+    };
+
+    class optimum_db
+    {
+    private:
+        int nr_in;
+        uint64_t tt_mask;
+        std::unordered_map<uint64_t, optimum_db_entry> table;
+        std::vector<std::vector<partial_dag>> dags; ///< Indexed by size
+        int max_steps = 0;
+
+        /// If the table can become complete, the functions found in the
+        /// current round are tracked, so that the round stops as soon as
+        /// all missing functions are found.
+        bool track_round;
+        uint64_t nr_missing;
+        std::unordered_set<uint64_t> round_found;
+        std::mutex round_mutex;
+        std::atomic<bool> round_done;
+
+        /// The state of a search through one partial DAG.
+        struct search_state
+        {
+            const partial_dag* dag;
+            uint32_t dag_idx;
+            uint64_t tts[OPTDB_MAX_IN + OPTDB_MAX_STEPS];
+            uint8_t pis[2 * OPTDB_MAX_STEPS];
+            int nr_pis;
+            uint32_t ops;
+            std::unordered_set<uint64_t> found;
+            std::vector<optimum_db_entry> entries;
+        };
+
+        uint64_t simulate_entry(const optimum_db_entry& e, const uint8_t* pis) const
+        {
+            const auto& dag = dags[e.nr_steps][e.dag_idx];
+            uint64_t tts[OPTDB_MAX_STEPS];
+            auto pi_idx = 0;
+            for (int i = 0; i < e.nr_steps; i++) {
+                const auto v = dag.get_vertex(i);
+                uint64_t in[2];
+                for (int j = 0; j < 2; j++) {
+                    in[j] = v[j] == FANIN_PI ?
+                        tts_var(pis[pi_idx++]) : tts[v[j] - 1];
+                }
+                tts[i] = enum_apply_op((e.ops >> (3 * i)) & 7, in[0], in[1]) & tt_mask;
+            }
+            return tts[e.nr_steps - 1];
+        }
+
+        uint64_t tts_var(int i) const
+        {
+            static const uint64_t vars[OPTDB_MAX_IN] = {
+                0xaaaaaaaaaaaaaaaa, 0xcccccccccccccccc, 0xf0f0f0f0f0f0f0f0,
+                0xff00ff00ff00ff00, 0xffff0000ffff0000, 0xffffffff00000000
+            };
+            return vars[i] & tt_mask;
+        }
+
+        bool is_redundant(const search_state& s, int i, uint64_t tt) const
+        {
+            if (tt == 0 || tt == tt_mask) {
+                return true;
+            }
+            for (int j = 0; j < nr_in + i; j++) {
+                if (s.tts[j] == tt || (s.tts[j] ^ tt_mask) == tt) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Enumerates the inputs and operators of vertex i and above.
+        /// Inputs up to max_pi have been used by the lower vertices.
+        void search(search_state& s, int i, int max_pi)
+        {
+            if (round_done) {
+                return;
+            }
+            const auto v = s.dag->get_vertex(i);
+            if (v[0] == FANIN_PI && v[1] == FANIN_PI) {
+                // Both fanins are inputs. Since the operators are closed
+                // under swapping their fanins, the first one is smaller.
+                for (int a = 0; a <= std::min(max_pi + 1, nr_in - 1); a++) {
+                    const auto max_b = std::min(std::max(max_pi, a) + 1, nr_in - 1);
+                    for (int b = a + 1; b <= max_b; b++) {
+                        s.pis[s.nr_pis] = a;
+                        s.pis[s.nr_pis + 1] = b;
+                        s.nr_pis += 2;
+                        search_ops(s, i, s.tts[a], s.tts[b], std::max(max_pi, b));
+                        s.nr_pis -= 2;
+                    }
+                }
+            } else if (v[0] == FANIN_PI) {
+                const auto b = s.tts[nr_in + v[1] - 1];
+                for (int a = 0; a <= std::min(max_pi + 1, nr_in - 1); a++) {
+                    s.pis[s.nr_pis++] = a;
+                    search_ops(s, i, s.tts[a], b, std::max(max_pi, a));
+                    s.nr_pis--;
+                }
+            } else {
+                search_ops(s, i, s.tts[nr_in + v[0] - 1],
+                        s.tts[nr_in + v[1] - 1], max_pi);
+            }
+        }
+
+        void search_ops(search_state& s, int i, uint64_t a, uint64_t b, int max_pi)
+        {
+            const auto nr_steps = s.dag->nr_vertices();
+            for (int op = 0; op < ENUM_NR_OPS; op++) {
+                const auto tt = enum_apply_op(op, a, b) & tt_mask;
+                if (is_redundant(s, i, tt)) {
+                    continue;
+                }
+                s.ops = (s.ops & ~(7u << (3 * i))) | (uint32_t(op) << (3 * i));
+                if (i + 1 < nr_steps) {
+                    s.tts[nr_in + i] = tt;
+                    search(s, i + 1, max_pi);
+                    continue;
+                }
+                if (table.count(tt) || !s.found.insert(tt).second) {
+                    continue;
+                }
+                optimum_db_entry e;
+                e.nr_steps = nr_steps;
+                e.out_inv = 0;
+                e.dag_idx = s.dag_idx;
+                e.ops = s.ops;
+                std::copy(s.pis, s.pis + s.nr_pis, e.pis);
+                s.entries.push_back(e);
+                if (track_round) {
+                    track(e, tt);
+                }
+            }
+        }
+
+        /// Calls fn(tt, entry) for the chains obtained from a chain found
+        /// by the search, for all permutations of the inputs and for its
+        /// complement.
+        template<typename Fn>
+        void foreach_variant(const optimum_db_entry& e, Fn&& fn) const
+        {
+            const auto nr_pis = dags[e.nr_steps][e.dag_idx].nr_pi_fanins();
+            int perm[OPTDB_MAX_IN];
+            for (int i = 0; i < nr_in; i++) {
+                perm[i] = i;
+            }
+            do {
+                auto pe = e;
+                for (int j = 0; j < nr_pis; j++) {
+                    pe.pis[j] = perm[e.pis[j]];
+                }
+                const auto tt = simulate_entry(pe, pe.pis);
+                fn(tt, pe);
+                pe.out_inv = 1;
+                fn(tt ^ tt_mask, pe);
+            } while (std::next_permutation(perm, perm + nr_in));
+        }
+
+        void record(const optimum_db_entry& e)
+        {
+            foreach_variant(e, [this](uint64_t tt, const optimum_db_entry& pe) {
+                table.emplace(tt, pe);
+            });
+        }
+
+        void track(const optimum_db_entry& e, uint64_t tt)
+        {
+            std::lock_guard<std::mutex> lock(round_mutex);
+            if (round_found.count(tt)) {
+                return;
+            }
+            foreach_variant(e, [this](uint64_t tt, const optimum_db_entry&) {
+                round_found.insert(tt);
+            });
+            if (round_found.size() == nr_missing) {
+                round_done = true;
+            }
+        }
+
+    public:
+        optimum_db(int nr_in) :
+            nr_in(nr_in), track_round(false), nr_missing(0), round_done(false)
+        {
+            assert(nr_in >= 1 && nr_in <= OPTDB_MAX_IN);
+            tt_mask = ~uint64_t(0) >> (64 - (1 << nr_in));
+            dags.resize(1);
+
+            optimum_db_entry e = {};
+            table.emplace(0, e);
+            e.out_inv = 1;
+            table.emplace(tt_mask, e);
+        }
+
+        int get_nr_in() const
+        {
+            return nr_in;
+        }
+
+        /// The number of functions with a known optimum chain.
+        std::size_t size() const
+        {
+            return table.size();
+        }
+
+        /// Returns true if all functions of nr_in inputs are known.
+        bool is_complete() const
+        {
+            return nr_in <= 4 && table.size() == (uint64_t(1) << (1 << nr_in));
+        }
+
+        /// The largest chain size that has been enumerated.
+        int get_max_steps() const
+        {
+            return max_steps;
+        }
+
+        /// Enumerates the chains of up to max_steps steps, using the given
+        /// number of threads. The partial DAGs of each size are distributed
+        /// over the threads. Chains that were enumerated by an earlier
+        /// call are not enumerated again. Returns the number of functions
+        /// that were added.
+        std::size_t build(int max_steps, int nr_threads = 1)
+        {
+            assert(max_steps <= OPTDB_MAX_STEPS);
+            assert(nr_threads >= 1);
+            const auto initial_size = table.size();
+            if (this->max_steps == 0) {
+                // Functions of size zero are projections.
+                for (int i = 0; i < nr_in; i++) {
+                    optimum_db_entry e = {};
+                    e.pis[0] = i;
+                    table.emplace(tts_var(i), e);
+                    e.out_inv = 1;
+                    table.emplace(tts_var(i) ^ tt_mask, e);
+                }
+            }
+
+            for (int k = this->max_steps + 1; k <= max_steps && !is_complete(); k++) {
+#ifndef DISABLE_NAUTY
+                dags.push_back(pd_generate_nonisomorphic(k));
+#else
+                dags.push_back(pd_generate(k));
+#endif
+                const auto& k_dags = dags[k];
+                track_round = nr_in <= 4;
+                if (track_round) {
+                    nr_missing = (uint64_t(1) << (1 << nr_in)) - table.size();
+                }
+                round_found.clear();
+                round_done = false;
+                std::atomic<std::size_t> next_dag(0);
+                std::vector<std::vector<optimum_db_entry>> entries(nr_threads);
+                std::vector<std::thread> threads;
+                for (int t = 0; t < nr_threads; t++) {
+                    threads.emplace_back([this, t, &k_dags, &next_dag, &entries] {
+                        search_state s;
+                        for (int i = 0; i < nr_in; i++) {
+                            s.tts[i] = tts_var(i);
+                        }
+                        while (!round_done) {
+                            const auto dag_idx = next_dag++;
+                            if (dag_idx >= k_dags.size()) {
+                                break;
+                            }
+                            s.dag = &k_dags[dag_idx];
+                            s.dag_idx = uint32_t(dag_idx);
+                            s.nr_pis = 0;
+                            s.ops = 0;
+                            search(s, 0, -1);
+                        }
+                        entries[t] = std::move(s.entries);
+                    });
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+
+                // Record the chains in the order of their DAGs, so that
+                // the table does not depend on the scheduling, unless the
+                // round stopped early.
+                std::vector<optimum_db_entry> all;
+                for (auto& es : entries) {
+                    all.insert(all.end(), es.begin(), es.end());
+                }
+                std::stable_sort(all.begin(), all.end(),
+                        [](const optimum_db_entry& a, const optimum_db_entry& b) {
+                    return a.dag_idx < b.dag_idx;
+                });
+                for (const auto& e : all) {
+                    record(e);
+                }
+                this->max_steps = k;
+            }
+            return table.size() - initial_size;
+        }
+
+        /// Returns the optimum number of steps of a function, or -1 if
+        /// it has no chain of up to get_max_steps() steps.
+        int get_nr_steps(const kitty::dynamic_truth_table& tt) const
+        {
+            assert(tt.num_vars() == nr_in);
+            const auto it = table.find(*tt.cbegin() & tt_mask);
+            return it == table.end() ? -1 : it->second.nr_steps;
+        }
+
+        /// Gets an optimum chain for a function. Returns false if it has
+        /// no chain of up to get_max_steps() steps.
+        bool get_chain(const kitty::dynamic_truth_table& tt, chain& c) const
+        {
+            assert(tt.num_vars() == nr_in);
+            const auto it = table.find(*tt.cbegin() & tt_mask);
+            if (it == table.end()) {
+                return false;
+            }
+            const auto& e = it->second;
+            c.reset(nr_in, 1, e.nr_steps, 2);
+            if (e.nr_steps == 0) {
+                const auto is_const = (*tt.cbegin() & tt_mask) == 0 ||
+                    (*tt.cbegin() & tt_mask) == tt_mask;
+                c.set_output(0, is_const ? 0 : e.pis[0] + 1, e.out_inv);
+                return true;
+            }
+
+            const auto& dag = dags[e.nr_steps][e.dag_idx];
+            kitty::dynamic_truth_table op(2);
+            auto pi_idx = 0;
+            for (int i = 0; i < e.nr_steps; i++) {
+                const auto v = dag.get_vertex(i);
+                int fanins[2];
+                for (int j = 0; j < 2; j++) {
+                    fanins[j] = v[j] == FANIN_PI ?
+                        e.pis[pi_idx++] : nr_in + v[j] - 1;
+                }
+                *op.begin() = enum_op_word((e.ops >> (3 * i)) & 7);
+                c.set_step(i, fanins[0], fanins[1], op);
+            }
+            c.set_output(0, nr_in + e.nr_steps, e.out_inv);
+            return true;
+        }
+
+        /// Calls fn(tt, nr_steps) for every known function, where tt holds
+        /// the truth table in its lowest 2^nr_in bits.
+        template<typename Fn>
+        void foreach_function(Fn&& fn) const
+        {
+            for (const auto& kv : table) {
+                fn(kv.first, int(kv.second.nr_steps));
+            }
+        }
+
+        /// Counts the known functions by their optimum number of steps.
+        std::vector<uint64_t> get_distribution() const
+        {
+            std::vector<uint64_t> counts(max_steps + 1, 0);
+            for (const auto& kv : table) {
+                counts[kv.second.nr_steps]++;
+            }
+            return counts;
+        }
+    };
+}
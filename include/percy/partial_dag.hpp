@@ -6,7 +6,9 @@
 #include <vector>
 #include <ostream>
 #include <set>
-#include "tt_utils.hpp"
+#include <cstring>
+#include <type_traits>
+#include "spec.hpp"
 
 namespace percy
 {
@@ -15,45 +17,63 @@ namespace percy
     /// be connected to any one of the PIs.
     const int FANIN_PI = 0;
 
-    class partial_dag
+    /// The maximum in-degree of partial DAG vertices.
+    const int PD_MAX_FANIN = 3;
+
+    /// A lightweight read-only view of the fanins of a partial DAG vertex.
+    /// It refers to the storage of the DAG it was obtained from, so it must
+    /// not outlive that DAG.
+    class pd_vertex
     {
         private:
-            int fanin; /// The in-degree of vertices in the DAG
-            std::vector<std::vector<int>> vertices;
+            const uint8_t* _fanins;
+            int _size;
 
         public:
-            partial_dag() : fanin(0) { }
+            pd_vertex(const uint8_t* fanins, int size) :
+                _fanins(fanins), _size(size) { }
 
-            partial_dag(int fanin, int nr_vertices = 0)
-            {
-                reset(fanin, nr_vertices);
-            }
+            int operator[](int i) const { return _fanins[i]; }
 
-            partial_dag(const partial_dag& dag)
+            int at(int i) const
             {
-                fanin = dag.fanin;
-                vertices = dag.vertices;
+                assert(i < _size);
+                return _fanins[i];
             }
 
-            partial_dag& operator=(const partial_dag& dag)
+            int size() const { return _size; }
+            const uint8_t* begin() const { return _fanins; }
+            const uint8_t* end() const { return _fanins + _size; }
+    };
+
+    /// Partial DAGs are stored in a flat, fixed-capacity array of byte-sized
+    /// fanin entries. This makes them trivially copyable, so that moving them
+    /// through the concurrent queues of the parallel synthesizers amounts to
+    /// a single memcpy, without any heap allocations.
+    class partial_dag
+    {
+        private:
+            uint8_t fanin; /// The in-degree of vertices in the DAG
+            uint8_t _nr_vertices;
+            uint8_t vertices[MAX_STEPS][PD_MAX_FANIN];
+
+        public:
+            partial_dag()
             {
-                fanin = dag.fanin;
-                vertices = dag.vertices;
-                return *this;
+                reset(0, 0);
             }
 
-            partial_dag(partial_dag&& dag)
+            partial_dag(int fanin, int nr_vertices = 0)
             {
-                fanin = dag.fanin;
-                vertices = std::move(dag.vertices);
+                reset(fanin, nr_vertices);
             }
 
-            int nr_pi_fanins()
+            int nr_pi_fanins() const
             {
                 int count = 0;
-                for (const auto& v : vertices) {
-                    for (auto fanin : v) {
-                        if (fanin == FANIN_PI) {
+                for (int i = 0; i < _nr_vertices; i++) {
+                    for (int j = 0; j < fanin; j++) {
+                        if (vertices[i][j] == FANIN_PI) {
                             count++;
                         }
                     }
@@ -66,13 +86,13 @@ namespace percy
             foreach_vertex(Fn&& fn) const
             {
                 for (int i = 0; i < nr_vertices(); i++) {
-                    fn(vertices[i], i);
+                    fn(get_vertex(i), i);
                 }
             }
 
             template<typename Fn>
             void 
-            foreach_fanin(std::vector<int>& v, Fn&& fn) const
+            foreach_fanin(const pd_vertex& v, Fn&& fn) const
             {
                 for (auto i = 0; i < fanin; i++) {
                     fn(v[i], i);
@@ -82,11 +102,11 @@ namespace percy
             void 
             reset(int fanin, int nr_vertices)
             {
+                assert(fanin <= PD_MAX_FANIN);
+                assert(nr_vertices <= MAX_STEPS);
                 this->fanin = fanin;
-                vertices.resize(nr_vertices);
-                for (auto& vertex : vertices) {
-                    vertex.resize(fanin);
-                }
+                this->_nr_vertices = nr_vertices;
+                std::memset(vertices, 0, sizeof(vertices));
             }
 
             void 
@@ -120,23 +140,27 @@ namespace percy
             add_vertex(const std::vector<int>& fanins)
             {
                 assert(fanins.size() == static_cast<unsigned>(fanin));
-                vertices.push_back(fanins);
+                assert(_nr_vertices < MAX_STEPS);
+                for (int i = 0; i < fanin; i++) {
+                    vertices[_nr_vertices][i] = fanins[i];
+                }
+                _nr_vertices++;
             }
 
-            const std::vector<int>& 
+            pd_vertex 
             get_vertex(int v_idx) const
             {
-                return vertices[v_idx];
+                return pd_vertex(vertices[v_idx], fanin);
             }
 
-            const std::vector<std::vector<int>>& get_vertices() const 
+            int get_fanin() const
             {
-                return vertices;
+                return fanin;
             }
 
             int nr_vertices() const
             {
-                return vertices.size();
+                return _nr_vertices;
             }
 
 #ifndef DISABLE_NAUTY
@@ -226,6 +250,9 @@ namespace percy
             
     };
 
+    static_assert(std::is_trivially_copyable<partial_dag>::value,
+        "partial DAGs must be trivially copyable");
+
     enum partial_gen_type
     {
         GEN_TUPLES, /// No restrictions besides acyclicity
@@ -383,7 +410,7 @@ namespace percy
             int buf = dag.nr_vertices();
             fwrite(&buf, sizeof(int), 1, fhandle);
             for (int i = 0; i < dag.nr_vertices(); i++) {
-                auto& v = dag.get_vertex(i);
+                const auto v = dag.get_vertex(i);
                 for (const auto fanin : v) {
                     buf = fanin;
                     auto stat = fwrite(&buf, sizeof(int), 1, fhandle);
@@ -392,6 +419,34 @@ namespace percy
             }
         }
 
+        /// Reads the next partial DAG with the given fanin size from a
+        /// file written by write_partial_dag. Returns false if the end of
+        /// the file is reached before a complete DAG could be read.
+        inline bool read_partial_dag(partial_dag& dag, int fanin, FILE* fhandle)
+        {
+            int buf;
+            if (fread(&buf, sizeof(int), 1, fhandle) != 1) {
+                return false;
+            }
+            if (buf < 0 || buf > MAX_STEPS) {
+                return false;
+            }
+            dag.reset(fanin, buf);
+            int fanins[PD_MAX_FANIN];
+            for (int i = 0; i < dag.nr_vertices(); i++) {
+                if (fread(fanins, sizeof(int), fanin, fhandle) !=
+                        static_cast<size_t>(fanin)) {
+                    return false;
+                }
+                if (fanin == 2) {
+                    dag.set_vertex(i, fanins[0], fanins[1]);
+                } else {
+                    dag.set_vertex(i, fanins[0], fanins[1], fanins[2]);
+                }
+            }
+            return true;
+        }
+
         /// Writes a collection of partial DAGs to the specified filename
         inline void write_partial_dags(const std::vector<partial_dag>& dags, const char* const filename)
         {
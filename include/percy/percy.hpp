@@ -1,9 +1,13 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <random>
 #include "spec.hpp"
 #include "fence.hpp"
 #include "chain.hpp"
@@ -14,9 +18,18 @@
 #include "partial_dag.hpp"
 #include "generators/partial_dag_generator.hpp"
 #include "generators/partial_dag3_generator.hpp"
+#include "generators/partial_dag_shards.hpp"
 #include "solvers.hpp"
 #include "encoders.hpp"
+#include "warm_start.hpp"
 #include "cnf.hpp"
+#include "solver_profile.hpp"
+#include "enumeration.hpp"
+#include "structure_stats.hpp"
+#include "structure_filter.hpp"
+#include "structure_nogoods.hpp"
+#include "enum_synthesis.hpp"
+#include "optimum_db.hpp"
 #include <limits>
 
 /*******************************************************************************
@@ -68,6 +81,7 @@ namespace percy
             return success;
         }
 
+        warm_start ws(spec.warm_start);
         spec.nr_steps = spec.initial_steps;
         while (true) {
             solver.restart();
@@ -75,6 +89,7 @@ namespace percy
                 spec.nr_steps++;
                 continue;
             }
+            ws.load(spec, encoder, solver);
             if (stats) {
                 stats->nr_vars = solver.nr_vars();
                 stats->nr_clauses = solver.nr_clauses();
@@ -105,6 +120,7 @@ namespace percy
                 if (stats) {
                     stats->unsat_time += elapsed_time;
                 }
+                ws.save(spec, encoder, solver);
                 spec.nr_steps++;
             } else {
                 return timeout;
@@ -112,6 +128,149 @@ namespace percy
         }
     }
 
+    /// Selects up to nr_minterms minterms from the set diff of differing
+    /// minterms, according to the given CEGAR strategy. Minterm 0 is never
+    /// selected, since only normal functions are synthesized. The diverse
+    /// strategy starts from the first differing minterm and then greedily
+    /// adds the minterm with the largest Hamming distance to the minterms
+    /// selected so far.
+    inline void
+    select_counterexamples(
+        const kitty::dynamic_truth_table& diff,
+        int nr_minterms,
+        CegarStrategy strategy,
+        std::vector<int64_t>& mints)
+    {
+        mints.clear();
+        if (nr_minterms <= 0) {
+            return;
+        }
+
+        std::vector<int64_t> candidates;
+        const auto nr_bits = int64_t(diff.num_bits());
+        for (auto w = 0u; w < diff.num_blocks(); w++) {
+            auto word = diff.cbegin()[w];
+            while (word) {
+                const auto idx = int64_t(w) * 64 + __builtin_ctzll(word);
+                word &= word - 1;
+                if (idx == 0 || idx >= nr_bits) {
+                    continue;
+                }
+                if (strategy != CEGAR_DIVERSE &&
+                        int(mints.size()) < nr_minterms) {
+                    mints.push_back(idx);
+                } else {
+                    candidates.push_back(idx);
+                }
+            }
+            if (strategy != CEGAR_DIVERSE &&
+                    int(mints.size()) >= nr_minterms) {
+                return;
+            }
+        }
+        if (strategy != CEGAR_DIVERSE || candidates.empty()) {
+            return;
+        }
+
+        // Distance of every candidate to the closest selected minterm.
+        std::vector<int> dist(candidates.size(), std::numeric_limits<int>::max());
+        auto next = 0u;
+        while (int(mints.size()) < nr_minterms) {
+            const auto mint = candidates[next];
+            mints.push_back(mint);
+            auto max_dist = 0;
+            for (auto i = 0u; i < candidates.size(); i++) {
+                dist[i] = std::min(dist[i],
+                        __builtin_popcountll(uint64_t(candidates[i] ^ mint)));
+                if (dist[i] > max_dist) {
+                    max_dist = dist[i];
+                    next = i;
+                }
+            }
+            if (max_dist == 0) {
+                break;
+            }
+        }
+    }
+
+    /// Seeds a CEGAR formula with spec.nr_rand_tt_assigns minterms that are
+    /// spread out over the input space, so that the first rounds already
+    /// constrain all parts of the truth table. The add_minterm function
+    /// adds the clauses for a minterm t, where t is the index of the
+    /// minterm minus one. Returns false if the formula becomes UNSAT.
+    template<typename AddFn>
+    inline bool
+    cegar_seed(
+        const spec& spec,
+        solver_wrapper& solver,
+        AddFn add_minterm,
+        synth_stats* stats = nullptr)
+    {
+        if (spec.nr_rand_tt_assigns <= 0) {
+            return true;
+        }
+        const auto nr_clauses = solver.nr_clauses();
+        kitty::dynamic_truth_table all(spec.nr_in);
+        all = ~all;
+        std::vector<int64_t> mints;
+        select_counterexamples(all, spec.nr_rand_tt_assigns, CEGAR_DIVERSE, mints);
+        auto res = true;
+        for (const auto mint : mints) {
+            if (!add_minterm(int(mint - 1))) {
+                res = false;
+                break;
+            }
+        }
+        if (stats) {
+            stats->nr_cegar_minterms += int(mints.size());
+            stats->nr_cegar_clauses += solver.nr_clauses() - nr_clauses;
+        }
+        return res;
+    }
+
+    /// Refines a CEGAR formula after a round in which the solution differs
+    /// from the specification at minterm first_one. If the CEGAR strategy
+    /// of the specification selects more than one minterm per round,
+    /// compute_diff is called to compute the set of all differing
+    /// minterms. Returns false if the formula becomes UNSAT.
+    template<typename DiffFn, typename AddFn>
+    inline bool
+    cegar_refine(
+        const spec& spec,
+        solver_wrapper& solver,
+        int64_t first_one,
+        DiffFn compute_diff,
+        AddFn add_minterm,
+        synth_stats* stats = nullptr)
+    {
+        const auto nr_clauses = solver.nr_clauses();
+        std::vector<int64_t> mints;
+        if (spec.cegar_strategy != CEGAR_FIRST && spec.cegar_nr_minterms > 1) {
+            kitty::dynamic_truth_table diff(spec.nr_in);
+            compute_diff(diff);
+            select_counterexamples(diff, spec.cegar_nr_minterms,
+                    spec.cegar_strategy, mints);
+        }
+        if (mints.empty()) {
+            mints.push_back(first_one);
+        }
+        auto res = true;
+        for (const auto mint : mints) {
+            if (spec.verbosity) {
+                printf("  CEGAR difference at tt index %ld\n", long(mint));
+            }
+            if (!add_minterm(int(mint - 1))) {
+                res = false;
+                break;
+            }
+        }
+        if (stats) {
+            stats->nr_cegar_minterms += int(mints.size());
+            stats->nr_cegar_clauses += solver.nr_clauses() - nr_clauses;
+        }
+        return res;
+    }
+
     inline synth_result
     std_cegar_synthesize(
         spec& spec, 
@@ -127,6 +286,9 @@ namespace percy
             stats->synth_time = 0;
             stats->sat_time = 0;
             stats->unsat_time = 0;
+            stats->nr_cegar_rounds = 0;
+            stats->nr_cegar_minterms = 0;
+            stats->nr_cegar_clauses = 0;
         }
 
         // The special case when the Boolean chain to be synthesized
@@ -140,6 +302,14 @@ namespace percy
             return success;
         }
 
+        const auto add_minterm = [&](int t) {
+            return encoder.create_tt_clauses(spec, t);
+        };
+        const auto compute_diff = [&](kitty::dynamic_truth_table& diff) {
+            encoder.simulation_difference(spec, diff);
+        };
+
+        warm_start ws(spec.warm_start);
         encoder.reset_sim_tts(spec.nr_in);
         spec.nr_steps = spec.initial_steps;
         while (true) {
@@ -148,11 +318,22 @@ namespace percy
                 spec.nr_steps++;
                 continue;
             }
+            ws.load(spec, encoder, solver);
             auto iMint = 1;
+            if (!cegar_seed(spec, solver, add_minterm, stats)) {
+                spec.nr_steps++;
+                continue;
+            }
+            // The first round solves the seeded formula, and the later
+            // ones add the counterexamples of the previous round.
             for (int i = 0; iMint != -1; i++) {
-                if (!encoder.create_tt_clauses(spec, iMint - 1)) {
+                if (i > 0 && !cegar_refine(spec, solver, iMint,
+                            compute_diff, add_minterm, stats)) {
                     break;
                 }
+                if (stats) {
+                    stats->nr_cegar_rounds++;
+                }
                 auto begin = std::chrono::steady_clock::now();
                 auto stat = solver.solve(spec.conflict_limit);
                 auto end = std::chrono::steady_clock::now();
@@ -179,6 +360,7 @@ namespace percy
                 encoder.cegar_extract_chain(spec, chain);
                 break;
             }
+            ws.save(spec, encoder, solver);
             spec.nr_steps++;
         }
 
@@ -210,6 +392,9 @@ namespace percy
             solver = new satoko_wrapper;
             break;
 #endif
+        case SLV_PORTFOLIO:
+            solver = new portfolio_wrapper;
+            break;
         default:
             fprintf(stderr, "Error: solver type %d not found", type);
             exit(1);
@@ -219,6 +404,200 @@ namespace percy
         return res;
     }
 
+    /// Returns a solver that is configured with the given profile.
+    inline std::unique_ptr<solver_wrapper>
+    get_solver(const solver_profile& profile)
+    {
+        auto solver = get_solver(profile.type);
+        profile.apply(*solver);
+        return solver;
+    }
+
+    /***************************************************************************
+        Keeps solvers that are no longer in use, so that synthesizer threads
+        can reuse them instead of allocating a new solver every time. A
+        solver is restarted when it is handed out, which resets it in place
+        for the backends that support it.
+    ***************************************************************************/
+    class solver_pool
+    {
+    public:
+        class handle
+        {
+        private:
+            solver_pool* pool;
+            SolverType type;
+            std::unique_ptr<solver_wrapper> solver;
+
+        public:
+            handle(solver_pool& pool, SolverType type,
+                    std::unique_ptr<solver_wrapper> solver) :
+                pool(&pool), type(type), solver(std::move(solver))
+            {
+            }
+
+            /// Owns a solver that does not belong to a pool, and is
+            /// destroyed along with the handle.
+            explicit handle(std::unique_ptr<solver_wrapper> solver) :
+                pool(nullptr), type(SLV_TOTAL), solver(std::move(solver))
+            {
+            }
+
+            handle(handle&& other) = default;
+            handle& operator=(handle&& other) = delete;
+
+            ~handle()
+            {
+                if (solver && pool) {
+                    pool->release(type, std::move(solver));
+                }
+            }
+
+            solver_wrapper& operator*() const
+            {
+                return *solver;
+            }
+
+            solver_wrapper* operator->() const
+            {
+                return solver.get();
+            }
+        };
+
+    private:
+        std::mutex mutex;
+        std::vector<std::unique_ptr<solver_wrapper>> idle[SLV_TOTAL];
+
+        void release(SolverType type, std::unique_ptr<solver_wrapper> solver)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle[type].push_back(std::move(solver));
+        }
+
+    public:
+        /// Hands out an idle solver of the given type, or a new one if
+        /// there is none. The solver returns to the pool when the handle
+        /// is destroyed.
+        handle acquire(SolverType type = SLV_BSAT2)
+        {
+            std::unique_ptr<solver_wrapper> solver;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!idle[type].empty()) {
+                    solver = std::move(idle[type].back());
+                    idle[type].pop_back();
+                }
+            }
+            if (solver) {
+                solver->restart();
+            } else {
+                solver = get_solver(type);
+            }
+            return handle(*this, type, std::move(solver));
+        }
+
+        /// Returns the number of idle solvers of the given type.
+        std::size_t nr_idle(SolverType type = SLV_BSAT2)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return idle[type].size();
+        }
+
+        /// Frees all idle solvers.
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& solvers : idle) {
+                solvers.clear();
+            }
+        }
+    };
+
+    inline solver_pool& get_solver_pool()
+    {
+        static solver_pool pool;
+        return pool;
+    }
+
+    /// Creates the solver of worker i of a parallel synthesizer. Without
+    /// a factory, the workers use pooled BSAT solvers, or ABC's Glucose in
+    /// the fence-based majority synthesizers.
+    typedef std::function<std::unique_ptr<solver_wrapper>(int i)> solver_factory;
+
+    /// Creates the encoder of worker i of a parallel synthesizer, which
+    /// encodes into the worker's solver.
+    template<typename Encoder>
+    using encoder_factory =
+        std::function<std::unique_ptr<Encoder>(solver_wrapper& solver, int i)>;
+
+    /// Makes the solver of worker i search differently from those of the
+    /// other workers with the variants that the members of a portfolio
+    /// use. Worker 0 keeps the default configuration.
+    inline void
+    diversify_solver(solver_wrapper& solver, SolverType type, int i)
+    {
+        if (i == 0) {
+            return;
+        }
+        if (type == SLV_BSAT2) {
+            apply_portfolio_variant(static_cast<bsat_wrapper&>(solver), i);
+        }
+#ifdef USE_SATOKO
+        if (type == SLV_SATOKO) {
+            apply_portfolio_variant(static_cast<satoko_wrapper&>(solver), i);
+        }
+#endif
+    }
+
+    /// Returns a factory for the workers of a parallel synthesizer that
+    /// creates solvers with the given profile, diversified per worker if
+    /// diversify is set. Parameters that the profile sets to other values
+    /// than the defaults keep those values on every worker. The
+    /// synthesizers call a factory from several worker threads at once,
+    /// so a factory of one's own must be thread-safe.
+    inline solver_factory
+    make_solver_factory(const solver_profile& profile, bool diversify = true)
+    {
+        return [profile, diversify](int i) {
+            auto solver = get_solver(profile);
+            if (diversify) {
+                diversify_solver(*solver, profile.type, i);
+                profile.apply_tuned(*solver);
+            }
+            return solver;
+        };
+    }
+
+    inline solver_factory
+    make_solver_factory(SolverType type, bool diversify = true)
+    {
+        return make_solver_factory(solver_profile(type), diversify);
+    }
+
+    /// Returns the solver of worker i of a parallel synthesizer: a new one
+    /// from the factory, or a pooled BSAT solver if there is no factory.
+    inline solver_pool::handle
+    get_worker_solver(const solver_factory& make_solver, int i)
+    {
+        if (make_solver) {
+            return solver_pool::handle(make_solver(i));
+        }
+        return get_solver_pool().acquire(SLV_BSAT2);
+    }
+
+    /// Returns the encoder of worker i of a parallel synthesizer: one from
+    /// the factory, or a default one if there is no factory.
+    template<typename Encoder>
+    inline std::unique_ptr<Encoder>
+    get_worker_encoder(const encoder_factory<Encoder>& make_encoder,
+            solver_wrapper& solver, int i)
+    {
+        if (make_encoder) {
+            return make_encoder(solver, i);
+        }
+        return std::unique_ptr<Encoder>(new Encoder(solver));
+    }
+
     inline std::unique_ptr<encoder>
     get_encoder(solver_wrapper& solver, EncoderType enc_type = ENC_SSV)
     {
@@ -250,6 +629,37 @@ namespace percy
         return res;
     }
 
+    /// Encodes the synthesis problem for fence f. If the solver and the
+    /// encoder support it, the part of the formula that is the same for
+    /// all fences with the same number of steps is encoded once, and the
+    /// solver rolls back to it for the other fences of that size.
+    /// shared_steps is the number of steps of the part that the solver
+    /// is bookmarked at, -1 if there is none yet, and 0 if the solver or
+    /// the encoder do not support this.
+    inline bool
+    fence_encode(
+        spec& spec,
+        const fence& f,
+        solver_wrapper& solver,
+        fence_encoder& encoder,
+        int& shared_steps)
+    {
+        if (shared_steps == spec.nr_steps) {
+            solver.rollback();
+            return encoder.encode_structure(spec, f);
+        }
+        solver.restart();
+        if (shared_steps != 0) {
+            if (encoder.encode_shared(spec) && solver.bookmark()) {
+                shared_steps = spec.nr_steps;
+                return encoder.encode_structure(spec, f);
+            }
+            shared_steps = 0;
+            solver.restart();
+        }
+        return encoder.encode(spec, f);
+    }
+
     inline synth_result 
     fence_synthesize(spec& spec, chain& chain, solver_wrapper& solver, fence_encoder& encoder)
     {
@@ -274,8 +684,10 @@ namespace percy
         po_filter<unbounded_generator> g(
             unbounded_generator(spec.initial_steps),
             spec.get_nr_out(), spec.fanin);
+        warm_start ws(spec.warm_start);
         int old_nnodes = 1;
         auto total_conflicts = 0;
+        auto shared_steps = -1;
         while (true) {
             g.next_fence(f);
             spec.nr_steps = f.nr_nodes();
@@ -287,10 +699,10 @@ namespace percy
                 old_nnodes = spec.nr_steps;
             }
 
-            solver.restart();
-            if (!encoder.encode(spec, f)) {
+            if (!fence_encode(spec, f, solver, encoder, shared_steps)) {
                 continue;
             }
+            ws.load(spec, encoder, solver);
 
             if (spec.verbosity) {
                 printf("  next fence:\n");
@@ -307,6 +719,7 @@ namespace percy
                 encoder.extract_chain(spec, chain);
                 return success;
             } else if (status == failure) {
+                ws.save(spec, encoder, solver);
                 total_conflicts += solver.nr_conflicts();
                 if (spec.conflict_limit &&
                     total_conflicts > spec.conflict_limit) {
@@ -344,32 +757,38 @@ namespace percy
         chain& chain, 
         solver_wrapper& solver, 
         fence_encoder& encoder, 
-        fence& fence)
+        fence& fence,
+        synth_stats* stats = NULL)
     {
+        const auto add_minterm = [&](int t) {
+            return encoder.create_tt_clauses(spec, t);
+        };
+        const auto compute_diff = [&](kitty::dynamic_truth_table& diff) {
+            encoder.simulation_difference(spec, diff);
+        };
+
         solver.restart();
         if (!encoder.cegar_encode(spec, fence)) {
             return failure;
         }
+        if (!cegar_seed(spec, solver, add_minterm, stats)) {
+            return failure;
+        }
         
         while (true) {
+            if (stats) {
+                stats->nr_cegar_rounds++;
+            }
             auto status = solver.solve(spec.conflict_limit);
             if (status == success) {
-                auto sim_tt = encoder.simulate(spec);
-                if (spec.out_inv) {
-                    sim_tt = ~sim_tt;
-                }
-                auto xor_tt = sim_tt ^ (spec[0]);
-                auto first_one = kitty::find_first_one_bit(xor_tt);
+                const auto first_one = encoder.find_counterexample(spec);
                 if (first_one == -1) {
                     encoder.extract_chain(spec, chain);
                     return success;
                 }
-                // Add additional constraint.
-                if (spec.verbosity) {
-                    printf("  CEGAR difference at tt index %ld\n",
-                        first_one);
-                }
-                if (!encoder.create_tt_clauses(spec, first_one - 1)) {
+                // Add additional constraints.
+                if (!cegar_refine(spec, solver, first_one, compute_diff,
+                            add_minterm, stats)) {
                     return failure;
                 }
             } else {
@@ -379,7 +798,12 @@ namespace percy
     }
     
     inline synth_result 
-    fence_cegar_synthesize(spec& spec, chain& chain, solver_wrapper& solver, fence_encoder& encoder)
+    fence_cegar_synthesize(
+        spec& spec, 
+        chain& chain, 
+        solver_wrapper& solver, 
+        fence_encoder& encoder,
+        synth_stats* stats = NULL)
     {
         assert(spec.get_nr_in() >= spec.fanin);
 
@@ -396,6 +820,18 @@ namespace percy
             return success;
         }
 
+        if (stats) {
+            stats->nr_cegar_rounds = 0;
+            stats->nr_cegar_minterms = 0;
+            stats->nr_cegar_clauses = 0;
+        }
+        const auto add_minterm = [&](int t) {
+            return encoder.create_tt_clauses(spec, t);
+        };
+        const auto compute_diff = [&](kitty::dynamic_truth_table& diff) {
+            encoder.simulation_difference(spec, diff);
+        };
+
         encoder.reset_sim_tts(spec.nr_in);
 
         fence f;
@@ -421,23 +857,22 @@ namespace percy
             if (!encoder.cegar_encode(spec, f)) {
                 continue;
             }
+            if (!cegar_seed(spec, solver, add_minterm, stats)) {
+                continue;
+            }
             while (true) {
+                if (stats) {
+                    stats->nr_cegar_rounds++;
+                }
                 auto status = solver.solve(spec.conflict_limit);
                 if (status == success) {
-                    auto sim_tt = encoder.simulate(spec);
-                    if (spec.out_inv) {
-                        sim_tt = ~sim_tt;
-                    }
-                    auto xor_tt = sim_tt ^ (spec[0]);
-                    if (spec.has_dc_mask(0)) {
-                        xor_tt &= ~spec.get_dc_mask(0);
-                    }
-                    auto first_one = kitty::find_first_one_bit(xor_tt);
+                    const auto first_one = encoder.find_counterexample(spec);
                     if (first_one == -1) {
                         encoder.extract_chain(spec, chain);
                         return success;
                     }
-                    if (!encoder.create_tt_clauses(spec, first_one - 1)) {
+                    if (!cegar_refine(spec, solver, first_one, compute_diff,
+                                add_minterm, stats)) {
                         break;
                     }
                 } else if (status == failure) {
@@ -475,7 +910,10 @@ namespace percy
         case SYNTH_FENCE:
             return fence_synthesize(spec, chain, solver, static_cast<fence_encoder&>(encoder));
         case SYNTH_FENCE_CEGAR:
-            return fence_cegar_synthesize(spec, chain, solver, static_cast<fence_encoder&>(encoder));
+            return fence_cegar_synthesize(spec, chain, solver, static_cast<fence_encoder&>(encoder), stats);
+        case SYNTH_ENUM:
+            // Needs neither the solver nor the encoder.
+            return enum_synthesize(spec, chain, stats);
      //   case SYNTH_DAG:
       //      return dag_synthesize(spec, chain, solver, static_cast<dag_encoder<2>&>(encoder));
         default:
@@ -484,18 +922,58 @@ namespace percy
         }
     }
 
+    /// Same as fence_encode, but for partial DAGs.
+    inline bool
+    pd_encode(
+        spec& spec,
+        const partial_dag& dag,
+        solver_wrapper& solver,
+        partial_dag_encoder& encoder,
+        int& shared_steps)
+    {
+        if (shared_steps == spec.nr_steps) {
+            solver.rollback();
+            return encoder.encode_structure(spec, dag);
+        }
+        solver.restart();
+        if (shared_steps != 0) {
+            if (encoder.encode_shared(spec) && solver.bookmark()) {
+                shared_steps = spec.nr_steps;
+                return encoder.encode_structure(spec, dag);
+            }
+            shared_steps = 0;
+            solver.restart();
+        }
+        return encoder.encode(spec, dag);
+    }
+
+    /// Synthesizes a chain with the structure of a partial DAG. When
+    /// shared_steps is given, the solver may be rolled back to the
+    /// encoding of a previous call instead of being restarted, see
+    /// pd_encode.
     inline synth_result
     pd_synthesize(
         spec& spec, 
         chain& chain, 
         const partial_dag& dag,
         solver_wrapper& solver, 
-        partial_dag_encoder& encoder)
+        partial_dag_encoder& encoder,
+        warm_start* ws = nullptr,
+        int* shared_steps = nullptr)
     {
         spec.nr_steps = dag.nr_vertices();
-        solver.restart();
-        if (!encoder.encode(spec, dag)) {
-            return failure;
+        if (shared_steps) {
+            if (!pd_encode(spec, dag, solver, encoder, *shared_steps)) {
+                return failure;
+            }
+        } else {
+            solver.restart();
+            if (!encoder.encode(spec, dag)) {
+                return failure;
+            }
+        }
+        if (ws) {
+            ws->load(spec, encoder, solver);
         }
 
         synth_result status;
@@ -508,6 +986,9 @@ namespace percy
             }
             return success;
         } else if (status == failure) {
+            if (ws) {
+                ws->save(spec, encoder, solver);
+            }
             return failure;
         } else {
             return percy::synth_result::timeout;
@@ -519,14 +1000,34 @@ namespace percy
         chain& chain, 
         const partial_dag& dag,
         solver_wrapper& solver, 
-        partial_dag_encoder& encoder)
+        partial_dag_encoder& encoder,
+        synth_stats* stats = NULL,
+        warm_start* ws = nullptr)
     {
+        kitty::dynamic_truth_table xor_tt;
+        const auto add_minterm = [&](int t) {
+            return encoder.create_tt_clauses(spec, dag, t) &&
+                encoder.fix_output_sim_vars(spec, t);
+        };
+        const auto compute_diff = [&](kitty::dynamic_truth_table& diff) {
+            diff = xor_tt;
+        };
+
         spec.nr_steps = dag.nr_vertices();
         solver.restart();
         if (!encoder.cegar_encode(spec, dag)) {
             return failure;
         }
+        if (ws) {
+            ws->load(spec, encoder, solver);
+        }
+        if (!cegar_seed(spec, solver, add_minterm, stats)) {
+            return failure;
+        }
         while (true) {
+            if (stats) {
+                stats->nr_cegar_rounds++;
+            }
             auto stat = solver.solve(0);
 
             if (stat == success) {
@@ -534,23 +1035,21 @@ namespace percy
                 if (spec.out_inv) {
                     sim_tt = ~sim_tt;
                 }
-                auto xor_tt = sim_tt ^ (spec[0]);
+                xor_tt = sim_tt ^ (spec[0]);
                 auto first_one = kitty::find_first_one_bit(xor_tt);
                 if (first_one == -1) {
                     encoder.extract_chain(spec, dag, chain);
                     return success;
                 }
-                // Add additional constraint.
-                if (spec.verbosity) {
-                    printf("  CEGAR difference at tt index %ld\n",
-                        first_one);
-                }
-                if (!encoder.create_tt_clauses(spec, dag, first_one - 1)) {
-                    return failure;
-                } else if (!encoder.fix_output_sim_vars(spec, first_one - 1)) {
+                // Add additional constraints.
+                if (!cegar_refine(spec, solver, first_one, compute_diff,
+                            add_minterm, stats)) {
                     return failure;
                 }
             } else {
+                if (ws) {
+                    ws->save(spec, encoder, solver);
+                }
                 return failure;
             }
         }
@@ -611,7 +1110,8 @@ namespace percy
         const std::vector<partial_dag>& dags,
         solver_wrapper& solver,
         partial_dag_encoder& encoder,
-        SynthMethod synth_method = SYNTH_STD)
+        SynthMethod synth_method = SYNTH_STD,
+        structure_filter* filter = nullptr)
     {
         assert(spec.get_nr_in() >= spec.fanin);
         spec.preprocess();
@@ -627,14 +1127,24 @@ namespace percy
             return success;
         }
 
+        if (filter) {
+            filter->set_spec(spec);
+        }
+        warm_start ws(spec.warm_start);
+        auto shared_steps = -1;
         for (auto& dag : dags) {
+            if (filter && !filter->check(dag)) {
+                continue;
+            }
             synth_result status;
             switch (synth_method) {
             case SYNTH_STD_CEGAR:
-                status = pd_cegar_synthesize(spec, chain, dag, solver, encoder);
+                status = pd_cegar_synthesize(spec, chain, dag, solver,
+                        encoder, NULL, &ws);
                 break;
             default:
-                status = pd_synthesize(spec, chain, dag, solver, encoder);
+                status = pd_synthesize(spec, chain, dag, solver, encoder,
+                        &ws, &shared_steps);
                 break;
             }
             if (status == success) {
@@ -644,12 +1154,78 @@ namespace percy
         return failure;
     }
 
+    /// Same as pd_synthesize, but encodes the partial DAGs
+    /// incrementally. Consecutive DAGs that share a prefix of identical
+    /// vertices reuse the clauses of that prefix, as well as the clauses
+    /// learned from them. This works best when the DAGs are in the order
+    /// in which the generators produce them.
+    inline synth_result pd_inc_synthesize(
+        spec& spec,
+        chain& chain,
+        const std::vector<partial_dag>& dags,
+        solver_wrapper& solver,
+        partial_dag_encoder& encoder,
+        structure_filter* filter = nullptr,
+        structure_nogoods* nogoods = nullptr)
+    {
+        assert(spec.get_nr_in() >= spec.fanin);
+        spec.preprocess();
+
+        // The special case when the Boolean chain to be synthesized
+        // consists entirely of trivial functions.
+        if (spec.nr_triv == spec.get_nr_out()) {
+            chain.reset(spec.get_nr_in(), spec.get_nr_out(), 0, spec.fanin);
+            for (int h = 0; h < spec.get_nr_out(); h++) {
+                chain.set_output(h, (spec.triv_func(h) << 1) +
+                    ((spec.out_inv >> h) & 1));
+            }
+            return success;
+        }
+
+        if (filter) {
+            filter->set_spec(spec);
+        }
+        if (nogoods) {
+            nogoods->set_spec(spec);
+        }
+        solver.restart();
+        encoder.inc_reset();
+        pd_nogood nogood;
+        for (auto& dag : dags) {
+            if (filter && !filter->check(dag)) {
+                continue;
+            }
+            if (nogoods && nogoods->blocks(dag)) {
+                continue;
+            }
+            spec.nr_steps = dag.nr_vertices();
+            if (!encoder.inc_encode(spec, dag)) {
+                continue;
+            }
+            const auto status = encoder.inc_solve(0);
+            if (status == success) {
+                encoder.extract_chain(spec, dag, chain);
+                return success;
+            }
+            // Learn which part of the DAG made it unsatisfiable, so that
+            // later DAGs with the same part can be skipped.
+            if (nogoods && encoder.inc_nogood(nogood)) {
+                nogoods->add(nogood);
+            }
+        }
+        return failure;
+    }
+
     inline synth_result
     pd_synthesize_parallel(
         spec& spec, 
         chain& c, 
         const std::vector<partial_dag>& dags,
-        int num_threads = std::thread::hardware_concurrency())
+        int num_threads = std::thread::hardware_concurrency(),
+        structure_stats* stats = nullptr,
+        structure_filter* filter = nullptr,
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<partial_dag_encoder>& make_encoder = nullptr)
     {
         assert(spec.get_nr_in() >= spec.fanin);
         spec.preprocess();
@@ -675,11 +1251,29 @@ namespace percy
         int* psize_found = &size_found;
         std::mutex found_mutex;
 
+        // Discard the DAGs that cannot lead to a solution, and try the
+        // ones that are most likely to be satisfiable first.
+        std::vector<partial_dag> ordered_dags;
+        auto pdags = &dags;
+        if (stats || filter) {
+            ordered_dags = dags;
+            if (filter) {
+                filter->set_spec(spec);
+                filter->apply(ordered_dags);
+            }
+            if (stats) {
+                stats->order(spec, ordered_dags);
+            }
+            pdags = &ordered_dags;
+        }
+
         for (int i = 0; i < num_threads; i++) {
-            threads[i] = std::thread([&spec, psize_found, pfinished, &found_mutex, &c, &q] {
+            threads[i] = std::thread([&spec, psize_found, pfinished, &found_mutex, &c, &q, stats, i, &make_solver, &make_encoder] {
                 percy::spec local_spec = spec;
-                bsat_wrapper solver;
-                partial_dag_encoder encoder(solver);
+                auto pooled = get_worker_solver(make_solver, i);
+                auto& solver = *pooled;
+                auto pencoder = get_worker_encoder(make_encoder, solver, i);
+                auto& encoder = *pencoder;
                 partial_dag dag;
                 local_spec.nr_steps = 0;
 
@@ -697,6 +1291,7 @@ namespace percy
                     }
                     local_spec.nr_steps = dag.nr_vertices();
                     synth_result status;
+                    const auto start = std::chrono::steady_clock::now();
                     solver.restart();
                     if (!encoder.encode(local_spec, dag)) {
                         continue;
@@ -719,12 +1314,17 @@ namespace percy
                         }
 
                     }
+                    if (stats) {
+                        const std::chrono::duration<double> elapsed =
+                            std::chrono::steady_clock::now() - start;
+                        stats->add_result(local_spec, dag, status, elapsed.count());
+                    }
                 }
             });
         }
         size_t dag_idx = 0;
-        while (size_found == PD_SIZE_CONST) {
-            while (!q.try_enqueue(dags.at(dag_idx))) {
+        while (size_found == PD_SIZE_CONST && dag_idx < pdags->size()) {
+            while (!q.try_enqueue(pdags->at(dag_idx))) {
                 if (size_found == PD_SIZE_CONST) {
                     std::this_thread::yield();
                 } else {
@@ -738,7 +1338,7 @@ namespace percy
             thread.join();
         }
 
-        return success;
+        return size_found == PD_SIZE_CONST ? failure : success;
     }
 
 
@@ -749,7 +1349,9 @@ namespace percy
         solver_wrapper& solver,
         partial_dag_encoder& encoder,
         std::string file_prefix = "",
-        int max_time = std::numeric_limits<int>::max()) // Timeout in seconds
+        int max_time = std::numeric_limits<int>::max(), // Timeout in seconds
+        structure_stats* stats = nullptr,
+        structure_filter* filter = nullptr)
     {
         assert(spec.get_nr_in() >= spec.fanin);
         spec.preprocess();
@@ -765,9 +1367,43 @@ namespace percy
             return success;
         }
 
+        if (filter) {
+            filter->set_spec(spec);
+        }
+
         partial_dag g;
+        std::vector<partial_dag> dags;
         spec.nr_steps = spec.initial_steps;
         auto begin = std::chrono::steady_clock::now();
+
+        // Returns failure if no chain was found with the DAG, and timeout
+        // if we ran out of time.
+        const auto try_dag = [&] (const partial_dag& dag) {
+            const auto start = std::chrono::steady_clock::now();
+            solver.restart();
+            if (!encoder.encode(spec, dag)) {
+                return failure;
+            }
+            const auto status = solver.solve(0);
+            auto end = std::chrono::steady_clock::now();
+            if (stats) {
+                const std::chrono::duration<double> elapsed = end - start;
+                stats->add_result(spec, dag, status, elapsed.count());
+            }
+            auto elapsed_time =
+                std::chrono::duration_cast<std::chrono::seconds>(
+                    end - begin
+                    ).count();
+            if (elapsed_time > max_time) {
+                return timeout;
+            }
+            if (status == success) {
+                encoder.extract_chain(spec, dag, chain);
+                return success;
+            }
+            return failure;
+        };
+
         while (true) {
             g.reset(2, spec.nr_steps);
             const auto filename = file_prefix + "pd" + std::to_string(spec.nr_steps) + ".bin";
@@ -777,6 +1413,9 @@ namespace percy
                 break;
             }
 
+            // With statistics, all DAGs of the current size are read
+            // first, so that the most promising ones can be tried first.
+            dags.clear();
             int buf;
             while (fread(&buf, sizeof(int), 1, fhandle) != 0) {
                 for (int i = 0; i < spec.nr_steps; i++) {
@@ -788,40 +1427,499 @@ namespace percy
                     auto fanin2 = buf;
                     g.set_vertex(i, fanin1, fanin2);
                 }
-                solver.restart();
-                if (!encoder.encode(spec, g)) {
+                if (filter && !filter->check(g)) {
                     continue;
                 }
-                const auto status = solver.solve(0);
-                auto end = std::chrono::steady_clock::now();
-                auto elapsed_time =
-                    std::chrono::duration_cast<std::chrono::seconds>(
-                        end - begin
-                        ).count();
-                if (elapsed_time > max_time) {
-                    return timeout;
+                if (stats) {
+                    dags.push_back(g);
+                    continue;
+                }
+                const auto status = try_dag(g);
+                if (status != failure) {
+                    fclose(fhandle);
+                    return status;
+                }
+            }
+            fclose(fhandle);
+            if (stats) {
+                stats->order(spec, dags);
+                for (const auto& dag : dags) {
+                    const auto status = try_dag(dag);
+                    if (status != failure) {
+                        return status;
+                    }
+                }
+            }
+            spec.nr_steps++;
+        }
+
+        return failure;
+    }
+
+    /// Same as pd_ser_synthesize, but parallel.  
+    inline synth_result pd_ser_synthesize_parallel(
+        spec& spec,
+        chain& c,
+        int num_threads = std::thread::hardware_concurrency(),
+        std::string file_prefix ="",
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<partial_dag_encoder>& make_encoder = nullptr)
+    {
+        assert(spec.get_nr_in() >= spec.fanin);
+        spec.preprocess();
+
+        // The special case when the Boolean chain to be synthesized
+        // consists entirely of trivial functions.
+        if (spec.nr_triv == spec.get_nr_out()) {
+            c.reset(spec.get_nr_in(), spec.get_nr_out(), 0, spec.fanin);
+            for (int h = 0; h < spec.get_nr_out(); h++) {
+                c.set_output(h, (spec.triv_func(h) << 1) +
+                    ((spec.out_inv >> h) & 1));
+            }
+            return success;
+        }
+
+        std::vector<std::thread> threads(num_threads);
+        moodycamel::ConcurrentQueue<partial_dag> q(num_threads * 3);
+        bool finished_generating = false;
+        bool* pfinished = &finished_generating;
+        int size_found = PD_SIZE_CONST;
+        int* psize_found = &size_found;
+        std::mutex found_mutex;
+
+        for (int i = 0; i < num_threads; i++) {
+            threads[i] = std::thread([&spec, psize_found, pfinished, &found_mutex, &c, &q, i, &make_solver, &make_encoder] {
+                percy::spec local_spec = spec;
+                auto pooled = get_worker_solver(make_solver, i);
+                auto& solver = *pooled;
+                auto pencoder = get_worker_encoder(make_encoder, solver, i);
+                auto& encoder = *pencoder;
+                partial_dag dag;
+
+                while (*psize_found > local_spec.nr_steps) {
+                    if (!q.try_dequeue(dag)) {
+                        if (*pfinished) {
+                            std::this_thread::yield();
+                            if (!q.try_dequeue(dag)) {
+                                break;
+                            }
+                        } else {
+                            std::this_thread::yield();
+                            continue;
+                        }
+                    }
+                    local_spec.nr_steps = dag.nr_vertices();
+                    synth_result status;
+                    solver.restart();
+                    if (!encoder.encode(local_spec, dag)) {
+                        continue;
+                    }
+                    while (true) {
+                        status = solver.solve(10);
+                        if (status == failure) {
+                            break;
+                        } else if (status == success) {
+                            std::lock_guard<std::mutex> vlock(found_mutex);
+                            if (*psize_found > local_spec.nr_steps) {
+                                encoder.extract_chain(local_spec, dag, c);
+                                *psize_found = local_spec.nr_steps;
+                            }
+                            break;
+                        } else if (*psize_found <= local_spec.nr_steps) {
+                            // Another thread found a solution that's
+                            // better or equal to this one.
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+
+        partial_dag g;
+        spec.nr_steps = spec.initial_steps;
+        while (size_found == PD_SIZE_CONST) {
+            g.reset(2, spec.nr_steps);
+            const auto filename = file_prefix + "pd" + std::to_string(spec.nr_steps) + ".bin";
+            auto fhandle = fopen(filename.c_str(), "rb");
+            if (fhandle == NULL) {
+                fprintf(stderr, "Error: unable to open PD file\n");
+                break;
+            }
+
+            int buf;
+            while (fread(&buf, sizeof(int), 1, fhandle) != 0) {
+                for (int i = 0; i < spec.nr_steps; i++) {
+                    auto read = fread(&buf, sizeof(int), 1, fhandle);
+                    assert(read > 0);
+                    auto fanin1 = buf;
+                    read = fread(&buf, sizeof(int), 1, fhandle);
+                    assert(read > 0);
+                    auto fanin2 = buf;
+                    g.set_vertex(i, fanin1, fanin2);
+                }
+                while (!q.try_enqueue(g)) {
+                    if (size_found == PD_SIZE_CONST) {
+                        std::this_thread::yield();
+                    } else {
+                        break;
+                    }
+                }
+                if (size_found != PD_SIZE_CONST) {
+                    break;
+                }
+            }
+            fclose(fhandle);
+            spec.nr_steps++;
+        }
+        finished_generating = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        spec.nr_steps = size_found;
+
+        return size_found == PD_SIZE_CONST ? failure : success;
+    }
+
+    /// Counterexamples shared by the workers of the parallel partial DAG
+    /// CEGAR synthesizers. A minterm that refuted one DAG is likely to
+    /// refute other DAGs as well, so the minterms that refuted the most
+    /// recent DAGs are kept in most recently used order and added to the
+    /// encoding of each new DAG before it is first solved.
+    class cegar_cex_pool
+    {
+    private:
+        std::vector<int> mints;
+        int capacity;
+        mutable std::mutex mints_mutex;
+
+    public:
+        cegar_cex_pool(int capacity = 16) : capacity(capacity)
+        {
+        }
+
+        void add(int t)
+        {
+            std::lock_guard<std::mutex> lock(mints_mutex);
+            auto it = std::find(mints.begin(), mints.end(), t);
+            if (it != mints.end()) {
+                mints.erase(it);
+            }
+            mints.insert(mints.begin(), t);
+            if (int(mints.size()) > capacity) {
+                mints.pop_back();
+            }
+        }
+
+        void get(std::vector<int>& dst) const
+        {
+            std::lock_guard<std::mutex> lock(mints_mutex);
+            dst = mints;
+        }
+
+        int size() const
+        {
+            std::lock_guard<std::mutex> lock(mints_mutex);
+            return int(mints.size());
+        }
+    };
+
+    /// Runs the workers of the parallel partial DAG CEGAR synthesizers.
+    /// The generate function puts the DAGs on the queue, in order of
+    /// increasing size, and should stop once size_found is set.
+    template<typename GenFn>
+    inline synth_result
+    pd_cegar_synthesize_parallel_impl(
+        spec& spec,
+        chain& c,
+        int num_threads,
+        cegar_cex_pool& pool,
+        const solver_factory& make_solver,
+        const encoder_factory<partial_dag_encoder>& make_encoder,
+        GenFn&& generate)
+    {
+        std::vector<std::thread> threads(num_threads);
+        moodycamel::ConcurrentQueue<partial_dag> q(num_threads * 3);
+        std::atomic<bool> finished_generating(false);
+        std::atomic<int> size_found(PD_SIZE_CONST);
+        std::mutex found_mutex;
+
+        for (int i = 0; i < num_threads; i++) {
+            threads[i] = std::thread([&, i] {
+                percy::spec local_spec = spec;
+                auto pooled = get_worker_solver(make_solver, i);
+                auto& solver = *pooled;
+                auto pencoder = get_worker_encoder(make_encoder, solver, i);
+                auto& encoder = *pencoder;
+                encoder.reset_sim_tts(spec.get_nr_in());
+                partial_dag dag;
+                std::vector<int> shared_mints;
+                std::vector<int> refuting_mints;
+                kitty::dynamic_truth_table xor_tt;
+                local_spec.nr_steps = 0;
+
+                const auto add_minterm = [&](int t) {
+                    return encoder.create_tt_clauses(local_spec, dag, t) &&
+                        encoder.fix_output_sim_vars(local_spec, t);
+                };
+                const auto add_refuting_minterm = [&](int t) {
+                    refuting_mints.push_back(t);
+                    return add_minterm(t);
+                };
+                const auto compute_diff = [&](kitty::dynamic_truth_table& diff) {
+                    diff = xor_tt;
+                };
+                // Returns success if a chain was found with the DAG and
+                // failure if it was refuted. Timeout means that another
+                // thread found a chain that is at least as small.
+                const auto try_dag = [&] {
+                    solver.restart();
+                    if (!encoder.cegar_encode(local_spec, dag)) {
+                        return failure;
+                    }
+                    pool.get(shared_mints);
+                    for (const auto t : shared_mints) {
+                        if (!add_minterm(t)) {
+                            return failure;
+                        }
+                    }
+                    if (!cegar_seed(local_spec, solver, add_minterm)) {
+                        return failure;
+                    }
+                    while (true) {
+                        const auto status = solver.solve(10);
+                        if (status == failure) {
+                            return failure;
+                        } else if (status == timeout) {
+                            if (size_found <= local_spec.nr_steps) {
+                                return timeout;
+                            }
+                            continue;
+                        }
+                        auto sim_tt = encoder.simulate(local_spec, dag);
+                        if (local_spec.out_inv) {
+                            sim_tt = ~sim_tt;
+                        }
+                        xor_tt = sim_tt ^ local_spec[0];
+                        const auto first_one = kitty::find_first_one_bit(xor_tt);
+                        if (first_one == -1) {
+                            std::lock_guard<std::mutex> vlock(found_mutex);
+                            if (size_found > local_spec.nr_steps) {
+                                encoder.extract_chain(local_spec, dag, c);
+                                size_found = local_spec.nr_steps;
+                            }
+                            return success;
+                        }
+                        if (!cegar_refine(local_spec, solver, first_one,
+                                    compute_diff, add_refuting_minterm)) {
+                            return failure;
+                        }
+                    }
+                };
+
+                while (size_found > local_spec.nr_steps) {
+                    if (!q.try_dequeue(dag)) {
+                        if (finished_generating) {
+                            std::this_thread::yield();
+                            if (!q.try_dequeue(dag)) {
+                                break;
+                            }
+                        } else {
+                            std::this_thread::yield();
+                            continue;
+                        }
+                    }
+                    local_spec.nr_steps = dag.nr_vertices();
+                    refuting_mints.clear();
+                    if (try_dag() == failure) {
+                        for (const auto t : refuting_mints) {
+                            pool.add(t);
+                        }
+                    }
+                }
+            });
+        }
+
+        generate(q, size_found);
+        finished_generating = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        spec.nr_steps = size_found;
+
+        return size_found == PD_SIZE_CONST ? failure : success;
+    }
+
+    /// Same as pd_synthesize_parallel, but the workers use the CEGAR
+    /// encoding of each DAG, and share the counterexamples that refuted
+    /// earlier DAGs. Only single-output specifications with fanin 2 are
+    /// supported.
+    inline synth_result
+    pd_cegar_synthesize_parallel(
+        spec& spec,
+        chain& c,
+        const std::vector<partial_dag>& dags,
+        int num_threads = std::thread::hardware_concurrency(),
+        structure_filter* filter = nullptr,
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<partial_dag_encoder>& make_encoder = nullptr)
+    {
+        assert(spec.get_nr_in() >= spec.fanin);
+        assert(spec.get_nr_out() == 1);
+        spec.preprocess();
+
+        // The special case when the Boolean chain to be synthesized
+        // consists entirely of trivial functions.
+        if (spec.nr_triv == spec.get_nr_out()) {
+            c.reset(spec.get_nr_in(), spec.get_nr_out(), 0, spec.fanin);
+            c.set_output(0, (spec.triv_func(0) << 1) + (spec.out_inv & 1));
+            return success;
+        }
+
+        std::vector<partial_dag> ordered_dags;
+        auto pdags = &dags;
+        if (filter) {
+            ordered_dags = dags;
+            filter->set_spec(spec);
+            filter->apply(ordered_dags);
+            pdags = &ordered_dags;
+        }
+        // The workers stop after the first size at which a chain is
+        // found, so the DAGs are tried in order of increasing size.
+        std::vector<const partial_dag*> sorted_dags;
+        for (const auto& dag : *pdags) {
+            sorted_dags.push_back(&dag);
+        }
+        std::stable_sort(sorted_dags.begin(), sorted_dags.end(),
+            [](const partial_dag* a, const partial_dag* b) {
+                return a->nr_vertices() < b->nr_vertices();
+            });
+
+        cegar_cex_pool pool;
+        return pd_cegar_synthesize_parallel_impl(spec, c, num_threads, pool,
+            make_solver, make_encoder,
+            [&](moodycamel::ConcurrentQueue<partial_dag>& q,
+                std::atomic<int>& size_found) {
+                for (const auto dag : sorted_dags) {
+                    if (size_found != PD_SIZE_CONST) {
+                        break;
+                    }
+                    while (!q.try_enqueue(*dag) && size_found == PD_SIZE_CONST) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+    }
+
+    /// Same as pd_ser_synthesize_parallel, but the workers use the CEGAR
+    /// encoding of each DAG, and share the counterexamples that refuted
+    /// earlier DAGs. The DAGs are streamed from the serialized files of
+    /// increasing size, so that they never need to be in memory all at
+    /// once.
+    inline synth_result
+    pd_ser_cegar_synthesize_parallel(
+        spec& spec,
+        chain& c,
+        int num_threads = std::thread::hardware_concurrency(),
+        std::string file_prefix = "",
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<partial_dag_encoder>& make_encoder = nullptr)
+    {
+        assert(spec.get_nr_in() >= spec.fanin);
+        assert(spec.get_nr_out() == 1);
+        spec.preprocess();
+
+        // The special case when the Boolean chain to be synthesized
+        // consists entirely of trivial functions.
+        if (spec.nr_triv == spec.get_nr_out()) {
+            c.reset(spec.get_nr_in(), spec.get_nr_out(), 0, spec.fanin);
+            c.set_output(0, (spec.triv_func(0) << 1) + (spec.out_inv & 1));
+            return success;
+        }
+
+        cegar_cex_pool pool;
+        const auto initial_steps = spec.initial_steps;
+        return pd_cegar_synthesize_parallel_impl(spec, c, num_threads, pool,
+            make_solver, make_encoder,
+            [&](moodycamel::ConcurrentQueue<partial_dag>& q,
+                std::atomic<int>& size_found) {
+                partial_dag g;
+                for (int nr_steps = initial_steps;
+                        size_found == PD_SIZE_CONST; nr_steps++) {
+                    const auto filename = file_prefix + "pd" +
+                        std::to_string(nr_steps) + ".bin";
+                    auto fhandle = fopen(filename.c_str(), "rb");
+                    if (fhandle == NULL) {
+                        fprintf(stderr, "Error: unable to open file %s\n",
+                                filename.c_str());
+                        break;
+                    }
+                    while (size_found == PD_SIZE_CONST &&
+                            read_partial_dag(g, 2, fhandle)) {
+                        while (!q.try_enqueue(g) && size_found == PD_SIZE_CONST) {
+                            std::this_thread::yield();
+                        }
+                    }
+                    fclose(fhandle);
+                }
+            });
+    }
+            
+    /// Places the fences for spec.nr_steps steps on the queue of the
+    /// parallel fence-based synthesizers.
+    inline void
+    pf_dispatch_fences(
+        spec& spec,
+        moodycamel::ConcurrentQueue<fence>& q,
+        const bool& found,
+        structure_stats* stats,
+        structure_filter* filter)
+    {
+        if (stats || filter) {
+            // Discard the fences that cannot lead to a solution, and
+            // dispatch the ones that are most likely to be
+            // satisfiable first.
+            std::vector<fence> fences;
+            generate_fences(spec, fences);
+            if (filter) {
+                filter->apply(fences);
+            }
+            if (stats) {
+                stats->order(spec, fences);
+            }
+            for (const auto& f : fences) {
+                while (!found && !q.try_enqueue(f)) {
+                    std::this_thread::yield();
+                }
+                if (found) {
+                    break;
                 }
-                if (status == success) {
-                    encoder.extract_chain(spec, g, chain);
-                    fclose(fhandle);
-                    return success;
+            }
+        } else {
+            // Stop generating once a solution is found, since the worker
+            // threads no longer empty the queue.
+            iter_fence_generator gen;
+            fence f;
+            for (int l = 1; l <= spec.nr_steps && !found; l++) {
+                gen.reset(spec.nr_steps, l, spec.get_nr_out(), spec.fanin);
+                while (!found && gen.next_fence(f)) {
+                    while (!found && !q.try_enqueue(f)) {
+                        std::this_thread::yield();
+                    }
                 }
             }
-            fclose(fhandle);
-            spec.nr_steps++;
         }
-
-        return failure;
     }
 
-    /// Same as pd_ser_synthesize, but parallel.  
-    inline synth_result pd_ser_synthesize_parallel(
-        spec& spec,
-        chain& c,
+    inline synth_result
+    pf_fence_synthesize(
+        spec& spec, 
+        chain& c, 
         int num_threads = std::thread::hardware_concurrency(),
-        std::string file_prefix ="")
+        structure_stats* stats = nullptr,
+        structure_filter* filter = nullptr,
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<ssv_fence2_encoder>& make_encoder = nullptr)
     {
-        assert(spec.get_nr_in() >= spec.fanin);
         spec.preprocess();
 
         // The special case when the Boolean chain to be synthesized
@@ -835,111 +1933,100 @@ namespace percy
             return success;
         }
 
+        if (filter) {
+            filter->set_spec(spec);
+        }
+
         std::vector<std::thread> threads(num_threads);
-        moodycamel::ConcurrentQueue<partial_dag> q(num_threads * 3);
+
+        moodycamel::ConcurrentQueue<fence> q(num_threads * 3);
+
         bool finished_generating = false;
         bool* pfinished = &finished_generating;
-        int size_found = PD_SIZE_CONST;
-        int* psize_found = &size_found;
+        bool found = false;
+        bool* pfound = &found;
         std::mutex found_mutex;
 
-        for (int i = 0; i < num_threads; i++) {
-            threads[i] = std::thread([&spec, psize_found, pfinished, &found_mutex, &c, &q] {
-                percy::spec local_spec = spec;
-                bsat_wrapper solver;
-                partial_dag_encoder encoder(solver);
-                partial_dag dag;
+        spec.nr_steps = spec.initial_steps;
+        while (true) {
+            for (int i = 0; i < num_threads; i++) {
+                threads[i] = std::thread([&spec, pfinished, pfound, &found_mutex, &c, &q, stats, i, &make_solver, &make_encoder] {
+                    auto pooled = get_worker_solver(make_solver, i);
+                    auto& solver = *pooled;
+                    auto pencoder = get_worker_encoder(make_encoder, solver, i);
+                    auto& encoder = *pencoder;
+                    fence local_fence;
 
-                while (*psize_found > local_spec.nr_steps) {
-                    if (!q.try_dequeue(dag)) {
-                        if (*pfinished) {
-                            std::this_thread::yield();
-                            if (!q.try_dequeue(dag)) {
-                                break;
+                    while (!(*pfound)) {
+                        if (!q.try_dequeue(local_fence)) {
+                            if (*pfinished) {
+                                std::this_thread::yield();
+                                if (!q.try_dequeue(local_fence)) {
+                                    break;
+                                }
+                            } else {
+                                std::this_thread::yield();
+                                continue;
                             }
-                        } else {
-                            std::this_thread::yield();
+                        }
+                        synth_result status;
+                        const auto start = std::chrono::steady_clock::now();
+                        solver.restart();
+                        if (!encoder.encode(spec, local_fence)) {
                             continue;
                         }
-                    }
-                    local_spec.nr_steps = dag.nr_vertices();
-                    synth_result status;
-                    solver.restart();
-                    if (!encoder.encode(local_spec, dag)) {
-                        continue;
-                    }
-                    while (true) {
-                        status = solver.solve(10);
-                        if (status == failure) {
-                            break;
-                        } else if (status == success) {
-                            std::lock_guard<std::mutex> vlock(found_mutex);
-                            if (*psize_found > local_spec.nr_steps) {
-                                encoder.extract_chain(local_spec, dag, c);
-                                *psize_found = local_spec.nr_steps;
+                        do {
+                            status = solver.solve(10);
+                            if (*pfound) {
+                                break;
+                            } else if (status == success) {
+                                std::lock_guard<std::mutex> vlock(found_mutex);
+                                if (!(*pfound)) {
+                                    encoder.extract_chain(spec, c);
+                                    *pfound = true;
+                                }
                             }
-                            break;
-                        } else if (*psize_found <= local_spec.nr_steps) {
-                            // Another thread found a solution that's
-                            // better or equal to this one.
-                            break;
+                        } while (status == timeout);
+                        if (stats) {
+                            const std::chrono::duration<double> elapsed =
+                                std::chrono::steady_clock::now() - start;
+                            stats->add_result(spec, local_fence, status, elapsed.count());
                         }
                     }
-                }
-            });
-        }
-
-        partial_dag g;
-        spec.nr_steps = spec.initial_steps;
-        while (size_found == PD_SIZE_CONST) {
-            g.reset(2, spec.nr_steps);
-            const auto filename = file_prefix + "pd" + std::to_string(spec.nr_steps) + ".bin";
-            auto fhandle = fopen(filename.c_str(), "rb");
-            if (fhandle == NULL) {
-                fprintf(stderr, "Error: unable to open PD file\n");
-                break;
+                });
             }
+            pf_dispatch_fences(spec, q, found, stats, filter);
+            finished_generating = true;
 
-            int buf;
-            while (fread(&buf, sizeof(int), 1, fhandle) != 0) {
-                for (int i = 0; i < spec.nr_steps; i++) {
-                    auto read = fread(&buf, sizeof(int), 1, fhandle);
-                    assert(read > 0);
-                    auto fanin1 = buf;
-                    read = fread(&buf, sizeof(int), 1, fhandle);
-                    assert(read > 0);
-                    auto fanin2 = buf;
-                    g.set_vertex(i, fanin1, fanin2);
-                }
-                while (!q.try_enqueue(g)) {
-                    if (size_found == PD_SIZE_CONST) {
-                        std::this_thread::yield();
-                    } else {
-                        break;
-                    }
-                }
-                if (size_found != PD_SIZE_CONST) {
-                    break;
-                }
+            for (auto& thread : threads) {
+                thread.join();
             }
-            fclose(fhandle);
+            if (found) {
+                break;
+            }
+            finished_generating = false;
             spec.nr_steps++;
         }
-        finished_generating = true;
-        for (auto& thread : threads) {
-            thread.join();
-        }
-        spec.nr_steps = size_found;
 
-        return size_found == PD_SIZE_CONST ? failure : success;
+        return success;
     }
-            
+    
+    /// Parallel version of fence_cegar_synthesize. The worker threads
+    /// start from an encoding without truth table clauses, and only add
+    /// the clauses for the minterms at which their candidate chains
+    /// violate one of the outputs. This keeps the encodings small for
+    /// specifications with many inputs.
     inline synth_result
-    pf_fence_synthesize(
+    pf_fence_cegar_synthesize(
         spec& spec, 
         chain& c, 
-        int num_threads = std::thread::hardware_concurrency())
+        int num_threads = std::thread::hardware_concurrency(),
+        structure_stats* stats = nullptr,
+        structure_filter* filter = nullptr,
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<ssv_fence2_encoder>& make_encoder = nullptr)
     {
+        assert(spec.get_nr_in() >= spec.fanin);
         spec.preprocess();
 
         // The special case when the Boolean chain to be synthesized
@@ -953,6 +2040,10 @@ namespace percy
             return success;
         }
 
+        if (filter) {
+            filter->set_spec(spec);
+        }
+
         std::vector<std::thread> threads(num_threads);
 
         moodycamel::ConcurrentQueue<fence> q(num_threads * 3);
@@ -966,10 +2057,19 @@ namespace percy
         spec.nr_steps = spec.initial_steps;
         while (true) {
             for (int i = 0; i < num_threads; i++) {
-                threads[i] = std::thread([&spec, pfinished, pfound, &found_mutex, &c, &q] {
-                    bsat_wrapper solver;
-                    ssv_fence2_encoder encoder(solver);
+                threads[i] = std::thread([&spec, pfinished, pfound, &found_mutex, &c, &q, stats, i, &make_solver, &make_encoder] {
+                    auto pooled = get_worker_solver(make_solver, i);
+                    auto& solver = *pooled;
+                    auto pencoder = get_worker_encoder(make_encoder, solver, i);
+                    auto& encoder = *pencoder;
+                    encoder.reset_sim_tts(spec.nr_in);
                     fence local_fence;
+                    const auto add_minterm = [&](int t) {
+                        return encoder.create_tt_clauses(spec, t);
+                    };
+                    const auto compute_diff = [&](kitty::dynamic_truth_table& diff) {
+                        encoder.simulation_difference(spec, diff);
+                    };
 
                     while (!(*pfound)) {
                         if (!q.try_dequeue(local_fence)) {
@@ -983,27 +2083,50 @@ namespace percy
                                 continue;
                             }
                         }
-                        synth_result status;
+                        // Remains a timeout if another thread finds a
+                        // solution before this fence is decided.
+                        synth_result result = timeout;
+                        const auto start = std::chrono::steady_clock::now();
                         solver.restart();
-                        if (!encoder.encode(spec, local_fence)) {
+                        if (!encoder.cegar_encode(spec, local_fence)) {
                             continue;
                         }
-                        do {
-                            status = solver.solve(10);
-                            if (*pfound) {
+                        if (!cegar_seed(spec, solver, add_minterm)) {
+                            continue;
+                        }
+                        while (!(*pfound)) {
+                            const auto status = solver.solve(10);
+                            if (status == timeout) {
+                                continue;
+                            } else if (status == failure) {
+                                result = failure;
                                 break;
-                            } else if (status == success) {
+                            }
+                            const auto first_one = encoder.find_counterexample(spec);
+                            if (first_one == -1) {
+                                result = success;
                                 std::lock_guard<std::mutex> vlock(found_mutex);
                                 if (!(*pfound)) {
                                     encoder.extract_chain(spec, c);
                                     *pfound = true;
                                 }
+                                break;
                             }
-                        } while (status == timeout);
+                            if (!cegar_refine(spec, solver, first_one,
+                                        compute_diff, add_minterm)) {
+                                result = failure;
+                                break;
+                            }
+                        }
+                        if (stats && result != timeout) {
+                            const std::chrono::duration<double> elapsed =
+                                std::chrono::steady_clock::now() - start;
+                            stats->add_result(spec, local_fence, result, elapsed.count());
+                        }
                     }
                 });
             }
-            generate_fences(spec, q);
+            pf_dispatch_fences(spec, q, found, stats, filter);
             finished_generating = true;
 
             for (auto& thread : threads) {
@@ -1032,8 +2155,8 @@ namespace percy
         switch (synth_method) {
         case SYNTH_FENCE:
             return pf_fence_synthesize(spec, chain);
-//        case SYNTH_FENCE_CEGAR:
-//            return pf_fence_cegar_synthesize(spec, chain, solver, encoder);
+        case SYNTH_FENCE_CEGAR:
+            return pf_fence_cegar_synthesize(spec, chain);
         default:
             fprintf(stderr, "Error: synthesis method %d not supported\n", synth_method);
             exit(1);
@@ -1053,6 +2176,208 @@ namespace percy
         return synthesize(spec, chain, *solver, *encoder, method);
     }
 
+    /***************************************************************************
+        Generates a family of formulas on which to tune a solver: for each
+        of nr_functions random functions of nr_in variables, the encodings
+        of its synthesis problem with up to two steps fewer than optimum.
+        Fence encodings are generated for every fence of those sizes, up to
+        max_fences per size. Trivial functions are skipped. Only the SSV,
+        MSV, DITT and fence encoders are supported.
+    ***************************************************************************/
+    inline std::vector<cnf_formula>
+    generate_tuning_instances(
+        int nr_in,
+        int nr_functions,
+        EncoderType enc_type = ENC_SSV,
+        int max_fences = 8,
+        int seed = 1)
+    {
+        std::vector<cnf_formula> instances;
+        switch (enc_type) {
+        case ENC_SSV:
+        case ENC_MSV:
+        case ENC_DITT:
+        case ENC_FENCE:
+            break;
+        default:
+            fprintf(stderr, "Error: encoder type %d not supported\n", enc_type);
+            return instances;
+        }
+
+        kitty::dynamic_truth_table tt(nr_in);
+        for (int i = 0; i < nr_functions; i++) {
+            kitty::create_random(tt, seed + i);
+            spec spec;
+            spec[0] = tt;
+            chain c;
+            if (synthesize(spec, c) != success) {
+                continue;
+            }
+            const auto opt = c.get_nr_steps();
+            for (int k = std::max(1, opt - 2); k <= opt; k++) {
+                if (enc_type != ENC_FENCE) {
+                    cnf_formula formula;
+                    auto encoder = get_encoder(formula, enc_type);
+                    spec.nr_steps = k;
+                    if (static_cast<std_encoder&>(*encoder).encode(spec)) {
+                        instances.push_back(std::move(formula));
+                    }
+                    continue;
+                }
+                auto fences = generate_fences(k, true, spec.get_nr_out());
+                if (int(fences.size()) > max_fences) {
+                    fences.resize(max_fences);
+                }
+                for (const auto& f : fences) {
+                    cnf_formula formula;
+                    ssv_fence_encoder encoder(formula);
+                    spec.nr_steps = k;
+                    if (encoder.encode(spec, f)) {
+                        instances.push_back(std::move(formula));
+                    }
+                }
+            }
+        }
+        return instances;
+    }
+
+    /***************************************************************************
+        Searches for the parameter values of a solver backend that need the
+        fewest conflicts on a family of formulas, e.g. the formulas that an
+        encoder produces for related functions. Each candidate is run with
+        several seeds, which shuffle the order of the clauses and set the
+        random seed of solvers that have one, and formulas that exceed the
+        conflict limit count twice the limit. Every round mutates the best
+        profile so far into one candidate per thread.
+    ***************************************************************************/
+    class solver_tuner
+    {
+    private:
+        std::vector<cnf_formula>& instances;
+        std::mt19937 rng;
+
+        solver_profile mutate(const solver_profile& profile)
+        {
+            const auto& params = get_solver_params(profile.type);
+            auto candidate = profile;
+            std::uniform_int_distribution<int> param_dist(0, int(params.size()) - 1);
+            std::uniform_real_distribution<double> real_dist(0.0, 1.0);
+            const auto nr_changes = 1 + (real_dist(rng) < 0.5);
+            for (int i = 0; i < nr_changes; i++) {
+                const auto idx = param_dist(rng);
+                const auto& param = params[idx];
+                auto value = candidate.values[idx];
+                if (real_dist(rng) < 0.3) {
+                    // Jump anywhere in the range.
+                    value = param.min_value +
+                        real_dist(rng) * (param.max_value - param.min_value);
+                } else {
+                    // Take a step of up to a fifth of the range.
+                    value += (real_dist(rng) - 0.5) * 0.4 *
+                        (param.max_value - param.min_value);
+                }
+                value = std::max(param.min_value, std::min(param.max_value, value));
+                if (param.is_integer) {
+                    value = std::round(value);
+                }
+                candidate.values[idx] = value;
+            }
+            return candidate;
+        }
+
+    public:
+        int nr_seeds = 3;
+        int conflict_limit = 100000;
+        int verbosity = 0;
+
+        solver_tuner(std::vector<cnf_formula>& instances, int seed = 1) :
+            instances(instances), rng(seed)
+        {
+        }
+
+        /// Returns the total number of conflicts of solvers with the given
+        /// profile on all instances and seeds.
+        int64_t evaluate(const solver_profile& profile) const
+        {
+            int64_t total_conflicts = 0;
+            std::vector<int> order;
+            for (int seed = 0; seed < nr_seeds; seed++) {
+                std::mt19937 order_rng(seed);
+                for (auto& instance : instances) {
+                    auto solver = get_solver(profile);
+                    if (seed > 0 && profile.type == SLV_BSAT2) {
+                        static_cast<bsat_wrapper&>(*solver).set_random_seed(
+                                91648253 + seed);
+                    }
+                    order.resize(instance.nr_clauses());
+                    for (std::size_t i = 0; i < order.size(); i++) {
+                        order[i] = int(i);
+                    }
+                    if (seed > 0) {
+                        std::shuffle(order.begin(), order.end(), order_rng);
+                    }
+                    if (!instance.add_to(*solver, &order)) {
+                        continue;
+                    }
+                    const auto status = solver->solve(conflict_limit);
+                    total_conflicts += status == timeout ?
+                        2 * int64_t(conflict_limit) : solver->nr_conflicts();
+                }
+            }
+            return total_conflicts;
+        }
+
+        /// Improves the given profile over a number of rounds, evaluating
+        /// nr_threads candidates in parallel in each round.
+        solver_profile tune(const solver_profile& start, int nr_rounds,
+                int nr_threads, int64_t* best_score = nullptr)
+        {
+            auto best = start;
+            auto score = evaluate(best);
+            const auto start_score = score;
+            if (verbosity) {
+                printf("default: %lld conflicts\n", (long long)score);
+            }
+            if (get_solver_params(start.type).empty()) {
+                nr_rounds = 0;
+            }
+
+            std::vector<solver_profile> candidates;
+            std::vector<int64_t> scores(nr_threads);
+            for (int round = 0; round < nr_rounds; round++) {
+                candidates.clear();
+                for (int i = 0; i < nr_threads; i++) {
+                    candidates.push_back(mutate(best));
+                }
+                std::vector<std::thread> threads;
+                for (int i = 0; i < nr_threads; i++) {
+                    threads.emplace_back([this, i, &candidates, &scores] {
+                        scores[i] = evaluate(candidates[i]);
+                    });
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+                for (int i = 0; i < nr_threads; i++) {
+                    if (scores[i] < score) {
+                        score = scores[i];
+                        best = candidates[i];
+                    }
+                }
+                if (verbosity) {
+                    printf("round %d: %lld conflicts (%.1f%% of default)\n",
+                            round + 1, (long long)score,
+                            start_score ? 100.0 * score / start_score : 100.0);
+                }
+            }
+            if (best_score) {
+                *best_score = score;
+            }
+            best.name = start.name;
+            return best;
+        }
+    };
+
     inline synth_result
     next_solution(
         spec& spec, 
@@ -1139,6 +2464,139 @@ namespace percy
         return failure;
     }
 
+    /***************************************************************************
+        Enumerates the optimum chains of a specification, like repeated
+        calls of next_solution, but with a cost per solution that does not
+        grow with the number of solutions. After the first solution the
+        solver is bookmarked, and the blocking clauses are recorded. Every
+        compact_interval solutions, the solver is rolled back and given
+        the blocking clauses again, which drops the learned clauses that
+        have piled up. Solvers without bookmarks are never compacted.
+
+        With structural set, all chains with the structure of a solution
+        are blocked at once. A solution store can filter out chains that
+        are equivalent to ones reported before.
+    ***************************************************************************/
+    class solution_enumerator
+    {
+    private:
+        spec& spec_;
+        solver_wrapper& solver;
+        enumerating_encoder& encoder;
+        SynthMethod synth_method;
+        cnf_formula blocking_log;
+        bool started = false;
+        bool can_compact = false;
+        int nr_blocked = 0;
+        enum_stats stats;
+
+        bool compact()
+        {
+            solver.rollback();
+            nr_blocked = 0;
+            stats.nr_compactions++;
+            return blocking_log.add_to(solver);
+        }
+
+        synth_result next_chain(chain& chain)
+        {
+            if (!started) {
+                started = true;
+                synth_result status;
+                switch (synth_method) {
+                case SYNTH_STD:
+                case SYNTH_STD_CEGAR:
+                    status = std_synthesize(spec_, chain, solver,
+                            dynamic_cast<std_encoder&>(encoder));
+                    break;
+                case SYNTH_FENCE:
+                    status = fence_synthesize(spec_, chain, solver,
+                            dynamic_cast<fence_encoder&>(encoder));
+                    break;
+                default:
+                    fprintf(stderr, "Error: solution enumeration not supported for synth method %d\n", synth_method);
+                    exit(1);
+                }
+                if (status == success && compact_interval > 0 &&
+                        spec_.nr_triv != spec_.get_nr_out() &&
+                        solver.bookmark()) {
+                    can_compact = true;
+                    blocking_log.restart();
+                    blocking_log.set_nr_vars(solver.nr_vars());
+                    encoder.set_blocking_log(&blocking_log);
+                }
+                return status;
+            }
+
+            // A chain of trivial functions is the only solution.
+            if (spec_.nr_triv == spec_.get_nr_out()) {
+                return failure;
+            }
+            if (can_compact && nr_blocked >= compact_interval && !compact()) {
+                return failure;
+            }
+            const auto blocked = structural ?
+                encoder.block_struct_solution(spec_) :
+                encoder.block_solution(spec_);
+            if (!blocked) {
+                return failure;
+            }
+            nr_blocked++;
+            const auto status = solver.solve(spec_.conflict_limit);
+            if (status == success) {
+                encoder.extract_chain(spec_, chain);
+            }
+            return status;
+        }
+
+    public:
+        bool structural = false;
+        int compact_interval = ENUM_COMPACT_INTERVAL; ///< 0 disables compaction
+        solution_store* store = nullptr;
+
+        solution_enumerator(
+            spec& spec,
+            solver_wrapper& solver,
+            enumerating_encoder& encoder,
+            SynthMethod synth_method = SYNTH_STD) :
+            spec_(spec), solver(solver), encoder(encoder),
+            synth_method(synth_method)
+        {
+        }
+
+        ~solution_enumerator()
+        {
+            encoder.set_blocking_log(nullptr);
+        }
+
+        /// Finds the next solution. Returns failure when all solutions
+        /// have been found.
+        synth_result next(chain& chain)
+        {
+            const auto begin = std::chrono::steady_clock::now();
+            while (true) {
+                const auto status = next_chain(chain);
+                if (status != success) {
+                    return status;
+                }
+                if (store && !store->insert(chain)) {
+                    stats.nr_duplicates++;
+                    continue;
+                }
+                break;
+            }
+            stats.add_solution(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - begin).count());
+            return success;
+        }
+
+        const enum_stats& get_stats() const
+        {
+            return stats;
+        }
+    };
+
     inline synth_result
     maj_synthesize(
         spec& spec, 
@@ -1462,7 +2920,9 @@ namespace percy
     parallel_maj_synthesize(
         spec& spec,
         mig& mig,
-        int num_threads = std::thread::hardware_concurrency())
+        int num_threads = std::thread::hardware_concurrency(),
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<maj_encoder>& make_encoder = nullptr)
     {
         spec.preprocess();
 
@@ -1486,13 +2946,19 @@ namespace percy
         bool* pfound = &found;
         std::mutex found_mutex;
 
+        // The workers use ABC's Glucose unless a factory is given.
+        const solver_factory make_worker_solver = make_solver ? make_solver :
+            [](int) { return std::unique_ptr<solver_wrapper>(new bmcg_wrapper); };
+
         spec.fanin = 3;
         spec.nr_steps = spec.initial_steps;
         while (true) {
             for (int i = 0; i < num_threads; i++) {
-                threads[i] = std::thread([&spec, pfinished, pfound, &found_mutex, &mig, &q] {
-                    bmcg_wrapper solver;
-                    maj_encoder encoder(solver);
+                threads[i] = std::thread([&spec, pfinished, pfound, &found_mutex, &mig, &q, i, &make_worker_solver, &make_encoder] {
+                    auto pooled = get_worker_solver(make_worker_solver, i);
+                    auto& solver = *pooled;
+                    auto pencoder = get_worker_encoder(make_encoder, solver, i);
+                    auto& encoder = *pencoder;
                     fence local_fence;
                     encoder.reset_sim_tts(spec.nr_in);
 
@@ -1539,7 +3005,9 @@ namespace percy
                                 }
                             } while (status == timeout);
 
-                            if (status == failure) {
+                            // A timeout means that another thread found a
+                            // solution, and there is no model to simulate.
+                            if (status != success) {
                                 break;
                             }
                             iMint = encoder.fence_simulate(spec);
@@ -1574,7 +3042,9 @@ namespace percy
     parallel_nocegar_maj_synthesize(
         spec& spec, 
         mig& mig, 
-        int num_threads = std::thread::hardware_concurrency())
+        int num_threads = std::thread::hardware_concurrency(),
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<maj_encoder>& make_encoder = nullptr)
     {
         spec.preprocess();
 
@@ -1598,13 +3068,19 @@ namespace percy
         bool* pfound = &found;
         std::mutex found_mutex;
 
+        // The workers use ABC's Glucose unless a factory is given.
+        const solver_factory make_worker_solver = make_solver ? make_solver :
+            [](int) { return std::unique_ptr<solver_wrapper>(new bmcg_wrapper); };
+
         spec.fanin = 3;
         spec.nr_steps = spec.initial_steps;
         while (true) {
             for (int i = 0; i < num_threads; i++) {
-                threads[i] = std::thread([&spec, pfinished, pfound, &found_mutex, &mig, &q] {
-                    bmcg_wrapper solver;
-                    maj_encoder encoder(solver);
+                threads[i] = std::thread([&spec, pfinished, pfound, &found_mutex, &mig, &q, i, &make_worker_solver, &make_encoder] {
+                    auto pooled = get_worker_solver(make_worker_solver, i);
+                    auto& solver = *pooled;
+                    auto pencoder = get_worker_encoder(make_encoder, solver, i);
+                    auto& encoder = *pencoder;
                     fence local_fence;
 
                     while (!(*pfound)) {
@@ -1817,7 +3293,9 @@ namespace percy
         spec& spec,
         mig& m,
         int num_threads = std::thread::hardware_concurrency(),
-        std::string file_prefix ="")
+        std::string file_prefix ="",
+        const solver_factory& make_solver = nullptr,
+        const encoder_factory<maj_encoder>& make_encoder = nullptr)
     {
         assert(spec.get_nr_in() >= spec.fanin);
         spec.preprocess();
@@ -1842,10 +3320,12 @@ namespace percy
         std::mutex found_mutex;
 
         for (int i = 0; i < num_threads; i++) {
-            threads[i] = std::thread([&spec, psize_found, pfinished, &found_mutex, &m, &q] {
+            threads[i] = std::thread([&spec, psize_found, pfinished, &found_mutex, &m, &q, i, &make_solver, &make_encoder] {
                 percy::spec local_spec = spec;
-                bsat_wrapper solver;
-                maj_encoder encoder(solver);
+                auto pooled = get_worker_solver(make_solver, i);
+                auto& solver = *pooled;
+                auto pencoder = get_worker_encoder(make_encoder, solver, i);
+                auto& encoder = *pencoder;
                 partial_dag dag;
 
                 while (*psize_found > local_spec.nr_steps) {
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "spec.hpp"
+#include "solvers.hpp"
+
+namespace percy
+{
+    /// A tunable parameter of a solver backend, with the range that the
+    /// tuner searches and the value that the backend uses by default.
+    struct solver_param
+    {
+        const char* name;
+        double min_value;
+        double max_value;
+        double default_value;
+        bool is_integer;
+        void (*apply)(solver_wrapper& solver, double value);
+    };
+
+    /// Returns the tunable parameters of a solver backend, which is empty
+    /// for backends that cannot be configured.
+    inline const std::vector<solver_param>&
+    get_solver_params(SolverType type)
+    {
+        static const std::vector<solver_param> bsat_params = {
+            { "nLearntStart", 1000, 40000, LEARNT_MAX_START_DEFAULT, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<bsat_wrapper&>(s).set_nLearntStart(int(v));
+                } },
+            { "nLearntDelta", 100, 10000, LEARNT_MAX_INCRE_DEFAULT, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<bsat_wrapper&>(s).set_nLearntDelta(int(v));
+                } },
+            { "nLearntRatio", 10, 100, LEARNT_MAX_RATIO_DEFAULT, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<bsat_wrapper&>(s).set_nLearntRatio(int(v));
+                } },
+            { "fNoRestarts", 0, 1, 0, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<bsat_wrapper&>(s).set_fNoRestarts(int(v));
+                } },
+            { "VarActType", 0, 2, 0, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<bsat_wrapper&>(s).set_VarActType(int(v));
+                } },
+            { "ClaActType", 0, 1, 0, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<bsat_wrapper&>(s).set_ClaActType(int(v));
+                } },
+        };
+#ifdef USE_SATOKO
+        static const std::vector<solver_param> satoko_params = {
+            { "f_rst", 0.6, 0.95, 0.8, false,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_f_rst(v);
+                } },
+            { "b_rst", 1.1, 2.0, 1.4, false,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_b_rst(v);
+                } },
+            { "fst_block_rst", 1000, 40000, 10000, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_fst_block_rst(unsigned(v));
+                } },
+            { "n_conf_fst_reduce", 500, 10000, 2000, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_n_conf_fst_reduce(unsigned(v));
+                } },
+            { "inc_reduce", 50, 2000, 300, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_inc_reduce(unsigned(v));
+                } },
+            { "inc_special_reduce", 200, 5000, 1000, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_inc_special_reduce(unsigned(v));
+                } },
+            { "lbd_freeze_clause", 5, 60, 30, true,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_lbd_freeze_clause(unsigned(v));
+                } },
+            { "learnt_ratio", 0.2, 0.9, 0.5, false,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_learnt_ratio(float(v));
+                } },
+            { "var_decay", 0.75, 0.99, 0.95, false,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_var_decay(v);
+                } },
+            { "clause_decay", 0.99, 0.9999, 0.995, false,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_clause_decay(float(v));
+                } },
+            { "garbage_max_ratio", 0.1, 0.6, 0.3, false,
+                [](solver_wrapper& s, double v) {
+                    static_cast<satoko_wrapper&>(s).set_garbage_max_ratio(float(v));
+                } },
+        };
+#endif
+        static const std::vector<solver_param> no_params;
+
+        switch (type) {
+        case SLV_BSAT2:
+            return bsat_params;
+#ifdef USE_SATOKO
+        case SLV_SATOKO:
+            return satoko_params;
+#endif
+        default:
+            return no_params;
+        }
+    }
+
+    /***************************************************************************
+        A named set of parameter values for a solver backend. Profiles are
+        stored as text files, which start with the name of the profile and
+        the solver type, followed by one parameter per line:
+
+            name bsat_ssv_4
+            solver SLV_BSAT2
+            nLearntStart 10000
+            ...
+
+        Parameters that do not appear in a file keep their default values.
+    ***************************************************************************/
+    class solver_profile
+    {
+    public:
+        std::string name;
+        SolverType type;
+        std::vector<double> values;
+
+        solver_profile(SolverType type = SLV_BSAT2, const char* name = "default") :
+            name(name), type(type)
+        {
+            for (const auto& param : get_solver_params(type)) {
+                values.push_back(param.default_value);
+            }
+        }
+
+        /// Sets a parameter by its name. Returns false if the backend
+        /// has no such parameter.
+        bool set(const char* param_name, double value)
+        {
+            const auto& params = get_solver_params(type);
+            for (std::size_t i = 0; i < params.size(); i++) {
+                if (strcmp(params[i].name, param_name) == 0) {
+                    values[i] = value;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// Configures a solver of the profile's type. Must be called
+        /// before variables are added to the solver.
+        void apply(solver_wrapper& solver) const
+        {
+            const auto& params = get_solver_params(type);
+            for (std::size_t i = 0; i < params.size(); i++) {
+                params[i].apply(solver, values[i]);
+            }
+            if (type == SLV_BSAT2) {
+                // The activity types take effect when the activities are
+                // initialized.
+                static_cast<bsat_wrapper&>(solver).init_activities();
+            }
+        }
+
+        /// Configures only the parameters whose values differ from the
+        /// defaults of the backend, e.g. to restore tuned values after a
+        /// solver has been varied.
+        void apply_tuned(solver_wrapper& solver) const
+        {
+            const auto& params = get_solver_params(type);
+            auto tuned = false;
+            for (std::size_t i = 0; i < params.size(); i++) {
+                if (values[i] != params[i].default_value) {
+                    params[i].apply(solver, values[i]);
+                    tuned = true;
+                }
+            }
+            if (tuned && type == SLV_BSAT2) {
+                static_cast<bsat_wrapper&>(solver).init_activities();
+            }
+        }
+
+        void print(FILE* f = stdout) const
+        {
+            const auto& params = get_solver_params(type);
+            fprintf(f, "name %s\n", name.c_str());
+            fprintf(f, "solver %s\n", SolverTypeToString[type]);
+            for (std::size_t i = 0; i < params.size(); i++) {
+                fprintf(f, "%s %.17g\n", params[i].name, values[i]);
+            }
+        }
+
+        bool write(const char* filename) const
+        {
+            auto fhandle = fopen(filename, "w");
+            if (fhandle == NULL) {
+                fprintf(stderr, "Error: unable to open %s\n", filename);
+                return false;
+            }
+            print(fhandle);
+            fclose(fhandle);
+            return true;
+        }
+
+        bool read(const char* filename)
+        {
+            auto fhandle = fopen(filename, "r");
+            if (fhandle == NULL) {
+                fprintf(stderr, "Error: unable to open %s\n", filename);
+                return false;
+            }
+            char key[64];
+            char value[256];
+            auto line = 0;
+            auto ok = true;
+            while (ok && fscanf(fhandle, "%63s %255s", key, value) == 2) {
+                line++;
+                if (strcmp(key, "name") == 0) {
+                    name = value;
+                } else if (strcmp(key, "solver") == 0) {
+                    ok = false;
+                    for (int t = 0; t < SLV_TOTAL; t++) {
+                        if (strcmp(value, SolverTypeToString[t]) == 0) {
+                            *this = solver_profile(SolverType(t), name.c_str());
+                            ok = true;
+                        }
+                    }
+                } else {
+                    ok = set(key, atof(value));
+                }
+                if (!ok) {
+                    fprintf(stderr, "Error: invalid entry \"%s %s\" on line "
+                            "%d of %s\n", key, value, line, filename);
+                }
+            }
+            fclose(fhandle);
+            return ok;
+        }
+    };
+}
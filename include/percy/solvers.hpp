@@ -10,4 +10,6 @@
 #endif
 #ifdef USE_SATOKO
 #include "solvers/satoko.hpp"
-#endif
\ No newline at end of file
+#endif
+#include "solvers/portfolio.hpp"
+#include "solvers/external.hpp"
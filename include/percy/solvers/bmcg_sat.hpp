@@ -40,8 +40,7 @@ namespace percy
 
         int nr_vars()
         {
-            // Not currently supported
-            return -1;
+            return pabc::bmcg_sat_solver_varnum(solver);
         }
 
         int nr_clauses()
@@ -95,5 +94,36 @@ namespace percy
             }
         }
 
+        bool final_conflict(std::vector<pabc::lit>& lits)
+        {
+            // The solver reports the final conflict as a clause, which
+            // consists of the negations of the failed assumptions.
+            int* conflict = NULL;
+            const auto size = pabc::bmcg_sat_solver_final(solver, &conflict);
+            lits.clear();
+            for (int i = 0; i < size; i++) {
+                lits.push_back(pabc::Abc_LitNot(conflict[i]));
+            }
+            return true;
+        }
+
+        int minimize_assumptions(std::vector<pabc::lit>& lits,
+                int conflict_limit = 0)
+        {
+            // The conflict budget is shared by all calls of the
+            // minimization.
+            pabc::bmcg_sat_solver_set_conflict_budget(solver, conflict_limit);
+            return pabc::bmcg_sat_solver_minimize_assumptions(solver,
+                    lits.data(), lits.size(), 0);
+        }
+
+        void copy_model(std::vector<uint8_t>& model)
+        {
+            model.resize(pabc::bmcg_sat_solver_varnum(solver));
+            for (int i = 0; i < int(model.size()); i++) {
+                model[i] = pabc::bmcg_sat_solver_read_cex_varvalue(solver, i);
+            }
+        }
+
     };
 }
@@ -9,6 +9,12 @@ namespace percy
     private:
         pabc::sat_solver * solver = NULL;
 
+        double get_activity(int var) const
+        {
+            return solver->VarActType == 0 ? double(solver->activity[var]) :
+                pabc::Abc_Word2Dbl(solver->activity[var]);
+        }
+
     public:
         bsat_wrapper()
         {
@@ -26,6 +32,28 @@ namespace percy
             pabc::sat_solver_restart(solver);
         }
 
+        bool bookmark()
+        {
+            // The bookmark has to be taken with all level 0 assignments
+            // propagated.
+            if (!pabc::sat_solver_simplify(solver)) {
+                return false;
+            }
+            pabc::sat_solver_bookmark(solver);
+            return true;
+        }
+
+        void rollback()
+        {
+            // A clause that made the formula unsatisfiable may have left
+            // assignments on the trail without propagating them. They
+            // are undone along with the rest of the trail.
+            solver->qhead = solver->qtail;
+            pabc::sat_solver_rollback(solver);
+            // Count conflicts from the rollback on, as after a restart.
+            solver->stats.conflicts = 0;
+        }
+
         void set_nr_vars(int nr_vars)
         {
             pabc::sat_solver_setnvars(solver, nr_vars);
@@ -92,6 +120,87 @@ namespace percy
             }
         }
 
+        bool final_conflict(std::vector<pabc::lit>& lits)
+        {
+            // The solver reports the final conflict as a clause, which
+            // consists of the negations of the failed assumptions.
+            int* conflict = NULL;
+            const auto size = pabc::sat_solver_final(solver, &conflict);
+            lits.clear();
+            for (int i = 0; i < size; i++) {
+                lits.push_back(pabc::Abc_LitNot(conflict[i]));
+            }
+            return true;
+        }
+
+        int minimize_assumptions(std::vector<pabc::lit>& lits,
+                int conflict_limit = 0)
+        {
+            return pabc::sat_solver_minimize_assumptions(solver, lits.data(),
+                    lits.size(), conflict_limit);
+        }
+
+        void copy_model(std::vector<uint8_t>& model)
+        {
+            model.resize(pabc::sat_solver_nvars(solver));
+            for (int i = 0; i < int(model.size()); i++) {
+                model[i] = solver->model[i] == pabc::l_True;
+            }
+        }
+
+        bool save_heuristics(std::vector<uint8_t>& phases,
+                std::vector<double>& activities)
+        {
+            const auto nr_vars = pabc::sat_solver_nvars(solver);
+            phases.resize(nr_vars);
+            activities.resize(nr_vars);
+            if (solver->VarActType > 1) {
+                return false;
+            }
+            auto min_act = std::numeric_limits<double>::max();
+            auto max_act = std::numeric_limits<double>::lowest();
+            for (int i = 0; i < nr_vars; i++) {
+                phases[i] = solver->polarity[i];
+                activities[i] = get_activity(i);
+                min_act = std::min(min_act, activities[i]);
+                max_act = std::max(max_act, activities[i]);
+            }
+            for (auto& act : activities) {
+                act = max_act > min_act ? (act - min_act) / (max_act - min_act) : 0;
+            }
+            return true;
+        }
+
+        void load_heuristics(const std::vector<int>& vars,
+                const std::vector<uint8_t>& phases,
+                const std::vector<double>& activities)
+        {
+            if (solver->VarActType > 1) {
+                return;
+            }
+            const auto var_inc = solver->VarActType == 0 ?
+                double(solver->var_inc) : pabc::Abc_Word2Dbl(solver->var_inc);
+            for (std::size_t i = 0; i < vars.size(); i++) {
+                const auto var = vars[i];
+                solver->polarity[var] = phases[i];
+                const auto act = get_activity(var) +
+                    activities[i] * WARM_START_BUMPS * var_inc;
+                solver->activity[var] = solver->VarActType == 0 ?
+                    pabc::word(act) : pabc::Abc_Dbl2Word(act);
+            }
+
+            // Restores the order of the decision heap. An array that is
+            // sorted by decreasing activity is a valid heap.
+            auto heap = pabc::veci_begin(&solver->order);
+            const auto heap_size = pabc::veci_size(&solver->order);
+            std::sort(heap, heap + heap_size, [this](int x, int y) {
+                return solver->activity[x] > solver->activity[y];
+            });
+            for (int i = 0; i < heap_size; i++) {
+                solver->orderpos[heap[i]] = i;
+            }
+        }
+
         void set_nLearntMax(int nLearntMax)
         {
             solver->nLearntMax = nLearntMax;
@@ -142,5 +251,20 @@ namespace percy
             solver_init_activities(solver);
         }
 
+        /// Calls fnct with every clause that the solver learns.
+        void set_learnt_callback(void* data,
+                void (*fnct)(void*, pabc::lit*, pabc::lit*))
+        {
+            pabc::sat_solver_set_learnt_func(solver, data, fnct);
+        }
+
+        /// Makes a running call to solve give up at its next conflict.
+        /// Must be called from the thread that runs the solver, e.g. from
+        /// its learned clause callback.
+        void interrupt()
+        {
+            solver->nConfLimit = 1;
+        }
+
     };
 }
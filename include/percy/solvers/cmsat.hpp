@@ -24,12 +24,31 @@ namespace percy
     {
     private:
         CMSat::SATSolver * solver = NULL;
+        /// CryptoMiniSat cannot be reset in place, so it is only recreated
+        /// if something was added since it was created.
+        bool dirty = false;
+        int nr_threads = std::thread::hardware_concurrency();
+
+        /// The literals of the clause or the assumptions that are passed
+        /// to the solver. They are kept per instance, so that solvers in
+        /// different threads do not share them and adding a clause does
+        /// not allocate.
+        std::vector<CMSat::Lit> clause_buffer;
+        std::vector<CMSat::Lit> assumption_buffer;
+
+        static void to_cmsat(const pabc::lit* begin, const pabc::lit* end,
+                std::vector<CMSat::Lit>& lits)
+        {
+            lits.clear();
+            for (auto i = begin; i < end; i++) {
+                lits.push_back(CMSat::Lit(pabc::Abc_Lit2Var(*i), pabc::Abc_LitIsCompl(*i)));
+            }
+        }
 
     public:
         cmsat_wrapper()
         {
             solver = new CMSat::SATSolver;
-            auto nr_threads = std::thread::hardware_concurrency();
             solver->set_num_threads(nr_threads);
         }
 
@@ -41,25 +60,38 @@ namespace percy
 
         void restart()
         {
+            if (!dirty) {
+                return;
+            }
+            dirty = false;
             delete solver;
             solver = new CMSat::SATSolver;
-            auto nr_threads = std::thread::hardware_concurrency();
             solver->set_num_threads(nr_threads);
         }
 
+        /// Sets the number of threads of the solver, e.g. to one when it
+        /// runs inside a parallel synthesizer. CryptoMiniSat only accepts
+        /// this before variables are added, so the solver is recreated.
+        void set_nr_threads(int nr_threads)
+        {
+            this->nr_threads = std::max(1, nr_threads);
+            dirty = false;
+            delete solver;
+            solver = new CMSat::SATSolver;
+            solver->set_num_threads(this->nr_threads);
+        }
+
         void set_nr_vars(int nr_vars)
         {
+            dirty = true;
             solver->new_vars(nr_vars);
         }
 
         int add_clause(pabc::lit* begin, pabc::lit* end)
         {
-            static std::vector<CMSat::Lit> clause;
-            clause.clear();
-            for (auto i = begin; i < end; i++) {
-                clause.push_back(CMSat::Lit(pabc::Abc_Lit2Var(*i), pabc::Abc_LitIsCompl(*i)));
-            }
-            return solver->add_clause(clause);
+            dirty = true;
+            to_cmsat(begin, end, clause_buffer);
+            return solver->add_clause(clause_buffer);
         }
 
         int var_value(int var)
@@ -69,11 +101,12 @@ namespace percy
 
         synth_result solve(int cl) 
         {
-            std::vector<CMSat::Lit> assumps;
+            assumption_buffer.clear();
+            dirty = true;
             if (cl > 0) {
                 solver->set_max_confl(cl);
             }
-            auto res = solver->solve(&assumps);
+            auto res = solver->solve(&assumption_buffer);
             if (res == CMSat::boolToLBool(true)) {
                 return success;
             } else if (res == CMSat::boolToLBool(false)) {
@@ -85,15 +118,12 @@ namespace percy
 
         synth_result solve(pabc::lit* begin, pabc::lit* end, int cl)
         {
-            static std::vector<CMSat::Lit> assumps;
-            assumps.clear();
-            for (auto i = begin; i < end; i++) {
-                assumps.push_back(CMSat::Lit(pabc::Abc_Lit2Var(*i), pabc::Abc_LitIsCompl(*i)));
-            }
+            to_cmsat(begin, end, assumption_buffer);
+            dirty = true;
             if (cl > 0) {
                 solver->set_max_confl(cl);
             }
-            auto res = solver->solve(&assumps);
+            auto res = solver->solve(&assumption_buffer);
             if (res == CMSat::boolToLBool(true)) {
                 return success;
             } else if (res == CMSat::boolToLBool(false)) {
@@ -103,6 +133,26 @@ namespace percy
             }
         }
 
+        bool final_conflict(std::vector<pabc::lit>& lits)
+        {
+            // The solver reports the final conflict as a clause, which
+            // consists of the negations of the failed assumptions.
+            lits.clear();
+            for (const auto& l : solver->get_conflict()) {
+                lits.push_back(pabc::Abc_Var2Lit(l.var(), !l.sign()));
+            }
+            return true;
+        }
+
+        void copy_model(std::vector<uint8_t>& model)
+        {
+            const auto& values = solver->get_model();
+            model.resize(values.size());
+            for (std::size_t i = 0; i < values.size(); i++) {
+                model[i] = values[i] == CMSat::boolToLBool(true);
+            }
+        }
+
         int nr_conflicts()
         {
             // TODO: check if we can now do this with CMSat.
@@ -122,6 +172,7 @@ namespace percy
 
         void add_var()
         {
+            dirty = true;
             solver->new_var();
         }
 
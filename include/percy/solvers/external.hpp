@@ -0,0 +1,469 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "solver_wrapper.hpp"
+
+namespace percy
+{
+    /// The number of bytes of DIMACS text that are written to an external
+    /// solver at once.
+    const int EXTERNAL_CHUNK_SIZE = 1 << 16;
+
+    /// The interval (in ms) at which a running external solver is checked
+    /// for interruptions.
+    const int EXTERNAL_POLL_INTERVAL = 20;
+
+    /// Creates a pipe whose ends are closed in the processes that are
+    /// started from the current one. Without pipe2, the flags are set
+    /// after the pipe is created, so the caller must hold the lock of
+    /// get_external_fork_mutex until it has started its process.
+    inline bool external_pipe(int fds[2])
+    {
+#ifdef __linux__
+        return pipe2(fds, O_CLOEXEC) == 0;
+#else
+        if (pipe(fds) != 0) {
+            return false;
+        }
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return true;
+#endif
+    }
+
+    /// Serializes the creation of pipes and processes of external
+    /// solvers in different threads on systems without pipe2.
+    inline std::mutex& get_external_fork_mutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    /***************************************************************************
+        Solves formulas with an external solver executable, which runs in
+        its own process for every call to solve. The formula is streamed to
+        the standard input of the solver in DIMACS format, and the result
+        is read from its standard output in the format of the SAT
+        competitions: an "s SATISFIABLE" or "s UNSATISFIABLE" line, and "v"
+        lines with the model. Exit codes 10 and 20 are understood as well.
+
+        The solver runs in a process group of its own, which is killed with
+        all the processes that the solver started if it exceeds the time
+        limit or is interrupted, and when it exits. Exceeding the memory
+        limit makes it fail in its own process. In all these cases, if it
+        crashes or reports no result, and if it keeps running after it has
+        closed its output, solve returns timeout. Conflict limits are ignored. Assumptions are passed as unit
+        clauses, so no final conflicts are reported.
+    ***************************************************************************/
+    class external_wrapper : public solver_wrapper
+    {
+    private:
+        std::vector<std::string> command;
+        int time_limit = 0;
+        int memory_limit = 0;
+        int nr_vars_ = 0;
+        std::vector<pabc::lit> clause_lits;
+        std::vector<std::size_t> clause_ends;
+        std::vector<uint8_t> model;
+        std::atomic<bool> interrupted;
+
+        /// The DIMACS text of the formula that is being streamed, which
+        /// is produced a chunk at a time.
+        struct dimacs_stream
+        {
+            const external_wrapper* solver;
+            const pabc::lit* assumptions;
+            int nr_assumptions;
+            std::size_t next_clause = 0;
+            int next_assumption = 0;
+            bool header_done = false;
+            std::string buffer;
+            std::size_t pos = 0;
+
+            void add_lit(pabc::lit l)
+            {
+                const auto var = pabc::Abc_Lit2Var(l) + 1;
+                buffer += std::to_string(pabc::Abc_LitIsCompl(l) ? -var : var);
+                buffer += ' ';
+            }
+
+            /// Makes the next chunk available. Returns false if the
+            /// whole formula has been written.
+            bool fill()
+            {
+                if (pos < buffer.size()) {
+                    return true;
+                }
+                buffer.clear();
+                pos = 0;
+                if (!header_done) {
+                    header_done = true;
+                    buffer += "p cnf " + std::to_string(solver->nr_vars_) + " " +
+                        std::to_string(solver->clause_ends.size() + nr_assumptions) + "\n";
+                }
+                const auto& ends = solver->clause_ends;
+                while (next_clause < ends.size() &&
+                        int(buffer.size()) < EXTERNAL_CHUNK_SIZE) {
+                    const auto begin = next_clause == 0 ? 0 : ends[next_clause - 1];
+                    for (auto i = begin; i < ends[next_clause]; i++) {
+                        add_lit(solver->clause_lits[i]);
+                    }
+                    buffer += "0\n";
+                    next_clause++;
+                }
+                while (next_assumption < nr_assumptions &&
+                        int(buffer.size()) < EXTERNAL_CHUNK_SIZE) {
+                    add_lit(assumptions[next_assumption++]);
+                    buffer += "0\n";
+                }
+                return !buffer.empty();
+            }
+        };
+
+        /// Reads the result from the output of the solver.
+        synth_result parse_output(const std::string& output, int status)
+        {
+            auto result = timeout;
+            model.assign(nr_vars_, 0);
+            std::size_t line = 0;
+            while (line < output.size()) {
+                auto end = output.find('\n', line);
+                if (end == std::string::npos) {
+                    end = output.size();
+                }
+                const auto text = output.c_str() + line;
+                if (strncmp(text, "s SATISFIABLE", 13) == 0) {
+                    result = success;
+                } else if (strncmp(text, "s UNSATISFIABLE", 15) == 0) {
+                    result = failure;
+                } else if (text[0] == 'v') {
+                    const char* p = text + 1;
+                    char* next;
+                    while (p < output.c_str() + end) {
+                        const auto l = strtol(p, &next, 10);
+                        if (next == p) {
+                            break;
+                        }
+                        const auto var = std::labs(l) - 1;
+                        if (var >= 0 && var < nr_vars_) {
+                            model[var] = l > 0;
+                        }
+                        p = next;
+                    }
+                }
+                line = end + 1;
+            }
+            if (result == timeout && WIFEXITED(status)) {
+                if (WEXITSTATUS(status) == 10) {
+                    result = success;
+                } else if (WEXITSTATUS(status) == 20) {
+                    result = failure;
+                }
+            }
+            return result;
+        }
+
+        synth_result run(const pabc::lit* begin, const pabc::lit* end)
+        {
+            if (command.empty()) {
+                fprintf(stderr, "Error: no external solver set\n");
+                return timeout;
+            }
+            // The child may only make async-signal-safe calls, so its
+            // arguments are prepared here.
+            std::vector<char*> args;
+            for (auto& arg : command) {
+                args.push_back(const_cast<char*>(arg.c_str()));
+            }
+            args.push_back(nullptr);
+            struct rlimit limit;
+            limit.rlim_cur = limit.rlim_max = rlim_t(memory_limit) << 20;
+
+            // Other threads may start processes of their own, which must
+            // not inherit the ends of the pipes: a solver whose input is
+            // still open elsewhere never sees its end.
+#ifdef __linux__
+            std::unique_lock<std::mutex> fork_lock;
+#else
+            std::unique_lock<std::mutex> fork_lock(get_external_fork_mutex());
+#endif
+            int to_child[2];
+            int from_child[2];
+            if (!external_pipe(to_child)) {
+                fprintf(stderr, "Error: unable to create pipe\n");
+                return timeout;
+            }
+            if (!external_pipe(from_child)) {
+                fprintf(stderr, "Error: unable to create pipe\n");
+                close(to_child[0]);
+                close(to_child[1]);
+                return timeout;
+            }
+
+            const auto pid = fork();
+            if (pid == 0) {
+                setpgid(0, 0);
+                dup2(to_child[0], STDIN_FILENO);
+                dup2(from_child[1], STDOUT_FILENO);
+                if (memory_limit > 0) {
+                    setrlimit(RLIMIT_AS, &limit);
+                }
+                execvp(args[0], args.data());
+                const char msg[] = "Error: unable to run external solver\n";
+                (void)!write(STDERR_FILENO, msg, sizeof(msg) - 1);
+                _exit(127);
+            }
+            if (pid > 0) {
+                // Also set here, so that the group exists before the
+                // parent may kill it.
+                setpgid(pid, pid);
+            }
+            if (fork_lock.owns_lock()) {
+                fork_lock.unlock();
+            }
+            close(to_child[0]);
+            close(from_child[1]);
+            if (pid < 0) {
+                fprintf(stderr, "Error: unable to start %s\n", args[0]);
+                close(to_child[1]);
+                close(from_child[0]);
+                return timeout;
+            }
+
+            // A solver that stops reading its input would raise SIGPIPE,
+            // which is blocked for this thread while the formula is
+            // written.
+            sigset_t sigpipe, old_mask;
+            sigemptyset(&sigpipe);
+            sigaddset(&sigpipe, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &sigpipe, &old_mask);
+
+            auto in_fd = to_child[1];
+            const auto out_fd = from_child[0];
+            fcntl(in_fd, F_SETFL, fcntl(in_fd, F_GETFL) | O_NONBLOCK);
+            fcntl(out_fd, F_SETFL, fcntl(out_fd, F_GETFL) | O_NONBLOCK);
+
+            dimacs_stream input;
+            input.solver = this;
+            input.assumptions = begin;
+            input.nr_assumptions = int(end - begin);
+            std::string output;
+            char chunk[4096];
+            auto finished = false;
+            const auto deadline = std::chrono::steady_clock::now() +
+                std::chrono::milliseconds(time_limit);
+            while (!finished && !interrupted) {
+                auto wait = EXTERNAL_POLL_INTERVAL;
+                if (time_limit > 0) {
+                    const auto left =
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            deadline - std::chrono::steady_clock::now()).count();
+                    if (left <= 0) {
+                        break;
+                    }
+                    wait = int(std::min<int64_t>(wait, left));
+                }
+                struct pollfd fds[2];
+                fds[0].fd = out_fd;
+                fds[0].events = POLLIN;
+                fds[1].fd = in_fd;
+                fds[1].events = POLLOUT;
+                if (poll(fds, in_fd >= 0 ? 2 : 1, wait) < 0 && errno != EINTR) {
+                    break;
+                }
+                if (in_fd >= 0 && fds[1].revents) {
+                    if (!input.fill()) {
+                        // The end of the input tells the solver to start.
+                        close(in_fd);
+                        in_fd = -1;
+                    } else {
+                        const auto n = write(in_fd, input.buffer.data() + input.pos,
+                                input.buffer.size() - input.pos);
+                        if (n > 0) {
+                            input.pos += n;
+                        } else if (n < 0 && errno != EAGAIN && errno != EINTR) {
+                            close(in_fd);
+                            in_fd = -1;
+                        }
+                    }
+                }
+                if (fds[0].revents) {
+                    const auto n = read(out_fd, chunk, sizeof(chunk));
+                    if (n > 0) {
+                        output.append(chunk, n);
+                    } else if (n == 0 ||
+                            (errno != EAGAIN && errno != EINTR)) {
+                        finished = true;
+                    }
+                }
+            }
+            if (in_fd >= 0) {
+                close(in_fd);
+            }
+            close(out_fd);
+            // A solver that has closed its output may still be running.
+            // Its exit is awaited without reaping it, so that its process
+            // group cannot be reused before it is killed.
+            while (finished) {
+                siginfo_t info;
+                info.si_pid = 0;
+                if (waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+                if (info.si_pid != 0) {
+                    break;
+                }
+                if (interrupted || (time_limit > 0 &&
+                            std::chrono::steady_clock::now() >= deadline)) {
+                    finished = false;
+                    break;
+                }
+                std::this_thread::sleep_for(
+                        std::chrono::milliseconds(EXTERNAL_POLL_INTERVAL));
+            }
+            // Stops the solver, if it is still running, and any processes
+            // that it started.
+            kill(-pid, SIGKILL);
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+            }
+
+            sigset_t pending;
+            sigpending(&pending);
+            if (sigismember(&pending, SIGPIPE) &&
+                    !sigismember(&old_mask, SIGPIPE)) {
+                int sig;
+                sigwait(&sigpipe, &sig);
+            }
+            pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+
+            if (!finished) {
+                return timeout;
+            }
+            return parse_output(output, status);
+        }
+
+    public:
+        /// command holds the executable and its arguments. The executable
+        /// is searched for in the PATH if it does not contain a slash.
+        external_wrapper(const std::vector<std::string>& command = {}) :
+            command(command), interrupted(false)
+        {
+        }
+
+        void set_command(const std::vector<std::string>& command)
+        {
+            this->command = command;
+        }
+
+        /// Sets the wall-clock time (in ms) after which the solver is
+        /// killed, or 0 for no limit.
+        void set_time_limit(int time_limit)
+        {
+            this->time_limit = time_limit;
+        }
+
+        /// Sets the size of the address space of the solver (in MB), or 0
+        /// for no limit.
+        void set_memory_limit(int memory_limit)
+        {
+            this->memory_limit = memory_limit;
+        }
+
+        /// Kills the solver that is running, which makes solve return
+        /// timeout. If no solver is running, the next call to solve
+        /// returns timeout right away. May be called from another thread.
+        void interrupt()
+        {
+            interrupted = true;
+        }
+
+        void restart()
+        {
+            nr_vars_ = 0;
+            clause_lits.clear();
+            clause_ends.clear();
+            model.clear();
+        }
+
+        void reserve(int nr_vars, int nr_clauses)
+        {
+            (void)nr_vars;
+            clause_ends.reserve(nr_clauses);
+        }
+
+        void set_nr_vars(int nr_vars)
+        {
+            nr_vars_ = nr_vars;
+        }
+
+        int nr_vars()
+        {
+            return nr_vars_;
+        }
+
+        int nr_clauses()
+        {
+            return int(clause_ends.size());
+        }
+
+        int nr_conflicts()
+        {
+            return 0;
+        }
+
+        void add_var()
+        {
+            nr_vars_++;
+        }
+
+        int add_clause(pabc::lit* begin, pabc::lit* end)
+        {
+            clause_lits.insert(clause_lits.end(), begin, end);
+            clause_ends.push_back(clause_lits.size());
+            return 1;
+        }
+
+        int var_value(int var)
+        {
+            return var < int(model.size()) ? model[var] : 0;
+        }
+
+        synth_result solve(int cl)
+        {
+            return solve(nullptr, nullptr, cl);
+        }
+
+        synth_result solve(pabc::lit* begin, pabc::lit* end, int)
+        {
+            // The flag is cleared only after the run, so that an interrupt
+            // that arrives before it starts is not lost.
+            const auto res = interrupted ? timeout : run(begin, end);
+            interrupted = false;
+            return res;
+        }
+    };
+}
+
+#endif
@@ -35,7 +35,78 @@ namespace percy
     private:
         GWType* solver;
         int nr_threads = 0;
-        
+
+        /// The literals of the clause or the assumptions that are passed
+        /// to the solver. They are kept per instance, so that solvers in
+        /// different threads do not share them and adding a clause does
+        /// not allocate.
+        Glucose::vec<Glucose::Lit> clause_buffer;
+        Glucose::vec<Glucose::Lit> assumption_buffer;
+
+        static void to_glucose(const pabc::lit* begin, const pabc::lit* end,
+                Glucose::vec<Glucose::Lit>& lits)
+        {
+            lits.clear();
+            for (auto i = begin; i != end; i++) {
+                lits.push(Glucose::mkLit((*i >> 1), (*i & 1)));
+            }
+        }
+#ifndef USE_GLUCOSE
+        /// Glucose::MultiSolvers cannot be reset in place, so it is only
+        /// recreated if something was added since it was created.
+        bool dirty = false;
+
+        /// Glucose::MultiSolvers does not support assumptions, so the
+        /// clauses are also kept here, and formulas are solved under
+        /// assumptions by a sequential solver that is created on demand.
+        std::vector<pabc::lit> clause_lits;
+        std::vector<std::size_t> clause_ends;
+        Glucose::Solver* assumption_solver = NULL;
+        bool solved_with_assumptions = false;
+
+        void clear_clauses()
+        {
+            clause_lits.clear();
+            clause_ends.clear();
+            delete assumption_solver;
+            assumption_solver = NULL;
+            solved_with_assumptions = false;
+        }
+
+        void create_assumption_solver()
+        {
+            assumption_solver = new Glucose::Solver;
+            for (int i = 0; i < solver->nVars(); i++) {
+                assumption_solver->newVar();
+            }
+            std::size_t begin = 0;
+            for (const auto end : clause_ends) {
+                to_glucose(clause_lits.data() + begin, clause_lits.data() + end,
+                        clause_buffer);
+                assumption_solver->addClause(clause_buffer);
+                begin = end;
+            }
+        }
+
+        /// Returns the model of the last call to solve.
+        const Glucose::vec<Glucose::lbool>& last_model() const
+        {
+            return solved_with_assumptions ? assumption_solver->model : solver->model;
+        }
+#else
+        const Glucose::vec<Glucose::lbool>& last_model() const
+        {
+            return solver->model;
+        }
+#endif
+
+        void set_dirty()
+        {
+#ifndef USE_GLUCOSE
+            dirty = true;
+#endif
+        }
+
     public:
         glucose_wrapper()
         {
@@ -44,29 +115,45 @@ namespace percy
 
         ~glucose_wrapper()
         {
+#ifndef USE_GLUCOSE
+            clear_clauses();
+#endif
             delete solver;
             solver = NULL;
         }
 
         void restart()
         {
+#ifdef USE_GLUCOSE
+            solver->reset();
+#else
+            if (!dirty) {
+                return;
+            }
+            clear_clauses();
             delete solver;
-#ifdef USE_SYRUP
             if (nr_threads > 0) {
                 solver = new GWType(nr_threads);
             } else {
                 solver = new GWType;
             }
-#else
-            solver = new GWType;
+            dirty = false;
 #endif
         }
 
+#ifdef USE_GLUCOSE
+        void reserve(int nr_vars, int nr_clauses)
+        {
+            solver->reserve(nr_vars, nr_clauses);
+        }
+#endif
+
 
         void set_nr_vars(int nr_vars)
         {
+            set_dirty();
             while (nr_vars-- > 0) {
-                solver->newVar();
+                add_var();
             }
         }
 
@@ -92,35 +179,108 @@ namespace percy
 
         int add_clause(pabc::lit* begin, pabc::lit* end)
         {
-            Glucose::vec<Glucose::Lit> litvec;
-            for (auto i = begin; i != end; i++) {
-                litvec.push(Glucose::mkLit((*i >> 1), (*i & 1)));
+            set_dirty();
+            to_glucose(begin, end, clause_buffer);
+#ifndef USE_GLUCOSE
+            clause_lits.insert(clause_lits.end(), begin, end);
+            clause_ends.push_back(clause_lits.size());
+            if (assumption_solver) {
+                assumption_solver->addClause(clause_buffer);
             }
-            return solver->addClause(litvec);
+#endif
+            return solver->addClause(clause_buffer);
         }
 
         void add_var()
         {
+            set_dirty();
             solver->newVar();
+#ifndef USE_GLUCOSE
+            if (assumption_solver) {
+                assumption_solver->newVar();
+            }
+#endif
         }
 
         int var_value(int var)
         {
+            return last_model()[var] == l_True;
+        }
+
+        void copy_model(std::vector<uint8_t>& model)
+        {
+            const auto& values = last_model();
+            model.resize(values.size());
+            for (int i = 0; i < values.size(); i++) {
+                model[i] = values[i] == l_True;
+            }
+        }
+
 #ifdef USE_GLUCOSE
-            return solver->modelValue(var) == l_True;
+        bool save_heuristics(std::vector<uint8_t>& phases,
+                std::vector<double>& activities)
+        {
+            const auto nr_vars = solver->nVars();
+            phases.resize(nr_vars);
+            activities.resize(nr_vars);
+            auto min_act = std::numeric_limits<double>::max();
+            auto max_act = std::numeric_limits<double>::lowest();
+            for (int i = 0; i < nr_vars; i++) {
+                // Glucose decides on the negative literal of a variable
+                // if its polarity is set.
+                phases[i] = !solver->getPolarity(i);
+                activities[i] = solver->varActivity(i);
+                min_act = std::min(min_act, activities[i]);
+                max_act = std::max(max_act, activities[i]);
+            }
+            for (auto& act : activities) {
+                act = max_act > min_act ? (act - min_act) / (max_act - min_act) : 0;
+            }
+            return true;
+        }
+
+        void load_heuristics(const std::vector<int>& vars,
+                const std::vector<uint8_t>& phases,
+                const std::vector<double>& activities)
+        {
+            for (std::size_t i = 0; i < vars.size(); i++) {
+                solver->setPolarity(vars[i], !phases[i]);
+                solver->bumpVarActivity(vars[i], activities[i] * WARM_START_BUMPS);
+            }
+        }
+#endif
+
+        bool final_conflict(std::vector<pabc::lit>& lits)
+        {
+            lits.clear();
+#ifndef USE_GLUCOSE
+            if (!solved_with_assumptions) {
+                // The formula is unsatisfiable without assumptions.
+                return true;
+            }
+            const auto& conflict = assumption_solver->conflict;
 #else
-            return solver->model[var] == l_True;
+            const auto& conflict = solver->conflict;
 #endif
+            // The solver reports the final conflict as a clause, which
+            // consists of the negations of the failed assumptions.
+            for (int i = 0; i < conflict.size(); i++) {
+                lits.push_back(pabc::Abc_Var2Lit(Glucose::var(conflict[i]),
+                            !Glucose::sign(conflict[i])));
+            }
+            return true;
         }
 
         synth_result solve(int cl)
         {
 #ifdef USE_GLUCOSE
-            Glucose::vec<Glucose::Lit> litvec;
+            assumption_buffer.clear();
             if (cl) {
                 solver->setConfBudget(cl);
+            } else {
+                solver->budgetOff();
             }
-            auto res = solver->solveLimited(litvec);
+            auto res = solver->solveLimited(assumption_buffer);
             if (res == l_True) {
                 return success;
             } else if (res == l_False) {
@@ -129,6 +289,8 @@ namespace percy
                 return timeout;
             }
 #else
+            dirty = true;
+            solved_with_assumptions = false;
             int ret2 = solver->simplify();
             solver->use_simplification = false;
             if (ret2) {
@@ -139,8 +301,8 @@ namespace percy
                 return failure;
             }
 
-            // Conflict limits are currently not supported by 
-            // Glucose::MultiSolvers.   
+            // Conflict limits are currently not supported by
+            // Glucose::MultiSolvers.
             auto res = solver->solve();
             if (res == l_True) {
                 return success;
@@ -153,17 +315,28 @@ namespace percy
         }
 
 
-#ifdef USE_GLUCOSE
         synth_result solve(pabc::lit* begin, pabc::lit* end, int cl)
         {
-            Glucose::vec<Glucose::Lit> litvec;
-            for (auto i = begin; i != end; i++) {
-                litvec.push(Glucose::mkLit((*i >> 1), (*i & 1)));
+#ifndef USE_GLUCOSE
+            if (begin == end) {
+                return solve(cl);
             }
+            if (!assumption_solver) {
+                create_assumption_solver();
+            }
+            dirty = true;
+            solved_with_assumptions = true;
+            auto seq_solver = assumption_solver;
+#else
+            auto seq_solver = solver;
+#endif
+            to_glucose(begin, end, assumption_buffer);
             if (cl) {
-                solver->setConfBudget(cl);
+                seq_solver->setConfBudget(cl);
+            } else {
+                seq_solver->budgetOff();
             }
-            auto res = solver->solveLimited(litvec);
+            auto res = seq_solver->solveLimited(assumption_buffer);
             if (res == l_True) {
                 return success;
             } else if (res == l_False) {
@@ -172,19 +345,18 @@ namespace percy
                 return timeout;
             }
         }
-#else
-        synth_result solve(pabc::lit*, pabc::lit*, int cl)
-        {
-            return solve(cl);
-        }
-#endif
 
 #ifdef USE_SYRUP
         void set_nr_threads(int nr_threads)
         {
+            if (nr_threads == this->nr_threads && !dirty) {
+                return;
+            }
+            clear_clauses();
             delete solver;
             this->nr_threads = nr_threads;
             solver = new Glucose::MultiSolvers(nr_threads);
+            dirty = false;
         }
 #endif
     };
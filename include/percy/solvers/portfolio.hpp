@@ -0,0 +1,368 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "solver_wrapper.hpp"
+#include "bsat2.hpp"
+#ifdef USE_SATOKO
+#include "satoko.hpp"
+#endif
+#include "../concurrentqueue.h"
+
+namespace percy
+{
+    /// Learned clauses of up to this many literals are shared between the
+    /// solvers of a portfolio.
+    const int PORTFOLIO_MAX_SHARED_SIZE = 8;
+
+    /// The number of conflicts after which the solvers of a portfolio
+    /// take in the clauses that the others have shared.
+    const int PORTFOLIO_ROUND_CONFLICTS = 1000;
+
+    const int PORTFOLIO_DEFAULT_THREADS = 4;
+
+    /// Gives BSAT solver i of a group that works on related formulas its
+    /// own seed for random decisions, so that the solvers of the group
+    /// explore different parts of the search space.
+    inline void
+    apply_portfolio_variant(bsat_wrapper& solver, int i)
+    {
+        solver.set_random_seed(91648253 + 7919 * i);
+    }
+
+#ifdef USE_SATOKO
+    /// Gives Satoko solver i of a group that works on related formulas
+    /// one of three configurations of its decay and restart parameters.
+    inline void
+    apply_portfolio_variant(satoko_wrapper& solver, int i)
+    {
+        if (i % 3 == 1) {
+            solver.set_var_decay(0.9);
+        } else if (i % 3 == 2) {
+            solver.set_f_rst(0.9);
+            solver.set_b_rst(1.2);
+        }
+    }
+#endif
+
+    /***************************************************************************
+        Solves a formula with several differently configured solvers in
+        parallel, and returns the result of the first one that finishes.
+        The solvers share their short learned clauses through lock-free
+        queues, and take in the clauses of the others after every
+        PORTFOLIO_ROUND_CONFLICTS conflicts. Half of the solvers are
+        Satoko instances if it is available, the others are BSAT instances.
+    ***************************************************************************/
+    class portfolio_wrapper : public solver_wrapper
+    {
+    private:
+        struct shared_clause
+        {
+            int size;
+            std::array<pabc::lit, PORTFOLIO_MAX_SHARED_SIZE> lits;
+        };
+
+        struct member
+        {
+            portfolio_wrapper* portfolio;
+            int idx;
+            std::unique_ptr<solver_wrapper> solver;
+            bsat_wrapper* bsat = nullptr;
+#ifdef USE_SATOKO
+            satoko_wrapper* satoko = nullptr;
+#endif
+            /// Clauses that the other solvers have shared.
+            moodycamel::ConcurrentQueue<shared_clause> inbox;
+            std::vector<shared_clause> imported;
+
+            /// The number of clauses of the portfolio that the solver has.
+            std::size_t nr_clauses = 0;
+            /// Becomes false if adding a clause made the solver find that
+            /// the formula is unsatisfiable.
+            bool ok = true;
+        };
+
+        int nr_threads = PORTFOLIO_DEFAULT_THREADS;
+        int nr_vars_ = 0;
+        std::vector<pabc::lit> clause_lits;
+        std::vector<std::size_t> clause_ends;
+        std::vector<std::unique_ptr<member>> members;
+
+        std::atomic<bool> stopped;
+        std::atomic<int> winner;
+        synth_result winner_status = timeout;
+
+        void create_members()
+        {
+            members.clear();
+            for (int i = 0; i < nr_threads; i++) {
+                auto m = new member;
+                m->portfolio = this;
+                m->idx = i;
+                // Each solver gets its own configuration, so that they
+                // explore different parts of the search space.
+                const auto variant = i / 2;
+#ifdef USE_SATOKO
+                if (i % 2 == 1) {
+                    m->satoko = new satoko_wrapper;
+                    m->solver.reset(m->satoko);
+                    apply_portfolio_variant(*m->satoko, variant);
+                    m->satoko->set_learnt_callback(m, satoko_learnt);
+                    members.emplace_back(m);
+                    continue;
+                }
+#endif
+                m->bsat = new bsat_wrapper;
+                m->solver.reset(m->bsat);
+                apply_portfolio_variant(*m->bsat, i);
+                m->bsat->set_VarActType(variant % 2);
+                m->bsat->init_activities();
+                m->bsat->set_learnt_callback(m, bsat_learnt);
+                members.emplace_back(m);
+            }
+        }
+
+        /// Passes on the variables and clauses that were added to the
+        /// portfolio since the last call.
+        void sync(member& m)
+        {
+            while (m.solver->nr_vars() < nr_vars_) {
+                m.solver->add_var();
+            }
+            auto begin = m.nr_clauses == 0 ? 0 : clause_ends[m.nr_clauses - 1];
+            for (; m.nr_clauses < clause_ends.size(); m.nr_clauses++) {
+                const auto end = clause_ends[m.nr_clauses];
+                if (m.ok && !m.solver->add_clause(clause_lits.data() + begin,
+                            clause_lits.data() + end)) {
+                    m.ok = false;
+                }
+                begin = end;
+            }
+        }
+
+        static void share(member* m, const pabc::lit* begin, int size)
+        {
+            auto portfolio = m->portfolio;
+            if (portfolio->stopped.load(std::memory_order_relaxed)) {
+#ifdef USE_SATOKO
+                if (m->satoko) {
+                    m->satoko->interrupt();
+                    return;
+                }
+#endif
+                m->bsat->interrupt();
+                return;
+            }
+            if (size > PORTFOLIO_MAX_SHARED_SIZE) {
+                return;
+            }
+            shared_clause clause;
+            clause.size = size;
+            std::copy(begin, begin + size, clause.lits.begin());
+            for (auto& other : portfolio->members) {
+                if (other.get() != m) {
+                    other->inbox.enqueue(clause);
+                }
+            }
+        }
+
+        static void bsat_learnt(void* data, pabc::lit* begin, pabc::lit* end)
+        {
+            share(static_cast<member*>(data), begin, int(end - begin));
+        }
+
+        static void satoko_learnt(void* data, unsigned* lits, unsigned size)
+        {
+            share(static_cast<member*>(data),
+                    reinterpret_cast<pabc::lit*>(lits), int(size));
+        }
+
+        /// Adds the clauses that the other solvers have shared. Returns
+        /// false if they make the formula unsatisfiable.
+        bool import(member& m)
+        {
+            m.imported.resize(64);
+            while (true) {
+                const auto nr_clauses = m.inbox.try_dequeue_bulk(
+                        m.imported.begin(), m.imported.size());
+                for (std::size_t i = 0; i < nr_clauses; i++) {
+                    auto& clause = m.imported[i];
+                    if (!m.solver->add_clause(clause.lits.data(),
+                                clause.lits.data() + clause.size)) {
+                        return false;
+                    }
+                }
+                if (nr_clauses < m.imported.size()) {
+                    return true;
+                }
+            }
+        }
+
+        void finish(member& m, synth_result status)
+        {
+            auto expected = -1;
+            if (winner.compare_exchange_strong(expected, m.idx)) {
+                winner_status = status;
+            }
+            stopped = true;
+        }
+
+        void run(member& m, pabc::lit* begin, pabc::lit* end, int cl)
+        {
+            sync(m);
+            const auto start_conflicts = m.solver->nr_conflicts();
+            while (!stopped) {
+                if (!m.ok || !import(m)) {
+                    m.ok = false;
+                    finish(m, failure);
+                    return;
+                }
+                auto budget = PORTFOLIO_ROUND_CONFLICTS;
+                if (cl) {
+                    budget = std::min(budget,
+                            cl - (m.solver->nr_conflicts() - start_conflicts));
+                    if (budget <= 0) {
+                        return;
+                    }
+                }
+                const auto status = m.solver->solve(begin, end, budget);
+                if (status != timeout) {
+                    finish(m, status);
+                    return;
+                }
+            }
+        }
+
+        solver_wrapper& winning_solver()
+        {
+            assert(winner >= 0);
+            return *members[winner]->solver;
+        }
+
+    public:
+        portfolio_wrapper(int nr_threads = PORTFOLIO_DEFAULT_THREADS) :
+            nr_threads(std::max(1, nr_threads)), stopped(false), winner(-1)
+        {
+        }
+
+        /// Sets the number of solvers, each of which runs in its own
+        /// thread.
+        void set_nr_threads(int nr_threads)
+        {
+            this->nr_threads = std::max(1, nr_threads);
+            members.clear();
+        }
+
+        int get_nr_threads() const
+        {
+            return nr_threads;
+        }
+
+        void restart()
+        {
+            nr_vars_ = 0;
+            clause_lits.clear();
+            clause_ends.clear();
+            winner = -1;
+            for (auto& m : members) {
+                m->solver->restart();
+                m->nr_clauses = 0;
+                m->ok = true;
+                shared_clause clause;
+                while (m->inbox.try_dequeue(clause)) {
+                }
+            }
+        }
+
+        void set_nr_vars(int nr_vars)
+        {
+            nr_vars_ = nr_vars;
+        }
+
+        int nr_vars()
+        {
+            return nr_vars_;
+        }
+
+        int nr_clauses()
+        {
+            return int(clause_ends.size());
+        }
+
+        /// Returns the number of conflicts of all solvers together.
+        int nr_conflicts()
+        {
+            auto nr_conflicts = 0;
+            for (auto& m : members) {
+                nr_conflicts += m->solver->nr_conflicts();
+            }
+            return nr_conflicts;
+        }
+
+        void add_var()
+        {
+            nr_vars_++;
+        }
+
+        int add_clause(pabc::lit* begin, pabc::lit* end)
+        {
+            clause_lits.insert(clause_lits.end(), begin, end);
+            clause_ends.push_back(clause_lits.size());
+            return 1;
+        }
+
+        int var_value(int var)
+        {
+            return winning_solver().var_value(var);
+        }
+
+        void copy_model(std::vector<uint8_t>& model)
+        {
+            winning_solver().copy_model(model);
+        }
+
+        bool final_conflict(std::vector<pabc::lit>& lits)
+        {
+            if (winner < 0) {
+                lits.clear();
+                return false;
+            }
+            auto& m = *members[winner];
+            if (!m.ok) {
+                // The formula is unsatisfiable without assumptions.
+                lits.clear();
+                return true;
+            }
+            return m.solver->final_conflict(lits);
+        }
+
+        synth_result solve(int cl)
+        {
+            return solve(nullptr, nullptr, cl);
+        }
+
+        synth_result solve(pabc::lit* begin, pabc::lit* end, int cl)
+        {
+            if (int(members.size()) != nr_threads) {
+                create_members();
+            }
+            stopped = false;
+            winner = -1;
+            winner_status = timeout;
+
+            std::vector<std::thread> threads;
+            for (int i = 1; i < nr_threads; i++) {
+                threads.emplace_back([this, i, begin, end, cl] {
+                    run(*members[i], begin, end, cl);
+                });
+            }
+            run(*members[0], begin, end, cl);
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            return winner_status;
+        }
+    };
+}
@@ -18,6 +18,7 @@ namespace percy
     {
     private:
         satoko::satoko_t * solver = NULL;
+        char no_simplify = 0;
 
     public:
         satoko_wrapper()
@@ -34,6 +35,40 @@ namespace percy
         void restart()
         {
             satoko::satoko_reset(solver);
+            // Bookmarks turn off simplification, which would remove
+            // clauses from before the bookmark.
+            solver->opts.no_simplify = no_simplify;
+        }
+
+        bool bookmark()
+        {
+            if (solver->status != satoko::SATOKO_OK) {
+                return false;
+            }
+            satoko::satoko_bookmark(solver);
+            return true;
+        }
+
+        void rollback()
+        {
+            // Satoko removes the bookmark when it rolls back to it.
+            satoko::satoko_rollback(solver);
+            satoko::satoko_bookmark(solver);
+        }
+
+        void reserve(int nr_vars, int nr_clauses)
+        {
+            // Per-variable state and the clause database. A clause takes
+            // two header words and about three literals.
+            satoko::vec_uint_reserve(solver->levels, nr_vars);
+            satoko::vec_uint_reserve(solver->reasons, nr_vars);
+            satoko::vec_uint_reserve(solver->trail, nr_vars);
+            satoko::vec_char_reserve(solver->assigns, nr_vars);
+            satoko::vec_char_reserve(solver->polarity, nr_vars);
+            satoko::vec_char_reserve(solver->seen, nr_vars);
+            satoko::vec_uint_reserve(solver->originals, nr_clauses);
+            satoko::cdb_grow(solver->all_clauses,
+                    satoko::cdb_size(solver->all_clauses) + 5 * nr_clauses);
         }
 
         void set_nr_vars(int nr_vars)
@@ -95,11 +130,105 @@ namespace percy
             }
         }
 
+        bool final_conflict(std::vector<pabc::lit>& lits)
+        {
+            // The solver reports the final conflict as a clause, which
+            // consists of the negations of the failed assumptions.
+            int* conflict = NULL;
+            const auto size = satoko::satoko_final_conflict(solver, &conflict);
+            lits.clear();
+            for (int i = 0; i < size; i++) {
+                lits.push_back(pabc::Abc_LitNot(conflict[i]));
+            }
+            return true;
+        }
+
+        int minimize_assumptions(std::vector<pabc::lit>& lits,
+                int conflict_limit = 0)
+        {
+            // The minimization solves while some of the assumptions are
+            // still assigned from the previous call, so the solver must
+            // not simplify its clauses in the meantime.
+            const auto no_simplify = solver->opts.no_simplify;
+            solver->opts.no_simplify = 1;
+            const auto size = satoko::satoko_minimize_assumptions(solver,
+                    lits.data(), lits.size(), conflict_limit);
+            solver->opts.no_simplify = no_simplify;
+            return size;
+        }
+
+        void copy_model(std::vector<uint8_t>& model)
+        {
+            model.resize(satoko::satoko_varnum(solver));
+            for (int i = 0; i < int(model.size()); i++) {
+                model[i] = satoko::vec_char_at(solver->polarity, i) ==
+                    satoko::SATOKO_LIT_TRUE;
+            }
+        }
+
+        bool save_heuristics(std::vector<uint8_t>& phases,
+                std::vector<double>& activities)
+        {
+            const auto nr_vars = satoko::satoko_varnum(solver);
+            phases.resize(nr_vars);
+            activities.resize(nr_vars);
+            auto min_act = std::numeric_limits<double>::max();
+            auto max_act = std::numeric_limits<double>::lowest();
+            for (int i = 0; i < nr_vars; i++) {
+                phases[i] = satoko::vec_char_at(solver->polarity, i) ==
+                    satoko::SATOKO_LIT_TRUE;
+                activities[i] = satoko::sdbl2double(
+                        satoko::vec_sdbl_at(solver->activity, i));
+                min_act = std::min(min_act, activities[i]);
+                max_act = std::max(max_act, activities[i]);
+            }
+            for (auto& act : activities) {
+                act = max_act > min_act ? (act - min_act) / (max_act - min_act) : 0;
+            }
+            return true;
+        }
+
+        void load_heuristics(const std::vector<int>& vars,
+                const std::vector<uint8_t>& phases,
+                const std::vector<double>& activities)
+        {
+            for (std::size_t i = 0; i < vars.size(); i++) {
+                const auto var = vars[i];
+                // The polarity of an assigned variable holds its value,
+                // e.g. for units that were propagated while encoding.
+                if (satoko::var_value(solver, var) !=
+                        satoko::SATOKO_VAR_UNASSING) {
+                    continue;
+                }
+                satoko::vec_char_assign(solver->polarity, var, phases[i] ?
+                        satoko::SATOKO_LIT_TRUE : satoko::SATOKO_LIT_FALSE);
+                // Small doubles cannot represent amounts below one.
+                const auto nr_bumps = activities[i] * WARM_START_BUMPS;
+                if (nr_bumps < 1.0) {
+                    continue;
+                }
+                const auto inc = satoko::sdbl_mult(solver->var_act_inc,
+                        satoko::double2sdbl(nr_bumps));
+                satoko::vec_sdbl_assign(solver->activity, var, satoko::sdbl_add(
+                            satoko::vec_sdbl_at(solver->activity, var), inc));
+                if (satoko::heap_in_heap(solver->var_order, var)) {
+                    satoko::heap_decrease(solver->var_order, var);
+                }
+            }
+        }
+
         void set_no_simplify(char no_simplify)
         {
+            this->no_simplify = no_simplify;
             solver->opts.no_simplify = no_simplify;
         }
 
+        /// Returns the options that the solver runs with.
+        const satoko::satoko_opts_t& get_options() const
+        {
+            return solver->opts;
+        }
+
         void set_f_rst(double f_rst)
         {
             solver->opts.f_rst = f_rst;
@@ -184,6 +313,21 @@ namespace percy
         {
             solver->opts.garbage_max_ratio = garbage_max_ratio;
         }
+
+        /// Calls fnct with every clause that the solver learns.
+        void set_learnt_callback(void* data,
+                void (*fnct)(void*, unsigned*, unsigned))
+        {
+            satoko::satoko_set_learnt_func(solver, data, fnct);
+        }
+
+        /// Makes a running call to solve give up at its next conflict.
+        /// Must be called from the thread that runs the solver, e.g. from
+        /// its learned clause callback.
+        void interrupt()
+        {
+            solver->opts.conf_limit = 1;
+        }
     };
 }
 
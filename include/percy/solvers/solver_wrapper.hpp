@@ -8,7 +8,11 @@
 #include <abc/satSolver.h>
 #pragma GCC diagnostic pop
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <thread>
+#include <vector>
 
 namespace percy
 {
@@ -19,6 +23,10 @@ namespace percy
         timeout
     };
 
+    /// The number of activity bumps that a warm-started variable receives
+    /// if it was the most active variable of the previous formula.
+    const int WARM_START_BUMPS = 32;
+
     class solver_wrapper
     {
     public:
@@ -26,7 +34,39 @@ namespace percy
         {
 
         }
+        /// Removes all variables and clauses. Solvers reset in place where
+        /// their backends allow it, so that the memory of the previous
+        /// formula is reused for the next one.
         virtual void restart() = 0;
+
+        /// Marks the current variables and clauses, so that rollback can
+        /// return the solver to them once the clauses that were added
+        /// afterwards have been solved. Returns false if the solver does
+        /// not support bookmarks, in which case callers restart it and
+        /// encode the complete formula instead.
+        virtual bool bookmark()
+        {
+            return false;
+        }
+
+        /// Removes the variables and clauses that were added since the
+        /// last bookmark, along with the clauses learned since then. The
+        /// bookmark stays in place, so that the solver can roll back to
+        /// it again.
+        virtual void rollback()
+        {
+        }
+
+        /// Hints at the size of the formula that is about to be added, so
+        /// that a solver can allocate room for it at once instead of
+        /// growing while clauses are added. nr_clauses is an estimate and
+        /// may be 0 if it is not known.
+        virtual void reserve(int nr_vars, int nr_clauses)
+        {
+            (void)nr_vars;
+            (void)nr_clauses;
+        }
+
         virtual void set_nr_vars(int nr_vars) = 0;
         virtual int  nr_vars() = 0;
         virtual int  nr_clauses() = 0;
@@ -36,6 +76,88 @@ namespace percy
         virtual int  var_value(int var) = 0;
         virtual synth_result solve(int conflict_limit = 0) = 0;
         virtual synth_result solve(pabc::lit* begin, pabc::lit* end, int conflict_limit = 0) = 0;
+
+        /// After a call to solve with assumptions has returned failure,
+        /// stores the assumptions that were used to derive the final
+        /// conflict in lits. Returns false if the solver cannot report
+        /// them, in which case all assumptions may have been involved.
+        virtual bool final_conflict(std::vector<pabc::lit>& lits)
+        {
+            lits.clear();
+            return false;
+        }
+
+        /// Reorders assumptions under which the formula is unsatisfiable,
+        /// so that their first k literals still make it unsatisfiable but
+        /// none of these can be dropped, and returns k. Every solver call
+        /// is limited to conflict_limit conflicts, and a literal is kept
+        /// if the call that tries to drop it times out.
+        virtual int minimize_assumptions(std::vector<pabc::lit>& lits,
+                int conflict_limit = 0)
+        {
+            // Tries to drop one literal at a time. Whenever that succeeds,
+            // the literals outside of the final conflict are dropped as
+            // well. The literals in front of the current one cannot be
+            // dropped, so they are part of every final conflict.
+            std::vector<pabc::lit> conflict;
+            int nr_kept = lits.size();
+            int i = 0;
+            while (i < nr_kept) {
+                std::swap(lits[i], lits[nr_kept - 1]);
+                const auto res = solve(lits.data(),
+                        lits.data() + nr_kept - 1, conflict_limit);
+                if (res != failure) {
+                    std::swap(lits[i], lits[nr_kept - 1]);
+                    i++;
+                    continue;
+                }
+                nr_kept--;
+                if (final_conflict(conflict)) {
+                    const auto last = std::stable_partition(lits.begin(),
+                            lits.begin() + nr_kept, [&](pabc::lit l) {
+                        return std::find(conflict.begin(), conflict.end(),
+                                l) != conflict.end();
+                    });
+                    nr_kept = last - lits.begin();
+                }
+            }
+            return nr_kept;
+        }
+
+        /// Stores the saved phase and the activity of every variable, with
+        /// activities scaled to [0, 1]. Returns false if the solver does
+        /// not expose its decision heuristics.
+        virtual bool save_heuristics(std::vector<uint8_t>& phases,
+                std::vector<double>& activities)
+        {
+            phases.clear();
+            activities.clear();
+            return false;
+        }
+
+        /// Sets the preferred phases of the given variables and raises
+        /// their activities in proportion to the given values in [0, 1],
+        /// so that the search on a new formula starts where the search on
+        /// a related one ended.
+        virtual void load_heuristics(const std::vector<int>& vars,
+                const std::vector<uint8_t>& phases,
+                const std::vector<double>& activities)
+        {
+            (void)vars;
+            (void)phases;
+            (void)activities;
+        }
+
+        /// Copies the values of all variables in the last satisfying
+        /// assignment to model, which is resized to the number of
+        /// variables.
+        virtual void copy_model(std::vector<uint8_t>& model)
+        {
+            model.resize(nr_vars());
+            for (int i = 0; i < int(model.size()); i++) {
+                model[i] = var_value(i);
+            }
+        }
     };
 	
 }
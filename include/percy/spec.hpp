@@ -23,6 +23,7 @@ namespace percy
         SYNTH_FENCE_CEGAR,
         SYNTH_DAG,
         SYNTH_FDAG,
+        SYNTH_ENUM,
         SYNTH_TOTAL
     };
 
@@ -34,6 +35,7 @@ namespace percy
         "SYNTH_FENCE_CEGAR",
         "SYNTH_DAG",
         "SYNTH_FDAG",
+        "SYNTH_ENUM",
     };
 
     enum EncoderType
@@ -61,6 +63,7 @@ namespace percy
         SLV_CMSAT,
         SLV_GLUCOSE,
         SLV_SATOKO,
+        SLV_PORTFOLIO,
         SLV_TOTAL,
     };
 
@@ -70,6 +73,24 @@ namespace percy
         "SLV_CMSAT",
         "SLV_GLUCOSE",
         "SLV_SATOKO",
+        "SLV_PORTFOLIO",
+    };
+
+    /// Strategies to select the counterexamples that refine the formula
+    /// in each round of CEGAR-based synthesis.
+    enum CegarStrategy
+    {
+        CEGAR_FIRST,   ///< Add the first differing minterm
+        CEGAR_FIRST_K, ///< Add the first cegar_nr_minterms differing minterms
+        CEGAR_DIVERSE, ///< Add differing minterms that are far apart in Hamming distance
+        CEGAR_TOTAL
+    };
+
+    const char * const CegarStrategyToString[CEGAR_TOTAL] =
+    {
+        "CEGAR_FIRST",
+        "CEGAR_FIRST_K",
+        "CEGAR_DIVERSE",
     };
 
     enum Primitive
@@ -91,6 +112,9 @@ namespace percy
         int64_t synth_time = 0; ///< How much time was spent on SAT formulae (in us)
         int nr_vars = 0;
         int nr_clauses = 0;
+        int nr_cegar_rounds = 0;   ///< Number of SAT calls made by CEGAR loops
+        int nr_cegar_minterms = 0; ///< Number of minterms added by CEGAR refinement
+        int nr_cegar_clauses = 0;  ///< Number of clauses added by CEGAR refinement, as counted by the solver
     }; 
 
     class spec
@@ -127,6 +151,20 @@ namespace percy
 
             /// Limit on the number of SAT conflicts. Zero means no limit.
             int conflict_limit = 0;
+
+            /// Carries the phases and activities of the solver over from
+            /// one formula to the next when a synthesizer tries several
+            /// related ones, e.g. successive numbers of steps or fences.
+            bool warm_start = false;
+
+            /// Selects the counterexamples added in each CEGAR round.
+            CegarStrategy cegar_strategy = CEGAR_FIRST;
+            /// Number of counterexamples added per CEGAR round by the
+            /// CEGAR_FIRST_K and CEGAR_DIVERSE strategies.
+            int cegar_nr_minterms = 4;
+            /// Number of minterms, chosen far apart in Hamming distance,
+            /// with which CEGAR formulas are seeded before the first round.
+            int nr_rand_tt_assigns = 0;
             
             /// Constructs a spec with one output
             spec()
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <kitty/kitty.hpp>
+#include "spec.hpp"
+#include "fence.hpp"
+#include "partial_dag.hpp"
+
+namespace percy
+{
+
+    /***************************************************************************
+        A pluggable stage of cheap structural checks that discards partial
+        DAGs and fences before any SAT call is made. Every filter must be
+        sound: it may only reject a structure if no chain with that
+        structure can implement the specification. Filters are evaluated in
+        the order in which they were added; the built-in ones come first.
+
+        The filter counts how many structures it checked and how many it
+        pruned. The counters are atomic, so a single filter may be shared
+        by the worker threads of the parallel synthesizers.
+    ***************************************************************************/
+    class structure_filter
+    {
+        public:
+            using pd_filter_fn =
+                std::function<bool(const spec&, const partial_dag&)>;
+            using fence_filter_fn =
+                std::function<bool(const spec&, const fence&)>;
+
+        private:
+            const spec* _spec = nullptr;
+            int _support = 0; /// Nr. of inputs any of the outputs depend on
+            int _max_support = 0; /// Largest support of a single output
+            bool _use_defaults;
+            std::vector<pd_filter_fn> _pd_filters;
+            std::vector<fence_filter_fn> _fence_filters;
+            std::atomic<uint64_t> _nr_checked;
+            std::atomic<uint64_t> _nr_pruned;
+
+            bool passes_default_filters(const partial_dag& dag) const
+            {
+                // Every input in the support has to be read by a gate in
+                // the output cone, and only free fanins can read inputs.
+                // The last vertex is the output of the partial DAG.
+                if (dag.nr_vertices() == 0) {
+                    return _support == 0;
+                }
+                if (nr_pi_fanins_in_output_cone(dag) < _support) {
+                    return false;
+                }
+                // All nontrivial outputs need distinct gates.
+                if (dag.nr_vertices() < _spec->nr_nontriv) {
+                    return false;
+                }
+                return true;
+            }
+
+            bool passes_default_filters(const fence& f) const
+            {
+                // All nontrivial outputs need distinct gates.
+                if (f.nr_nodes() < _spec->nr_nontriv) {
+                    return false;
+                }
+                // A connected cone of m gates with fanin r has at most
+                // m(r-1)+1 fanins that are not connected to other gates in
+                // the cone, so it can read no more than that many inputs.
+                const auto max_pi_reads =
+                    f.nr_nodes() * (_spec->fanin - 1) + 1;
+                if (max_pi_reads < _max_support) {
+                    return false;
+                }
+                if (f.nr_nodes() * _spec->fanin < _support) {
+                    return false;
+                }
+                return true;
+            }
+
+        public:
+            structure_filter(bool use_default_filters = true) :
+                _use_defaults(use_default_filters),
+                _nr_checked(0),
+                _nr_pruned(0)
+            {
+            }
+
+            /// Counts the number of free fanins of vertices that are in
+            /// the transitive fanin cone of the last vertex.
+            static int nr_pi_fanins_in_output_cone(const partial_dag& dag)
+            {
+                bool in_cone[MAX_STEPS] = { false };
+                in_cone[dag.nr_vertices() - 1] = true;
+                auto nr_pi_fanins = 0;
+                for (int i = dag.nr_vertices() - 1; i >= 0; i--) {
+                    if (!in_cone[i]) {
+                        continue;
+                    }
+                    const auto v = dag.get_vertex(i);
+                    for (int j = 0; j < dag.get_fanin(); j++) {
+                        if (v[j] == FANIN_PI) {
+                            nr_pi_fanins++;
+                        } else {
+                            in_cone[v[j] - 1] = true;
+                        }
+                    }
+                }
+                return nr_pi_fanins;
+            }
+
+            /// Sets the specification to filter for. Must be called after
+            /// the specification has been preprocessed, and before any
+            /// structures are checked.
+            void set_spec(const spec& spec)
+            {
+                _spec = &spec;
+                _support = 0;
+                _max_support = 0;
+                std::vector<int> out_support(spec.nr_nontriv, 0);
+                for (int i = 0; i < spec.get_nr_in(); i++) {
+                    auto in_support = false;
+                    for (int h = 0; h < spec.nr_nontriv; h++) {
+                        if (kitty::has_var(spec[spec.synth_func(h)], i)) {
+                            in_support = true;
+                            out_support[h]++;
+                        }
+                    }
+                    if (in_support) {
+                        _support++;
+                    }
+                }
+                for (auto s : out_support) {
+                    _max_support = std::max(_max_support, s);
+                }
+            }
+
+            void add_filter(pd_filter_fn fn)
+            {
+                _pd_filters.push_back(std::move(fn));
+            }
+
+            void add_filter(fence_filter_fn fn)
+            {
+                _fence_filters.push_back(std::move(fn));
+            }
+
+            /// Returns false if the partial DAG can be discarded.
+            bool check(const partial_dag& dag)
+            {
+                assert(_spec != nullptr);
+                _nr_checked++;
+                auto pass = !_use_defaults || passes_default_filters(dag);
+                for (auto i = 0u; pass && i < _pd_filters.size(); i++) {
+                    pass = _pd_filters[i](*_spec, dag);
+                }
+                if (!pass) {
+                    _nr_pruned++;
+                }
+                return pass;
+            }
+
+            /// Returns false if the fence can be discarded.
+            bool check(const fence& f)
+            {
+                assert(_spec != nullptr);
+                _nr_checked++;
+                auto pass = !_use_defaults || passes_default_filters(f);
+                for (auto i = 0u; pass && i < _fence_filters.size(); i++) {
+                    pass = _fence_filters[i](*_spec, f);
+                }
+                if (!pass) {
+                    _nr_pruned++;
+                }
+                return pass;
+            }
+
+            /// Removes the structures that can be discarded, preserving
+            /// the order of the remaining ones.
+            template<typename Structure>
+            void apply(std::vector<Structure>& structures)
+            {
+                structures.erase(
+                    std::remove_if(structures.begin(), structures.end(),
+                        [this] (const Structure& s) { return !check(s); }),
+                    structures.end());
+            }
+
+            uint64_t nr_checked() const
+            {
+                return _nr_checked;
+            }
+
+            uint64_t nr_pruned() const
+            {
+                return _nr_pruned;
+            }
+
+            void reset_counters()
+            {
+                _nr_checked = 0;
+                _nr_pruned = 0;
+            }
+    };
+
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <set>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <kitty/kitty.hpp>
+#include "spec.hpp"
+#include "partial_dag.hpp"
+
+namespace percy
+{
+
+    /***************************************************************************
+        A structural nogood: a set of vertices, each with a fixed index and
+        fixed fanins, such that no partial DAG that contains all of them
+        can implement the specification. If nr_vertices is not -1, the
+        nogood only applies to partial DAGs with that many vertices.
+    ***************************************************************************/
+    struct pd_nogood
+    {
+        int fanin = 2;
+        int nr_vertices = -1;
+        int nr_fixed = 0;
+        int indices[MAX_STEPS];
+        uint8_t fanins[MAX_STEPS][PD_MAX_FANIN];
+
+        void add_vertex(const partial_dag& dag, int i)
+        {
+            assert(nr_fixed < MAX_STEPS);
+            const auto v = dag.get_vertex(i);
+            fanin = dag.get_fanin();
+            indices[nr_fixed] = i;
+            for (int j = 0; j < PD_MAX_FANIN; j++) {
+                fanins[nr_fixed][j] = j < dag.get_fanin() ? v[j] : 0;
+            }
+            nr_fixed++;
+        }
+
+        /// Returns true if dag contains all vertices of the nogood.
+        bool matches(const partial_dag& dag) const
+        {
+            if (nr_vertices != -1 && nr_vertices != dag.nr_vertices()) {
+                return false;
+            }
+            for (int k = 0; k < nr_fixed; k++) {
+                const auto i = indices[k];
+                if (i >= dag.nr_vertices()) {
+                    return false;
+                }
+                const auto v = dag.get_vertex(i);
+                for (int j = 0; j < dag.get_fanin(); j++) {
+                    if (v[j] != fanins[k][j]) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /// Returns true if the nogood fixes every vertex of a DAG of a
+        /// given size.
+        bool is_complete() const
+        {
+            if (nr_vertices != nr_fixed) {
+                return false;
+            }
+            for (int k = 0; k < nr_fixed; k++) {
+                if (indices[k] != k) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// Returns true if every partial DAG matched by other is also
+        /// matched by this nogood.
+        bool subsumes(const pd_nogood& other) const
+        {
+            if (nr_vertices != -1 && nr_vertices != other.nr_vertices) {
+                return false;
+            }
+            for (int k = 0; k < nr_fixed; k++) {
+                auto found = false;
+                for (int l = 0; l < other.nr_fixed && !found; l++) {
+                    found = indices[k] == other.indices[l] &&
+                        std::equal(fanins[k], fanins[k] + PD_MAX_FANIN,
+                                other.fanins[l]);
+                }
+                if (!found) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /***************************************************************************
+        Collects the structural nogoods that are learned from the final
+        conflicts of unsatisfiable partial DAGs during synthesis of a
+        specification, and uses them to discard later partial DAGs
+        without encoding them. The nogoods are specific to the function
+        being synthesized, so the store is cleared when the specification
+        changes.
+
+        A nogood that fixes all vertices of a DAG also holds for the DAGs
+        that are isomorphic to it, since they have the same clauses up to
+        renaming. Such nogoods are stored by canonical representation, so
+        that they prune entire isomorphism classes.
+
+        The store is thread-safe, so it can be shared by the worker threads
+        of the parallel synthesizers.
+    ***************************************************************************/
+    class structure_nogoods
+    {
+        private:
+            std::string spec_key;
+            std::vector<pd_nogood> nogoods;
+#ifndef DISABLE_NAUTY
+            std::set<std::vector<graph>> can_reprs[MAX_STEPS + 1];
+            std::unique_ptr<pd_iso_checker> checkers[MAX_STEPS + 1];
+            size_t nr_can_reprs = 0;
+
+            std::vector<graph> crepr(const partial_dag& dag)
+            {
+                auto& checker = checkers[dag.nr_vertices()];
+                if (!checker) {
+                    checker.reset(new pd_iso_checker(dag.nr_vertices()));
+                }
+                return checker->crepr(dag);
+            }
+#endif
+            uint64_t nr_blocked = 0;
+            mutable std::mutex nogoods_mutex;
+
+            void clear_nogoods()
+            {
+                nogoods.clear();
+#ifndef DISABLE_NAUTY
+                for (auto& reprs : can_reprs) {
+                    reprs.clear();
+                }
+                nr_can_reprs = 0;
+#endif
+            }
+
+            static std::string make_spec_key(const spec& spec)
+            {
+                std::string key = std::to_string(spec.get_nr_in()) + "," +
+                    std::to_string(spec.out_inv) + "," +
+                    std::to_string(spec.add_nontriv_clauses);
+                for (int h = 0; h < spec.get_nr_out(); h++) {
+                    key += "," + kitty::to_hex(spec[h]);
+                }
+                return key;
+            }
+
+        public:
+            /// Prepares the store for synthesis of spec. Nogoods learned
+            /// for other specifications are discarded.
+            void set_spec(const spec& spec)
+            {
+                auto key = make_spec_key(spec);
+                std::lock_guard<std::mutex> lock(nogoods_mutex);
+                if (key != spec_key) {
+                    spec_key = std::move(key);
+                    clear_nogoods();
+                }
+            }
+
+            /// Adds a nogood, unless it is subsumed by a known nogood.
+            /// Known nogoods that it subsumes are removed.
+            void add(const pd_nogood& nogood)
+            {
+                std::lock_guard<std::mutex> lock(nogoods_mutex);
+#ifndef DISABLE_NAUTY
+                if (nogood.is_complete()) {
+                    partial_dag dag(nogood.fanin, nogood.nr_vertices);
+                    for (int i = 0; i < nogood.nr_vertices; i++) {
+                        if (nogood.fanin == 2) {
+                            dag.set_vertex(i, nogood.fanins[i][0],
+                                    nogood.fanins[i][1]);
+                        } else {
+                            dag.set_vertex(i, nogood.fanins[i][0],
+                                    nogood.fanins[i][1], nogood.fanins[i][2]);
+                        }
+                    }
+                    if (can_reprs[dag.nr_vertices()].insert(crepr(dag)).second) {
+                        nr_can_reprs++;
+                    }
+                    return;
+                }
+#endif
+                for (const auto& ng : nogoods) {
+                    if (ng.subsumes(nogood)) {
+                        return;
+                    }
+                }
+                nogoods.erase(
+                    std::remove_if(nogoods.begin(), nogoods.end(),
+                        [&nogood] (const pd_nogood& ng) {
+                            return nogood.subsumes(ng);
+                        }),
+                    nogoods.end());
+                nogoods.push_back(nogood);
+            }
+
+            /// Returns true if dag matches one of the nogoods, in which
+            /// case it cannot implement the specification.
+            bool blocks(const partial_dag& dag)
+            {
+                std::lock_guard<std::mutex> lock(nogoods_mutex);
+                for (const auto& ng : nogoods) {
+                    if (ng.matches(dag)) {
+                        nr_blocked++;
+                        return true;
+                    }
+                }
+#ifndef DISABLE_NAUTY
+                const auto& reprs = can_reprs[dag.nr_vertices()];
+                if (!reprs.empty() && reprs.count(crepr(dag)) > 0) {
+                    nr_blocked++;
+                    return true;
+                }
+#endif
+                return false;
+            }
+
+            size_t size() const
+            {
+                std::lock_guard<std::mutex> lock(nogoods_mutex);
+#ifndef DISABLE_NAUTY
+                return nogoods.size() + nr_can_reprs;
+#else
+                return nogoods.size();
+#endif
+            }
+
+            /// The number of partial DAGs discarded so far.
+            uint64_t nr_blocked_dags() const
+            {
+                std::lock_guard<std::mutex> lock(nogoods_mutex);
+                return nr_blocked;
+            }
+
+            void clear()
+            {
+                std::lock_guard<std::mutex> lock(nogoods_mutex);
+                spec_key.clear();
+                clear_nogoods();
+                nr_blocked = 0;
+            }
+    };
+
+}
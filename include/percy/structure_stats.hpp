@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <kitty/kitty.hpp>
+#include "spec.hpp"
+#include "fence.hpp"
+#include "partial_dag.hpp"
+#include "solvers/solver_wrapper.hpp"
+
+namespace percy
+{
+
+    /***************************************************************************
+        Keeps track of how often topological structures (partial DAGs or
+        fences) turned out to be satisfiable, and how long it took to
+        decide them. Outcomes are recorded per structure and per spec
+        signature, which is a cheap summary of the functions being
+        synthesized: the support size, the number of nontrivial outputs,
+        and the (complement invariant) weight of their truth tables. The
+        synthesizers can use these statistics to try the most promising
+        structures first.
+
+        The store is thread-safe, so it can be shared by the worker
+        threads of the parallel synthesizers.
+    ***************************************************************************/
+    class structure_stats
+    {
+        private:
+            struct record
+            {
+                uint64_t nr_sat = 0;
+                uint64_t nr_unsat = 0;
+                double total_time = 0; /// Seconds spent deciding the structure
+            };
+
+            std::unordered_map<std::string, record> records;
+            mutable std::mutex records_mutex;
+
+            static std::string
+            make_key(const std::string& signature, const std::string& structure)
+            {
+                return signature + " " + structure;
+            }
+
+        public:
+            static std::string signature(const spec& spec)
+            {
+                std::string sig;
+                int support = 0;
+                for (int i = 0; i < spec.get_nr_in(); i++) {
+                    for (int h = 0; h < spec.nr_nontriv; h++) {
+                        if (kitty::has_var(spec[spec.synth_func(h)], i)) {
+                            support++;
+                            break;
+                        }
+                    }
+                }
+                sig += std::to_string(support) + "," +
+                    std::to_string(spec.nr_nontriv);
+                for (int h = 0; h < spec.nr_nontriv; h++) {
+                    const auto& tt = spec[spec.synth_func(h)];
+                    const auto ones = kitty::count_ones(tt);
+                    const auto zeros = tt.num_bits() - ones;
+                    sig += "," + std::to_string(std::min(ones, zeros));
+                }
+
+                return sig;
+            }
+
+            static std::string structure_key(const partial_dag& dag)
+            {
+                std::string key = "p";
+                dag.foreach_vertex([&key, &dag] (const pd_vertex& v, int) {
+                    key += ",";
+                    for (int i = 0; i < dag.get_fanin(); i++) {
+                        if (i > 0) {
+                            key += ":";
+                        }
+                        key += std::to_string(v[i]);
+                    }
+                });
+                return key;
+            }
+
+            static std::string structure_key(const fence& f)
+            {
+                std::string key = "f";
+                for (int i = 0; i < f.nr_levels(); i++) {
+                    key += "," + std::to_string(f.at(i));
+                }
+                return key;
+            }
+
+            static int structure_size(const partial_dag& dag)
+            {
+                return dag.nr_vertices();
+            }
+
+            static int structure_size(const fence& f)
+            {
+                return f.nr_nodes();
+            }
+
+            /// Records the outcome of a synthesis attempt with the given
+            /// structure. Timeouts are not recorded, since they say
+            /// nothing about satisfiability.
+            template<typename Structure>
+            void
+            add_result(
+                const spec& spec,
+                const Structure& s,
+                synth_result result,
+                double time)
+            {
+                if (result != success && result != failure) {
+                    return;
+                }
+                const auto key = make_key(signature(spec), structure_key(s));
+                std::lock_guard<std::mutex> lock(records_mutex);
+                auto& r = records[key];
+                if (result == success) {
+                    r.nr_sat++;
+                } else {
+                    r.nr_unsat++;
+                }
+                r.total_time += time;
+            }
+
+            /// Returns the Laplace smoothed probability that the given
+            /// structure is satisfiable for specifications with the same
+            /// signature as spec. Unseen structures have probability 1/2.
+            double
+            sat_probability(
+                const std::string& signature,
+                const std::string& structure) const
+            {
+                std::lock_guard<std::mutex> lock(records_mutex);
+                const auto it = records.find(make_key(signature, structure));
+                if (it == records.end()) {
+                    return 0.5;
+                }
+                const auto& r = it->second;
+                return (r.nr_sat + 1.0) / (r.nr_sat + r.nr_unsat + 2.0);
+            }
+
+            template<typename Structure>
+            double sat_probability(const spec& spec, const Structure& s) const
+            {
+                return sat_probability(signature(spec), structure_key(s));
+            }
+
+            /// Sorts the structures by descending likelihood of being
+            /// satisfiable for spec. Structures are only reordered within
+            /// runs of the same size, so synthesizers that rely on trying
+            /// smaller structures first still find optimum chains. The
+            /// order of equally likely structures is preserved.
+            template<typename Structure>
+            void order(const spec& spec, std::vector<Structure>& structures) const
+            {
+                const auto sig = signature(spec);
+                std::vector<double> probs(structures.size());
+                for (auto i = 0u; i < structures.size(); i++) {
+                    probs[i] = sat_probability(sig, structure_key(structures[i]));
+                }
+                std::vector<size_t> perm(structures.size());
+                std::iota(perm.begin(), perm.end(), 0);
+                auto run_begin = perm.begin();
+                while (run_begin != perm.end()) {
+                    const auto run_size = structure_size(structures[*run_begin]);
+                    auto run_end = run_begin;
+                    while (run_end != perm.end() &&
+                            structure_size(structures[*run_end]) == run_size) {
+                        run_end++;
+                    }
+                    std::stable_sort(run_begin, run_end,
+                        [&probs] (size_t i, size_t j) {
+                            return probs[i] > probs[j];
+                        });
+                    run_begin = run_end;
+                }
+                std::vector<Structure> sorted;
+                sorted.reserve(structures.size());
+                for (auto i : perm) {
+                    sorted.push_back(structures[i]);
+                }
+                structures = std::move(sorted);
+            }
+
+            size_t size() const
+            {
+                std::lock_guard<std::mutex> lock(records_mutex);
+                return records.size();
+            }
+
+            void clear()
+            {
+                std::lock_guard<std::mutex> lock(records_mutex);
+                records.clear();
+            }
+
+            /// Writes the statistics to a file, one record per line.
+            bool save(const std::string& filename) const
+            {
+                auto fhandle = fopen(filename.c_str(), "w");
+                if (fhandle == NULL) {
+                    fprintf(stderr, "Error: unable to open output file\n");
+                    return false;
+                }
+                std::lock_guard<std::mutex> lock(records_mutex);
+                for (const auto& entry : records) {
+                    const auto& r = entry.second;
+                    fprintf(fhandle, "%s %lu %lu %f\n", entry.first.c_str(),
+                        (unsigned long)r.nr_sat, (unsigned long)r.nr_unsat,
+                        r.total_time);
+                }
+                fclose(fhandle);
+                return true;
+            }
+
+            /// Merges the statistics stored in a file into this store.
+            bool load(const std::string& filename)
+            {
+                auto fhandle = fopen(filename.c_str(), "r");
+                if (fhandle == NULL) {
+                    fprintf(stderr, "Error: unable to open input file\n");
+                    return false;
+                }
+                char sig[256];
+                char structure[256];
+                unsigned long nr_sat, nr_unsat;
+                double time;
+                std::lock_guard<std::mutex> lock(records_mutex);
+                while (fscanf(fhandle, "%255s %255s %lu %lu %lf", sig,
+                            structure, &nr_sat, &nr_unsat, &time) == 5) {
+                    auto& r = records[make_key(sig, structure)];
+                    r.nr_sat += nr_sat;
+                    r.nr_unsat += nr_unsat;
+                    r.total_time += time;
+                }
+                fclose(fhandle);
+                return true;
+            }
+    };
+
+}
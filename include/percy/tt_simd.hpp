@@ -0,0 +1,409 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PERCY_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define PERCY_SIMD_X86 0
+#endif
+
+namespace percy
+{
+    /***************************************************************************
+        Vectorized kernels for the truth table operations that dominate
+        simulation during CEGAR synthesis. Each kernel has a scalar version
+        and, on x86, AVX2 and AVX-512 versions that are compiled through
+        target attributes, so that no special compiler flags are needed.
+        The version to use is selected at runtime based on the CPU.
+
+        All kernels operate on arrays of 64-bit words. Inputs and outputs
+        may alias, but must not partially overlap.
+    ***************************************************************************/
+    enum simd_level
+    {
+        SIMD_SCALAR,
+        SIMD_AVX2,
+        SIMD_AVX512,
+    };
+
+    static inline const char* simd_level_name(simd_level level)
+    {
+        switch (level) {
+        case SIMD_AVX2:
+            return "AVX2";
+        case SIMD_AVX512:
+            return "AVX-512";
+        default:
+            return "scalar";
+        }
+    }
+
+    /// Returns the best instruction set supported by the CPU.
+    static inline simd_level detect_simd_level()
+    {
+#if PERCY_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SIMD_AVX512;
+        } else if (__builtin_cpu_supports("avx2")) {
+            return SIMD_AVX2;
+        }
+#endif
+        return SIMD_SCALAR;
+    }
+
+    namespace simd
+    {
+        inline simd_level& active_level()
+        {
+            static simd_level level = detect_simd_level();
+            return level;
+        }
+
+        /// Below this many words the scalar loops are at least as fast,
+        /// since they avoid the dispatch and the tail handling.
+        static constexpr int MIN_SIMD_WORDS = 4;
+
+        static inline bool use(simd_level level, int nr_words)
+        {
+            return nr_words >= MIN_SIMD_WORDS && active_level() >= level;
+        }
+
+        /*******************************************************************
+            Scalar versions. These also handle the tails of the vectorized
+            versions.
+        *******************************************************************/
+        static inline void
+        and_inv_scalar(const uint64_t* x, const uint64_t* y, uint64_t* out,
+                int begin, int end, uint64_t inv_x, uint64_t inv_y,
+                uint64_t inv_out)
+        {
+            for (int i = begin; i < end; i++) {
+                out[i] = ((x[i] ^ inv_x) & (y[i] ^ inv_y)) ^ inv_out;
+            }
+        }
+
+        static inline void
+        xor_inv_scalar(const uint64_t* x, const uint64_t* y, uint64_t* out,
+                int begin, int end, uint64_t inv_out)
+        {
+            for (int i = begin; i < end; i++) {
+                out[i] = x[i] ^ y[i] ^ inv_out;
+            }
+        }
+
+        static inline void
+        maj_inv_scalar(const uint64_t* x, const uint64_t* y, const uint64_t* z,
+                uint64_t* out, int begin, int end, uint64_t inv_x,
+                uint64_t inv_y, uint64_t inv_z, uint64_t inv_out)
+        {
+            for (int i = begin; i < end; i++) {
+                const auto a = x[i] ^ inv_x;
+                const auto b = y[i] ^ inv_y;
+                const auto c = z[i] ^ inv_z;
+                out[i] = ((a & b) | (a & c) | (b & c)) ^ inv_out;
+            }
+        }
+
+        static inline int64_t
+        first_difference_scalar(const uint64_t* x, const uint64_t* y,
+                const uint64_t* dc, uint64_t inv, int begin, int end)
+        {
+            for (int i = begin; i < end; i++) {
+                auto diff = x[i] ^ y[i] ^ inv;
+                if (dc != nullptr) {
+                    diff &= ~dc[i];
+                }
+                if (diff) {
+                    return int64_t(i) * 64 + __builtin_ctzll(diff);
+                }
+            }
+            return -1;
+        }
+
+#if PERCY_SIMD_X86
+        /*******************************************************************
+            AVX2 versions, processing four words at a time.
+        *******************************************************************/
+        __attribute__((target("avx2"))) static inline void
+        and_inv_avx2(const uint64_t* x, const uint64_t* y, uint64_t* out,
+                int nr_words, uint64_t inv_x, uint64_t inv_y, uint64_t inv_out)
+        {
+            const auto vx = _mm256_set1_epi64x(int64_t(inv_x));
+            const auto vy = _mm256_set1_epi64x(int64_t(inv_y));
+            const auto vo = _mm256_set1_epi64x(int64_t(inv_out));
+            int i = 0;
+            for (; i + 4 <= nr_words; i += 4) {
+                const auto a = _mm256_loadu_si256((const __m256i*)(x + i));
+                const auto b = _mm256_loadu_si256((const __m256i*)(y + i));
+                const auto r = _mm256_xor_si256(_mm256_and_si256(
+                            _mm256_xor_si256(a, vx), _mm256_xor_si256(b, vy)), vo);
+                _mm256_storeu_si256((__m256i*)(out + i), r);
+            }
+            and_inv_scalar(x, y, out, i, nr_words, inv_x, inv_y, inv_out);
+        }
+
+        __attribute__((target("avx2"))) static inline void
+        xor_inv_avx2(const uint64_t* x, const uint64_t* y, uint64_t* out,
+                int nr_words, uint64_t inv_out)
+        {
+            const auto vo = _mm256_set1_epi64x(int64_t(inv_out));
+            int i = 0;
+            for (; i + 4 <= nr_words; i += 4) {
+                const auto a = _mm256_loadu_si256((const __m256i*)(x + i));
+                const auto b = _mm256_loadu_si256((const __m256i*)(y + i));
+                const auto r = _mm256_xor_si256(_mm256_xor_si256(a, b), vo);
+                _mm256_storeu_si256((__m256i*)(out + i), r);
+            }
+            xor_inv_scalar(x, y, out, i, nr_words, inv_out);
+        }
+
+        __attribute__((target("avx2"))) static inline void
+        maj_inv_avx2(const uint64_t* x, const uint64_t* y, const uint64_t* z,
+                uint64_t* out, int nr_words, uint64_t inv_x, uint64_t inv_y,
+                uint64_t inv_z, uint64_t inv_out)
+        {
+            const auto vx = _mm256_set1_epi64x(int64_t(inv_x));
+            const auto vy = _mm256_set1_epi64x(int64_t(inv_y));
+            const auto vz = _mm256_set1_epi64x(int64_t(inv_z));
+            const auto vo = _mm256_set1_epi64x(int64_t(inv_out));
+            int i = 0;
+            for (; i + 4 <= nr_words; i += 4) {
+                const auto a = _mm256_xor_si256(
+                        _mm256_loadu_si256((const __m256i*)(x + i)), vx);
+                const auto b = _mm256_xor_si256(
+                        _mm256_loadu_si256((const __m256i*)(y + i)), vy);
+                const auto c = _mm256_xor_si256(
+                        _mm256_loadu_si256((const __m256i*)(z + i)), vz);
+                // maj(a, b, c) = (a & b) | (c & (a | b))
+                const auto r = _mm256_or_si256(_mm256_and_si256(a, b),
+                        _mm256_and_si256(c, _mm256_or_si256(a, b)));
+                _mm256_storeu_si256((__m256i*)(out + i), _mm256_xor_si256(r, vo));
+            }
+            maj_inv_scalar(x, y, z, out, i, nr_words, inv_x, inv_y, inv_z,
+                    inv_out);
+        }
+
+        __attribute__((target("avx2"))) static inline int64_t
+        first_difference_avx2(const uint64_t* x, const uint64_t* y,
+                const uint64_t* dc, uint64_t inv, int nr_words)
+        {
+            const auto vi = _mm256_set1_epi64x(int64_t(inv));
+            int i = 0;
+            for (; i + 4 <= nr_words; i += 4) {
+                const auto a = _mm256_loadu_si256((const __m256i*)(x + i));
+                const auto b = _mm256_loadu_si256((const __m256i*)(y + i));
+                auto diff = _mm256_xor_si256(_mm256_xor_si256(a, b), vi);
+                if (dc != nullptr) {
+                    const auto d = _mm256_loadu_si256((const __m256i*)(dc + i));
+                    diff = _mm256_andnot_si256(d, diff);
+                }
+                if (!_mm256_testz_si256(diff, diff)) {
+                    return first_difference_scalar(x, y, dc, inv, i, i + 4);
+                }
+            }
+            return first_difference_scalar(x, y, dc, inv, i, nr_words);
+        }
+
+        /*******************************************************************
+            AVX-512 versions, processing eight words at a time. The
+            ternary logic instruction evaluates each operation, including
+            the inversions, in a single instruction.
+        *******************************************************************/
+        __attribute__((target("avx512f"))) static inline void
+        and_inv_avx512(const uint64_t* x, const uint64_t* y, uint64_t* out,
+                int nr_words, uint64_t inv_x, uint64_t inv_y, uint64_t inv_out)
+        {
+            const auto vx = _mm512_set1_epi64(int64_t(inv_x));
+            const auto vy = _mm512_set1_epi64(int64_t(inv_y));
+            const auto vo = _mm512_set1_epi64(int64_t(inv_out));
+            int i = 0;
+            for (; i + 8 <= nr_words; i += 8) {
+                const auto a = _mm512_xor_si512(_mm512_loadu_si512(x + i), vx);
+                const auto b = _mm512_xor_si512(_mm512_loadu_si512(y + i), vy);
+                // 0x6a = (a & b) ^ c
+                const auto r = _mm512_ternarylogic_epi64(a, b, vo, 0x6a);
+                _mm512_storeu_si512(out + i, r);
+            }
+            and_inv_scalar(x, y, out, i, nr_words, inv_x, inv_y, inv_out);
+        }
+
+        __attribute__((target("avx512f"))) static inline void
+        xor_inv_avx512(const uint64_t* x, const uint64_t* y, uint64_t* out,
+                int nr_words, uint64_t inv_out)
+        {
+            const auto vo = _mm512_set1_epi64(int64_t(inv_out));
+            int i = 0;
+            for (; i + 8 <= nr_words; i += 8) {
+                const auto a = _mm512_loadu_si512(x + i);
+                const auto b = _mm512_loadu_si512(y + i);
+                // 0x96 = a ^ b ^ c
+                const auto r = _mm512_ternarylogic_epi64(a, b, vo, 0x96);
+                _mm512_storeu_si512(out + i, r);
+            }
+            xor_inv_scalar(x, y, out, i, nr_words, inv_out);
+        }
+
+        __attribute__((target("avx512f"))) static inline void
+        maj_inv_avx512(const uint64_t* x, const uint64_t* y, const uint64_t* z,
+                uint64_t* out, int nr_words, uint64_t inv_x, uint64_t inv_y,
+                uint64_t inv_z, uint64_t inv_out)
+        {
+            const auto vx = _mm512_set1_epi64(int64_t(inv_x));
+            const auto vy = _mm512_set1_epi64(int64_t(inv_y));
+            const auto vz = _mm512_set1_epi64(int64_t(inv_z));
+            const auto vo = _mm512_set1_epi64(int64_t(inv_out));
+            int i = 0;
+            for (; i + 8 <= nr_words; i += 8) {
+                const auto a = _mm512_xor_si512(_mm512_loadu_si512(x + i), vx);
+                const auto b = _mm512_xor_si512(_mm512_loadu_si512(y + i), vy);
+                const auto c = _mm512_xor_si512(_mm512_loadu_si512(z + i), vz);
+                // 0xe8 = maj(a, b, c)
+                const auto r = _mm512_ternarylogic_epi64(a, b, c, 0xe8);
+                _mm512_storeu_si512(out + i, _mm512_xor_si512(r, vo));
+            }
+            maj_inv_scalar(x, y, z, out, i, nr_words, inv_x, inv_y, inv_z,
+                    inv_out);
+        }
+
+        __attribute__((target("avx512f"))) static inline int64_t
+        first_difference_avx512(const uint64_t* x, const uint64_t* y,
+                const uint64_t* dc, uint64_t inv, int nr_words)
+        {
+            const auto vi = _mm512_set1_epi64(int64_t(inv));
+            int i = 0;
+            for (; i + 8 <= nr_words; i += 8) {
+                const auto a = _mm512_loadu_si512(x + i);
+                const auto b = _mm512_loadu_si512(y + i);
+                auto diff = _mm512_ternarylogic_epi64(a, b, vi, 0x96);
+                if (dc != nullptr) {
+                    diff = _mm512_andnot_si512(_mm512_loadu_si512(dc + i), diff);
+                }
+                const auto nonzero = _mm512_test_epi64_mask(diff, diff);
+                if (nonzero) {
+                    const auto w = i + __builtin_ctz(unsigned(nonzero));
+                    return first_difference_scalar(x, y, dc, inv, w, w + 1);
+                }
+            }
+            return first_difference_scalar(x, y, dc, inv, i, nr_words);
+        }
+#endif
+    }
+
+    /// Overrides the SIMD level used by the kernels, which is only meant
+    /// for tests and benchmarks. Levels that the CPU does not support are
+    /// clamped to the best supported one.
+    static inline void set_simd_level(simd_level level)
+    {
+        const auto max_level = detect_simd_level();
+        simd::active_level() = level > max_level ? max_level : level;
+    }
+
+    static inline simd_level get_simd_level()
+    {
+        return simd::active_level();
+    }
+
+    /// Computes out = ((x ^ inv_x) & (y ^ inv_y)) ^ inv_out, where the
+    /// inversion masks are either all zeros or all ones. This covers all
+    /// AND and OR type operators, e.g. x | y = ~(~x & ~y).
+    static inline void
+    tt_and_inv(const uint64_t* x, const uint64_t* y, uint64_t* out,
+            int nr_words, uint64_t inv_x = 0, uint64_t inv_y = 0,
+            uint64_t inv_out = 0)
+    {
+#if PERCY_SIMD_X86
+        if (simd::use(SIMD_AVX512, nr_words)) {
+            simd::and_inv_avx512(x, y, out, nr_words, inv_x, inv_y, inv_out);
+            return;
+        } else if (simd::use(SIMD_AVX2, nr_words)) {
+            simd::and_inv_avx2(x, y, out, nr_words, inv_x, inv_y, inv_out);
+            return;
+        }
+#endif
+        simd::and_inv_scalar(x, y, out, 0, nr_words, inv_x, inv_y, inv_out);
+    }
+
+    /// Computes out = x ^ y ^ inv_out.
+    static inline void
+    tt_xor_inv(const uint64_t* x, const uint64_t* y, uint64_t* out,
+            int nr_words, uint64_t inv_out = 0)
+    {
+#if PERCY_SIMD_X86
+        if (simd::use(SIMD_AVX512, nr_words)) {
+            simd::xor_inv_avx512(x, y, out, nr_words, inv_out);
+            return;
+        } else if (simd::use(SIMD_AVX2, nr_words)) {
+            simd::xor_inv_avx2(x, y, out, nr_words, inv_out);
+            return;
+        }
+#endif
+        simd::xor_inv_scalar(x, y, out, 0, nr_words, inv_out);
+    }
+
+    /// Computes out = x ^ inv_out, i.e. a copy or a complement.
+    static inline void
+    tt_not_inv(const uint64_t* x, uint64_t* out, int nr_words,
+            uint64_t inv_out = ~uint64_t(0))
+    {
+        tt_and_inv(x, x, out, nr_words, 0, 0, inv_out);
+    }
+
+    /// Computes out = maj(x ^ inv_x, y ^ inv_y, z ^ inv_z) ^ inv_out,
+    /// which covers the operators of MIGs with complemented edges.
+    static inline void
+    tt_maj_inv(const uint64_t* x, const uint64_t* y, const uint64_t* z,
+            uint64_t* out, int nr_words, uint64_t inv_x = 0,
+            uint64_t inv_y = 0, uint64_t inv_z = 0, uint64_t inv_out = 0)
+    {
+#if PERCY_SIMD_X86
+        if (simd::use(SIMD_AVX512, nr_words)) {
+            simd::maj_inv_avx512(x, y, z, out, nr_words, inv_x, inv_y, inv_z,
+                    inv_out);
+            return;
+        } else if (simd::use(SIMD_AVX2, nr_words)) {
+            simd::maj_inv_avx2(x, y, z, out, nr_words, inv_x, inv_y, inv_z,
+                    inv_out);
+            return;
+        }
+#endif
+        simd::maj_inv_scalar(x, y, z, out, 0, nr_words, inv_x, inv_y, inv_z,
+                inv_out);
+    }
+
+    /// Returns the index of the first bit at which x ^ inv and y differ,
+    /// ignoring the bits that are set in the optional don't care mask dc.
+    /// Returns -1 if there is no such bit. Only the bits of the last word
+    /// that are set in last_mask are compared, so that the unused bits of
+    /// truth tables with fewer than 6 variables can be ignored.
+    static inline int64_t
+    tt_find_first_difference(const uint64_t* x, const uint64_t* y,
+            int nr_words, const uint64_t* dc = nullptr, uint64_t inv = 0,
+            uint64_t last_mask = ~uint64_t(0))
+    {
+        const auto nr_full_words = nr_words - 1;
+        int64_t idx = -1;
+#if PERCY_SIMD_X86
+        if (simd::use(SIMD_AVX512, nr_full_words)) {
+            idx = simd::first_difference_avx512(x, y, dc, inv, nr_full_words);
+        } else if (simd::use(SIMD_AVX2, nr_full_words)) {
+            idx = simd::first_difference_avx2(x, y, dc, inv, nr_full_words);
+        } else
+#endif
+        {
+            idx = simd::first_difference_scalar(x, y, dc, inv, 0, nr_full_words);
+        }
+        if (idx != -1 || nr_words == 0) {
+            return idx;
+        }
+        auto diff = (x[nr_full_words] ^ y[nr_full_words] ^ inv) & last_mask;
+        if (dc != nullptr) {
+            diff &= ~dc[nr_full_words];
+        }
+        return diff ? int64_t(nr_full_words) * 64 + __builtin_ctzll(diff) : -1;
+    }
+
+}
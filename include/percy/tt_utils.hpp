@@ -5,6 +5,8 @@
 #include <kitty/kitty.hpp>
 #include <unordered_set>
 #pragma GCC diagnostic pop
+#include <cstdint>
+#include "tt_simd.hpp"
 
 namespace percy
 {
@@ -29,4 +31,129 @@ namespace percy
         return classes;
     }
 
+
+    /***************************************************************************
+        Word-level kernels that apply the operator of a step to the truth
+        tables of its fanins. Bit j of an operator is its value when fanin
+        k has value (j >> k) & 1. The results are not masked, so callers
+        that use truth tables of fewer than 6 variables must clear the
+        unused bits.
+    ***************************************************************************/
+    template<typename F>
+    static inline void
+    apply_words(const uint64_t* x, const uint64_t* y, uint64_t* out, int nr_words, F f)
+    {
+        for (int i = 0; i < nr_words; i++) {
+            out[i] = f(x[i], y[i]);
+        }
+    }
+
+    /// All non-constant fanin 2 operators map onto the AND, XOR and NOT
+    /// kernels, which are vectorized for larger truth tables.
+    static inline void
+    apply_op2(unsigned op, const uint64_t* x, const uint64_t* y, uint64_t* out, int nr_words)
+    {
+        const auto ones = ~uint64_t(0);
+        switch (op & 0xf) {
+        case 0x0: apply_words(x, y, out, nr_words, [](uint64_t, uint64_t) { return uint64_t(0); }); break;
+        case 0x1: tt_and_inv(x, y, out, nr_words, ones, ones, 0); break;
+        case 0x2: tt_and_inv(x, y, out, nr_words, 0, ones, 0); break;
+        case 0x3: tt_not_inv(y, out, nr_words, ones); break;
+        case 0x4: tt_and_inv(x, y, out, nr_words, ones, 0, 0); break;
+        case 0x5: tt_not_inv(x, out, nr_words, ones); break;
+        case 0x6: tt_xor_inv(x, y, out, nr_words, 0); break;
+        case 0x7: tt_and_inv(x, y, out, nr_words, 0, 0, ones); break;
+        case 0x8: tt_and_inv(x, y, out, nr_words, 0, 0, 0); break;
+        case 0x9: tt_xor_inv(x, y, out, nr_words, ones); break;
+        case 0xa: tt_not_inv(x, out, nr_words, 0); break;
+        case 0xb: tt_and_inv(x, y, out, nr_words, ones, 0, ones); break;
+        case 0xc: tt_not_inv(y, out, nr_words, 0); break;
+        case 0xd: tt_and_inv(x, y, out, nr_words, 0, ones, ones); break;
+        case 0xe: tt_and_inv(x, y, out, nr_words, ones, ones, ones); break;
+        default: apply_words(x, y, out, nr_words, [](uint64_t, uint64_t) { return ~uint64_t(0); }); break;
+        }
+    }
+
+    /// Evaluates a fanin 2 operator on a single word without branches.
+    /// The masks m[j] are all ones if bit j of the operator is set.
+    static inline uint64_t
+    op2_word(const uint64_t m[4], uint64_t x, uint64_t y)
+    {
+        return (m[0] & ~x & ~y) | (m[1] & x & ~y) | (m[2] & ~x & y) | (m[3] & x & y);
+    }
+
+    /// Fanin 3 operators are evaluated as a multiplexer, selected by the
+    /// third fanin, of their two fanin 2 cofactors. Majority and minority
+    /// have their own kernel, since they are the only operators of MIGs.
+    static inline void
+    apply_op3(unsigned op, const uint64_t* x, const uint64_t* y,
+            const uint64_t* z, uint64_t* out, int nr_words)
+    {
+        if ((op & 0xff) == 0xe8) {
+            tt_maj_inv(x, y, z, out, nr_words);
+            return;
+        } else if ((op & 0xff) == 0x17) {
+            tt_maj_inv(x, y, z, out, nr_words, 0, 0, 0, ~uint64_t(0));
+            return;
+        }
+        uint64_t m0[4], m1[4];
+        for (int j = 0; j < 4; j++) {
+            m0[j] = ((op >> j) & 1) ? ~uint64_t(0) : 0;
+            m1[j] = ((op >> (j + 4)) & 1) ? ~uint64_t(0) : 0;
+        }
+        for (int i = 0; i < nr_words; i++) {
+            const auto f0 = op2_word(m0, x[i], y[i]);
+            const auto f1 = op2_word(m1, x[i], y[i]);
+            out[i] = (z[i] & f1) | (~z[i] & f0);
+        }
+    }
+
+    /// Computes the majority of three truth tables, with optionally
+    /// complemented inputs, into out. Unlike kitty::ternary_majority this
+    /// reuses the storage of out, which is only reallocated if its number
+    /// of variables differs from that of the inputs.
+    static inline void
+    ternary_majority_into(const kitty::dynamic_truth_table& x,
+            const kitty::dynamic_truth_table& y,
+            const kitty::dynamic_truth_table& z, kitty::dynamic_truth_table& out,
+            bool inv_x = false, bool inv_y = false, bool inv_z = false)
+    {
+        if (out.num_vars() != x.num_vars()) {
+            out = kitty::dynamic_truth_table(x.num_vars());
+        }
+        const auto ones = ~uint64_t(0);
+        tt_maj_inv(&*x.cbegin(), &*y.cbegin(), &*z.cbegin(), &*out.begin(),
+                int(out.num_blocks()), inv_x ? ones : 0, inv_y ? ones : 0,
+                inv_z ? ones : 0);
+        out.mask_bits();
+    }
+
+    /// Evaluates an operator of arbitrary fanin as a sum of its minterms.
+    static inline void
+    apply_op(uint32_t op, const uint64_t* const* ins, int fanin, uint64_t* out,
+            int nr_words)
+    {
+        if (fanin == 2) {
+            apply_op2(op, ins[0], ins[1], out, nr_words);
+            return;
+        } else if (fanin == 3) {
+            apply_op3(op, ins[0], ins[1], ins[2], out, nr_words);
+            return;
+        }
+        for (int i = 0; i < nr_words; i++) {
+            uint64_t res = 0;
+            for (int j = 0; j < (1 << fanin); j++) {
+                if (!((op >> j) & 1)) {
+                    continue;
+                }
+                auto minterm = ~uint64_t(0);
+                for (int k = 0; k < fanin; k++) {
+                    minterm &= ((j >> k) & 1) ? ins[k][i] : ~ins[k][i];
+                }
+                res |= minterm;
+            }
+            out[i] = res;
+        }
+    }
+
 }
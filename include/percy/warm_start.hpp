@@ -0,0 +1,112 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include "spec.hpp"
+#include "solvers/solver_wrapper.hpp"
+#include "encoders/encoder.hpp"
+
+namespace percy
+{
+    /***************************************************************************
+        Carries the decision heuristics of a solver over from one formula to
+        the next, when a synthesizer tries a sequence of related formulas,
+        such as those for successive numbers of steps, neighbouring fences,
+        or sibling partial DAGs. The variables of the formulas are matched
+        through their roles in the encodings, and every variable of the new
+        formula takes over the saved phase and activity of the last variable
+        with the same role.
+    ***************************************************************************/
+    class warm_start
+    {
+    private:
+        struct var_state
+        {
+            uint8_t phase;
+            double activity;
+        };
+
+        bool enabled;
+        std::unordered_map<int64_t, var_state> saved;
+
+        std::vector<int64_t> roles;
+        std::vector<int> vars;
+        std::vector<uint8_t> phases;
+        std::vector<double> activities;
+
+    public:
+        warm_start(bool enabled = true) : enabled(enabled)
+        {
+        }
+
+        /// Records the phases and activities of the variables of the
+        /// current encoding, after the solver has been called on it.
+        void save(const spec& spec, const encoder& encoder,
+                solver_wrapper& solver)
+        {
+            if (!enabled) {
+                return;
+            }
+            encoder.get_var_roles(spec, roles);
+            if (roles.empty() || !solver.save_heuristics(phases, activities)) {
+                return;
+            }
+            const auto nr_vars = std::min(roles.size(), phases.size());
+            for (std::size_t i = 0; i < nr_vars; i++) {
+                if (roles[i] != -1) {
+                    saved[roles[i]] = { phases[i], activities[i] };
+                }
+            }
+        }
+
+        /// Transfers the saved phases and activities to the variables of
+        /// the current encoding, which must not have been solved yet.
+        /// Returns the number of variables that were warm-started.
+        int load(const spec& spec, const encoder& encoder,
+                solver_wrapper& solver)
+        {
+            if (!enabled || saved.empty()) {
+                return 0;
+            }
+            encoder.get_var_roles(spec, roles);
+            vars.clear();
+            phases.clear();
+            activities.clear();
+            const auto nr_vars = std::min(int(roles.size()), solver.nr_vars());
+            for (int i = 0; i < nr_vars; i++) {
+                if (roles[i] == -1) {
+                    continue;
+                }
+                const auto it = saved.find(roles[i]);
+                if (it != saved.end()) {
+                    vars.push_back(i);
+                    phases.push_back(it->second.phase);
+                    activities.push_back(it->second.activity);
+                }
+            }
+            if (!vars.empty()) {
+                solver.load_heuristics(vars, phases, activities);
+            }
+            if (spec.verbosity) {
+                printf("warm-started %zu variables\n", vars.size());
+            }
+            return int(vars.size());
+        }
+
+        bool is_enabled() const
+        {
+            return enabled;
+        }
+
+        /// Returns the number of roles for which a state is saved.
+        std::size_t size() const
+        {
+            return saved.size();
+        }
+
+        void clear()
+        {
+            saved.clear();
+        }
+    };
+}
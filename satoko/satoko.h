@@ -138,6 +138,7 @@ extern int satoko_learntnum(satoko_t *);
 extern int satoko_conflictnum(satoko_t *);
 extern void satoko_set_stop(satoko_t *, int *);
 extern void satoko_set_stop_func(satoko_t *s, int (*fnct)(int));
+extern void satoko_set_learnt_func(satoko_t *s, void *, void (*fnct)(void *, unsigned *, unsigned));
 extern void satoko_set_runid(satoko_t *, int);
 extern int satoko_read_cex_varvalue(satoko_t *, int);
 extern pabc::abctime satoko_set_runtime_limit(satoko_t *, pabc::abctime);
@@ -347,6 +347,8 @@ static inline void solver_handle_conflict(solver_t *s, unsigned confl_cref)
 
     vec_uint_clear(s->temp_lits);
     solver_analyze(s, confl_cref, s->temp_lits, &bt_level, &lbd);
+    if (s->pFuncLearnt)
+        s->pFuncLearnt(s->pLearntData, vec_uint_data(s->temp_lits), vec_uint_size(s->temp_lits));
     s->sum_lbd += lbd;
     b_queue_push(s->bq_lbd, lbd);
     solver_cancel_until(s, bt_level);
@@ -429,14 +431,17 @@ static inline void solver_garbage_collect(solver_t *s)
 static inline void solver_reduce_cdb(solver_t *s)
 {
     unsigned i, limit;
-    unsigned n_learnts = vec_uint_size(s->learnts);
+    unsigned n_learnts = vec_uint_size(s->learnts) - s->book_cl_lrnt;
     unsigned cref;
     struct clause *clause;
     struct clause **learnts_cls;
 
+    /* Only the clauses learnt after the bookmark are reduced */
+    if (n_learnts == 0)
+        return;
     learnts_cls = satoko_alloc(struct clause *, n_learnts);
     vec_uint_foreach_start(s->learnts, cref, i, s->book_cl_lrnt)
-        learnts_cls[i] = clause_fetch(s, cref);
+        learnts_cls[i - s->book_cl_lrnt] = clause_fetch(s, cref);
 
     limit = (unsigned)(n_learnts * s->opts.learnt_ratio);
 
@@ -448,7 +453,7 @@ static inline void solver_reduce_cdb(solver_t *s)
     if (learnts_cls[n_learnts - 1]->lbd <= 6)
         s->RC2 += s->opts.inc_special_reduce;
 
-    vec_uint_clear(s->learnts);
+    vec_uint_shrink(s->learnts, s->book_cl_lrnt);
     for (i = 0; i < n_learnts; i++) {
         clause = learnts_cls[i];
         cref = cdb_cref(s->all_clauses, (unsigned *)clause);
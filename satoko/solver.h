@@ -106,6 +106,10 @@ struct solver_t_ {
     int     RunId;           
     int   (*pFuncStop)(int);  
 
+    /* Callback for every learned clause */
+    void   *pLearntData;
+    void  (*pFuncLearnt)(void *, unsigned *, unsigned);
+
     struct satoko_stats stats;
     struct satoko_opts opts;
 };
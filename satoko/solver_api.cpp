@@ -513,7 +513,6 @@ void satoko_rollback(satoko_t *s)
     struct clause **cl_to_remove;
 
     // printf("[Satoko] rollback.\n");
-    assert(s->status == SATOKO_OK);
     assert(solver_dlevel(s) == 0);
     if (!s->book_vars) {
         satoko_reset(s);
@@ -522,23 +521,31 @@ void satoko_rollback(satoko_t *s)
     cl_to_remove = satoko_alloc(struct clause *, n_originals + n_learnts);
     /* Mark clauses */
     vec_uint_foreach_start(s->originals, cref, i, s->book_cl_orig)
-        cl_to_remove[i] = clause_fetch(s, cref);
+        cl_to_remove[i - s->book_cl_orig] = clause_fetch(s, cref);
     vec_uint_foreach_start(s->learnts, cref, i, s->book_cl_lrnt)
-        cl_to_remove[n_originals + i] = clause_fetch(s, cref);
+        cl_to_remove[n_originals + i - s->book_cl_lrnt] = clause_fetch(s, cref);
     for (i = 0; i < n_originals + n_learnts; i++) {
         clause_unwatch(s, cdb_cref(s->all_clauses, (unsigned *)cl_to_remove[i]));
         cl_to_remove[i]->f_mark = 1;
+        cdb_remove(s->all_clauses, cl_to_remove[i]);
     }
     satoko_free(cl_to_remove);
     vec_uint_shrink(s->originals, s->book_cl_orig);
     vec_uint_shrink(s->learnts, s->book_cl_lrnt);
+    /* Unassign the variables that were assigned at level 0 after the bookmark */
+    for (i = s->book_trail; i < vec_uint_size(s->trail); i++) {
+        unsigned var = lit2var(vec_uint_at(s->trail, i));
+        vec_char_assign(s->assigns, var, SATOKO_VAR_UNASSING);
+        vec_uint_assign(s->reasons, var, UNDEF);
+    }
+    vec_uint_shrink(s->trail, s->book_trail);
+    s->i_qhead = s->book_trail;
     /* Shrink variable related vectors */
-    for (i = s->book_vars; i < 2 * vec_char_size(s->assigns); i++) {
+    for (i = 2 * s->book_vars; i < 2 * vec_char_size(s->assigns); i++) {
         vec_wl_at(s->watches, i)->size = 0;
         vec_wl_at(s->watches, i)->n_bin = 0;
     }
-    // s->i_qhead = s->book_qhead;
-    s->watches->size = s->book_vars;
+    s->watches->size = 2 * s->book_vars;
     vec_act_shrink(s->activity, s->book_vars);
     vec_uint_shrink(s->levels, s->book_vars);
     vec_uint_shrink(s->reasons, s->book_vars);
@@ -546,10 +553,11 @@ void satoko_rollback(satoko_t *s)
     vec_char_shrink(s->assigns, s->book_vars);
     vec_char_shrink(s->seen, s->book_vars);
     vec_char_shrink(s->polarity, s->book_vars);
+    if (s->marks)
+        vec_char_shrink(s->marks, s->book_vars);
     solver_rebuild_order(s);
-    /* Rewind solver and cancel level 0 assignments to the trail */
-    solver_cancel_until(s, 0);
-    vec_uint_shrink(s->trail, s->book_trail);
+    /* The formula at the bookmark was consistent */
+    s->status = SATOKO_OK;
     if (s->book_cdb)
         s->all_clauses->size = s->book_cdb;
     s->book_cl_orig = 0;
@@ -652,6 +660,12 @@ void satoko_set_stop_func(satoko_t *s, int (*fnct)(int))
     s->pFuncStop = fnct;
 }
 
+void satoko_set_learnt_func(satoko_t *s, void * pdata, void (*fnct)(void *, unsigned *, unsigned))
+{
+    s->pLearntData = pdata;
+    s->pFuncLearnt = fnct;
+}
+
 void satoko_set_runid(satoko_t *s, int id)
 {
     s->RunId = id;
@@ -0,0 +1,158 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+
+/*******************************************************************************
+    Verifies that all solver backends agree on formulas solved under
+    assumptions, that their final conflicts and minimized assumptions are
+    sufficient to make a formula unsatisfiable, and that their exported
+    models satisfy all clauses.
+*******************************************************************************/
+typedef std::vector<std::vector<pabc::lit>> cnf_t;
+
+cnf_t random_cnf(int nr_vars, int nr_clauses)
+{
+    cnf_t cnf(nr_clauses);
+    for (auto& clause : cnf) {
+        for (int j = 0; j < 3; j++) {
+            clause.push_back(pabc::Abc_Var2Lit(rand() % nr_vars, rand() & 1));
+        }
+    }
+    return cnf;
+}
+
+bool satisfies(const cnf_t& cnf, const std::vector<uint8_t>& model)
+{
+    for (const auto& clause : cnf) {
+        auto sat = false;
+        for (const auto l : clause) {
+            sat |= model[pabc::Abc_Lit2Var(l)] != pabc::Abc_LitIsCompl(l);
+        }
+        if (!sat) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Every literal that is assumed must be part of a core, if the formula
+/// with only these assumptions is unsatisfiable but would become
+/// satisfiable without any one of them.
+bool is_minimal(solver_wrapper& solver, std::vector<pabc::lit> core)
+{
+    if (solver.solve(core.data(), core.data() + core.size(), 0) != failure) {
+        return false;
+    }
+    for (std::size_t i = 0; i < core.size(); i++) {
+        std::swap(core[i], core.back());
+        const auto res = solver.solve(core.data(), core.data() + core.size() - 1, 0);
+        std::swap(core[i], core.back());
+        if (res != success) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Returns the number of unsatisfiable instances, so that the backends
+/// can be compared.
+int check_solver(solver_wrapper& solver, int nr_tests)
+{
+    const int nr_vars = 24;
+    std::vector<uint8_t> model;
+    std::vector<pabc::lit> assumptions, conflict;
+    auto nr_unsat = 0;
+    for (int t = 0; t < nr_tests; t++) {
+        solver.restart();
+        solver.set_nr_vars(nr_vars);
+        const auto cnf = random_cnf(nr_vars, 3 * nr_vars);
+        for (auto clause : cnf) {
+            solver.add_clause(clause.data(), clause.data() + clause.size());
+        }
+        assert(solver.nr_vars() == nr_vars);
+
+        assumptions.clear();
+        for (int i = 0; i < nr_vars; i++) {
+            if (rand() % 3 == 0) {
+                assumptions.push_back(pabc::Abc_Var2Lit(i, rand() & 1));
+            }
+        }
+        const auto begin = assumptions.data();
+        const auto end = begin + assumptions.size();
+        const auto res = solver.solve(begin, end, 0);
+        assert(res != timeout);
+        if (res == success) {
+            solver.copy_model(model);
+            assert(int(model.size()) == nr_vars);
+            assert(satisfies(cnf, model));
+            for (int i = 0; i < nr_vars; i++) {
+                assert(model[i] == solver.var_value(i));
+            }
+            for (const auto l : assumptions) {
+                assert(model[pabc::Abc_Lit2Var(l)] != pabc::Abc_LitIsCompl(l));
+            }
+            continue;
+        }
+        nr_unsat++;
+
+        // The final conflict consists of assumptions, which are enough to
+        // make the formula unsatisfiable.
+        assert(solver.final_conflict(conflict));
+        for (const auto l : conflict) {
+            assert(std::find(begin, end, l) != end);
+        }
+        assert(solver.solve(conflict.data(), conflict.data() + conflict.size(), 0) == failure);
+
+        auto minimized = assumptions;
+        const auto size = solver.minimize_assumptions(minimized);
+        assert(size <= int(assumptions.size()));
+        std::vector<pabc::lit> core(minimized.begin(), minimized.begin() + size);
+        assert(is_minimal(solver, core));
+        // The literals are only reordered.
+        std::sort(minimized.begin(), minimized.end());
+        auto sorted = assumptions;
+        std::sort(sorted.begin(), sorted.end());
+        assert(minimized == sorted);
+
+        // The default implementation finds a minimal core as well.
+        minimized = assumptions;
+        const auto size2 = solver.solver_wrapper::minimize_assumptions(minimized);
+        core.assign(minimized.begin(), minimized.begin() + size2);
+        assert(is_minimal(solver, core));
+    }
+    return nr_unsat;
+}
+
+int main()
+{
+    const int nr_tests = 200;
+
+    srand(1);
+    bsat_wrapper bsat;
+    const auto nr_unsat = check_solver(bsat, nr_tests);
+    printf("%d of %d instances are unsatisfiable\n", nr_unsat, nr_tests);
+    assert(nr_unsat > 0 && nr_unsat < nr_tests);
+
+    srand(1);
+    bmcg_wrapper bmcg;
+    assert(check_solver(bmcg, nr_tests) == nr_unsat);
+#ifdef USE_SATOKO
+    srand(1);
+    satoko_wrapper satoko;
+    assert(check_solver(satoko, nr_tests) == nr_unsat);
+#endif
+#if defined(USE_GLUCOSE) || defined(USE_SYRUP)
+    srand(1);
+    glucose_wrapper glucose;
+    assert(check_solver(glucose, nr_tests) == nr_unsat);
+#endif
+#ifdef USE_CMS
+    srand(1);
+    cmsat_wrapper cmsat;
+    assert(check_solver(cmsat, nr_tests) == nr_unsat);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that solvers which roll back to a bookmark behave like fresh
+    solvers with the same formula, and that the synthesizers which encode
+    the structure-independent part of their formulas once and roll back to
+    it find chains of the same size as the ones that restart.
+*******************************************************************************/
+typedef std::vector<std::vector<pabc::lit>> cnf_t;
+
+void add_random_clauses(cnf_t& cnf, int nr_vars, int first_var, int nr_clauses)
+{
+    for (int i = 0; i < nr_clauses; i++) {
+        std::vector<pabc::lit> clause;
+        // Some units, to have assignments at level 0.
+        const auto size = rand() % 32 == 0 ? 1 : 3;
+        for (int j = 0; j < size; j++) {
+            // The clauses after the bookmark mostly use their own
+            // variables, but also constrain the shared ones.
+            const auto var = (j == 0 && first_var > 0) ?
+                first_var + rand() % (nr_vars - first_var) : rand() % nr_vars;
+            clause.push_back(pabc::Abc_Var2Lit(var, rand() & 1));
+        }
+        cnf.push_back(clause);
+    }
+}
+
+bool add_cnf(solver_wrapper& solver, cnf_t& cnf)
+{
+    auto ok = true;
+    for (auto& clause : cnf) {
+        ok &= solver.add_clause(clause.data(), clause.data() + clause.size()) != 0;
+    }
+    return ok;
+}
+
+bool satisfies(const cnf_t& cnf, solver_wrapper& solver)
+{
+    for (const auto& clause : cnf) {
+        auto sat = false;
+        for (const auto l : clause) {
+            sat |= solver.var_value(pabc::Abc_Lit2Var(l)) !=
+                pabc::Abc_LitIsCompl(l);
+        }
+        if (!sat) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_rollback(solver_wrapper& solver, int nr_tests)
+{
+    const int nr_shared_vars = 40;
+    const int nr_vars = 100;
+    for (int t = 0; t < nr_tests; t++) {
+        cnf_t shared;
+        add_random_clauses(shared, nr_shared_vars, 0, 60);
+        solver.restart();
+        solver.set_nr_vars(nr_shared_vars);
+        if (!add_cnf(solver, shared) || !solver.bookmark()) {
+            continue;
+        }
+        for (int r = 0; r < 20; r++) {
+            solver.rollback();
+            assert(solver.nr_vars() == nr_shared_vars);
+            cnf_t structure;
+            add_random_clauses(structure, nr_vars, nr_shared_vars,
+                    150 + rand() % 150);
+            solver.set_nr_vars(nr_vars);
+            const auto added = add_cnf(solver, structure);
+
+            bsat_wrapper fresh;
+            fresh.set_nr_vars(nr_vars);
+            auto fresh_added = add_cnf(fresh, shared);
+            fresh_added &= add_cnf(fresh, structure);
+            if (!fresh_added) {
+                assert(!added || solver.solve(0) == failure);
+                continue;
+            }
+            const auto expected = fresh.solve(0);
+            if (!added) {
+                assert(expected == failure);
+                continue;
+            }
+            const auto res = solver.solve(0);
+            assert(res == expected);
+            if (res == success) {
+                assert(satisfies(shared, solver));
+                assert(satisfies(structure, solver));
+            }
+        }
+    }
+}
+
+void check_cnf_rollback()
+{
+    cnf_formula cnf;
+    cnf.set_nr_vars(3);
+    pabc::lit lits[2] = { pabc::Abc_Var2Lit(0, 0), pabc::Abc_Var2Lit(1, 1) };
+    cnf.add_clause(lits, lits + 2);
+    assert(cnf.bookmark());
+    for (int i = 0; i < 3; i++) {
+        cnf.set_nr_vars(5 + i);
+        cnf.add_clause(lits, lits + 1);
+        cnf.add_clause(lits + 1, lits + 2);
+        assert(cnf.nr_clauses() == 3);
+        cnf.rollback();
+        assert(cnf.nr_vars() == 3);
+        assert(cnf.nr_clauses() == 1);
+    }
+}
+
+void check_fence(solver_wrapper& solver, int nr_in, int nr_tests)
+{
+    ssv_fence2_encoder encoder(solver);
+    encoder.reset_sim_tts(nr_in);
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec.add_lex_func_clauses = false;
+        spec[0] = tt;
+        chain c1, c2;
+        const auto res1 = synthesize(spec, c1);
+        assert(res1 == success);
+        const auto res2 = fence_synthesize(spec, c2, solver, encoder);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+    }
+}
+
+void check_fence_multi(solver_wrapper& solver, int nr_in, int nr_tests)
+{
+    ssv_fence2_encoder encoder(solver);
+    encoder.reset_sim_tts(nr_in);
+    dynamic_truth_table tt1(nr_in), tt2(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt1, 2 * t);
+        kitty::create_random(tt2, 2 * t + 1);
+        spec spec;
+        spec.add_lex_func_clauses = false;
+        spec[0] = tt1;
+        spec[1] = tt2;
+        chain c1, c2;
+        const auto res1 = synthesize(spec, c1);
+        assert(res1 == success);
+        const auto res2 = fence_synthesize(spec, c2, solver, encoder);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+    }
+}
+
+void check_pd(solver_wrapper& solver, int nr_in, int nr_tests,
+        const std::vector<partial_dag>& dags)
+{
+    partial_dag_encoder encoder(solver);
+    encoder.reset_sim_tts(nr_in);
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec.add_alonce_clauses = false;
+        spec.add_nontriv_clauses = false;
+        spec.add_lex_func_clauses = false;
+        spec.add_colex_clauses = false;
+        spec.add_noreapply_clauses = false;
+        spec.add_symvar_clauses = false;
+        spec[0] = tt;
+        chain c1, c2;
+        const auto res1 = synthesize(spec, c1);
+        assert(res1 == success);
+        const auto res2 = pd_synthesize(spec, c2, dags, solver, encoder);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+        // With symmetry breaking, which depends on the DAG.
+        spec.add_nontriv_clauses = true;
+        spec.add_noreapply_clauses = true;
+        spec.add_symvar_clauses = true;
+        const auto res3 = pd_synthesize(spec, c2, dags, solver, encoder);
+        assert(res3 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+    }
+}
+
+int main()
+{
+    srand(1);
+
+    check_cnf_rollback();
+    bsat_wrapper bsat;
+    check_rollback(bsat, 50);
+#ifdef USE_SATOKO
+    satoko_wrapper satoko;
+    check_rollback(satoko, 50);
+#endif
+
+    const auto dags = pd_generate_max(6);
+    check_fence(bsat, 4, 16);
+    check_fence_multi(bsat, 3, 8);
+    check_pd(bsat, 4, 16, dags);
+#ifdef USE_SATOKO
+    check_fence(satoko, 4, 16);
+    check_fence_multi(satoko, 3, 8);
+    check_pd(satoko, 4, 16, dags);
+#endif
+#if defined(USE_GLUCOSE)
+    glucose_wrapper glucose;
+    check_fence(glucose, 4, 8);
+#endif
+
+    return 0;
+}
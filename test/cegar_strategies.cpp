@@ -0,0 +1,200 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that all CEGAR refinement strategies, with and without seeding,
+    lead to optimum chains, and that the statistics they report are
+    consistent.
+*******************************************************************************/
+void check_selection()
+{
+    dynamic_truth_table diff(4);
+    kitty::create_from_hex_string(diff, "f0f1");
+    std::vector<int64_t> mints;
+
+    // Minterm 0 is never selected.
+    select_counterexamples(diff, 3, CEGAR_FIRST_K, mints);
+    assert((mints == std::vector<int64_t>{ 4, 5, 6 }));
+
+    select_counterexamples(diff, 3, CEGAR_DIVERSE, mints);
+    assert(mints.size() == 3);
+    assert(mints[0] == 4);
+    // 15 = 1111 is the only minterm at distance 3 from 4 = 0100.
+    assert(mints[1] == 15);
+    for (auto i = 0u; i < mints.size(); i++) {
+        assert(kitty::get_bit(diff, mints[i]));
+        for (auto j = 0u; j < i; j++) {
+            assert(mints[i] != mints[j]);
+        }
+    }
+
+    // Asking for more minterms than there are returns all of them.
+    select_counterexamples(diff, 100, CEGAR_DIVERSE, mints);
+    assert(mints.size() == 8);
+    select_counterexamples(diff, 100, CEGAR_FIRST_K, mints);
+    assert(mints.size() == 8);
+}
+
+void set_strategy(spec& spec, int i)
+{
+    spec.cegar_strategy = CegarStrategy(i % CEGAR_TOTAL);
+    spec.nr_rand_tt_assigns = (i / CEGAR_TOTAL) ? 8 : 0;
+}
+
+void check_std_cegar(int nr_in, int nr_tests)
+{
+    spec spec;
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    msv_encoder msv_encoder(solver);
+    chain c1, c2;
+    synth_stats stats;
+    dynamic_truth_table tt(nr_in);
+
+    int total_rounds[2 * CEGAR_TOTAL] = { 0 };
+    int total_clauses[2 * CEGAR_TOTAL] = { 0 };
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, rand());
+        spec[0] = tt;
+        spec.cegar_strategy = CEGAR_FIRST;
+        spec.nr_rand_tt_assigns = 0;
+        const auto res1 = synthesize(spec, c1, solver, encoder);
+        assert(res1 == success);
+
+        for (int i = 0; i < 2 * CEGAR_TOTAL; i++) {
+            set_strategy(spec, i);
+            auto& enc = (i & 1) ? static_cast<std_cegar_encoder&>(msv_encoder) :
+                static_cast<std_cegar_encoder&>(encoder);
+            const auto res2 = synthesize(spec, c2, solver, enc,
+                    SYNTH_STD_CEGAR, &stats);
+            assert(res2 == success);
+            assert(c2.satisfies_spec(spec));
+            assert(c1.get_nr_steps() == c2.get_nr_steps());
+            if (spec.nr_nontriv > 0) {
+                assert(stats.nr_cegar_rounds > 0);
+                assert(stats.nr_cegar_minterms > 0);
+                // Every minterm adds the clauses that tie the outputs to
+                // the steps.
+                assert(stats.nr_cegar_clauses > 0);
+            }
+            if (spec.cegar_strategy == CEGAR_FIRST && spec.nr_rand_tt_assigns == 0) {
+                // A minterm for each refinement, none for the first round
+                // of each step count.
+                assert(stats.nr_cegar_minterms < stats.nr_cegar_rounds);
+            }
+            total_rounds[i] += stats.nr_cegar_rounds;
+            total_clauses[i] += stats.nr_cegar_clauses;
+        }
+    }
+    for (int i = 0; i < 2 * CEGAR_TOTAL; i++) {
+        printf("nr_in=%d %s%s: %d rounds, %d clauses\n", nr_in,
+                CegarStrategyToString[i % CEGAR_TOTAL],
+                (i / CEGAR_TOTAL) ? " (seeded)" : "", total_rounds[i],
+                total_clauses[i]);
+    }
+}
+
+void check_fence_cegar(int nr_in, int nr_out, int nr_tests)
+{
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    bsat_wrapper fence_solver;
+    ssv_fence2_encoder fence_encoder(fence_solver);
+    chain c1, c2, c3;
+    synth_stats stats;
+    dynamic_truth_table tt(nr_in);
+
+    for (int t = 0; t < nr_tests; t++) {
+        spec spec;
+        spec.add_lex_func_clauses = false;
+        for (int h = 0; h < nr_out; h++) {
+            kitty::create_random(tt, rand());
+            spec[h] = tt;
+        }
+        const auto res1 = synthesize(spec, c1, solver, encoder);
+        assert(res1 == success);
+
+        for (int i = 0; i < 2 * CEGAR_TOTAL; i++) {
+            set_strategy(spec, i);
+            const auto res2 = synthesize(spec, c2, fence_solver,
+                    fence_encoder, SYNTH_FENCE_CEGAR, &stats);
+            assert(res2 == success);
+            assert(c2.satisfies_spec(spec));
+            assert(c1.get_nr_steps() == c2.get_nr_steps());
+            // Every fence is seeded and takes at least one round.
+            assert(stats.nr_cegar_minterms <= stats.nr_cegar_rounds *
+                    (spec.cegar_nr_minterms + spec.nr_rand_tt_assigns));
+
+            const auto res3 = pf_fence_cegar_synthesize(spec, c3, 2);
+            assert(res3 == success);
+            assert(c3.satisfies_spec(spec));
+            assert(c1.get_nr_steps() == c3.get_nr_steps());
+        }
+    }
+}
+
+void check_pd_cegar(int nr_in)
+{
+    spec spec;
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    partial_dag_encoder pd_encoder(solver);
+    pd_encoder.reset_sim_tts(nr_in);
+    chain c1, c2;
+    synth_stats stats;
+    dynamic_truth_table tt(nr_in);
+    const auto dags = pd_generate_max(5);
+
+    for (int t = 0; t < 10; t++) {
+        kitty::create_random(tt, rand());
+        spec[0] = tt;
+        spec.cegar_strategy = CEGAR_FIRST;
+        spec.nr_rand_tt_assigns = 0;
+        const auto res1 = synthesize(spec, c1, solver, encoder);
+        assert(res1 == success);
+        if (c1.get_nr_steps() == 0 || c1.get_nr_steps() > 5) {
+            continue;
+        }
+
+        for (int i = 0; i < 2 * CEGAR_TOTAL; i++) {
+            set_strategy(spec, i);
+            spec.preprocess();
+            auto res2 = failure;
+            for (const auto& dag : dags) {
+                if (dag.nr_vertices() != c1.get_nr_steps()) {
+                    continue;
+                }
+                res2 = pd_cegar_synthesize(spec, c2, dag, solver,
+                        pd_encoder, &stats);
+                if (res2 == success) {
+                    break;
+                }
+            }
+            assert(res2 == success);
+            // Chains found from partial DAGs are not in canonical form.
+            assert(c2.simulate()[0] == spec[0]);
+        }
+    }
+}
+
+int main()
+{
+    srand(1);
+    check_selection();
+
+    check_std_cegar(3, 10);
+    check_std_cegar(4, 4);
+
+    check_fence_cegar(3, 1, 10);
+    check_fence_cegar(4, 1, 4);
+    check_fence_cegar(3, 2, 6);
+
+    check_pd_cegar(4);
+
+    return 0;
+}
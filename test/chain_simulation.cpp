@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies the word-level chain simulation against a minterm by minterm
+    evaluation of random chains, for all fanins and for both dynamic and
+    static truth tables.
+*******************************************************************************/
+chain random_chain(int nr_in, int fanin, int nr_steps, int nr_out)
+{
+    chain c;
+    c.reset(nr_in, nr_out, nr_steps, fanin);
+    std::vector<int> fanins(fanin);
+    dynamic_truth_table op(fanin);
+    for (int i = 0; i < nr_steps; i++) {
+        for (int j = 0; j < fanin; j++) {
+            fanins[j] = rand() % (nr_in + i);
+        }
+        for (int j = 0; j < (1 << fanin); j++) {
+            if (rand() & 1) {
+                kitty::set_bit(op, j);
+            } else {
+                kitty::clear_bit(op, j);
+            }
+        }
+        c.set_step(i, fanins, op);
+    }
+    for (int h = 0; h < nr_out; h++) {
+        c.set_output(h, rand() % (2 * (nr_in + nr_steps + 1)));
+    }
+    return c;
+}
+
+/// Returns the value of output h of the chain for input minterm x.
+int eval_output(const chain& c, int h, int x)
+{
+    std::vector<int> values(c.get_nr_inputs() + c.get_nr_steps());
+    for (int i = 0; i < c.get_nr_inputs(); i++) {
+        values[i] = (x >> i) & 1;
+    }
+    for (int i = 0; i < c.get_nr_steps(); i++) {
+        const auto& step = c.get_step(i);
+        auto j = 0;
+        for (int k = 0; k < c.get_fanin(); k++) {
+            j |= values[step[k]] << k;
+        }
+        values[c.get_nr_inputs() + i] = kitty::get_bit(c.get_operator(i), j);
+    }
+    const auto out = c.get_outputs()[h];
+    const auto var = out >> 1;
+    return (var == 0 ? 0 : values[var - 1]) ^ (out & 1);
+}
+
+template<typename TT>
+void check_simulation(const chain& c, const std::vector<TT>& fs)
+{
+    assert(fs.size() == static_cast<unsigned>(c.get_nr_outputs()));
+    for (int h = 0; h < c.get_nr_outputs(); h++) {
+        assert(fs[h].num_vars() == c.get_nr_inputs());
+        for (int x = 0; x < (1 << c.get_nr_inputs()); x++) {
+            assert(kitty::get_bit(fs[h], x) ==
+                    static_cast<unsigned>(eval_output(c, h, x)));
+        }
+        // Unused bits of small truth tables are cleared.
+        for (uint64_t i = fs[h].num_bits(); i < 64; i++) {
+            assert(((*fs[h].cbegin()) >> i & 1) == 0);
+        }
+    }
+}
+
+template<int NumVars>
+void check_static(int fanin)
+{
+    std::vector<kitty::static_truth_table<NumVars>> fs, tts;
+    for (int i = 0; i < 50; i++) {
+        const auto c = random_chain(NumVars, fanin, 1 + rand() % 12, 1 + rand() % 3);
+        c.simulate(fs, tts);
+        check_simulation(c, fs);
+        const auto dyn_fs = c.simulate();
+        for (auto h = 0u; h < fs.size(); h++) {
+            assert(*fs[h].cbegin() == *dyn_fs[h].cbegin());
+        }
+    }
+}
+
+int main()
+{
+    srand(1);
+    for (int fanin = 2; fanin <= MAX_FANIN; fanin++) {
+        for (int nr_in = fanin; nr_in <= 9; nr_in++) {
+            std::vector<dynamic_truth_table> fs, tts;
+            for (int i = 0; i < 50; i++) {
+                const auto c = random_chain(nr_in, fanin, 1 + rand() % 12, 1 + rand() % 3);
+                c.simulate(fs, tts);
+                check_simulation(c, fs);
+                check_simulation(c, c.simulate());
+            }
+        }
+    }
+
+    // The scratch storage is reused for chains of the same shape.
+    {
+        std::vector<dynamic_truth_table> fs, tts;
+        const auto c = random_chain(8, 2, 10, 2);
+        c.simulate(fs, tts);
+        const auto* data = &*tts.back().cbegin();
+        c.simulate(fs, tts);
+        assert(data == &*tts.back().cbegin());
+        check_simulation(c, fs);
+    }
+
+    for (int fanin = 2; fanin <= 3; fanin++) {
+        check_static<3>(fanin);
+        check_static<4>(fanin);
+        check_static<5>(fanin);
+        check_static<6>(fanin);
+    }
+
+    return 0;
+}
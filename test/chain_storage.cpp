@@ -0,0 +1,118 @@
+#include <cstdio>
+#include <utility>
+#include <vector>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies the accessors of the flat chain storage, and that chains can
+    be copied and moved without changing the functions they compute.
+*******************************************************************************/
+chain full_adder()
+{
+    chain c;
+    c.reset(3, 2, 0, 2);
+    dynamic_truth_table xor_tt(2), and_tt(2), or_tt(2);
+    kitty::create_from_hex_string(xor_tt, "6");
+    kitty::create_from_hex_string(and_tt, "8");
+    kitty::create_from_hex_string(or_tt, "e");
+    const std::vector<int> s1 = { 0, 1 };
+    const std::vector<int> s2 = { 2, 3 };
+    const std::vector<int> s3 = { 0, 1 };
+    const std::vector<int> s4 = { 2, 3 };
+    const std::vector<int> s5 = { 5, 6 };
+    c.add_step(s1, xor_tt);
+    c.add_step(s2, xor_tt);
+    c.add_step(s3, and_tt);
+    c.add_step(s4, and_tt);
+    c.add_step(s5, or_tt);
+    c.set_output(0, 5, false);
+    c.set_output(1, 8, false);
+    return c;
+}
+
+void check_full_adder(const chain& c)
+{
+    assert(c.get_nr_steps() == 5);
+    assert(c.get_fanin() == 2);
+    const auto step = c.get_step(4);
+    assert(step.size() == 2);
+    assert(step[0] == 5 && step.at(1) == 6);
+    auto nr_fanins = 0;
+    for (const auto fid : c.get_step(1)) {
+        assert(fid == 2 + nr_fanins);
+        nr_fanins++;
+    }
+    assert(nr_fanins == 2);
+    assert(c.get_operator_word(0) == 0x6);
+    assert(c.get_operator_word(4) == 0xe);
+    assert(kitty::to_hex(c.get_operator(2)) == "8");
+
+    const auto tts = c.simulate();
+    assert(kitty::to_hex(tts[0]) == "96");
+    assert(kitty::to_hex(tts[1]) == "e8");
+}
+
+int main()
+{
+    auto c1 = full_adder();
+    check_full_adder(c1);
+
+    // Copies are independent of the original.
+    chain c2(c1);
+    check_full_adder(c2);
+    dynamic_truth_table nand_tt(2);
+    kitty::create_from_hex_string(nand_tt, "7");
+    c2.set_step(0, 0, 1, nand_tt);
+    assert(c2.get_operator_word(0) == 0x7);
+    check_full_adder(c1);
+
+    // Moves take over the storage of the original.
+    chain c3(std::move(c2));
+    assert(c3.get_operator_word(0) == 0x7);
+    chain c4;
+    c4 = std::move(c1);
+    check_full_adder(c4);
+    c4 = c3;
+    assert(c4.get_operator_word(0) == 0x7);
+
+    std::vector<chain> chains;
+    for (int i = 0; i < 100; i++) {
+        chains.push_back(full_adder());
+    }
+    for (const auto& c : chains) {
+        check_full_adder(c);
+    }
+
+    // Inverting an output complements its step, unless the step is used
+    // elsewhere, in which case an inverted copy of it is added.
+    auto c5 = full_adder();
+    c5.get_outputs().push_back(8 << 1);
+    c5.set_output(0, 5, true);
+    c5.set_output(1, 7, true);
+    c5.denormalize();
+    const auto tts = c5.simulate();
+    assert(kitty::to_hex(tts[0]) == "69");
+    assert(kitty::to_hex(tts[1]) == "9f");
+    assert(kitty::to_hex(tts[2]) == "e8");
+    assert(c5.get_operator_word(1) == 0x9);
+    assert(c5.get_nr_steps() == 6);
+    assert(c5.get_operator_word(5) == 0x7);
+    assert(c5.get_outputs()[1] == (9 << 1));
+
+    // Operators of fanin 5 fill the entire operator word.
+    chain c6;
+    c6.reset(5, 1, 1, 5);
+    dynamic_truth_table op(5);
+    kitty::create_from_hex_string(op, "fffffffe");
+    const int fanins[] = { 0, 1, 2, 3, 4 };
+    c6.set_step(0, fanins, op);
+    c6.set_output(0, 6, true);
+    c6.denormalize();
+    assert(c6.get_operator_word(0) == 0x1);
+    assert(kitty::to_hex(c6.simulate()[0]) == "00000001");
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that solvers of the same backend can be used at the same time
+    in different threads: every thread synthesizes the same functions and
+    solves the same formulas under assumptions with a solver of its own,
+    and must get the results that a single BSAT solver gets.
+*******************************************************************************/
+typedef std::vector<std::vector<pabc::lit>> cnf_t;
+
+struct instance
+{
+    cnf_t cnf;
+    std::vector<pabc::lit> assumptions;
+    synth_result result;
+};
+
+const int nr_vars = 24;
+
+synth_result solve(solver_wrapper& solver, instance& inst)
+{
+    solver.restart();
+    solver.set_nr_vars(nr_vars);
+    for (auto& clause : inst.cnf) {
+        solver.add_clause(clause.data(), clause.data() + clause.size());
+    }
+    const auto begin = inst.assumptions.data();
+    return solver.solve(begin, begin + inst.assumptions.size(), 0);
+}
+
+std::vector<instance> random_instances(int nr_instances)
+{
+    bsat_wrapper bsat;
+    std::vector<instance> instances(nr_instances);
+    for (auto& inst : instances) {
+        inst.cnf.resize(3 * nr_vars);
+        for (auto& clause : inst.cnf) {
+            for (int j = 0; j < 3; j++) {
+                clause.push_back(pabc::Abc_Var2Lit(rand() % nr_vars, rand() & 1));
+            }
+        }
+        for (int i = 0; i < nr_vars; i++) {
+            if (rand() % 3 == 0) {
+                inst.assumptions.push_back(pabc::Abc_Var2Lit(i, rand() & 1));
+            }
+        }
+        inst.result = solve(bsat, inst);
+    }
+    return instances;
+}
+
+void check_backend(const solver_factory& factory, int nr_threads,
+        const std::vector<dynamic_truth_table>& functions,
+        const std::vector<int>& nr_steps, const std::vector<instance>& instances)
+{
+    std::vector<std::thread> threads;
+    std::vector<int> nr_errors(nr_threads, 0);
+    for (int i = 0; i < nr_threads; i++) {
+        threads.emplace_back([&, i] {
+            // The clauses are passed to the solvers as mutable arrays.
+            auto local_instances = instances;
+            auto solver = factory(i);
+            ssv_encoder encoder(*solver);
+            for (std::size_t j = 0; j < functions.size(); j++) {
+                spec spec;
+                spec[0] = functions[j];
+                chain c;
+                const auto res = synthesize(spec, c, *solver, encoder);
+                if (res != success || !c.satisfies_spec(spec) ||
+                        c.get_nr_steps() != nr_steps[j]) {
+                    nr_errors[i]++;
+                }
+            }
+            for (auto& inst : local_instances) {
+                if (solve(*solver, inst) != inst.result) {
+                    nr_errors[i]++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto n : nr_errors) {
+        assert(n == 0);
+    }
+}
+
+template<typename Solver>
+std::unique_ptr<solver_wrapper> make_solver(int)
+{
+    return std::unique_ptr<solver_wrapper>(new Solver);
+}
+
+int main()
+{
+    const int nr_threads = 4;
+
+    srand(1);
+    std::vector<dynamic_truth_table> functions;
+    std::vector<int> nr_steps;
+    bsat_wrapper bsat;
+    ssv_encoder encoder(bsat);
+    for (int i = 0; i < 16; i++) {
+        dynamic_truth_table tt(3);
+        kitty::create_random(tt, i);
+        spec spec;
+        spec[0] = tt;
+        chain c;
+        const auto res = synthesize(spec, c, bsat, encoder);
+        assert(res == success);
+        functions.push_back(tt);
+        nr_steps.push_back(c.get_nr_steps());
+    }
+    const auto instances = random_instances(64);
+
+    check_backend(make_solver<bsat_wrapper>, nr_threads, functions, nr_steps, instances);
+    check_backend(make_solver<bmcg_wrapper>, nr_threads, functions, nr_steps, instances);
+#ifdef USE_SATOKO
+    check_backend(make_solver<satoko_wrapper>, nr_threads, functions, nr_steps, instances);
+#endif
+#if defined(USE_GLUCOSE) || defined(USE_SYRUP)
+    check_backend(make_solver<glucose_wrapper>, nr_threads, functions, nr_steps, instances);
+#endif
+#ifdef USE_CMS
+    check_backend(make_solver<cmsat_wrapper>, nr_threads, functions, nr_steps, instances);
+#endif
+
+    return 0;
+}
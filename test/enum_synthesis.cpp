@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that the enumeration synthesizer finds chains of the same
+    size as the SAT-based synthesizer, and that these chains satisfy the
+    same symmetry breaks.
+*******************************************************************************/
+void check_cost_table()
+{
+    // The number of functions of four variables by optimum chain size,
+    // as given by Knuth in TAOCP 7.1.2.
+    const int expected[] = { 10, 60, 456, 2474, 10624, 24184, 25008, 2720 };
+    int counts[8] = { 0 };
+    const auto& db = get_enum_cost_db();
+    for (int f = 0; f < (1 << 16); f++) {
+        assert(db.cost[f] < 8);
+        counts[db.cost[f]]++;
+    }
+    for (int i = 0; i < 8; i++) {
+        assert(counts[i] == expected[i]);
+    }
+}
+
+void check_equivalence(spec& spec, solver_wrapper& solver, std_encoder& encoder)
+{
+    chain c1, c2;
+    synth_stats stats;
+    const auto res1 = synthesize(spec, c1, solver, encoder);
+    assert(res1 == success);
+    const auto res2 = synthesize(spec, c2, solver, encoder, SYNTH_ENUM, &stats);
+    assert(res2 == success);
+    assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+    auto has_dc = false;
+    for (int h = 0; h < spec.get_nr_out(); h++) {
+        has_dc |= spec.has_dc_mask(h);
+    }
+    if (!has_dc) {
+        assert(c2.satisfies_spec(spec));
+        return;
+    }
+    // The chain only has to agree with the specification on the care set.
+    const auto tts = c2.simulate();
+    for (int h = 0; h < spec.get_nr_out(); h++) {
+        auto diff = tts[h] ^ spec[h];
+        if (spec.has_dc_mask(h)) {
+            diff &= ~spec.get_dc_mask(h);
+        }
+        assert(kitty::is_const0(diff));
+    }
+}
+
+void check_random(int nr_in, int nr_out, int nr_tests, bool dont_cares = false)
+{
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    dynamic_truth_table tt(nr_in), dc(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        spec spec;
+        for (int h = 0; h < nr_out; h++) {
+            kitty::create_random(tt, rand());
+            spec[h] = tt;
+            if (dont_cares) {
+                // About a quarter of the minterms are don't cares.
+                dynamic_truth_table dc2(nr_in);
+                kitty::create_random(dc, rand());
+                kitty::create_random(dc2, rand());
+                spec.set_dont_care(h, dc & dc2);
+            }
+        }
+        check_equivalence(spec, solver, encoder);
+    }
+}
+
+/// Random functions of five inputs need too many steps to be synthesized
+/// quickly, so these are taken from random chains of a few steps.
+void check_small_chains(int nr_in, int nr_steps, int nr_tests)
+{
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    const char* ops[] = { "8", "e", "6", "2", "4" };
+    dynamic_truth_table op(2);
+    for (int t = 0; t < nr_tests; t++) {
+        chain c;
+        c.reset(nr_in, 1, nr_steps, 2);
+        for (int i = 0; i < nr_steps; i++) {
+            kitty::create_from_hex_string(op, ops[rand() % 5]);
+            const auto k = 1 + rand() % (nr_in + i - 1);
+            c.set_step(i, rand() % k, k, op);
+        }
+        c.set_output(0, nr_in + nr_steps, rand() & 1);
+
+        spec spec;
+        spec[0] = c.simulate()[0];
+        check_equivalence(spec, solver, encoder);
+    }
+}
+
+void check_all(int nr_in)
+{
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    dynamic_truth_table tt(nr_in);
+    do {
+        spec spec;
+        spec[0] = tt;
+        check_equivalence(spec, solver, encoder);
+        kitty::next_inplace(tt);
+    } while (!kitty::is_const0(tt));
+}
+
+int main()
+{
+    srand(1);
+    check_cost_table();
+
+    check_all(2);
+    check_all(3);
+    check_random(4, 1, 16);
+    check_random(3, 2, 32);
+    check_random(3, 3, 8);
+    check_random(4, 1, 16, true);
+    check_small_chains(4, 5, 16);
+    check_small_chains(5, 5, 8);
+
+    // Unsupported specifications are rejected.
+    spec spec;
+    chain c;
+    dynamic_truth_table tt(6);
+    kitty::create_random(tt, rand());
+    spec[0] = tt;
+    assert(enum_synthesize(spec, c) == failure);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <percy/percy.hpp>
+
+using namespace percy;
+
+/*******************************************************************************
+    A stand-in for an external solver executable, which the external_solver
+    test runs in a child process. Reads a DIMACS formula from the standard
+    input, solves it with BSAT, and writes the result in the format of the
+    SAT competitions. An argument makes it misbehave instead:
+
+        hang   never answers
+        oom    allocates memory until it fails
+        crash  aborts after reading the formula
+        noisy  writes a lot of comments before it reads the formula
+        linger closes its output after the result, and keeps running
+        orphan starts a process that keeps running and holds the output
+               open, writes its pid to the file given as the second
+               argument, and exits
+*******************************************************************************/
+int main(int argc, char** argv)
+{
+    const char* mode = argc > 1 ? argv[1] : "";
+
+    if (strcmp(mode, "noisy") == 0) {
+        for (int i = 0; i < 100000; i++) {
+            printf("c waiting for the formula\n");
+        }
+    }
+
+    bsat_wrapper solver;
+    std::vector<pabc::lit> clause;
+    char token[32];
+    int nr_vars = 0;
+    auto ok = true;
+    while (scanf("%31s", token) == 1) {
+        if (token[0] == 'c') {
+            while (getchar() != '\n' && !feof(stdin)) {
+            }
+        } else if (token[0] == 'p') {
+            int nr_clauses;
+            if (scanf("%*s %d %d", &nr_vars, &nr_clauses) != 2) {
+                fprintf(stderr, "Error: invalid header\n");
+                return 1;
+            }
+            solver.set_nr_vars(nr_vars);
+        } else {
+            const auto l = atoi(token);
+            if (l == 0) {
+                ok = ok && solver.add_clause(clause.data(),
+                        clause.data() + clause.size());
+                clause.clear();
+            } else {
+                clause.push_back(pabc::Abc_Var2Lit(abs(l) - 1, l < 0));
+            }
+        }
+    }
+
+    if (strcmp(mode, "hang") == 0) {
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    } else if (strcmp(mode, "oom") == 0) {
+        std::vector<std::vector<char>> blocks;
+        while (true) {
+            blocks.emplace_back(1 << 20, 1);
+        }
+    } else if (strcmp(mode, "crash") == 0) {
+        abort();
+    } else if (strcmp(mode, "orphan") == 0) {
+        const auto pid = fork();
+        if (pid == 0) {
+            while (true) {
+                sleep(1);
+            }
+        }
+        if (argc > 2) {
+            if (FILE* f = fopen(argv[2], "w")) {
+                fprintf(f, "%d\n", int(pid));
+                fclose(f);
+            }
+        }
+        return 1;
+    }
+
+    const auto res = ok ? solver.solve(0) : failure;
+    if (res == success) {
+        printf("s SATISFIABLE\nv");
+        for (int i = 0; i < nr_vars; i++) {
+            printf(" %d", solver.var_value(i) ? i + 1 : -(i + 1));
+        }
+        printf(" 0\n");
+    } else {
+        printf("s UNSATISFIABLE\n");
+    }
+    if (strcmp(mode, "linger") == 0) {
+        fclose(stdout);
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+    return res == success ? 10 : 20;
+}
@@ -0,0 +1,187 @@
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that an external solver process finds chains of the same size
+    as BSAT, and that solvers that hang, run out of memory, crash or are
+    interrupted are stopped and make solve return timeout.
+*******************************************************************************/
+#if !defined(_WIN32) && defined(DIMACS_SOLVER)
+void set_mode(external_wrapper& solver, const char* mode = nullptr,
+        const char* arg = nullptr)
+{
+    std::vector<std::string> command = { DIMACS_SOLVER };
+    if (mode) {
+        command.push_back(mode);
+    }
+    if (arg) {
+        command.push_back(arg);
+    }
+    solver.set_command(command);
+}
+
+void add_formula(solver_wrapper& solver)
+{
+    // (x0 | x1) & (!x0 | x1) & (!x1 | x2)
+    pabc::lit clauses[3][2] = {
+        { pabc::Abc_Var2Lit(0, 0), pabc::Abc_Var2Lit(1, 0) },
+        { pabc::Abc_Var2Lit(0, 1), pabc::Abc_Var2Lit(1, 0) },
+        { pabc::Abc_Var2Lit(1, 1), pabc::Abc_Var2Lit(2, 0) },
+    };
+    solver.restart();
+    solver.set_nr_vars(3);
+    for (auto& clause : clauses) {
+        solver.add_clause(clause, clause + 2);
+    }
+}
+
+void check_formula()
+{
+    external_wrapper solver;
+    set_mode(solver);
+    add_formula(solver);
+    assert(solver.solve(0) == success);
+    assert(solver.var_value(1) == 1);
+    assert(solver.var_value(2) == 1);
+
+    pabc::lit assumption = pabc::Abc_Var2Lit(2, 1);
+    assert(solver.solve(&assumption, &assumption + 1, 0) == failure);
+    assumption = pabc::Abc_Var2Lit(0, 1);
+    assert(solver.solve(&assumption, &assumption + 1, 0) == success);
+    assert(solver.var_value(0) == 0);
+}
+
+void check_synthesis(int nr_in, int nr_tests)
+{
+    bsat_wrapper bsat;
+    ssv_encoder bsat_encoder(bsat);
+    external_wrapper solver;
+    set_mode(solver);
+    ssv_encoder encoder(solver);
+
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec[0] = tt;
+        chain c1, c2;
+        const auto res1 = synthesize(spec, c1, bsat, bsat_encoder);
+        assert(res1 == success);
+        const auto res2 = synthesize(spec, c2, solver, encoder);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+    }
+}
+
+/// Returns true if the process with the given pid has exited.
+bool has_exited(int pid)
+{
+    for (int i = 0; i < 100; i++) {
+        std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+        std::string pid_field, name, state;
+        if (!(stat >> pid_field >> name >> state) || state == "Z") {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return false;
+}
+
+/// Returns the number of milliseconds that a call to solve takes.
+int64_t check_timeout(external_wrapper& solver)
+{
+    add_formula(solver);
+    const auto begin = std::chrono::steady_clock::now();
+    assert(solver.solve(0) == timeout);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+}
+
+void check_limits()
+{
+    external_wrapper hang;
+    set_mode(hang, "hang");
+    hang.set_time_limit(200);
+    assert(check_timeout(hang) < 5000);
+
+    external_wrapper oom;
+    set_mode(oom, "oom");
+    oom.set_memory_limit(256);
+    assert(check_timeout(oom) < 5000);
+
+    external_wrapper crash;
+    set_mode(crash, "crash");
+    check_timeout(crash);
+
+    external_wrapper missing({ "./no_such_solver" });
+    check_timeout(missing);
+
+    external_wrapper interrupted;
+    set_mode(interrupted, "hang");
+    std::thread killer([&interrupted] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        interrupted.interrupt();
+    });
+    assert(check_timeout(interrupted) < 5000);
+    killer.join();
+
+    // An interrupt that arrives before solve starts stops only the next
+    // call.
+    external_wrapper early;
+    set_mode(early);
+    early.interrupt();
+    add_formula(early);
+    assert(early.solve(0) == timeout);
+    assert(early.solve(0) == success);
+
+    // The solver answers but does not exit after closing its output.
+    external_wrapper linger;
+    set_mode(linger, "linger");
+    linger.set_time_limit(200);
+    assert(check_timeout(linger) < 5000);
+
+    // The processes that the solver started are stopped with it.
+#ifdef __linux__
+    const char pid_file[] = "external_solver_orphan.txt";
+    remove(pid_file);
+    external_wrapper orphan;
+    set_mode(orphan, "orphan", pid_file);
+    orphan.set_time_limit(200);
+    assert(check_timeout(orphan) < 5000);
+    int pid = 0;
+    std::ifstream(pid_file) >> pid;
+    remove(pid_file);
+    assert(pid > 0);
+    assert(has_exited(pid));
+#endif
+
+    // The solver writes more output than a pipe holds before it reads
+    // the formula.
+    external_wrapper noisy;
+    set_mode(noisy, "noisy");
+    add_formula(noisy);
+    assert(noisy.solve(0) == success);
+}
+
+int main()
+{
+    check_formula();
+    check_limits();
+    check_synthesis(3, 16);
+
+    return 0;
+}
+#else
+int main()
+{
+    return 0;
+}
+#endif
@@ -0,0 +1,118 @@
+#include <percy/percy.hpp>
+#include <cassert>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace percy;
+using std::vector;
+
+/*******************************************************************************
+    Verifies that the explicit-stack fence generator generates the same
+    fences, in the same order, as the recursive generator, and that its
+    ranges partition the fences.
+*******************************************************************************/
+bool equal_fences(const fence& f1, const fence& f2)
+{
+    if (f1.nr_nodes() != f2.nr_nodes() || f1.nr_levels() != f2.nr_levels()) {
+        return false;
+    }
+    for (int i = 0; i < f1.nr_levels(); i++) {
+        if (f1.at(i) != f2.at(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_generator(int k, int l, int nr_outputs, int max_fanin, bool po_filter)
+{
+    vector<fence> expected;
+    rec_fence_generator recgen(po_filter);
+    recgen.reset(k, l, nr_outputs, max_fanin);
+    recgen.generate_fences(expected);
+
+    vector<fence> fences;
+    fence f;
+    iter_fence_generator gen(po_filter);
+    gen.reset(k, l, nr_outputs, max_fanin);
+    while (gen.next_fence(f)) {
+        fences.push_back(f);
+    }
+    assert(!gen.next_fence(f));
+    assert(gen.nr_solutions() == expected.size());
+    assert(fences.size() == expected.size());
+    for (auto i = 0u; i < fences.size(); i++) {
+        assert(equal_fences(fences[i], expected[i]));
+    }
+
+    for (int nr_ranges = 2; nr_ranges <= 5; nr_ranges++) {
+        for (int split_level = 0; split_level <= l + 1; split_level++) {
+            vector<int> nr_found(expected.size(), 0);
+            for (int range = 0; range < nr_ranges; range++) {
+                iter_fence_generator rgen(po_filter);
+                rgen.set_range(nr_ranges, range, split_level);
+                rgen.reset(k, l, nr_outputs, max_fanin);
+                auto idx = 0u;
+                while (rgen.next_fence(f)) {
+                    // Ranges preserve the relative order of the fences.
+                    while (idx < expected.size() &&
+                            !equal_fences(f, expected[idx])) {
+                        idx++;
+                    }
+                    assert(idx < expected.size());
+                    nr_found[idx]++;
+                }
+            }
+            for (auto n : nr_found) {
+                assert(n == 1);
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    for (int k = 1; k <= 10; k++) {
+        for (int l = 1; l <= k; l++) {
+            for (int nr_outputs = 1; nr_outputs <= 3; nr_outputs++) {
+                for (int max_fanin = 2; max_fanin <= 3; max_fanin++) {
+                    check_generator(k, l, nr_outputs, max_fanin, true);
+                }
+            }
+            check_generator(k, l, 1, 2, false);
+        }
+    }
+
+    // Generate the ranges in parallel.
+    spec spec;
+    for (int k = 1; k <= 12; k++) {
+        spec.nr_steps = k;
+        vector<fence> expected;
+        generate_fences(spec, expected);
+
+        // try_enqueue does not allocate, so leave room for a partially
+        // filled block per producer.
+        moodycamel::ConcurrentQueue<fence> q(expected.size() + 1024);
+        vector<std::thread> threads;
+        const auto nr_threads = 4;
+        for (int i = 0; i < nr_threads; i++) {
+            threads.push_back(std::thread([&spec, &q, nr_threads, i] {
+                generate_fences(spec, q, nr_threads, i);
+            }));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        fence f;
+        auto nr_fences = 0u;
+        while (q.try_dequeue(f)) {
+            assert(f.nr_nodes() == k);
+            nr_fences++;
+        }
+        assert(nr_fences == expected.size());
+        printf("# fences = %u\n", nr_fences);
+    }
+
+    return 0;
+}
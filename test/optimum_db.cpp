@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that the tables built by enumerating partial DAGs contain
+    optimum chains: the complete table of four-input functions against the
+    footprint table, a table of three-input functions against SAT-based
+    synthesis, and a table of five-input functions against the enumeration
+    synthesizer.
+*******************************************************************************/
+void check_chain(const optimum_db& db, const dynamic_truth_table& tt)
+{
+    chain c;
+    const auto found = db.get_chain(tt, c);
+    assert(found);
+    assert(c.get_nr_steps() == db.get_nr_steps(tt));
+    assert(c.simulate()[0] == tt);
+}
+
+void check_complete4()
+{
+    optimum_db db(4);
+    db.build(OPTDB_MAX_STEPS, 2);
+    assert(db.is_complete());
+    assert(db.get_max_steps() == 7);
+
+    // The distribution given by Knuth in TAOCP 7.1.2.
+    const uint64_t expected[] = { 10, 60, 456, 2474, 10624, 24184, 25008, 2720 };
+    const auto counts = db.get_distribution();
+    assert(counts.size() == 8);
+    for (int i = 0; i < 8; i++) {
+        assert(counts[i] == expected[i]);
+    }
+
+    dynamic_truth_table tt(4);
+    const auto& cost_db = get_enum_cost_db();
+    db.foreach_function([&](uint64_t f, int nr_steps) {
+        assert(cost_db.cost[f] == nr_steps);
+    });
+    for (int i = 0; i < 1000; i++) {
+        kitty::create_random(tt, rand());
+        check_chain(db, tt);
+    }
+}
+
+void check_sat(int nr_in, int max_steps, int nr_tests)
+{
+    optimum_db db(nr_in);
+    db.build(max_steps, 2);
+    assert(!db.is_complete());
+
+    // Building in several calls or with one thread gives the same
+    // functions.
+    optimum_db db1(nr_in);
+    db1.build(max_steps - 1);
+    db1.build(max_steps);
+    assert(db1.get_distribution() == db.get_distribution());
+
+    spec spec;
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    chain c;
+    dynamic_truth_table tt(nr_in);
+    auto nr_known = 0;
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, rand());
+        spec[0] = tt;
+        const auto res = synthesize(spec, c, solver, encoder);
+        assert(res == success);
+        if (c.get_nr_steps() <= max_steps) {
+            assert(db.get_nr_steps(tt) == c.get_nr_steps());
+            check_chain(db, tt);
+            nr_known++;
+        } else {
+            assert(db.get_nr_steps(tt) == -1);
+        }
+    }
+    printf("nr_in=%d: %d of %d functions in a table of %zu\n", nr_in,
+            nr_known, nr_tests, db.size());
+}
+
+/// Random functions of five inputs need too many steps to be synthesized
+/// quickly, so the functions of the table are checked instead, and must
+/// not have smaller chains than the table holds.
+void check_enum(int nr_in, int max_steps, int nr_tests)
+{
+    optimum_db db(nr_in);
+    db.build(max_steps, 2);
+    assert(!db.is_complete());
+
+    const auto stride = std::max<std::size_t>(1, db.size() / nr_tests);
+    std::vector<uint64_t> functions;
+    std::size_t i = 0;
+    db.foreach_function([&](uint64_t f, int) {
+        if (i++ % stride == 0) {
+            functions.push_back(f);
+        }
+    });
+
+    dynamic_truth_table tt(nr_in);
+    chain c;
+    for (auto f : functions) {
+        kitty::create_from_words(tt, &f, &f + 1);
+        spec spec;
+        spec[0] = tt;
+        const auto res = enum_synthesize(spec, c);
+        assert(res == success);
+        assert(db.get_nr_steps(tt) == c.get_nr_steps());
+        check_chain(db, tt);
+    }
+    printf("nr_in=%d: %zu functions of a table of %zu\n", nr_in,
+            functions.size(), db.size());
+}
+
+int main()
+{
+    srand(1);
+    check_complete4();
+    check_sat(3, 3, 64);
+    check_enum(5, 4, 64);
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+#define MAX_TESTS 256
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that fence-based CEGAR synthesis, both serial and parallel,
+    finds optimum chains for single and multi-output specifications, with
+    and without don't cares.
+*******************************************************************************/
+bool satisfies_dc_spec(const chain& c, const spec& spec)
+{
+    const auto tts = c.simulate();
+    for (int h = 0; h < spec.get_nr_out(); h++) {
+        auto diff = tts[h] ^ spec[h];
+        if (spec.has_dc_mask(h)) {
+            diff &= ~spec.get_dc_mask(h);
+        }
+        if (!kitty::is_const0(diff)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void check_single_output(int nr_in)
+{
+    spec spec;
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    // The fence encoders do not order the operators of steps.
+    spec.add_lex_func_clauses = false;
+
+    auto max_tests = (1 << (1 << nr_in));
+    max_tests = std::min(max_tests, MAX_TESTS);
+    dynamic_truth_table tt(nr_in);
+    chain c1, c2, c3;
+
+    for (auto i = 1; i < max_tests; i++) {
+        kitty::create_from_words(tt, &i, &i+1);
+        spec[0] = tt;
+
+        const auto res1 = synthesize(spec, c1, solver, encoder);
+        assert(res1 == success);
+
+        const auto res2 = pf_fence_cegar_synthesize(spec, c2, 2);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+        const auto res3 = pf_synthesize(spec, c3, SYNTH_FENCE_CEGAR);
+        assert(res3 == success);
+        assert(c3.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c3.get_nr_steps());
+
+        printf("(%d/%d)\r", i+1, max_tests);
+        fflush(stdout);
+    }
+    printf("\n");
+}
+
+void check_multi_output(int nr_in, int nr_out, bool dont_cares)
+{
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    bsat_wrapper fence_solver;
+    ssv_fence2_encoder fence_encoder(fence_solver);
+    fence_encoder.reset_sim_tts(nr_in);
+
+    srand(nr_in * 17 + nr_out);
+    chain c1, c2, c3, c4;
+    dynamic_truth_table tt(nr_in), dc_mask(nr_in);
+
+    for (int i = 0; i < 32; i++) {
+        spec spec;
+        spec.add_lex_func_clauses = false;
+        for (int h = 0; h < nr_out; h++) {
+            // Only use non-trivial outputs, since the standard encoder
+            // indexes the don't care masks by non-trivial output.
+            do {
+                kitty::create_random(tt, rand());
+                spec[h] = tt;
+                spec.preprocess();
+            } while (spec.nr_nontriv != h + 1);
+            if (dont_cares) {
+                kitty::create_random(dc_mask, rand());
+                kitty::create_random(tt, rand());
+                dc_mask &= tt;
+                kitty::clear_bit(dc_mask, 0);
+                spec.set_dont_care(h, dc_mask);
+            }
+        }
+
+        const auto res1 = synthesize(spec, c1, solver, encoder);
+        assert(res1 == success);
+        assert(satisfies_dc_spec(c1, spec));
+
+        const auto res2 = fence_synthesize(spec, c2, fence_solver, fence_encoder);
+        assert(res2 == success);
+        assert(satisfies_dc_spec(c2, spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+        const auto res3 = fence_cegar_synthesize(spec, c3, fence_solver, fence_encoder);
+        assert(res3 == success);
+        assert(satisfies_dc_spec(c3, spec));
+        assert(c1.get_nr_steps() == c3.get_nr_steps());
+
+        const auto res4 = pf_fence_cegar_synthesize(spec, c4, 2);
+        assert(res4 == success);
+        assert(satisfies_dc_spec(c4, spec));
+        assert(c1.get_nr_steps() == c4.get_nr_steps());
+
+        printf("(%d/%d)\r", i+1, 32);
+        fflush(stdout);
+    }
+    printf("\n");
+}
+
+int main()
+{
+    check_single_output(2);
+    check_single_output(3);
+    check_single_output(4);
+
+    check_multi_output(3, 2, false);
+    check_multi_output(3, 3, false);
+    check_multi_output(3, 2, true);
+    check_multi_output(3, 3, true);
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that the parallel partial DAG CEGAR synthesizers, with DAGs in
+    memory and streamed from the serialized files, find chains of the same
+    size as the standard synthesizer.
+*******************************************************************************/
+void check_pool()
+{
+    cegar_cex_pool pool(3);
+    std::vector<int> mints;
+    pool.add(1);
+    pool.add(2);
+    pool.add(3);
+    pool.add(1);
+    pool.get(mints);
+    assert((mints == std::vector<int>{ 1, 3, 2 }));
+    pool.add(4);
+    pool.get(mints);
+    assert((mints == std::vector<int>{ 4, 1, 3 }));
+    assert(pool.size() == 3);
+}
+
+void check_pd_cegar_parallel(int nr_in, int nr_tests, int max_steps)
+{
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    chain c1, c2, c3;
+    dynamic_truth_table tt(nr_in);
+    const auto dags = pd_generate_max(max_steps);
+
+    for (int t = 0; t < nr_tests; t++) {
+        spec spec;
+        kitty::create_random(tt, rand());
+        spec[0] = tt;
+        const auto res1 = synthesize(spec, c1, solver, encoder);
+        assert(res1 == success);
+
+        spec.add_lex_func_clauses = false;
+        spec.add_colex_clauses = false;
+        const auto res2 = pd_cegar_synthesize_parallel(spec, c2, dags, 2);
+        if (c1.get_nr_steps() <= max_steps) {
+            assert(res2 == success);
+            assert(c2.get_nr_steps() == c1.get_nr_steps());
+            // Chains found from partial DAGs are not in canonical form.
+            assert(c2.simulate()[0] == spec[0]);
+        } else {
+            assert(res2 == failure);
+        }
+
+        const auto res3 = pd_ser_cegar_synthesize_parallel(spec, c3, 2,
+                "../../test/");
+        assert(res3 == success);
+        assert(c3.get_nr_steps() == c1.get_nr_steps());
+        assert(c3.simulate()[0] == spec[0]);
+    }
+}
+
+int main()
+{
+    srand(1);
+    check_pool();
+
+    check_pd_cegar_parallel(3, 20, 5);
+    check_pd_cegar_parallel(4, 10, 5);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <percy/percy.hpp>
+#include <chrono>
+
+#define MAX_TESTS 256
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that incremental synthesis over a set of partial DAGs finds
+    chains of the same size as non-incremental synthesis.
+*******************************************************************************/
+void check_pd_inc_equivalence(int nr_in)
+{
+    spec spec;
+
+    bsat_wrapper solver;
+    partial_dag_encoder encoder(solver);
+    encoder.reset_sim_tts(nr_in);
+
+    spec.add_alonce_clauses = false;
+    spec.add_nontriv_clauses = false;
+    spec.add_lex_func_clauses = false;
+    spec.add_colex_clauses = false;
+    spec.add_noreapply_clauses = false;
+    spec.add_symvar_clauses = false;
+
+    // don't run too many tests.
+    auto max_tests = (1 << (1 << nr_in));
+    max_tests = std::min(max_tests, MAX_TESTS);
+    dynamic_truth_table tt(nr_in);
+
+    chain c1, c2;
+
+    auto dags = pd_generate_max(7);
+
+    int64_t total_elapsed1 = 0;
+    int64_t total_elapsed2 = 0;
+
+    for (auto i = 1; i < max_tests; i++) {
+        kitty::create_from_words(tt, &i, &i+1);
+        spec[0] = tt;
+
+        auto start = std::chrono::steady_clock::now();
+        const auto res1 = pd_synthesize(spec, c1, dags, solver, encoder);
+        const auto elapsed1 = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start
+            ).count();
+        assert(res1 == success);
+        assert(c1.satisfies_spec(spec));
+
+        start = std::chrono::steady_clock::now();
+        const auto res2 = pd_inc_synthesize(spec, c2, dags, solver, encoder);
+        const auto elapsed2 = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start
+            ).count();
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+        printf("(%d/%d)\r", i+1, max_tests);
+        fflush(stdout);
+        total_elapsed1 += elapsed1;
+        total_elapsed2 += elapsed2;
+    }
+    printf("\n");
+    printf("Time elapsed (PD): %ldus\n", total_elapsed1);
+    printf("Time elapsed (PD INC): %ldus\n", total_elapsed2);
+}
+
+int main()
+{
+    {
+        // The symmetry breaking clauses depend on the complete DAG, so
+        // they must be retired along with it.
+        bsat_wrapper solver;
+        partial_dag_encoder encoder(solver);
+        encoder.reset_sim_tts(4);
+        spec spec;
+        chain c;
+        kitty::static_truth_table<4> tt;
+        kitty::create_from_hex_string(tt, "0357");
+        spec[0] = tt;
+        spec.add_alonce_clauses = false;
+        spec.add_lex_func_clauses = false;
+        spec.add_colex_clauses = false;
+
+        auto dags = pd_generate_max(6);
+        const auto status = pd_inc_synthesize(spec, c, dags, solver, encoder);
+        assert(status == success);
+        assert(c.satisfies_spec(spec));
+        assert(encoder.inc_nr_levels() == c.get_nr_steps());
+
+        // Restarting the solver midway through must not change the result.
+        encoder.set_inc_max_vars(64);
+        chain c2;
+        const auto status2 = pd_inc_synthesize(spec, c2, dags, solver, encoder);
+        assert(status2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c.get_nr_steps() == c2.get_nr_steps());
+    }
+
+    check_pd_inc_equivalence(2);
+    check_pd_inc_equivalence(3);
+    check_pd_inc_equivalence(4);
+
+    return 0;
+}
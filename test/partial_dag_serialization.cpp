@@ -1,5 +1,6 @@
 #include <percy/percy.hpp>
 #include <vector>
+#include <cstring>
 
 using namespace percy;
 
@@ -30,8 +31,28 @@ int main(void)
     dags.push_back(g2);
     dags.push_back(g3);
 
+    // Partial DAGs are trivially copyable, so a bytewise copy must
+    // result in an identical DAG.
+    partial_dag g4;
+    std::memcpy(&g4, &g3, sizeof(partial_dag));
+    assert(g4.nr_vertices() == g3.nr_vertices());
+    for (int i = 0; i < g3.nr_vertices(); i++) {
+        assert(g4.get_vertex(i)[0] == g3.get_vertex(i)[0]);
+        assert(g4.get_vertex(i)[1] == g3.get_vertex(i)[1]);
+    }
+
     write_partial_dags(dags, "test.bin");
     auto read_dags = read_partial_dags("test.bin");
+    assert(read_dags.size() == dags.size());
+    for (auto i = 0u; i < dags.size(); i++) {
+        assert(read_dags[i].nr_vertices() == dags[i].nr_vertices());
+        for (int j = 0; j < dags[i].nr_vertices(); j++) {
+            const auto v1 = read_dags[i].get_vertex(j);
+            const auto v2 = dags[i].get_vertex(j);
+            assert(v1.size() == v2.size());
+            assert(v1[0] == v2[0] && v1[1] == v2[1]);
+        }
+    }
     for (const auto& dag : read_dags) {
         for (int i = 0; i < dag.nr_vertices(); i++) {
             auto v = dag.get_vertex(i);
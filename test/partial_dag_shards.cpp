@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <percy/percy.hpp>
+
+using namespace percy;
+
+/*******************************************************************************
+    Verifies that partial DAG databases generated in shards, including
+    shards that were interrupted and resumed, are identical to the ones
+    generated in a single run.
+*******************************************************************************/
+std::vector<char> read_file(const std::string& filename)
+{
+    std::vector<char> bytes;
+    auto fhandle = fopen(filename.c_str(), "rb");
+    assert(fhandle != NULL);
+    int c;
+    while ((c = fgetc(fhandle)) != EOF) {
+        bytes.push_back(static_cast<char>(c));
+    }
+    fclose(fhandle);
+    return bytes;
+}
+
+/// Simulates a shard that was killed after it entered its second subtree,
+/// while it was writing the index line of the third one.
+void interrupt_shard(const std::string& idx_filename)
+{
+    auto fhandle = fopen(idx_filename.c_str(), "r");
+    assert(fhandle != NULL);
+    std::vector<std::string> lines;
+    char line[128];
+    while (fgets(line, sizeof(line), fhandle) != NULL) {
+        lines.push_back(line);
+    }
+    fclose(fhandle);
+    assert(lines.size() > 4);
+
+    fhandle = fopen(idx_filename.c_str(), "w");
+    assert(fhandle != NULL);
+    for (int i = 0; i < 3; i++) {
+        fputs(lines[i].c_str(), fhandle);
+    }
+    fputs(lines[3].substr(0, 1).c_str(), fhandle);
+    fclose(fhandle);
+}
+
+void check_shards(int fanin, int nr_vertices, int split_level, int nr_shards)
+{
+    const auto base = "shard_pd" + std::to_string(fanin) + "_" +
+        std::to_string(nr_vertices) + "_" + std::to_string(nr_shards);
+    const auto ref_filename = base + "_ref.bin";
+    if (fanin == 2) {
+        pd_write_nonisomorphic(nr_vertices, ref_filename.c_str());
+    } else {
+        pd3_write_nonisomorphic(nr_vertices, ref_filename.c_str());
+    }
+
+    for (int i = 0; i < nr_shards; i++) {
+        remove(pd_shard_filename(base.c_str(), i, nr_shards, ".idx").c_str());
+        const auto res = pd_write_shard(
+            fanin, nr_vertices, split_level, nr_shards, i, base.c_str());
+        assert(res);
+    }
+    const auto filename = base + ".bin";
+    assert(pd_merge_shards(base.c_str(), nr_shards, filename.c_str()));
+    assert(read_file(filename) == read_file(ref_filename));
+
+    // Completed shards are not generated again.
+    assert(pd_write_shard(
+        fanin, nr_vertices, split_level, nr_shards, 0, base.c_str()));
+
+    // Shards generated with other parameters are rejected.
+    assert(!pd_write_shard(
+        fanin, nr_vertices, split_level + 1, nr_shards, 0, base.c_str()));
+
+    const auto idx_filename =
+        pd_shard_filename(base.c_str(), 0, nr_shards, ".idx");
+    interrupt_shard(idx_filename);
+    pd_shard_index index;
+    assert(read_pd_shard_index(idx_filename.c_str(), index));
+    assert(!index.done);
+    assert(index.entries.size() == 2);
+    assert(!pd_merge_shards(base.c_str(), nr_shards, filename.c_str()));
+
+    assert(pd_write_shard(
+        fanin, nr_vertices, split_level, nr_shards, 0, base.c_str()));
+    assert(pd_merge_shards(base.c_str(), nr_shards, filename.c_str()));
+    assert(read_file(filename) == read_file(ref_filename));
+}
+
+int main()
+{
+    check_shards(2, 6, 4, 1);
+    check_shards(2, 6, 4, 3);
+    check_shards(2, 7, 5, 4);
+    check_shards(2, 3, 5, 2);
+    check_shards(3, 5, 3, 3);
+
+    const auto dags = read_partial_dags("shard_pd2_6_3.bin");
+    assert(dags.size() == pd_generate_nonisomorphic(6).size());
+
+    return 0;
+}
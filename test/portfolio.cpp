@@ -0,0 +1,191 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that the portfolio solver agrees with a sequential solver on
+    random formulas, with and without assumptions, and that synthesizers
+    using it find chains of the same size.
+*******************************************************************************/
+typedef std::vector<std::vector<pabc::lit>> cnf_t;
+
+cnf_t random_cnf(int nr_vars, int nr_clauses)
+{
+    cnf_t cnf(nr_clauses);
+    for (auto& clause : cnf) {
+        for (int j = 0; j < 3; j++) {
+            clause.push_back(pabc::Abc_Var2Lit(rand() % nr_vars, rand() & 1));
+        }
+    }
+    return cnf;
+}
+
+bool satisfies(const cnf_t& cnf, const std::vector<uint8_t>& model)
+{
+    for (const auto& clause : cnf) {
+        auto sat = false;
+        for (const auto l : clause) {
+            sat |= model[pabc::Abc_Lit2Var(l)] != pabc::Abc_LitIsCompl(l);
+        }
+        if (!sat) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void add_cnf(solver_wrapper& solver, int nr_vars, cnf_t& cnf)
+{
+    solver.restart();
+    solver.set_nr_vars(nr_vars);
+    for (auto& clause : cnf) {
+        solver.add_clause(clause.data(), clause.data() + clause.size());
+    }
+}
+
+/// Solves random formulas near the satisfiability threshold, which are
+/// hard enough for the solvers to share clauses, and some of them under
+/// assumptions.
+void check_random(portfolio_wrapper& portfolio, int nr_vars, int nr_tests)
+{
+    bsat_wrapper bsat;
+    std::vector<uint8_t> model;
+    std::vector<pabc::lit> assumptions, conflict;
+    for (int t = 0; t < nr_tests; t++) {
+        auto cnf = random_cnf(nr_vars, int(4.26 * nr_vars));
+        add_cnf(bsat, nr_vars, cnf);
+        add_cnf(portfolio, nr_vars, cnf);
+        assert(portfolio.nr_vars() == nr_vars);
+        assert(portfolio.nr_clauses() == int(cnf.size()));
+
+        const auto res = portfolio.solve(0);
+        assert(res == bsat.solve(0));
+        if (res == failure) {
+            // BSAT cannot be used again once the formula is known to be
+            // unsatisfiable.
+            continue;
+        }
+        portfolio.copy_model(model);
+        assert(satisfies(cnf, model));
+        for (int i = 0; i < nr_vars; i++) {
+            assert(model[i] == portfolio.var_value(i));
+        }
+
+        // The formula can be solved again, with more clauses and under
+        // assumptions.
+        assumptions.clear();
+        for (int i = 0; i < nr_vars; i += 8) {
+            assumptions.push_back(pabc::Abc_Var2Lit(i, rand() & 1));
+        }
+        auto extra = random_cnf(nr_vars, nr_vars / 8);
+        for (auto& clause : extra) {
+            bsat.add_clause(clause.data(), clause.data() + clause.size());
+            portfolio.add_clause(clause.data(), clause.data() + clause.size());
+            cnf.push_back(clause);
+        }
+        const auto begin = assumptions.data();
+        const auto end = begin + assumptions.size();
+        const auto res2 = portfolio.solve(begin, end, 0);
+        assert(res2 == bsat.solve(begin, end, 0));
+        if (res2 == success) {
+            portfolio.copy_model(model);
+            assert(satisfies(cnf, model));
+            for (const auto l : assumptions) {
+                assert(model[pabc::Abc_Lit2Var(l)] != pabc::Abc_LitIsCompl(l));
+            }
+        } else {
+            assert(portfolio.final_conflict(conflict));
+            for (const auto l : conflict) {
+                assert(std::find(begin, end, l) != end);
+            }
+            assert(bsat.solve(conflict.data(),
+                        conflict.data() + conflict.size(), 0) == failure);
+        }
+    }
+}
+
+void check_conflict_limit(portfolio_wrapper& portfolio)
+{
+    // A pigeonhole formula that is too hard for a small conflict limit.
+    const int nr_holes = 9;
+    const int nr_pigeons = nr_holes + 1;
+    portfolio.restart();
+    portfolio.set_nr_vars(nr_pigeons * nr_holes);
+    std::vector<pabc::lit> clause;
+    for (int p = 0; p < nr_pigeons; p++) {
+        clause.clear();
+        for (int h = 0; h < nr_holes; h++) {
+            clause.push_back(pabc::Abc_Var2Lit(p * nr_holes + h, 0));
+        }
+        portfolio.add_clause(clause.data(), clause.data() + clause.size());
+    }
+    for (int h = 0; h < nr_holes; h++) {
+        for (int p1 = 0; p1 < nr_pigeons; p1++) {
+            for (int p2 = p1 + 1; p2 < nr_pigeons; p2++) {
+                pabc::lit lits[2];
+                lits[0] = pabc::Abc_Var2Lit(p1 * nr_holes + h, 1);
+                lits[1] = pabc::Abc_Var2Lit(p2 * nr_holes + h, 1);
+                portfolio.add_clause(lits, lits + 2);
+            }
+        }
+    }
+    assert(portfolio.solve(100) == timeout);
+}
+
+void check_synthesis(int nr_in, int nr_tests)
+{
+    bsat_wrapper bsat;
+    ssv_encoder bsat_encoder(bsat);
+    auto portfolio = get_solver(SLV_PORTFOLIO);
+    ssv_encoder portfolio_encoder(*portfolio);
+    ssv_fence2_encoder fence_encoder(*portfolio);
+    fence_encoder.reset_sim_tts(nr_in);
+
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec[0] = tt;
+        chain c1, c2, c3;
+        const auto res1 = synthesize(spec, c1, bsat, bsat_encoder);
+        assert(res1 == success);
+        const auto res2 = synthesize(spec, c2, *portfolio, portfolio_encoder);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+        const auto res3 = synthesize(spec, c3, *portfolio, portfolio_encoder,
+                SYNTH_STD_CEGAR);
+        assert(res3 == success);
+        assert(c3.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c3.get_nr_steps());
+
+        spec.add_lex_func_clauses = false;
+        const auto res4 = fence_synthesize(spec, c3, *portfolio, fence_encoder);
+        assert(res4 == success);
+        assert(c3.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c3.get_nr_steps());
+    }
+}
+
+int main()
+{
+    srand(1);
+
+    portfolio_wrapper portfolio(4);
+    check_random(portfolio, 24, 100);
+    check_random(portfolio, 120, 8);
+    portfolio.set_nr_threads(1);
+    check_random(portfolio, 24, 20);
+    portfolio.set_nr_threads(3);
+    check_random(portfolio, 120, 4);
+    check_conflict_limit(portfolio);
+
+    check_synthesis(3, 16);
+    check_synthesis(4, 4);
+
+    return 0;
+}
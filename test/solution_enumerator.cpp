@@ -0,0 +1,126 @@
+#include <cstdio>
+#include <set>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that the solution enumerator finds the same solutions as
+    repeated calls of next_solution, also when it compacts its solver after
+    every few solutions, that structural enumeration finds every structure
+    once, and that the latency statistics account for every solution.
+*******************************************************************************/
+void no_symmetry_breaking(spec& spec)
+{
+    spec.add_alonce_clauses = false;
+    spec.add_colex_clauses = false;
+    spec.add_lex_func_clauses = false;
+    spec.add_noreapply_clauses = false;
+    spec.add_symvar_clauses = false;
+}
+
+void check_enumeration(solver_wrapper& solver, enumerating_encoder& encoder,
+        SynthMethod synth_method, int nr_in, int nr_tests)
+{
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        no_symmetry_breaking(spec);
+        spec[0] = tt;
+        chain c;
+
+        // Different assignments of the encoding can give the same chain.
+        std::multiset<std::size_t> expected;
+        std::set<std::size_t> expected_structs;
+        encoder.reset();
+        while (next_solution(spec, c, solver, encoder, synth_method) == success) {
+            assert(c.satisfies_spec(spec));
+            expected.insert(c.hash());
+            expected_structs.insert(c.hash(false));
+        }
+
+        for (const auto compact_interval : { 0, 1, 3 }) {
+            std::multiset<std::size_t> found;
+            solution_enumerator enumerator(spec, solver, encoder, synth_method);
+            enumerator.compact_interval = compact_interval;
+            while (enumerator.next(c) == success) {
+                assert(c.satisfies_spec(spec));
+                found.insert(c.hash());
+            }
+            assert(found == expected);
+
+            const auto& stats = enumerator.get_stats();
+            assert(stats.nr_solutions == int(found.size()));
+            assert(stats.nr_duplicates == 0);
+            assert(stats.window_latencies.size() ==
+                    std::size_t(std::max(0, stats.nr_solutions - 1) /
+                        ENUM_LATENCY_WINDOW));
+            if (compact_interval == 0) {
+                assert(stats.nr_compactions == 0);
+            } else if (stats.nr_solutions > compact_interval + 1) {
+                assert(stats.nr_compactions > 0);
+            }
+        }
+
+        chain_hash_store store(true);
+        solution_enumerator enumerator(spec, solver, encoder, synth_method);
+        enumerator.structural = true;
+        enumerator.compact_interval = 2;
+        enumerator.store = &store;
+        std::set<std::size_t> found_structs;
+        while (enumerator.next(c) == success) {
+            assert(c.satisfies_spec(spec));
+            found_structs.insert(c.hash(false));
+        }
+        assert(found_structs == expected_structs);
+        assert(store.size() == found_structs.size());
+        assert(enumerator.get_stats().nr_solutions == int(store.size()));
+    }
+}
+
+void check_duplicates()
+{
+    dynamic_truth_table and_tt(2), or_tt(2);
+    kitty::create_from_hex_string(and_tt, "8");
+    kitty::create_from_hex_string(or_tt, "e");
+
+    chain_hash_store store;
+    chain c1, c2;
+    c1.reset(2, 1, 1, 2);
+    c1.set_step(0, 0, 1, and_tt);
+    c1.set_output(0, 6);
+    c2 = c1;
+    assert(store.insert(c1));
+    assert(!store.insert(c2));
+    c2.set_step(0, 0, 1, or_tt);
+    assert(store.insert(c2));
+    assert(store.size() == 2);
+
+    chain_hash_store struct_store(true);
+    assert(struct_store.insert(c1));
+    assert(!struct_store.insert(c2));
+}
+
+int main()
+{
+    check_duplicates();
+
+    bsat_wrapper bsat;
+    ssv_encoder ssv_bsat(bsat);
+    msv_encoder msv_bsat(bsat);
+    ssv_fence_encoder fence_bsat(bsat);
+    check_enumeration(bsat, ssv_bsat, SYNTH_STD, 3, 32);
+    check_enumeration(bsat, ssv_bsat, SYNTH_STD, 4, 4);
+    check_enumeration(bsat, msv_bsat, SYNTH_STD, 3, 16);
+    check_enumeration(bsat, fence_bsat, SYNTH_FENCE, 3, 16);
+#ifdef USE_SATOKO
+    satoko_wrapper satoko;
+    ssv_encoder ssv_satoko(satoko);
+    check_enumeration(satoko, ssv_satoko, SYNTH_STD, 3, 32);
+    check_enumeration(satoko, ssv_satoko, SYNTH_STD, 4, 4);
+#endif
+
+    return 0;
+}
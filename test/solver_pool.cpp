@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that solvers which are restarted and reused find chains of the
+    same size as new solvers, and that pooled solvers are handed out again
+    once they are released.
+*******************************************************************************/
+void check_reuse(SolverType type, int nr_in, int nr_tests)
+{
+    auto reused = get_solver(type);
+    ssv_encoder reused_encoder(*reused);
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, rand());
+        spec spec;
+        spec[0] = tt;
+
+        auto fresh = get_solver(type);
+        ssv_encoder fresh_encoder(*fresh);
+        chain c1, c2;
+        const auto res1 = synthesize(spec, c1, *fresh, fresh_encoder);
+        assert(res1 == success);
+        const auto res2 = synthesize(spec, c2, *reused, reused_encoder);
+        assert(res2 == success);
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+        assert(c2.satisfies_spec(spec));
+    }
+}
+
+/// Adds the same unsatisfiable formula after every restart, followed by a
+/// satisfiable one, so that leftover clauses or assignments of a previous
+/// formula would change the result.
+void check_restart(solver_wrapper& solver)
+{
+    for (int i = 0; i < 8; i++) {
+        solver.restart();
+        solver.reserve(2, 4);
+        solver.set_nr_vars(2);
+        pabc::lit lits[2];
+        for (int j = 0; j < 4; j++) {
+            lits[0] = pabc::Abc_Var2Lit(0, j & 1);
+            lits[1] = pabc::Abc_Var2Lit(1, (j >> 1) & 1);
+            solver.add_clause(lits, lits + 2);
+        }
+        assert(solver.solve(0) == failure);
+
+        solver.restart();
+        solver.set_nr_vars(2);
+        lits[0] = pabc::Abc_Var2Lit(0, 1);
+        solver.add_clause(lits, lits + 1);
+        assert(solver.solve(0) == success);
+        assert(!solver.var_value(0));
+        assert(solver.nr_clauses() <= 1);
+    }
+}
+
+void check_pool()
+{
+    auto& pool = get_solver_pool();
+    pool.clear();
+    assert(pool.nr_idle() == 0);
+
+    solver_wrapper* first = nullptr;
+    {
+        auto solver = pool.acquire();
+        first = &(*solver);
+        check_restart(*solver);
+        assert(pool.nr_idle() == 0);
+    }
+    assert(pool.nr_idle() == 1);
+    {
+        // The released solver is handed out again, in a clean state.
+        auto solver1 = pool.acquire();
+        assert(&(*solver1) == first);
+        assert(solver1->nr_vars() == 0);
+        auto solver2 = pool.acquire();
+        assert(&(*solver2) != first);
+        assert(pool.nr_idle() == 0);
+    }
+    assert(pool.nr_idle() == 2);
+
+    // Parallel synthesizers take their solvers from the pool.
+    spec spec;
+    chain c1, c2;
+    dynamic_truth_table tt(4);
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    for (int t = 0; t < 8; t++) {
+        kitty::create_random(tt, rand());
+        spec[0] = tt;
+        const auto res1 = synthesize(spec, c1, solver, encoder);
+        assert(res1 == success);
+        // The fence encoder does not order the operators of steps.
+        spec.add_lex_func_clauses = false;
+        const auto res2 = pf_fence_synthesize(spec, c2, 2);
+        assert(res2 == success);
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+        assert(c2.satisfies_spec(spec));
+        spec.add_lex_func_clauses = true;
+    }
+    assert(pool.nr_idle() >= 2);
+    pool.clear();
+    assert(pool.nr_idle() == 0);
+}
+
+int main()
+{
+    srand(1);
+
+    bsat_wrapper bsat;
+    check_restart(bsat);
+    check_reuse(SLV_BSAT2, 3, 32);
+    check_reuse(SLV_BSAT2, 4, 8);
+#ifdef USE_SATOKO
+    satoko_wrapper satoko;
+    check_restart(satoko);
+    check_reuse(SLV_SATOKO, 3, 32);
+    check_reuse(SLV_SATOKO, 4, 8);
+#endif
+#if defined(USE_GLUCOSE) || defined(USE_SYRUP)
+    glucose_wrapper glucose;
+    check_restart(glucose);
+    check_reuse(SLV_GLUCOSE, 3, 32);
+#endif
+#ifdef USE_CMS
+    cmsat_wrapper cmsat;
+    check_restart(cmsat);
+    check_reuse(SLV_CMSAT, 3, 32);
+#endif
+    check_pool();
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that solver profiles survive being written to and read from a
+    file, that solvers configured with them find chains of the same size,
+    and that tuning never returns a profile that is worse than the one it
+    started from.
+*******************************************************************************/
+void check_round_trip(SolverType type)
+{
+    const auto& params = get_solver_params(type);
+    solver_profile profile(type, "round_trip");
+    assert(profile.values.size() == params.size());
+    for (std::size_t i = 0; i < params.size(); i++) {
+        assert(profile.values[i] == params[i].default_value);
+        assert(params[i].min_value <= params[i].default_value);
+        assert(params[i].default_value <= params[i].max_value);
+        profile.values[i] = params[i].max_value;
+    }
+    assert(!profile.set("no_such_param", 1));
+
+    const auto filename = "solver_profile_test.txt";
+    assert(profile.write(filename));
+    solver_profile read_profile;
+    assert(read_profile.read(filename));
+    remove(filename);
+    assert(read_profile.name == profile.name);
+    assert(read_profile.type == type);
+    assert(read_profile.values == profile.values);
+}
+
+void check_synthesis(const solver_profile& profile, int nr_in, int nr_tests)
+{
+    bsat_wrapper bsat;
+    ssv_encoder bsat_encoder(bsat);
+    auto solver = get_solver(profile);
+    ssv_encoder encoder(*solver);
+
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec[0] = tt;
+        chain c1, c2;
+        const auto res1 = synthesize(spec, c1, bsat, bsat_encoder);
+        assert(res1 == success);
+        const auto res2 = synthesize(spec, c2, *solver, encoder);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+    }
+}
+
+/// Synthesizes with the extreme values of all parameters.
+void check_extremes(SolverType type, int nr_in, int nr_tests)
+{
+    const auto& params = get_solver_params(type);
+    solver_profile min_profile(type), max_profile(type);
+    for (std::size_t i = 0; i < params.size(); i++) {
+        min_profile.values[i] = params[i].min_value;
+        max_profile.values[i] = params[i].max_value;
+    }
+    check_synthesis(min_profile, nr_in, nr_tests);
+    check_synthesis(max_profile, nr_in, nr_tests);
+}
+
+void check_tuning(SolverType type, EncoderType enc_type)
+{
+    auto instances = generate_tuning_instances(4, 2, enc_type, 2);
+    assert(!instances.empty());
+
+    solver_tuner tuner(instances);
+    tuner.nr_seeds = 2;
+    tuner.conflict_limit = 20000;
+    solver_profile start(type, "tuned");
+    const auto start_score = tuner.evaluate(start);
+    int64_t score;
+    const auto best = tuner.tune(start, 3, 2, &score);
+    assert(best.name == start.name);
+    assert(score <= start_score);
+    assert(tuner.evaluate(best) == score);
+    for (std::size_t i = 0; i < best.values.size(); i++) {
+        const auto& param = get_solver_params(type)[i];
+        assert(best.values[i] >= param.min_value);
+        assert(best.values[i] <= param.max_value);
+    }
+    check_synthesis(best, 3, 8);
+}
+
+int main()
+{
+    check_round_trip(SLV_BSAT2);
+    check_synthesis(solver_profile(SLV_BSAT2), 3, 16);
+    check_extremes(SLV_BSAT2, 3, 16);
+    check_tuning(SLV_BSAT2, ENC_SSV);
+    check_tuning(SLV_BSAT2, ENC_FENCE);
+    assert(generate_tuning_instances(3, 2, ENC_DAG).empty());
+#ifdef USE_SATOKO
+    check_round_trip(SLV_SATOKO);
+    check_synthesis(solver_profile(SLV_SATOKO), 3, 16);
+    check_extremes(SLV_SATOKO, 3, 16);
+    check_tuning(SLV_SATOKO, ENC_SSV);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <percy/percy.hpp>
+
+#define MAX_TESTS 256
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Tests the structural pre-filters, and verifies that synthesizers that
+    use them still find optimum chains.
+*******************************************************************************/
+void check_filter_rules()
+{
+    spec spec;
+    kitty::static_truth_table<4> tt;
+    kitty::create_from_hex_string(tt, "8000"); // 4-input AND
+    spec[0] = tt;
+    spec.preprocess();
+
+    structure_filter filter;
+    filter.set_spec(spec);
+
+    // A chain of three gates has enough free fanins.
+    partial_dag g1(2, 3);
+    g1.set_vertex(0, 0, 0);
+    g1.set_vertex(1, 0, 1);
+    g1.set_vertex(2, 0, 2);
+    assert(structure_filter::nr_pi_fanins_in_output_cone(g1) == 4);
+    assert(filter.check(g1));
+
+    // The output reads only inputs, so the rest of the DAG dangles.
+    partial_dag g2(2, 3);
+    g2.set_vertex(0, 0, 0);
+    g2.set_vertex(1, 0, 1);
+    g2.set_vertex(2, 0, 0);
+    assert(structure_filter::nr_pi_fanins_in_output_cone(g2) == 2);
+    assert(!filter.check(g2));
+
+    // Two gates cannot read four inputs.
+    partial_dag g3(2, 2);
+    g3.set_vertex(0, 0, 0);
+    g3.set_vertex(1, 0, 1);
+    assert(!filter.check(g3));
+    assert(filter.nr_checked() == 3);
+    assert(filter.nr_pruned() == 2);
+
+    fence f1(3, 2);
+    f1[0] = 2;
+    f1[1] = 1;
+    assert(filter.check(f1));
+    fence f2(2, 2);
+    f2[0] = 1;
+    f2[1] = 1;
+    assert(!filter.check(f2));
+    assert(filter.nr_pruned() == 3);
+
+    // User supplied filters run after the built-in ones.
+    filter.reset_counters();
+    filter.add_filter(structure_filter::pd_filter_fn(
+        [] (const percy::spec&, const partial_dag& dag) {
+            return dag.get_vertex(0)[1] == FANIN_PI;
+        }));
+    assert(filter.check(g1));
+    g1.set_vertex(1, 1, 1);
+    g1.set_vertex(0, 0, 1);
+    assert(!filter.check(g1));
+    assert(filter.nr_pruned() == 1);
+
+    structure_filter no_defaults(false);
+    no_defaults.set_spec(spec);
+    assert(no_defaults.check(g3));
+}
+
+void check_filter_equivalence(int nr_in)
+{
+    spec spec;
+    bsat_wrapper solver;
+    partial_dag_encoder encoder(solver);
+    encoder.reset_sim_tts(nr_in);
+
+    spec.add_alonce_clauses = false;
+    spec.add_nontriv_clauses = false;
+    spec.add_lex_func_clauses = false;
+    spec.add_colex_clauses = false;
+    spec.add_noreapply_clauses = false;
+    spec.add_symvar_clauses = false;
+
+    auto max_tests = (1 << (1 << nr_in));
+    max_tests = std::min(max_tests, MAX_TESTS);
+    dynamic_truth_table tt(nr_in);
+    chain c1, c2, c3, c4;
+
+    const auto dags = pd_generate_max(7);
+    structure_filter filter;
+
+    for (auto i = 1; i < max_tests; i++) {
+        kitty::create_from_words(tt, &i, &i+1);
+        spec[0] = tt;
+
+        const auto res1 = pd_synthesize(spec, c1, dags, solver, encoder);
+        assert(res1 == success);
+
+        const auto res2 = pd_synthesize(
+            spec, c2, dags, solver, encoder, SYNTH_STD, &filter);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+        const auto res3 = pd_synthesize_parallel(
+            spec, c3, dags, 2, nullptr, &filter);
+        assert(res3 == success);
+        assert(c1.get_nr_steps() == c3.get_nr_steps());
+        assert(c3.simulate()[0] == tt);
+
+        const auto res4 = pf_fence_synthesize(spec, c4, 2, nullptr, &filter);
+        assert(res4 == success);
+        assert(c1.get_nr_steps() == c4.get_nr_steps());
+        assert(c4.simulate()[0] == tt);
+
+        printf("(%d/%d)\r", i+1, max_tests);
+        fflush(stdout);
+    }
+    printf("\n");
+    printf("Pruned %lu/%lu structures\n",
+        (unsigned long)filter.nr_pruned(), (unsigned long)filter.nr_checked());
+    if (nr_in > 2) {
+        assert(filter.nr_pruned() > 0);
+    }
+}
+
+int main()
+{
+    check_filter_rules();
+    check_filter_equivalence(2);
+    check_filter_equivalence(3);
+    check_filter_equivalence(4);
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <algorithm>
+#include <percy/percy.hpp>
+
+#define MAX_TESTS 256
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Tests the final conflicts reported by the solvers, and verifies that
+    incremental partial DAG synthesis still finds optimum chains when it
+    skips partial DAGs using the structural nogoods learned from them.
+*******************************************************************************/
+void check_final_conflict(solver_wrapper& solver)
+{
+    solver.restart();
+    solver.set_nr_vars(4);
+    // x = 0, a = 1, b = 2, c = 3: a implies x, b implies !x.
+    pabc::lit clause1[] = { pabc::Abc_Var2Lit(1, 1), pabc::Abc_Var2Lit(0, 0) };
+    pabc::lit clause2[] = { pabc::Abc_Var2Lit(2, 1), pabc::Abc_Var2Lit(0, 1) };
+    solver.add_clause(clause1, clause1 + 2);
+    solver.add_clause(clause2, clause2 + 2);
+
+    pabc::lit assumps[] = {
+        pabc::Abc_Var2Lit(3, 0),
+        pabc::Abc_Var2Lit(1, 0),
+        pabc::Abc_Var2Lit(2, 0)
+    };
+    assert(solver.solve(assumps, assumps + 2, 0) == success);
+    assert(solver.solve(assumps, assumps + 3, 0) == failure);
+
+    std::vector<pabc::lit> conflict;
+    assert(solver.final_conflict(conflict));
+    std::sort(conflict.begin(), conflict.end());
+    assert(conflict.size() == 2);
+    assert(conflict[0] == pabc::Abc_Var2Lit(1, 0));
+    assert(conflict[1] == pabc::Abc_Var2Lit(2, 0));
+}
+
+void check_nogoods()
+{
+    partial_dag g1(2, 3);
+    g1.set_vertex(0, 0, 0);
+    g1.set_vertex(1, 0, 1);
+    g1.set_vertex(2, 1, 2);
+    partial_dag g2(2, 4);
+    g2.set_vertex(0, 0, 0);
+    g2.set_vertex(1, 0, 0);
+    g2.set_vertex(2, 1, 2);
+    g2.set_vertex(3, 0, 3);
+
+    pd_nogood ng1;
+    ng1.add_vertex(g1, 2);
+    assert(ng1.matches(g1));
+    assert(ng1.matches(g2));
+    ng1.nr_vertices = 3;
+    assert(ng1.matches(g1));
+    assert(!ng1.matches(g2));
+
+    pd_nogood ng2;
+    ng2.add_vertex(g1, 1);
+    ng2.add_vertex(g1, 2);
+    assert(ng2.matches(g1));
+    assert(!ng2.matches(g2));
+
+    spec spec;
+    kitty::static_truth_table<3> tt;
+    kitty::create_from_hex_string(tt, "e8");
+    spec[0] = tt;
+    structure_nogoods nogoods;
+    nogoods.set_spec(spec);
+    nogoods.add(ng2);
+    assert(nogoods.size() == 1);
+    assert(nogoods.blocks(g1));
+    assert(!nogoods.blocks(g2));
+    ng1.nr_vertices = -1;
+    nogoods.add(ng1);
+    assert(nogoods.size() == 1);
+    assert(nogoods.blocks(g2));
+    nogoods.add(ng2);
+    assert(nogoods.size() == 1);
+    assert(nogoods.nr_blocked_dags() == 2);
+
+    // Nogoods that fix a complete DAG also apply to isomorphic DAGs.
+    partial_dag g3(2, 4);
+    g3.set_vertex(0, 0, 0);
+    g3.set_vertex(1, 0, 1);
+    g3.set_vertex(2, 0, 0);
+    g3.set_vertex(3, 2, 3);
+    partial_dag g4(2, 4);
+    g4.set_vertex(0, 0, 0);
+    g4.set_vertex(1, 0, 0);
+    g4.set_vertex(2, 0, 1);
+    g4.set_vertex(3, 2, 3);
+    pd_nogood ng3;
+    ng3.nr_vertices = 4;
+    for (int i = 0; i < 4; i++) {
+        ng3.add_vertex(g3, i);
+    }
+    assert(ng3.is_complete());
+    assert(!ng3.matches(g4));
+    assert(!nogoods.blocks(g4));
+    nogoods.add(ng3);
+    assert(nogoods.size() == 2);
+    assert(nogoods.blocks(g3));
+    assert(nogoods.blocks(g4));
+    partial_dag g5(2, 4);
+    g5.set_vertex(0, 0, 0);
+    g5.set_vertex(1, 0, 1);
+    g5.set_vertex(2, 0, 2);
+    g5.set_vertex(3, 0, 3);
+    assert(!nogoods.blocks(g5));
+
+    // The nogoods do not carry over to other functions.
+    kitty::create_from_hex_string(tt, "96");
+    spec[0] = tt;
+    nogoods.set_spec(spec);
+    assert(nogoods.size() == 0);
+    assert(!nogoods.blocks(g1));
+}
+
+void check_nogood_synthesis(int nr_in, bool symmetry_breaking)
+{
+    spec spec;
+
+    bsat_wrapper solver;
+    partial_dag_encoder encoder(solver);
+    encoder.reset_sim_tts(nr_in);
+
+    spec.add_alonce_clauses = false;
+    spec.add_nontriv_clauses = false;
+    spec.add_lex_func_clauses = false;
+    spec.add_colex_clauses = false;
+    spec.add_noreapply_clauses = symmetry_breaking;
+    spec.add_symvar_clauses = symmetry_breaking;
+
+    auto max_tests = (1 << (1 << nr_in));
+    max_tests = std::min(max_tests, MAX_TESTS);
+    dynamic_truth_table tt(nr_in);
+    chain c1, c2;
+
+    const auto dags = pd_generate_max(7);
+    structure_nogoods nogoods;
+
+    for (auto i = 1; i < max_tests; i++) {
+        kitty::create_from_words(tt, &i, &i+1);
+        spec[0] = tt;
+
+        const auto res1 = pd_synthesize(spec, c1, dags, solver, encoder);
+        assert(res1 == success);
+
+        const auto res2 = pd_inc_synthesize(
+            spec, c2, dags, solver, encoder, nullptr, &nogoods);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+        printf("(%d/%d)\r", i+1, max_tests);
+        fflush(stdout);
+    }
+    printf("\n");
+    printf("Skipped %lu partial DAGs\n",
+        (unsigned long)nogoods.nr_blocked_dags());
+    // Symmetry breaking clauses depend on the complete DAG, so no
+    // nogoods are learned from conflicts that involve them.
+    if (nr_in > 3 && !symmetry_breaking) {
+        assert(nogoods.nr_blocked_dags() > 0);
+    }
+}
+
+int main()
+{
+    {
+        bsat_wrapper solver;
+        check_final_conflict(solver);
+    }
+#ifndef DISABLE_SATOKO
+    {
+        satoko_wrapper solver;
+        check_final_conflict(solver);
+    }
+#endif
+    {
+        bmcg_wrapper solver;
+        check_final_conflict(solver);
+    }
+
+    check_nogoods();
+    check_nogood_synthesis(3, false);
+    check_nogood_synthesis(4, false);
+    check_nogood_synthesis(4, true);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <cstdio>
+#include <percy/percy.hpp>
+
+#define MAX_TESTS 64
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Tests the store of per-structure synthesis statistics, and verifies that
+    synthesizers that order their structures by it still find optimum
+    chains.
+*******************************************************************************/
+void check_stats_store()
+{
+    spec spec;
+    kitty::static_truth_table<3> tt;
+    kitty::create_from_hex_string(tt, "e8");
+    spec[0] = tt;
+    spec.preprocess();
+
+    auto dags = pd_generate(3);
+    assert(dags.size() > 1);
+
+    structure_stats stats;
+    assert(stats.sat_probability(spec, dags[0]) == 0.5);
+    stats.add_result(spec, dags[0], failure, 0.1);
+    stats.add_result(spec, dags[0], failure, 0.1);
+    stats.add_result(spec, dags[1], success, 0.1);
+    stats.add_result(spec, dags[1], timeout, 0.1);
+    assert(stats.size() == 2);
+    assert(stats.sat_probability(spec, dags[0]) == 0.25);
+    assert(stats.sat_probability(spec, dags[1]) == 2.0 / 3.0);
+
+    // The functions of a different signature are not affected.
+    percy::spec spec2;
+    kitty::create_from_hex_string(tt, "80");
+    spec2[0] = tt;
+    spec2.preprocess();
+    assert(stats.sat_probability(spec2, dags[0]) == 0.5);
+
+    auto ordered = dags;
+    stats.order(spec, ordered);
+    assert(ordered.size() == dags.size());
+    assert(structure_stats::structure_key(ordered[0]) ==
+            structure_stats::structure_key(dags[1]));
+    assert(structure_stats::structure_key(ordered.back()) ==
+            structure_stats::structure_key(dags[0]));
+
+    fence f(3, 2);
+    f[0] = 2;
+    f[1] = 1;
+    stats.add_result(spec, f, success, 0.1);
+    assert(stats.sat_probability(spec, f) == 2.0 / 3.0);
+
+    assert(stats.save("structure_stats.txt"));
+    structure_stats loaded;
+    assert(loaded.load("structure_stats.txt"));
+    assert(loaded.size() == stats.size());
+    assert(loaded.sat_probability(spec, dags[0]) == 0.25);
+    assert(loaded.sat_probability(spec, dags[1]) == 2.0 / 3.0);
+    assert(loaded.sat_probability(spec, f) == 2.0 / 3.0);
+}
+
+void check_stats_synthesis(int nr_in)
+{
+    spec spec;
+    bsat_wrapper solver;
+    ssv_encoder encoder1(solver);
+    partial_dag_encoder encoder2(solver);
+    encoder2.reset_sim_tts(nr_in);
+
+    for (int i = 1; i <= 7; i++) {
+        const auto filename = "stats_pd" + std::to_string(i) + ".bin";
+        write_partial_dags(pd_generate_nonisomorphic(i), filename.c_str());
+    }
+    const auto dags = pd_generate_max(7);
+
+    auto max_tests = (1 << (1 << nr_in));
+    max_tests = std::min(max_tests, MAX_TESTS);
+    dynamic_truth_table tt(nr_in);
+    chain c1, c2, c3, c4;
+
+    structure_stats stats;
+    for (auto i = 1; i < max_tests; i++) {
+        kitty::create_from_words(tt, &i, &i+1);
+        spec[0] = tt;
+
+        spec.add_lex_func_clauses = true;
+        const auto res1 = synthesize(spec, c1, solver, encoder1);
+        assert(res1 == success);
+
+        spec.add_lex_func_clauses = false;
+        // Synthesize every function twice, so that the second run uses
+        // the statistics of the first.
+        for (int j = 0; j < 2; j++) {
+            const auto res2 = pd_ser_synthesize(
+                spec, c2, solver, encoder2, "stats_",
+                std::numeric_limits<int>::max(), &stats);
+            assert(res2 == success);
+            assert(c2.get_nr_steps() == c1.get_nr_steps());
+            assert(c2.simulate()[0] == tt);
+
+            const auto res3 = pd_synthesize_parallel(spec, c3, dags, 2, &stats);
+            assert(res3 == success);
+            assert(c3.get_nr_steps() == c1.get_nr_steps());
+            assert(c3.simulate()[0] == tt);
+
+            const auto res4 = pf_fence_synthesize(spec, c4, 2, &stats);
+            assert(res4 == success);
+            assert(c4.get_nr_steps() == c1.get_nr_steps());
+            assert(c4.simulate()[0] == tt);
+        }
+
+        printf("(%d/%d)\r", i+1, max_tests);
+        fflush(stdout);
+    }
+    printf("\n");
+    assert(stats.size() > 0);
+}
+
+int main()
+{
+    check_stats_store();
+    check_stats_synthesis(2);
+    check_stats_synthesis(3);
+    check_stats_synthesis(4);
+
+    return 0;
+}
@@ -27,7 +27,7 @@ void check_fence_equivalence(int nr_in, bool full_coverage)
     }
     dynamic_truth_table tt(nr_in);
 
-    chain c1, c1_cegar, c2, c2_cegar;
+    chain c1, c1_cegar, c2, c2_cegar, c3;
 
     for (auto i = 1; i < max_tests; i++) {
         kitty::create_from_words(tt, &i, &i+1);
@@ -57,12 +57,20 @@ void check_fence_equivalence(int nr_in, bool full_coverage)
         auto c2_cegar_nr_vertices = c2.get_nr_steps();
         assert(c2_cegar.satisfies_spec(spec));
 
+        auto res3 = synthesize(spec, c3, solver, encoder1, SYNTH_ENUM);
+        assert(res3 == success);
+        auto sim_tts3 = c3.simulate();
+        auto c3_nr_vertices = c3.get_nr_steps();
+        assert(c3.satisfies_spec(spec));
+
         assert(c1_nr_vertices == c2_nr_vertices);
         assert(c1_nr_vertices == c1_cegar_nr_vertices);
         assert(c1_cegar_nr_vertices == c2_cegar_nr_vertices);
+        assert(c1_nr_vertices == c3_nr_vertices);
         assert(sim_tts1[0] == sim_tts2[0]);
         assert(sim_tts1[0] == sim_tts1_cegar[0]);
         assert(sim_tts1_cegar[0] == sim_tts2_cegar[0]);
+        assert(sim_tts1[0] == sim_tts3[0]);
         
         printf("(%d/%d)\r", i+1, max_tests);
         fflush(stdout);
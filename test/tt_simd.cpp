@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <percy/percy.hpp>
+
+using namespace percy;
+
+/*******************************************************************************
+    Verifies that the vectorized truth table kernels agree with their scalar
+    versions for all supported instruction sets, for all table sizes and
+    for aliased inputs and outputs.
+*******************************************************************************/
+uint64_t random_word()
+{
+    return (uint64_t(rand()) << 62) ^ (uint64_t(rand()) << 31) ^ uint64_t(rand());
+}
+
+std::vector<uint64_t> random_words(int nr_words)
+{
+    std::vector<uint64_t> words(nr_words);
+    for (auto& word : words) {
+        word = random_word();
+    }
+    return words;
+}
+
+uint64_t maj(uint64_t a, uint64_t b, uint64_t c)
+{
+    return (a & b) | (a & c) | (b & c);
+}
+
+void check_kernels(int nr_words)
+{
+    const auto ones = ~uint64_t(0);
+    const auto x = random_words(nr_words);
+    const auto y = random_words(nr_words);
+    const auto z = random_words(nr_words);
+    std::vector<uint64_t> out(nr_words);
+
+    for (int inv = 0; inv < 16; inv++) {
+        const uint64_t ix = (inv & 1) ? ones : 0;
+        const uint64_t iy = (inv & 2) ? ones : 0;
+        const uint64_t iz = (inv & 4) ? ones : 0;
+        const uint64_t io = (inv & 8) ? ones : 0;
+
+        tt_and_inv(x.data(), y.data(), out.data(), nr_words, ix, iy, io);
+        for (int i = 0; i < nr_words; i++) {
+            assert(out[i] == (((x[i] ^ ix) & (y[i] ^ iy)) ^ io));
+        }
+        tt_xor_inv(x.data(), y.data(), out.data(), nr_words, io);
+        for (int i = 0; i < nr_words; i++) {
+            assert(out[i] == (x[i] ^ y[i] ^ io));
+        }
+        tt_not_inv(x.data(), out.data(), nr_words, io);
+        for (int i = 0; i < nr_words; i++) {
+            assert(out[i] == (x[i] ^ io));
+        }
+        tt_maj_inv(x.data(), y.data(), z.data(), out.data(), nr_words,
+                ix, iy, iz, io);
+        for (int i = 0; i < nr_words; i++) {
+            assert(out[i] == (maj(x[i] ^ ix, y[i] ^ iy, z[i] ^ iz) ^ io));
+        }
+    }
+
+    // The output may be one of the inputs.
+    auto w = x;
+    tt_and_inv(w.data(), y.data(), w.data(), nr_words);
+    for (int i = 0; i < nr_words; i++) {
+        assert(w[i] == (x[i] & y[i]));
+    }
+
+    // Plant a single difference at every position, with and without
+    // inversion and don't cares.
+    for (int64_t bit = 0; bit < int64_t(nr_words) * 64; bit += 1 + rand() % 37) {
+        auto a = x;
+        a[bit / 64] ^= uint64_t(1) << (bit % 64);
+        assert(tt_find_first_difference(a.data(), x.data(), nr_words) == bit);
+
+        std::vector<uint64_t> b(nr_words);
+        for (int i = 0; i < nr_words; i++) {
+            b[i] = ~x[i];
+        }
+        assert(tt_find_first_difference(a.data(), b.data(), nr_words,
+                    nullptr, ones) == bit);
+
+        std::vector<uint64_t> dc(nr_words, 0);
+        dc[bit / 64] = uint64_t(1) << (bit % 64);
+        assert(tt_find_first_difference(a.data(), x.data(), nr_words,
+                    dc.data()) == -1);
+    }
+    assert(tt_find_first_difference(x.data(), x.data(), nr_words) == -1);
+
+    // Bits outside of the last word mask are ignored.
+    auto a = x;
+    a[nr_words - 1] ^= uint64_t(1) << 63;
+    assert(tt_find_first_difference(a.data(), x.data(), nr_words, nullptr,
+                0, ~uint64_t(0) >> 1) == -1);
+}
+
+int main()
+{
+    srand(1);
+    const auto max_level = detect_simd_level();
+    printf("CPU supports %s\n", simd_level_name(max_level));
+    for (int level = SIMD_SCALAR; level <= max_level; level++) {
+        set_simd_level(simd_level(level));
+        assert(get_simd_level() == level);
+        for (int nr_words = 1; nr_words <= 70; nr_words++) {
+            check_kernels(nr_words);
+        }
+        printf("%s kernels verified\n", simd_level_name(simd_level(level)));
+    }
+    set_simd_level(SIMD_AVX512);
+    assert(get_simd_level() == max_level);
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <cstdio>
+#include <cstdlib>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that synthesizers which warm-start their solvers from the
+    previous formula find chains of the same size as cold-started ones, and
+    that the variables of related encodings are matched by their roles.
+*******************************************************************************/
+
+/// The roles of an encoding must be unique, and the roles of the first
+/// steps must not change when steps are added.
+void check_roles(int nr_in)
+{
+    bsat_wrapper solver;
+    ssv_encoder encoder(solver);
+    spec spec;
+    dynamic_truth_table tt(nr_in);
+    kitty::create_majority(tt);
+    spec[0] = tt;
+    spec.preprocess();
+
+    std::vector<int64_t> prev_roles, roles;
+    for (int k = 1; k <= 5; k++) {
+        spec.nr_steps = k;
+        solver.restart();
+        encoder.encode(spec);
+        encoder.get_var_roles(spec, roles);
+        assert(int(roles.size()) == solver.nr_vars());
+
+        auto sorted = roles;
+        std::sort(sorted.begin(), sorted.end());
+        const auto first_role = std::upper_bound(sorted.begin(),
+                sorted.end(), int64_t(-1));
+        assert(std::adjacent_find(first_role, sorted.end()) == sorted.end());
+        assert(first_role != sorted.end());
+
+        // The selection variables of a step are the same, whatever the
+        // number of steps.
+        std::vector<int64_t> sel_roles, prev_sel_roles;
+        for (const auto role : roles) {
+            if (role != -1 && (role >> 56) == ROLE_SEL) {
+                sel_roles.push_back(role);
+            }
+        }
+        for (const auto role : prev_roles) {
+            if (role != -1 && (role >> 56) == ROLE_SEL) {
+                prev_sel_roles.push_back(role);
+            }
+        }
+        std::sort(sel_roles.begin(), sel_roles.end());
+        std::sort(prev_sel_roles.begin(), prev_sel_roles.end());
+        assert(std::includes(sel_roles.begin(), sel_roles.end(),
+                    prev_sel_roles.begin(), prev_sel_roles.end()));
+        prev_roles = roles;
+    }
+}
+
+/// The saved heuristics of a solver are loaded into another solver with
+/// the same formula.
+void check_round_trip(solver_wrapper& solver1, solver_wrapper& solver2)
+{
+    spec spec;
+    dynamic_truth_table tt(4);
+    kitty::create_from_hex_string(tt, "1ac8");
+    spec[0] = tt;
+    spec.preprocess();
+    spec.nr_steps = 4;
+
+    ssv_encoder encoder1(solver1);
+    ssv_encoder encoder2(solver2);
+    solver1.restart();
+    const auto encoded1 = encoder1.encode(spec);
+    assert(encoded1);
+    assert(solver1.solve(0) == failure);
+
+    std::vector<uint8_t> phases;
+    std::vector<double> activities;
+    if (!solver1.save_heuristics(phases, activities)) {
+        return;
+    }
+    assert(int(phases.size()) == solver1.nr_vars());
+    assert(phases.size() == activities.size());
+    for (const auto act : activities) {
+        assert(act >= 0 && act <= 1);
+    }
+
+    warm_start ws;
+    ws.save(spec, encoder1, solver1);
+    assert(ws.size() > 0);
+    solver2.restart();
+    const auto encoded2 = encoder2.encode(spec);
+    assert(encoded2);
+    assert(ws.load(spec, encoder2, solver2) > 0);
+    assert(solver2.solve(0) == failure);
+}
+
+void check_std(solver_wrapper& solver, int nr_in, int nr_tests, bool cegar)
+{
+    ssv_encoder encoder(solver);
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec[0] = tt;
+        chain c1, c2;
+        const auto res1 = synthesize(spec, c1, solver, encoder,
+                cegar ? SYNTH_STD_CEGAR : SYNTH_STD);
+        assert(res1 == success);
+
+        spec.warm_start = true;
+        const auto res2 = synthesize(spec, c2, solver, encoder,
+                cegar ? SYNTH_STD_CEGAR : SYNTH_STD);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+    }
+}
+
+void check_fence(solver_wrapper& solver, int nr_in, int nr_tests)
+{
+    ssv_fence2_encoder encoder(solver);
+    encoder.reset_sim_tts(nr_in);
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec.add_lex_func_clauses = false;
+        spec[0] = tt;
+        chain c1, c2;
+        const auto res1 = fence_synthesize(spec, c1, solver, encoder);
+        assert(res1 == success);
+
+        spec.warm_start = true;
+        const auto res2 = fence_synthesize(spec, c2, solver, encoder);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+    }
+}
+
+void check_pd(solver_wrapper& solver, int nr_in, int nr_tests,
+        const std::vector<partial_dag>& dags)
+{
+    partial_dag_encoder encoder(solver);
+    encoder.reset_sim_tts(nr_in);
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec.add_alonce_clauses = false;
+        spec.add_nontriv_clauses = false;
+        spec.add_lex_func_clauses = false;
+        spec.add_colex_clauses = false;
+        spec.add_noreapply_clauses = false;
+        spec.add_symvar_clauses = false;
+        spec[0] = tt;
+        chain c1, c2, c3;
+        const auto res1 = pd_synthesize(spec, c1, dags, solver, encoder);
+        assert(res1 == success);
+
+        spec.warm_start = true;
+        const auto res2 = pd_synthesize(spec, c2, dags, solver, encoder);
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c2.get_nr_steps());
+
+        const auto res3 = pd_synthesize(spec, c3, dags, solver, encoder,
+                SYNTH_STD_CEGAR);
+        assert(res3 == success);
+        assert(c3.satisfies_spec(spec));
+        assert(c1.get_nr_steps() == c3.get_nr_steps());
+    }
+}
+
+int main()
+{
+    check_roles(3);
+    check_roles(4);
+
+    bsat_wrapper bsat1, bsat2;
+    check_round_trip(bsat1, bsat2);
+#ifdef USE_SATOKO
+    satoko_wrapper satoko1, satoko2;
+    check_round_trip(satoko1, satoko2);
+#endif
+#if defined(USE_GLUCOSE)
+    glucose_wrapper glucose1, glucose2;
+    check_round_trip(glucose1, glucose2);
+#endif
+
+    const auto dags = pd_generate_max(6);
+    bsat_wrapper bsat;
+    check_std(bsat, 3, 32, false);
+    check_std(bsat, 4, 8, true);
+    check_fence(bsat, 4, 8);
+    check_pd(bsat, 4, 8, dags);
+#ifdef USE_SATOKO
+    satoko_wrapper satoko;
+    check_std(satoko, 3, 32, false);
+    check_std(satoko, 4, 8, true);
+    check_fence(satoko, 4, 8);
+    check_pd(satoko, 4, 8, dags);
+#endif
+#if defined(USE_GLUCOSE)
+    glucose_wrapper glucose;
+    check_std(glucose, 3, 32, false);
+    check_fence(glucose, 4, 8);
+#endif
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <percy/percy.hpp>
+
+using namespace percy;
+using kitty::dynamic_truth_table;
+
+/*******************************************************************************
+    Verifies that the parallel synthesizers find chains of optimum size
+    with the solvers and encoders that factories create for their workers,
+    and that every worker asks the factories for its own solver and
+    encoder.
+*******************************************************************************/
+const int nr_threads = 3;
+
+/// Records the workers that created solvers and encoders.
+struct worker_log
+{
+    std::mutex mutex;
+    std::set<int> solvers;
+    std::set<int> encoders;
+
+    solver_factory wrap(const solver_factory& make_solver)
+    {
+        return [this, make_solver](int i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            solvers.insert(i);
+            return make_solver(i);
+        };
+    }
+
+    template<typename Encoder>
+    encoder_factory<Encoder> make_encoder()
+    {
+        return [this](solver_wrapper& solver, int i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            encoders.insert(i);
+            return std::unique_ptr<Encoder>(new Encoder(solver));
+        };
+    }
+
+    /// Workers that find the queue empty may never start, but all
+    /// workers that started must have been diversified by index.
+    void check()
+    {
+        assert(!solvers.empty());
+        assert(solvers == encoders);
+        for (const auto i : solvers) {
+            assert(i >= 0 && i < nr_threads);
+        }
+        solvers.clear();
+        encoders.clear();
+    }
+};
+
+void check_pd(const solver_factory& make_solver, int nr_in, int nr_tests)
+{
+    bsat_wrapper bsat;
+    ssv_encoder encoder(bsat);
+    const auto dags = pd_generate_max(6);
+    worker_log log;
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec[0] = tt;
+        chain c1, c2, c3;
+        const auto res1 = synthesize(spec, c1, bsat, encoder);
+        assert(res1 == success);
+        if (c1.get_nr_steps() == 0) {
+            continue;
+        }
+
+        // The partial DAG encodings order the steps differently.
+        spec.add_lex_func_clauses = false;
+        spec.add_colex_clauses = false;
+        const auto res2 = pd_synthesize_parallel(spec, c2, dags, nr_threads,
+                nullptr, nullptr, log.wrap(make_solver),
+                log.make_encoder<partial_dag_encoder>());
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c2.get_nr_steps() == c1.get_nr_steps());
+        log.check();
+
+        const auto res3 = pd_cegar_synthesize_parallel(spec, c3, dags,
+                nr_threads, nullptr, log.wrap(make_solver),
+                log.make_encoder<partial_dag_encoder>());
+        assert(res3 == success);
+        assert(c3.satisfies_spec(spec));
+        assert(c3.get_nr_steps() == c1.get_nr_steps());
+        log.check();
+    }
+}
+
+void check_fence(const solver_factory& make_solver, int nr_in, int nr_tests)
+{
+    bsat_wrapper bsat;
+    ssv_encoder encoder(bsat);
+    worker_log log;
+    dynamic_truth_table tt(nr_in);
+    for (int t = 0; t < nr_tests; t++) {
+        kitty::create_random(tt, t);
+        spec spec;
+        spec[0] = tt;
+        chain c1, c2, c3;
+        const auto res1 = synthesize(spec, c1, bsat, encoder);
+        assert(res1 == success);
+        if (c1.get_nr_steps() == 0) {
+            continue;
+        }
+
+        spec.add_lex_func_clauses = false;
+        const auto res2 = pf_fence_synthesize(spec, c2, nr_threads,
+                nullptr, nullptr, log.wrap(make_solver),
+                log.make_encoder<ssv_fence2_encoder>());
+        assert(res2 == success);
+        assert(c2.satisfies_spec(spec));
+        assert(c2.get_nr_steps() == c1.get_nr_steps());
+        log.check();
+
+        const auto res3 = pf_fence_cegar_synthesize(spec, c3, nr_threads,
+                nullptr, nullptr, log.wrap(make_solver),
+                log.make_encoder<ssv_fence2_encoder>());
+        assert(res3 == success);
+        assert(c3.satisfies_spec(spec));
+        assert(c3.get_nr_steps() == c1.get_nr_steps());
+        log.check();
+    }
+}
+
+void check_maj(const solver_factory& make_solver)
+{
+    worker_log log;
+    for (const auto nr_in : { 3, 5 }) {
+        dynamic_truth_table tt(nr_in);
+        kitty::create_majority(tt);
+        spec spec;
+        spec[0] = tt;
+        mig m1, m2;
+        const auto res1 = parallel_maj_synthesize(spec, m1, nr_threads);
+        assert(res1 == success);
+        const auto res2 = parallel_maj_synthesize(spec, m2, nr_threads,
+                log.wrap(make_solver), log.make_encoder<maj_encoder>());
+        assert(res2 == success);
+        assert(m2.satisfies_spec(spec));
+        assert(m2.get_nr_steps() == m1.get_nr_steps());
+        log.check();
+    }
+}
+
+#ifdef USE_SATOKO
+/// The variants that diversify the workers must not override the values
+/// of a tuned profile.
+void check_tuned_satoko()
+{
+    solver_profile profile(SLV_SATOKO, "tuned");
+    profile.set("var_decay", 0.85);
+    profile.set("f_rst", 0.7);
+    profile.set("b_rst", 1.6);
+    const auto make_solver = make_solver_factory(profile);
+    for (int i = 0; i < 2 * nr_threads; i++) {
+        const auto solver = make_solver(i);
+        const auto& opts =
+            static_cast<satoko_wrapper&>(*solver).get_options();
+        assert(opts.var_decay == 0.85);
+        assert(opts.f_rst == 0.7);
+        assert(opts.b_rst == 1.6);
+    }
+    check_pd(make_solver, 3, 8);
+}
+#endif
+
+int main()
+{
+    const auto bsat = make_solver_factory(SLV_BSAT2);
+    check_pd(bsat, 3, 16);
+    check_pd(bsat, 4, 4);
+    check_fence(bsat, 3, 16);
+    check_maj(bsat);
+
+    solver_profile profile(SLV_BSAT2, "tuned");
+    profile.set("nLearntStart", 2000);
+    check_pd(make_solver_factory(profile, false), 3, 8);
+#ifdef USE_SATOKO
+    const auto satoko = make_solver_factory(SLV_SATOKO);
+    check_pd(satoko, 3, 16);
+    check_pd(satoko, 4, 4);
+    check_fence(satoko, 3, 16);
+    check_maj(satoko);
+    check_tuned_satoko();
+#endif
+
+    return 0;
+}